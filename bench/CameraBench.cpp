@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+#include "Camera.h"
+
+// The orbit moves the eye every iteration, so the view matrix is rebuilt
+static void BM_CameraOrbitViewProjection(benchmark::State& state) {
+    Camera camera;
+    float yaw = 0.0f;
+    for (auto _ : state) {
+        camera.OrbitAround(glm::vec3(0.0f), 10.0f, 30.0f, yaw);
+        yaw += 0.5f;
+        benchmark::DoNotOptimize(camera.GetViewProjectionMatrix());
+    }
+}
+BENCHMARK(BM_CameraOrbitViewProjection);
+
+// Mouse look followed by a step forward, as the free camera moves
+static void BM_CameraRotateTranslate(benchmark::State& state) {
+    Camera camera;
+    camera.LookAt(glm::vec3(0.0f, 2.0f, 8.0f), glm::vec3(0.0f));
+    float step = 0.01f;
+    for (auto _ : state) {
+        camera.Rotate(0.1f, 0.2f);
+        camera.Translate(glm::vec3(0.0f, 0.0f, step));
+        step = -step;
+        benchmark::DoNotOptimize(camera.GetViewProjectionMatrix());
+    }
+}
+BENCHMARK(BM_CameraRotateTranslate);
+
+// Window resize: only the projection is rebuilt
+static void BM_CameraSetAspectRatio(benchmark::State& state) {
+    Camera camera;
+    float aspect = 16.0f / 9.0f;
+    for (auto _ : state) {
+        camera.SetAspectRatio(aspect);
+        aspect = aspect > 1.5f ? 4.0f / 3.0f : 16.0f / 9.0f;
+        benchmark::DoNotOptimize(camera.GetViewProjectionMatrix());
+    }
+}
+BENCHMARK(BM_CameraSetAspectRatio);
+
+// Nothing changed, both matrices come from the cache
+static void BM_CameraViewProjectionCached(benchmark::State& state) {
+    Camera camera;
+    camera.LookAt(glm::vec3(0.0f, 2.0f, 8.0f), glm::vec3(0.0f));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(camera.GetViewProjectionMatrix());
+    }
+}
+BENCHMARK(BM_CameraViewProjectionCached);
@@ -0,0 +1,165 @@
+# Compares a Google Benchmark JSON report with the stored baseline and fails
+# when any benchmark's CPU time grew by more than its threshold, or when a
+# baseline benchmark is missing from the report. UPDATE=ON rewrites the
+# baseline from the report instead, keeping existing thresholds.
+#
+#   cmake -DRESULTS=<report.json> -DBASELINE=<baseline.json> [-DUPDATE=ON] -P CompareBaseline.cmake
+#
+# Times are stored and compared as integer picoseconds since math() has no
+# floating point.
+cmake_minimum_required(VERSION 3.20)
+
+set(DEFAULT_THRESHOLD 25)  # Percent
+
+# Converts a decimal time in the given unit to integer picoseconds
+function(to_picoseconds value unit out)
+    if(NOT value MATCHES "^([0-9]+)(\\.([0-9]*))?$")
+        message(FATAL_ERROR "Unexpected time value ${value}")
+    endif()
+    set(whole ${CMAKE_MATCH_1})
+    string(SUBSTRING "${CMAKE_MATCH_3}000000" 0 6 fraction)
+    string(REGEX REPLACE "^0+([0-9])" "\\1" fraction "${fraction}")
+    if(unit STREQUAL "ns")
+        set(scale 1000)
+    elseif(unit STREQUAL "us")
+        set(scale 1000000)
+    elseif(unit STREQUAL "ms")
+        set(scale 1000000000)
+    elseif(unit STREQUAL "s")
+        set(scale 1000000000000)
+    else()
+        message(FATAL_ERROR "Unknown time unit ${unit}")
+    endif()
+    math(EXPR result "${whole} * ${scale} + ${fraction} * ${scale} / 1000000")
+    set(${out} ${result} PARENT_SCOPE)
+endfunction()
+
+# Picoseconds as nanoseconds with three decimals
+function(to_nanoseconds picoseconds out)
+    math(EXPR whole "${picoseconds} / 1000")
+    math(EXPR fraction "${picoseconds} % 1000 + 1000")
+    string(SUBSTRING "${fraction}" 1 3 fraction)
+    set(${out} "${whole}.${fraction}" PARENT_SCOPE)
+endfunction()
+
+if(NOT EXISTS "${RESULTS}")
+    message(FATAL_ERROR "Benchmark report ${RESULTS} not found")
+endif()
+file(READ "${RESULTS}" results)
+
+# Median CPU time per benchmark; single runs count when there are no medians
+set(names)
+set(times)
+set(singleNames)
+set(singleTimes)
+string(JSON count LENGTH "${results}" benchmarks)
+if(count GREATER 0)
+    math(EXPR last "${count} - 1")
+    foreach(i RANGE ${last})
+        string(JSON entry GET "${results}" benchmarks ${i})
+        string(JSON runName GET "${entry}" run_name)
+        # Benchmarks that failed have no time and are reported missing
+        string(JSON failed ERROR_VARIABLE noErrorField GET "${entry}" error_occurred)
+        if(failed)
+            continue()
+        endif()
+        string(JSON runType GET "${entry}" run_type)
+        string(JSON cpuTime GET "${entry}" cpu_time)
+        string(JSON unit GET "${entry}" time_unit)
+        if(runType STREQUAL "aggregate")
+            string(JSON aggregate GET "${entry}" aggregate_name)
+            if(aggregate STREQUAL "median")
+                to_picoseconds(${cpuTime} ${unit} picoseconds)
+                list(APPEND names "${runName}")
+                list(APPEND times ${picoseconds})
+            endif()
+        elseif(NOT runName IN_LIST singleNames)
+            to_picoseconds(${cpuTime} ${unit} picoseconds)
+            list(APPEND singleNames "${runName}")
+            list(APPEND singleTimes ${picoseconds})
+        endif()
+    endforeach()
+endif()
+if(NOT names)
+    set(names ${singleNames})
+    set(times ${singleTimes})
+endif()
+if(NOT names)
+    message(FATAL_ERROR "No benchmarks in ${RESULTS}")
+endif()
+
+if(EXISTS "${BASELINE}")
+    file(READ "${BASELINE}" baseline)
+else()
+    set(baseline "{\"benchmarks\": {}}")
+endif()
+
+if(UPDATE)
+    list(LENGTH names count)
+    math(EXPR last "${count} - 1")
+    foreach(i RANGE ${last})
+        list(GET names ${i} name)
+        list(GET times ${i} picoseconds)
+        string(JSON threshold ERROR_VARIABLE missing GET "${baseline}" benchmarks "${name}" threshold_percent)
+        if(missing)
+            set(threshold ${DEFAULT_THRESHOLD})
+        endif()
+        string(JSON baseline SET "${baseline}" benchmarks "${name}"
+               "{\"cpu_time_ps\": ${picoseconds}, \"threshold_percent\": ${threshold}}")
+    endforeach()
+    file(WRITE "${BASELINE}" "${baseline}\n")
+    message("Baseline ${BASELINE} updated with ${count} benchmarks")
+    return()
+endif()
+
+set(failures)
+string(JSON count LENGTH "${baseline}" benchmarks)
+if(count EQUAL 0)
+    message(FATAL_ERROR "Baseline ${BASELINE} is empty, record one with the bench_baseline target")
+endif()
+math(EXPR last "${count} - 1")
+foreach(i RANGE ${last})
+    string(JSON name MEMBER "${baseline}" benchmarks ${i})
+    string(JSON expected GET "${baseline}" benchmarks "${name}" cpu_time_ps)
+    string(JSON threshold ERROR_VARIABLE missing GET "${baseline}" benchmarks "${name}" threshold_percent)
+    if(missing)
+        set(threshold ${DEFAULT_THRESHOLD})
+    endif()
+
+    list(FIND names "${name}" index)
+    if(index EQUAL -1)
+        message("  MISSING    ${name}")
+        list(APPEND failures "${name} (missing)")
+        continue()
+    endif()
+    list(GET times ${index} measured)
+
+    # Change in tenths of a percent, for the report only
+    math(EXPR change "(${measured} - ${expected}) * 1000 / (${expected} + 1)")
+    math(EXPR changeWhole "${change} / 10")
+    math(EXPR changeTenth "${change} % 10")
+    if(changeTenth LESS 0)
+        math(EXPR changeTenth "-${changeTenth}")
+        if(changeWhole EQUAL 0)
+            set(changeWhole "-0")
+        endif()
+    endif()
+    to_nanoseconds(${measured} measuredNs)
+    to_nanoseconds(${expected} expectedNs)
+    set(line "${name}: ${measuredNs} ns (baseline ${expectedNs} ns, ${changeWhole}.${changeTenth}%, limit +${threshold}%)")
+
+    math(EXPR limit "${expected} * (100 + ${threshold})")
+    math(EXPR scaled "${measured} * 100")
+    if(scaled GREATER limit)
+        message("  REGRESSED  ${line}")
+        list(APPEND failures "${name}")
+    else()
+        message("  ok         ${line}")
+    endif()
+endforeach()
+
+if(failures)
+    list(JOIN failures ", " failed)
+    message(FATAL_ERROR "Benchmark regressions: ${failed}")
+endif()
+message("All ${count} benchmarks within their thresholds")
@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+#include "Renderer.h"
+#include "StubGL.h"
+#include <filesystem>
+
+// Source directory, set by bench/CMakeLists.txt
+#ifndef BENCH_SHADER_DIR
+#define BENCH_SHADER_DIR "shaders"
+#endif
+
+// A GL Renderer that was never initialized draws lines through the native
+// path, so each call is the vertex generation plus one buffer upload and draw
+// into the stub loader. The *Instanced variants initialize it first, which is
+// the default path: segments packed into instance records, streamed through a
+// mapped ring buffer and drawn with one instanced quad draw.
+
+// Renderer::Initialize loads its shaders from ./shaders
+static bool InitializeInstanced(Renderer& renderer) {
+    std::error_code error;
+    std::filesystem::path previous = std::filesystem::current_path();
+    std::filesystem::current_path(std::filesystem::absolute(BENCH_SHADER_DIR).parent_path(), error);
+    bool initialized = !error && renderer.Initialize();
+    std::filesystem::current_path(previous, error);
+    return initialized && renderer.IsInstancedLines();
+}
+
+static void BM_DrawGrid(benchmark::State& state) {
+    InstallStubGL();
+    Renderer renderer;
+    int gridSize = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        renderer.DrawGrid(gridSize, 1.0f);
+    }
+    state.SetItemsProcessed(state.iterations() * (gridSize + 1) * 2);  // Lines
+}
+BENCHMARK(BM_DrawGrid)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_DrawCircle(benchmark::State& state) {
+    InstallStubGL();
+    Renderer renderer;
+    int segments = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        renderer.DrawCircle(0.0f, 0.0f, 1.0f, segments);
+    }
+    state.SetItemsProcessed(state.iterations() * segments);
+}
+BENCHMARK(BM_DrawCircle)->Arg(32)->Arg(256)->Arg(4096);
+
+static void BM_DrawGridInstanced(benchmark::State& state) {
+    InstallStubGL();
+    Renderer renderer;
+    if (!InitializeInstanced(renderer)) {
+        state.SkipWithError("Instanced line renderer unavailable");
+        return;
+    }
+    int gridSize = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        renderer.DrawGrid(gridSize, 1.0f);
+    }
+    state.SetItemsProcessed(state.iterations() * (gridSize + 1) * 2);
+}
+BENCHMARK(BM_DrawGridInstanced)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_DrawCircleInstanced(benchmark::State& state) {
+    InstallStubGL();
+    Renderer renderer;
+    if (!InitializeInstanced(renderer)) {
+        state.SkipWithError("Instanced line renderer unavailable");
+        return;
+    }
+    int segments = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        renderer.DrawCircle(0.0f, 0.0f, 1.0f, segments);
+    }
+    state.SetItemsProcessed(state.iterations() * segments);
+}
+BENCHMARK(BM_DrawCircleInstanced)->Arg(32)->Arg(256)->Arg(4096);
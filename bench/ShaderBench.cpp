@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include "Shader.h"
+#include "StubGL.h"
+#include <vector>
+
+// Source directory, set by bench/CMakeLists.txt
+#ifndef BENCH_SHADER_DIR
+#define BENCH_SHADER_DIR "shaders"
+#endif
+
+// Reads both stages from disk and submits them for compile and link
+static void BM_ShaderLoad(benchmark::State& state) {
+    InstallStubGL();
+    for (auto _ : state) {
+        Shader shader(BENCH_SHADER_DIR "/vertex.glsl", BENCH_SHADER_DIR "/fragment.glsl");
+        benchmark::DoNotOptimize(shader.GetID());
+    }
+}
+BENCHMARK(BM_ShaderLoad);
+
+// Three stages plus the uniform block binding, as the multi-view program does
+static void BM_ShaderLoadGeometry(benchmark::State& state) {
+    InstallStubGL();
+    for (auto _ : state) {
+        Shader shader(BENCH_SHADER_DIR "/vertex_multiview.glsl", BENCH_SHADER_DIR "/geometry_multiview.glsl",
+                      BENCH_SHADER_DIR "/fragment.glsl");
+        shader.SetUniformBlock("Views", 0);
+        benchmark::DoNotOptimize(shader.GetID());
+    }
+}
+BENCHMARK(BM_ShaderLoadGeometry);
+
+// The uniforms the scene pass sets once per frame
+static void BM_ShaderFrameUniforms(benchmark::State& state) {
+    InstallStubGL();
+    Shader shader(BENCH_SHADER_DIR "/vertex.glsl", BENCH_SHADER_DIR "/fragment.glsl");
+    glm::mat4 view(1.0f);
+    glm::mat4 projection(1.0f);
+    for (auto _ : state) {
+        shader.Use();
+        shader.SetMat4("view", view);
+        shader.SetMat4("projection", projection);
+        shader.SetVec3("lightPos", glm::vec3(1.2f, 1.0f, 2.0f));
+        shader.SetVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
+        shader.SetInt("cascadeCount", 0);
+        shader.SetBool("useTexture", false);
+    }
+    state.counters["glCalls"] = benchmark::Counter(static_cast<double>(GetStubGLCallCount()),
+                                                   benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_ShaderFrameUniforms);
+
+// Per-object model, color and texture flag for the non-instanced scene draw
+static void ObjectUniforms(benchmark::State& state, const Shader& shader) {
+    size_t count = static_cast<size_t>(state.range(0));
+    std::vector<glm::mat4> world(count, glm::mat4(1.0f));
+    std::vector<glm::vec3> colors(count, glm::vec3(0.8f, 0.3f, 0.2f));
+    for (auto _ : state) {
+        for (size_t i = 0; i < count; ++i) {
+            shader.SetMat4("model", world[i]);
+            shader.SetVec3("objectColor", colors[i]);
+            shader.SetBool("useTexture", (i & 1) != 0);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void BM_ShaderObjectUniforms(benchmark::State& state) {
+    InstallStubGL();
+    Shader shader(BENCH_SHADER_DIR "/vertex.glsl", BENCH_SHADER_DIR "/fragment.glsl");
+    shader.Use();
+    ObjectUniforms(state, shader);
+}
+BENCHMARK(BM_ShaderObjectUniforms)->Arg(100)->Arg(1000);
+
+// Software mode keeps the values on the CPU instead of calling GL
+static void BM_ShaderObjectUniformsSoftware(benchmark::State& state) {
+    Shader::SetSoftwareMode(true);
+    Shader shader(BENCH_SHADER_DIR "/vertex.glsl", BENCH_SHADER_DIR "/fragment.glsl");
+    shader.Use();
+    ObjectUniforms(state, shader);
+    Shader::SetSoftwareMode(false);
+}
+BENCHMARK(BM_ShaderObjectUniformsSoftware)->Arg(100)->Arg(1000);
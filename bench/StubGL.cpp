@@ -0,0 +1,182 @@
+#include "StubGL.h"
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+size_t s_calls = 0;
+GLuint s_nextName = 1;
+std::vector<char> s_mapped;  // Backs every glMapBufferRange
+
+void APIENTRY StubAttachShader(GLuint, GLuint) { ++s_calls; }
+void APIENTRY StubBindBuffer(GLenum, GLuint) { ++s_calls; }
+void APIENTRY StubBindVertexArray(GLuint) { ++s_calls; }
+void APIENTRY StubBlendFuncSeparate(GLenum, GLenum, GLenum, GLenum) { ++s_calls; }
+void APIENTRY StubBufferData(GLenum, GLsizeiptr, const void*, GLenum) { ++s_calls; }
+void APIENTRY StubBufferSubData(GLenum, GLintptr, GLsizeiptr, const void*) { ++s_calls; }
+void APIENTRY StubCompileShader(GLuint) { ++s_calls; }
+void APIENTRY StubDeleteBuffers(GLsizei, const GLuint*) { ++s_calls; }
+void APIENTRY StubDeleteProgram(GLuint) { ++s_calls; }
+void APIENTRY StubDeleteShader(GLuint) { ++s_calls; }
+void APIENTRY StubDeleteSync(GLsync) { ++s_calls; }
+void APIENTRY StubDeleteVertexArrays(GLsizei, const GLuint*) { ++s_calls; }
+void APIENTRY StubDisable(GLenum) { ++s_calls; }
+void APIENTRY StubDrawArrays(GLenum, GLint, GLsizei) { ++s_calls; }
+void APIENTRY StubDrawArraysInstanced(GLenum, GLint, GLsizei, GLsizei) { ++s_calls; }
+void APIENTRY StubEnable(GLenum) { ++s_calls; }
+void APIENTRY StubEnableVertexAttribArray(GLuint) { ++s_calls; }
+void APIENTRY StubLineWidth(GLfloat) { ++s_calls; }
+void APIENTRY StubLinkProgram(GLuint) { ++s_calls; }
+void APIENTRY StubPointSize(GLfloat) { ++s_calls; }
+void APIENTRY StubUniform1f(GLint, GLfloat) { ++s_calls; }
+void APIENTRY StubUniform1i(GLint, GLint) { ++s_calls; }
+void APIENTRY StubUniform2fv(GLint, GLsizei, const GLfloat*) { ++s_calls; }
+void APIENTRY StubUniform3fv(GLint, GLsizei, const GLfloat*) { ++s_calls; }
+void APIENTRY StubUniformBlockBinding(GLuint, GLuint, GLuint) { ++s_calls; }
+void APIENTRY StubUniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) { ++s_calls; }
+void APIENTRY StubUseProgram(GLuint) { ++s_calls; }
+void APIENTRY StubVertexAttribDivisor(GLuint, GLuint) { ++s_calls; }
+void APIENTRY StubVertexAttribIPointer(GLuint, GLint, GLenum, GLsizei, const void*) { ++s_calls; }
+void APIENTRY StubVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) { ++s_calls; }
+
+GLenum APIENTRY StubClientWaitSync(GLsync, GLbitfield, GLuint64) {
+    ++s_calls;
+    return GL_ALREADY_SIGNALED;
+}
+
+GLsync APIENTRY StubFenceSync(GLenum, GLbitfield) {
+    ++s_calls;
+    return reinterpret_cast<GLsync>(static_cast<uintptr_t>(s_nextName++));
+}
+
+void APIENTRY StubGenBuffers(GLsizei n, GLuint* buffers) {
+    ++s_calls;
+    for (GLsizei i = 0; i < n; ++i) {
+        buffers[i] = s_nextName++;
+    }
+}
+
+void APIENTRY StubGenVertexArrays(GLsizei n, GLuint* arrays) {
+    ++s_calls;
+    for (GLsizei i = 0; i < n; ++i) {
+        arrays[i] = s_nextName++;
+    }
+}
+
+// The same scratch memory for every mapping, so streaming costs one memcpy
+void* APIENTRY StubMapBufferRange(GLenum, GLintptr, GLsizeiptr length, GLbitfield) {
+    ++s_calls;
+    if (s_mapped.size() < static_cast<size_t>(length)) {
+        s_mapped.resize(static_cast<size_t>(length));
+    }
+    return s_mapped.data();
+}
+
+GLboolean APIENTRY StubUnmapBuffer(GLenum) {
+    ++s_calls;
+    return GL_TRUE;
+}
+
+GLuint APIENTRY StubCreateProgram() {
+    ++s_calls;
+    return s_nextName++;
+}
+
+GLuint APIENTRY StubCreateShader(GLenum) {
+    ++s_calls;
+    return s_nextName++;
+}
+
+void APIENTRY StubGetProgramiv(GLuint, GLenum, GLint* params) {
+    ++s_calls;
+    *params = GL_TRUE;
+}
+
+void APIENTRY StubGetShaderiv(GLuint, GLenum, GLint* params) {
+    ++s_calls;
+    *params = GL_TRUE;
+}
+
+void APIENTRY StubGetProgramInfoLog(GLuint, GLsizei, GLsizei* length, GLchar* infoLog) {
+    ++s_calls;
+    if (length != nullptr) {
+        *length = 0;
+    }
+    infoLog[0] = '\0';
+}
+
+void APIENTRY StubGetShaderInfoLog(GLuint, GLsizei, GLsizei* length, GLchar* infoLog) {
+    ++s_calls;
+    if (length != nullptr) {
+        *length = 0;
+    }
+    infoLog[0] = '\0';
+}
+
+GLuint APIENTRY StubGetUniformBlockIndex(GLuint, const GLchar*) {
+    ++s_calls;
+    return 0;
+}
+
+GLint APIENTRY StubGetUniformLocation(GLuint, const GLchar*) {
+    ++s_calls;
+    return 0;
+}
+
+void APIENTRY StubShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) { ++s_calls; }
+
+} // namespace
+
+void InstallStubGL() {
+    glad_glAttachShader = StubAttachShader;
+    glad_glBindBuffer = StubBindBuffer;
+    glad_glBindVertexArray = StubBindVertexArray;
+    glad_glBlendFuncSeparate = StubBlendFuncSeparate;
+    glad_glBufferData = StubBufferData;
+    glad_glBufferSubData = StubBufferSubData;
+    glad_glClientWaitSync = StubClientWaitSync;
+    glad_glCompileShader = StubCompileShader;
+    glad_glCreateProgram = StubCreateProgram;
+    glad_glCreateShader = StubCreateShader;
+    glad_glDeleteBuffers = StubDeleteBuffers;
+    glad_glDeleteProgram = StubDeleteProgram;
+    glad_glDeleteShader = StubDeleteShader;
+    glad_glDeleteSync = StubDeleteSync;
+    glad_glDeleteVertexArrays = StubDeleteVertexArrays;
+    glad_glDisable = StubDisable;
+    glad_glDrawArrays = StubDrawArrays;
+    glad_glDrawArraysInstanced = StubDrawArraysInstanced;
+    glad_glEnable = StubEnable;
+    glad_glEnableVertexAttribArray = StubEnableVertexAttribArray;
+    glad_glFenceSync = StubFenceSync;
+    glad_glGenBuffers = StubGenBuffers;
+    glad_glGenVertexArrays = StubGenVertexArrays;
+    glad_glGetProgramInfoLog = StubGetProgramInfoLog;
+    glad_glGetProgramiv = StubGetProgramiv;
+    glad_glGetShaderInfoLog = StubGetShaderInfoLog;
+    glad_glGetShaderiv = StubGetShaderiv;
+    glad_glGetUniformBlockIndex = StubGetUniformBlockIndex;
+    glad_glGetUniformLocation = StubGetUniformLocation;
+    glad_glLineWidth = StubLineWidth;
+    glad_glLinkProgram = StubLinkProgram;
+    glad_glMapBufferRange = StubMapBufferRange;
+    glad_glPointSize = StubPointSize;
+    glad_glShaderSource = StubShaderSource;
+    glad_glUniform1f = StubUniform1f;
+    glad_glUniform1i = StubUniform1i;
+    glad_glUniform2fv = StubUniform2fv;
+    glad_glUniform3fv = StubUniform3fv;
+    glad_glUniformBlockBinding = StubUniformBlockBinding;
+    glad_glUniformMatrix4fv = StubUniformMatrix4fv;
+    glad_glUnmapBuffer = StubUnmapBuffer;
+    glad_glUseProgram = StubUseProgram;
+    glad_glVertexAttribDivisor = StubVertexAttribDivisor;
+    glad_glVertexAttribIPointer = StubVertexAttribIPointer;
+    glad_glVertexAttribPointer = StubVertexAttribPointer;
+    s_calls = 0;
+}
+
+size_t GetStubGLCallCount() {
+    return s_calls;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+// Points the glad entry points reached by the benchmarked code at stubs that
+// do nothing, so the GL paths run without a context or GPU. Object names count
+// up from 1, compiles and links report success, uniform locations are 0.
+void InstallStubGL();
+
+// Calls made through the stubs since InstallStubGL
+size_t GetStubGLCallCount();
@@ -2,17 +2,46 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <ctime>
 #include <memory>
+#include <string>
+#include <vector>
+#include "Bounds.h"
+#include "DynamicResolution.h"
+#include "FrameCache.h"
+#include "MultiViewRenderer.h"
+#include "ObjectPicker.h"
+#include "SceneGraph.h"
 
 class Renderer;
 class Shader;
 class Camera;
+class OcclusionCuller;
+class OverlayCompositor;
+class FrameGraph;
+class PolylineCache;
+class TextureStreamer;
+class GLCapture;
+class FrameRecorder;
+class ParticleSystem;
+class TextRenderer;
+class CascadedShadowMap;
 
 class Application {
 public:
     Application(int width = 800, int height = 600, const char* title = "OpenGL 4.5 Application");
     ~Application();
 
+    // Records GL calls and input from startup for frameCount frames (see GLReplay)
+    void SetCapture(const std::string& path, int frameCount);
+    // Starts recording the window to path at startup (.y4m, .png sequence or raw)
+    void SetRecordPath(const std::string& path);
+    // Times multi-view rendering with 1 to 16 views after startup and prints the results
+    void SetMultiViewBench(bool enabled) { m_benchOnStart = enabled; }
+    // Renders the 3D scene at a resolution that keeps GPU frame time near settings.targetMs
+    void SetDynamicResolution(bool enabled, const DynamicResolution::Settings& settings);
+
     bool Initialize();
     void Run();
     void Shutdown();
@@ -20,14 +49,34 @@ public:
 private:
     void ProcessInput();
     void Update(float deltaTime);
-    void Render();
+    bool Render();  // Returns false when nothing was drawn and no swap is needed
+    DamageState GetDamageState() const;
     
     // Combined demo rendering method
+    void SetupTestScene();
+    void SetupSwarm();
+    void AnimateScene();
+    void UpdateScene();
+    void PrepareShadows();
+    void SetupTextures();
     void RenderTestScene();
+    void RenderTrace(const glm::mat4& viewProjection);
+    void SetupOverlay();
+    void RenderOverlay();
+    void UpdateLabels();
+    void RequestPick();
+    void SelectNode(SceneGraph::Node node);
+    void ConfigureMultiView(int views);
+    void RenderMultiView();
+    void StepMultiViewBench();
+    void ApplyRenderSize();
+    void DrawSceneObjects(const Shader& shader, const Shader& instancedShader, bool withColor);
 
     static void FramebufferSizeCallback(GLFWwindow* window, int width, int height);
     static void MouseCallback(GLFWwindow* window, double xpos, double ypos);
     static void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+    static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    static void WindowRefreshCallback(GLFWwindow* window);
     static void ErrorCallback(int error, const char* description);
 
     GLFWwindow* m_window;
@@ -37,10 +86,89 @@ private:
     std::unique_ptr<Renderer> m_renderer;
     std::unique_ptr<Shader> m_shader;
     std::unique_ptr<Shader> m_shader2D;
+    std::unique_ptr<Shader> m_depthShader;
+    std::unique_ptr<Shader> m_instancedShader;
+    std::unique_ptr<Shader> m_instancedDepthShader;
     std::unique_ptr<Camera> m_camera;
+    std::unique_ptr<OcclusionCuller> m_occlusionCuller;
+    std::unique_ptr<FrameCache> m_frameCache;
+    std::unique_ptr<FrameGraph> m_frameGraph;
+    std::unique_ptr<OverlayCompositor> m_overlay;
+    int m_hudLayer;      // Static HUD, rasterized once
+    int m_spinnerLayer;  // Animated spinner, re-rasterized when it moves
+    std::unique_ptr<PolylineCache> m_trace;  // Large time-series demo (F4)
+    std::unique_ptr<TextureStreamer> m_textureStreamer;
+    std::unique_ptr<GLCapture> m_capture;
+    std::string m_capturePath;
+    int m_captureFrames;
+    std::unique_ptr<FrameRecorder> m_recorder;  // Video recording (F7)
+    std::string m_recordPath;
+    bool m_recordOnStart;
+
+    // Test scene: textured cubes are drawn one by one, the rest in one instanced draw
+    std::unique_ptr<SceneGraph> m_scene;
+    SceneGraph::Node m_rotatingCube;
+    SceneGraph::Node m_swarm;  // Animated hierarchy of ~28k cubes (F8), kNone when off
+    std::vector<SceneGraph::Node> m_swarmRings;
+    std::vector<SceneGraph::Node> m_swarmSatellites;
+    std::vector<uint32_t> m_visibleTextured;   // Slots that survived culling
+    std::vector<uint32_t> m_visibleInstanced;
+
+    // SDF text: a label per renderable node and a stats line (F10)
+    std::unique_ptr<TextRenderer> m_text;
+    bool m_labelsEnabled;
+    std::vector<int> m_nodeLabels;  // Label per node handle, -1 for none
+    int m_hudLabel;
+
+    // Cascaded shadow maps (F11): moving casters are drawn every frame, the rest cached
+    std::unique_ptr<CascadedShadowMap> m_shadows;
+    bool m_shadowsEnabled;
+    std::vector<uint32_t> m_staticCasters;   // Slots
+    std::vector<uint32_t> m_dynamicCasters;
+    std::vector<uint8_t> m_casterMoving;     // Per node handle: 0 static, 1 moving, 2 not seen yet
+    size_t m_casterSceneCount;
+
+    // Left-click selection: GPU ID readback picks, cross-checked by a CPU ray pick
+    std::unique_ptr<ObjectPicker> m_picker;
+    bool m_pickRequested;
+    int m_pickX, m_pickY;   // Framebuffer pixel
+    double m_cursorX, m_cursorY;
+    std::vector<uint32_t> m_pickSlots;  // Renderable slots
+    std::vector<uint32_t> m_pickIds;    // Node handle per slot
+    std::vector<PickResult> m_pickResults;
+    PickResult m_cpuPick;   // For comparison with the GPU result of the same click
+    SceneGraph::Node m_selected;
+    glm::vec3 m_selectedColor;  // Its color before the highlight
+
+    // Multi-view (F12): a grid of cameras drawn by one culling pass and one draw
+    std::unique_ptr<MultiViewRenderer> m_multiView;
+    int m_multiViewCount;  // 0 when off; view 0 follows m_camera
+    std::vector<uint32_t> m_multiViewSlots;
+    bool m_benchOnStart;
+    int m_benchViews;      // View count being measured, 0 when no sweep runs
+    int m_benchFrame;
+    double m_benchCullMs, m_benchSubmitMs, m_benchGpuMs;
+
+    // Dynamic resolution (R): the scene pass renders smaller and is sharpened back up
+    std::unique_ptr<DynamicResolution> m_dynamicResolution;
+    DynamicResolution::Settings m_dynamicResolutionSettings;
+    bool m_dynamicResolutionEnabled;
+
+    std::unique_ptr<ParticleSystem> m_particles;  // Fountain (F9: GPU, CPU, off)
+    bool m_particlesVerified;
+    float m_frameDelta;
+    bool m_depthPrepass;     // Depth-only pass before shading (F1)
+    float m_statsTimer;
+    std::clock_t m_statsCpuClock;
+
+    // Damage tracking (F3): versions bump whenever what they describe changes
+    unsigned int m_sceneVersion;
+    bool m_sceneAnimating;    // Rotating cube (P)
+    bool m_overlayAnimating;  // Spinning overlay lines (O)
+    float m_overlayTime;
     
     bool m_shouldClose;
-    float m_time;  // For animations
+    float m_time;  // For scene animations
     
     // Camera control variables
     bool m_firstMouse;
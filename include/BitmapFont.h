@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+// Embedded monospaced bitmap font, the source of the text renderer's
+// distance-field atlas
+struct BitmapFont {
+    static constexpr int kGlyphWidth = 16;   // Also the advance
+    static constexpr int kGlyphHeight = 32;  // Also the line height
+    static constexpr int kBaseline = 25;     // Rows above the baseline
+    static constexpr int kFirstChar = 32;    // ' '
+    static constexpr int kGlyphCount = 95;   // Through '~'
+
+    // Rows top to bottom, bit 15 is the leftmost column
+    static const uint16_t kGlyphs[kGlyphCount][kGlyphHeight];
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cmath>
+
+// Axis-aligned bounding box
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+    glm::vec3 GetExtents() const { return (max - min) * 0.5f; }
+
+    // Bounds of this box after an affine transformation (Arvo's method)
+    AABB Transform(const glm::mat4& m) const {
+        glm::vec3 center = glm::vec3(m * glm::vec4(GetCenter(), 1.0f));
+        glm::vec3 extents = GetExtents();
+        glm::vec3 newExtents(0.0f);
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                newExtents[i] += std::abs(m[j][i]) * extents[j];
+            }
+        }
+        return { center - newExtents, center + newExtents };
+    }
+};
@@ -34,6 +34,12 @@ public:
     const glm::vec3& GetTarget() const { return m_target; }
     const glm::vec3& GetUp() const { return m_up; }
     float GetFOV() const { return m_fov; }
+    float GetAspectRatio() const { return m_aspectRatio; }
+    float GetNearPlane() const { return m_nearPlane; }
+    float GetFarPlane() const { return m_farPlane; }
+    
+    // Incremented on every change, lets callers detect camera motion between frames
+    unsigned int GetVersion() const { return m_version; }
     
 private:
     void UpdateViewMatrix() const;
@@ -55,4 +61,5 @@ private:
     mutable glm::mat4 m_projectionMatrix;
     mutable bool m_viewDirty;
     mutable bool m_projectionDirty;
+    unsigned int m_version;
 };
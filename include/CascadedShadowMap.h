@@ -0,0 +1,112 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "Bounds.h"
+
+class Camera;
+class Renderer;
+class Shader;
+
+// Directional-light cascaded shadow maps. The camera frustum is split
+// (practical split scheme) and each slice gets an orthographic light
+// projection fitted to its bounding sphere and snapped to whole texels, so the
+// map does not shimmer while the camera moves. Static casters are rendered
+// into a cached layer per cascade that is reused while the light, the
+// cascade's snapped projection and the static casters stay the same; each
+// frame only copies that layer and adds the dynamic casters on top. A cascade
+// with no dynamic casters in it is not touched at all.
+class CascadedShadowMap {
+public:
+    static constexpr int kMaxCascades = 4;  // Matches MAX_CASCADES in fragment.glsl
+
+    // What a cascade needs this frame
+    enum class CascadeWork {
+        Skip,     // Cached layer still valid, no dynamic casters
+        Dynamic,  // Copy the cached static layer, draw dynamic casters
+        Full      // Re-render the static layer first
+    };
+
+    struct Stats {
+        int cascades = 0;
+        CascadeWork work[kMaxCascades] = {};
+        float splits[kMaxCascades] = {};      // Far view distance of each cascade
+        size_t staticCasters[kMaxCascades] = {};   // Drawn by the last static re-render
+        size_t dynamicCasters[kMaxCascades] = {};  // Drawn this frame
+        size_t skipped = 0;         // Cascade updates avoided by caching, since ResetCounters
+        size_t staticRenders = 0;   // Static layer re-renders, since ResetCounters
+    };
+
+    CascadedShadowMap();
+    ~CascadedShadowMap();
+
+    bool Initialize(int resolution = 2048, int cascades = kMaxCascades);
+    void Shutdown();
+
+    // Cascades cover the view from the near plane up to this distance
+    void SetShadowDistance(float distance);
+    // Direction the light travels in; invalidates every cached cascade
+    void SetLightDirection(const glm::vec3& direction);
+    const glm::vec3& GetLightDirection() const { return m_lightDirection; }
+    // Call when static casters move, appear or disappear
+    void InvalidateStatic() { ++m_staticVersion; }
+
+    // Fits the cascades to the camera and decides what each one needs. Casters
+    // are slots into bounds and into the matrices later given to RenderCascade.
+    void Update(const Camera& camera, const std::vector<AABB>& bounds,
+                const std::vector<uint32_t>& staticCasters, const std::vector<uint32_t>& dynamicCasters);
+    int GetCascadeCount() const { return m_cascadeCount; }
+    CascadeWork GetWork(int cascade) const { return m_cascades[cascade].work; }
+
+    // Does the work decided by Update with the instanced depth shader. Restores
+    // the framebuffer and viewport it found.
+    void RenderCascade(int cascade, Renderer& renderer, const Shader& depthShader,
+                       const glm::mat4* world, const glm::vec3* colors);
+
+    // Shadow uniforms for fragment.glsl; the map goes to texture unit unit
+    void Bind(const Shader& shader, int unit) const;
+
+    const Stats& GetStats() const { return m_stats; }
+    void ResetCounters();
+
+private:
+    static constexpr float kSplitLambda = 0.75f;   // 0 uniform splits, 1 logarithmic
+    static constexpr float kCasterReach = 50.0f;   // Casters this far towards the light still count
+
+    struct Cascade {
+        glm::mat4 viewProjection = glm::mat4(1.0f);
+        float texelSize = 0.0f;  // World units per shadow texel
+        float splitFar = 0.0f;
+        CascadeWork work = CascadeWork::Full;
+        std::vector<uint32_t> staticCasters;   // Culled, filled only when re-rendering the static layer
+        std::vector<uint32_t> dynamicCasters;  // Culled, every frame
+
+        // State of the cached static layer
+        glm::mat4 cachedViewProjection = glm::mat4(0.0f);
+        unsigned int cachedStaticVersion = 0;
+        bool cacheValid = false;
+        bool hasDynamic = false;  // The sampled layer holds more than the static cache
+    };
+
+    void FitCascade(int index, const Camera& camera, float splitNear, float splitFar);
+    static void Cull(const glm::mat4& viewProjection, const std::vector<AABB>& bounds,
+                     const std::vector<uint32_t>& casters, std::vector<uint32_t>& result);
+    static void DrawCasters(Renderer& renderer, const std::vector<uint32_t>& casters,
+                            const glm::mat4* world, const glm::vec3* colors);
+
+    int m_resolution;
+    int m_cascadeCount;
+    float m_shadowDistance;
+    glm::vec3 m_lightDirection;
+    glm::mat4 m_lightView;
+    unsigned int m_staticVersion;
+
+    GLuint m_staticMap;   // Depth array, static casters only
+    GLuint m_shadowMap;   // Depth array sampled by the shading pass
+    GLuint m_framebuffers[2];  // Read, draw
+
+    Cascade m_cascades[kMaxCascades];
+    Stats m_stats;
+};
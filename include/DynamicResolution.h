@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <memory>
+
+class Shader;
+
+// Picks the resolution the 3D scene is rendered at so the GPU frame time stays
+// near a target, and scales that image up to the window with a sharpening
+// filter. Frame times are the GPU time of all frame graph passes of a frame,
+// which arrive a few frames later and leave out the idle gaps of CPU-bound
+// frames. The scale drops as soon as frames run over the target and
+// climbs back one step at a time while there is headroom. It moves in steps of
+// kScaleStep so render targets only come in a few sizes.
+class DynamicResolution {
+public:
+    struct Settings {
+        float minScale = 0.5f;
+        float maxScale = 1.0f;
+        float targetMs = 16.0f;   // GPU time per frame to aim for
+        float sharpness = 0.5f;   // 0 plain bilinear, 1 strongest
+    };
+
+    struct Stats {
+        double gpuMs = 0.0;       // Smoothed, at the current scale
+        size_t samples = 0;       // Frame times received at the current scale
+        size_t changes = 0;       // Scale changes since Initialize
+        double changeGpuMs = 0.0; // Smoothed frame time that caused the last change
+    };
+
+    DynamicResolution();
+    ~DynamicResolution();
+
+    bool Initialize(int width, int height);
+    void Shutdown();
+
+    // Clamps the settings and restarts at the largest scale
+    void SetSettings(const Settings& settings);
+    const Settings& GetSettings() const { return m_settings; }
+
+    // Window size; the render size follows from the scale
+    void Resize(int width, int height);
+    float GetScale() const { return m_scale; }
+    int GetWidth() const { return m_renderWidth; }
+    int GetHeight() const { return m_renderHeight; }
+
+    // After the frame graph ran the given frame. Only frames that rendered at
+    // the scale (scaled) steer it.
+    void EndFrame(unsigned long long frame, bool scaled);
+    // Takes the GPU time of an earlier frame and adjusts the scale; true when
+    // the render size changed. Frames seen before are ignored.
+    bool Update(unsigned long long frame, double gpuMs);
+
+    // Draws the scene texture over the whole viewport, sharpened
+    void Upscale(GLuint sceneTexture) const;
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    static constexpr int kHistoryFrames = 8;
+    static constexpr float kScaleStep = 0.05f;
+    static constexpr float kHeadroom = 0.8f;    // Grow only below this fraction of the target
+    static constexpr size_t kSettleSamples = 8; // Frame times to average before deciding
+
+    struct FrameRecord {
+        unsigned long long frame = 0;
+        bool pending = false;
+        bool scaled = false;
+        float scale = 0.0f;
+    };
+
+    void ApplyScale(float scale);
+
+    Settings m_settings;
+    float m_scale;
+    int m_width, m_height;
+    int m_renderWidth, m_renderHeight;
+
+    FrameRecord m_frames[kHistoryFrames];
+
+    std::unique_ptr<Shader> m_shader;
+    GLuint m_emptyVAO;
+
+    Stats m_stats;
+};
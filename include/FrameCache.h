@@ -0,0 +1,84 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// What changed since the last presented frame
+struct DamageState {
+    unsigned int cameraVersion = 0;
+    unsigned int sceneVersion = 0;
+    unsigned int overlayVersion = 0;
+    bool sceneAnimating = false;
+    bool overlayAnimating = false;
+};
+
+enum class FrameAction {
+    Full,     // Re-render the 3D scene into the cache, then the overlay
+    Overlay,  // Re-present the cached 3D result and redraw only the overlay
+    Skip      // Nothing changed: keep the previous image on screen
+};
+
+struct FrameCacheStats {
+    int framesFull = 0;
+    int framesOverlay = 0;
+    int framesSkipped = 0;
+    double idleSeconds = 0.0;     // Time spent blocked waiting for events
+    double fullFrameMs = 0.0;     // Running average CPU cost of a full frame
+    double overlayFrameMs = 0.0;  // Running average CPU cost of an overlay-only frame
+
+    // CPU time that full re-renders would have cost for the frames we avoided
+    double EstimatedCpuSavedMs() const;
+};
+
+// Damage-tracking frame cache. The 3D pass renders into an offscreen target that
+// is re-presented as long as the camera, scene and animations are unchanged.
+class FrameCache {
+public:
+    FrameCache();
+    ~FrameCache();
+
+    bool Initialize(int width, int height);
+    void Resize(int width, int height);
+    void Shutdown();
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const { return m_enabled; }
+
+    // Forces the next frame to re-present (e.g. the window was exposed)
+    void RequestPresent() { m_needsPresent = true; }
+    // Forces the next frame to re-render the 3D scene
+    void Invalidate() { m_valid = false; }
+
+    FrameAction Decide(const DamageState& state) const;
+
+    // Redirects the 3D pass into the cache target
+    void BeginScene();
+    void EndScene(const DamageState& state);
+    // Copies the cached color and depth into the default framebuffer
+    void Present();
+    void MarkPresented(const DamageState& state);
+    GLuint GetFramebuffer() const { return m_framebuffer; }
+
+    void RecordFrame(FrameAction action, double cpuMs);
+    void RecordIdle(double seconds) { m_stats.idleSeconds += seconds; }
+    const FrameCacheStats& GetStats() const { return m_stats; }
+    void ResetCounters();
+
+private:
+    void CreateTarget();
+    void DestroyTarget();
+
+    bool m_enabled;
+    bool m_valid;
+    bool m_needsPresent;
+    int m_width, m_height;
+
+    GLuint m_framebuffer;
+    GLuint m_colorTexture;
+    GLuint m_depthRenderbuffer;
+
+    unsigned int m_cameraVersion;
+    unsigned int m_sceneVersion;
+    unsigned int m_overlayVersion;
+
+    FrameCacheStats m_stats;
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// How a pass touches a resource
+enum class FrameGraphAccess {
+    Attachment,  // Rendered to / depth-tested against through the pass framebuffer
+    Sampled,     // Read through a sampler
+    Storage,     // Image load/store or shader storage writes
+    Copy         // Blit, readback or upload done by the pass itself
+};
+
+struct FrameGraphTextureDesc {
+    int width = 0;
+    int height = 0;
+    GLenum format = GL_RGBA8;
+    bool renderbuffer = false;  // Attachment-only storage, cannot be sampled
+
+    bool operator==(const FrameGraphTextureDesc& other) const {
+        return width == other.width && height == other.height && format == other.format && renderbuffer == other.renderbuffer;
+    }
+};
+
+// Frame graph: passes declare the resources they read and write, then the graph
+// culls passes whose results are never used, orders the rest, aliases transient
+// textures/renderbuffers with non-overlapping lifetimes onto the same GL objects,
+// inserts memory barriers and times each pass. Rebuilt every frame; the
+// physical resources and framebuffers persist across frames.
+class FrameGraph {
+public:
+    using Handle = int;
+
+    class Builder {
+    public:
+        Handle Create(const std::string& name, const FrameGraphTextureDesc& desc);
+        Handle Read(Handle resource, FrameGraphAccess access = FrameGraphAccess::Sampled);
+        Handle Write(Handle resource, FrameGraphAccess access = FrameGraphAccess::Attachment);
+        // Keep the pass even if nothing reads its outputs (readbacks, queries...)
+        void SetSideEffect();
+
+    private:
+        friend class FrameGraph;
+        Builder(FrameGraph& graph, int pass) : m_graph(graph), m_pass(pass) {}
+        FrameGraph& m_graph;
+        int m_pass;
+    };
+
+    class Resources {
+    public:
+        GLuint GetTexture(Handle resource) const;
+        GLuint GetFramebuffer() const { return m_framebuffer; }
+
+    private:
+        friend class FrameGraph;
+        Resources(const FrameGraph& graph, GLuint framebuffer) : m_graph(graph), m_framebuffer(framebuffer) {}
+        const FrameGraph& m_graph;
+        GLuint m_framebuffer;
+    };
+
+    using SetupFunc = std::function<void(Builder&)>;
+    using ExecuteFunc = std::function<void(const Resources&)>;
+
+    struct PassTiming {
+        double cpuMs = 0.0;
+        double gpuMs = 0.0;  // Reported a few frames late
+    };
+
+    // GPU time of every pass of one earlier frame, set once all of its
+    // queries finished
+    struct FrameTiming {
+        unsigned long long frame = 0;
+        double gpuMs = 0.0;
+        bool valid = false;
+    };
+
+    FrameGraph();
+    ~FrameGraph();
+
+    // Starts declaring a new frame
+    void Reset();
+    Handle ImportFramebuffer(const std::string& name, GLuint framebuffer, int width, int height);
+    Handle ImportTexture(const std::string& name, GLuint texture, const FrameGraphTextureDesc& desc);
+    void AddPass(const std::string& name, const SetupFunc& setup, const ExecuteFunc& execute);
+
+    void Compile();
+    void Execute();
+    void Shutdown();
+
+    // Human-readable dump of the compiled frame and a Graphviz version of it
+    std::string Dump() const;
+    std::string DumpGraphviz() const;
+
+    const std::map<std::string, PassTiming>& GetTimings() const { return m_timings; }
+    const FrameTiming& GetFrameTiming() const { return m_frameTiming; }
+    // Number of the next frame Execute runs
+    unsigned long long GetFrame() const { return m_frame; }
+    size_t GetTransientBytes() const;  // What transients would need without aliasing
+    size_t GetAllocatedBytes() const;  // What the aliased physical pool holds
+
+private:
+    static constexpr int kTimerFrames = 3;
+    static constexpr int kPhysicalIdleFrames = 120;
+
+    struct ResourceNode {
+        std::string name;
+        FrameGraphTextureDesc desc;
+        bool imported = false;
+        bool importedFramebuffer = false;
+        GLuint importedObject = 0;
+        std::vector<int> writers;
+        std::vector<int> readers;
+        int refCount = 0;
+        int firstUse = -1;  // Execution order index
+        int lastUse = -1;
+        int physical = -1;
+    };
+
+    struct PassNode {
+        std::string name;
+        ExecuteFunc execute;
+        std::vector<std::pair<int, FrameGraphAccess>> reads;
+        std::vector<std::pair<int, FrameGraphAccess>> writes;
+        std::vector<int> dependencies;
+        bool sideEffect = false;
+        bool culled = false;
+        int refCount = 0;
+        GLbitfield barriers = 0;
+    };
+
+    struct PhysicalResource {
+        FrameGraphTextureDesc desc;
+        GLuint object = 0;
+        int busyUntil = -1;  // Last execution index of the current owner
+        unsigned long long lastFrame = 0;
+    };
+
+    struct TimerQueries {
+        GLuint queries[kTimerFrames] = {};
+        bool issued[kTimerFrames] = {};
+    };
+
+    void CullPasses();
+    void SortPasses();
+    void AllocateResources();
+    void ComputeBarriers();
+    GLuint GetPassFramebuffer(const PassNode& pass, int& width, int& height);
+    void ReleaseIdlePhysicals();
+    void DestroyFramebuffers();
+    static size_t BytesPerPixel(GLenum format);
+    static bool IsDepthFormat(GLenum format);
+
+    std::vector<ResourceNode> m_resources;
+    std::vector<PassNode> m_passes;
+    std::vector<int> m_order;  // Surviving passes in execution order
+    bool m_compiled;
+
+    std::vector<PhysicalResource> m_physicals;
+    std::map<std::vector<GLuint>, GLuint> m_framebuffers;  // Keyed by attachment objects
+    unsigned long long m_frame;
+
+    std::map<std::string, TimerQueries> m_timers;
+    std::map<std::string, PassTiming> m_timings;
+    unsigned long long m_timerFrameNumbers[kTimerFrames] = {};  // Frame that issued each slot
+    FrameTiming m_frameTiming;
+    int m_timerFrame;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class RecordFormat {
+    Y4M,  // YUV 4:2:0 video, playable by ffmpeg/mpv
+    Raw,  // Headerless rgb24 frames, top row first
+    PNG   // One file per frame: <name>_000000.png
+};
+
+// Records the default framebuffer without stalling the GPU. Frames are read
+// back into a ring of PBOs with fences; completed buffers are mapped a few
+// frames later and handed to an encoder thread. The frames waiting for the
+// encoder come from a fixed pool, so memory is bounded. When the PBOs or the
+// pool are exhausted the frame is dropped and counted. The render thread never
+// waits.
+class FrameRecorder {
+public:
+    struct Stats {
+        int captured = 0;      // Readbacks issued
+        int written = 0;       // Frames encoded
+        int droppedBusy = 0;   // All PBOs still in flight
+        int droppedQueue = 0;  // Encoder behind, frame pool empty
+        int droppedSize = 0;   // Framebuffer size differs from the recording
+        double averageLatencyMs = 0.0;  // Readback issued -> frame written
+        double maxLatencyMs = 0.0;
+        size_t queuedFrames = 0;
+    };
+
+    FrameRecorder();
+    ~FrameRecorder();
+
+    // Format from the extension: .y4m, .png (sequence), anything else raw
+    bool Start(const std::string& path, int width, int height, int fps = 60, size_t maxQueuedFrames = 8);
+    // Drains in-flight readbacks and the encoder queue; blocks
+    void Stop();
+    bool IsRecording() const { return m_recording; }
+
+    // Once per frame: hands completed readbacks to the encoder
+    void Update();
+    // After the frame is drawn, before the swap: reads back the default framebuffer
+    void Capture(int width, int height);
+
+    Stats GetStats() const;
+
+    static RecordFormat FormatFromPath(const std::string& path);
+
+private:
+    static constexpr int kPboCount = 3;
+    using Clock = std::chrono::steady_clock;
+
+    struct Slot {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        Clock::time_point issued;
+    };
+
+    struct Frame {
+        std::vector<uint8_t> pixels;  // RGBA, bottom row first
+        int index = 0;
+        Clock::time_point issued;
+    };
+
+    void Deliver(Slot& slot, bool wait);
+    void EncoderLoop();
+    bool Encode(const Frame& frame);
+
+    bool m_recording;
+    RecordFormat m_format;
+    std::string m_path;
+    int m_width, m_height;
+    int m_fps;
+
+    Slot m_slots[kPboCount];
+    int m_readSlot;   // Oldest in-flight slot
+    int m_inFlight;
+    int m_frameIndex;
+
+    // Shared with the encoder thread
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queueChanged;
+    std::vector<std::unique_ptr<Frame>> m_framePool;
+    std::vector<Frame*> m_freeFrames;
+    std::deque<Frame*> m_queue;
+    bool m_stopping;
+    Stats m_stats;
+    double m_totalLatencyMs;
+
+    // Encoder thread only
+    std::thread m_encoder;
+    std::ofstream m_file;
+    std::vector<uint8_t> m_encodeBuffer;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+
+// Stream format shared by the capture layer and the GLReplay tool. A file is a
+// GLCaptureHeader followed by records: uint16 op, uint32 payload size, payload.
+// Object names, sync objects and uniform locations are recorded as the
+// capturing process saw them and remapped on replay.
+constexpr uint32_t kGLCaptureMagic = 0x50434C47;  // "GLCP"
+constexpr uint32_t kGLCaptureVersion = 8;
+
+struct GLCaptureHeader {
+    uint32_t magic = kGLCaptureMagic;
+    uint32_t version = kGLCaptureVersion;
+    int32_t width = 0;   // Default framebuffer size at capture start
+    int32_t height = 0;
+};
+
+// GL entry points recorded by the capture layer, one op per glad function
+#define GL_CAPTURE_FUNCTIONS(X) \
+    X(ActiveTexture) X(AttachShader) X(BeginQuery) X(BindBuffer) X(BindBufferBase) \
+    X(BindFramebuffer) X(BindRenderbuffer) X(BindTexture) X(BindVertexArray) \
+    X(BlendFunc) X(BlendFuncSeparate) X(BlitFramebuffer) X(BufferData) X(BufferSubData) \
+    X(Clear) X(ClearBufferfv) X(ClearBufferuiv) X(ClearColor) X(ClientWaitSync) \
+    X(ColorMask) X(CompileShader) X(CompressedTexImage2D) X(CopyBufferSubData) \
+    X(CreateProgram) X(CreateShader) X(DeleteBuffers) X(DeleteFramebuffers) \
+    X(DeleteProgram) X(DeleteQueries) X(DeleteRenderbuffers) X(DeleteShader) \
+    X(DeleteSync) X(DeleteTextures) X(DeleteVertexArrays) X(DepthFunc) X(DepthMask) \
+    X(Disable) X(DispatchCompute) X(DispatchComputeIndirect) X(DrawArrays) \
+    X(DrawArraysIndirect) X(DrawArraysInstanced) X(DrawBuffer) X(DrawBuffers) \
+    X(DrawElementsBaseVertex) X(DrawElementsInstancedBaseVertex) X(Enable) \
+    X(EnableVertexAttribArray) X(EndQuery) X(FenceSync) X(FramebufferRenderbuffer) \
+    X(FramebufferTexture2D) X(FramebufferTextureLayer) X(GenBuffers) X(GenFramebuffers) \
+    X(GenQueries) X(GenRenderbuffers) X(GenTextures) X(GenVertexArrays) \
+    X(GenerateMipmap) X(GetQueryObjectiv) X(GetQueryObjectuiv) X(GetQueryObjectui64v) \
+    X(GetUniformBlockIndex) X(GetUniformLocation) X(LineWidth) X(LinkProgram) \
+    X(MapBufferRange) X(MemoryBarrier) X(PixelStorei) X(PointSize) X(PolygonMode) \
+    X(PolygonOffset) X(QueryCounter) X(ReadBuffer) X(ReadPixels) X(RenderbufferStorage) \
+    X(ShaderSource) X(TexBuffer) X(TexImage2D) X(TexImage3D) X(TexParameteri) \
+    X(Uniform1f) X(Uniform1i) X(Uniform2fv) X(Uniform3fv) X(UniformBlockBinding) \
+    X(UniformMatrix4fv) X(UnmapBuffer) X(UseProgram) X(VertexAttribDivisor) \
+    X(VertexAttribIPointer) X(VertexAttribPointer) X(Viewport) X(ViewportArrayv)
+
+enum class GLCaptureOp : uint16_t {
+    // Stream markers
+    FrameBegin,  // int32 frame, float64 time, float64 deltaTime
+    FrameEnd,
+    Input,       // uint8 type, float64 time, int32 a, int32 b, float64 x, float64 y
+
+#define GL_CAPTURE_OP(name) name,
+    GL_CAPTURE_FUNCTIONS(GL_CAPTURE_OP)
+#undef GL_CAPTURE_OP
+
+    Count
+};
+
+// Input a is the key or button and b the action; for Resize they are the size
+enum class GLCaptureInputType : uint8_t { Key, MouseButton, CursorPos, Resize };
+
+// Pixel data pointers are recorded as one of these, followed by the offset or bytes
+enum class GLCaptureData : uint8_t { Null, Offset, Bytes };
+
+// Records the GL calls made through glad, with the buffer, texture and uniform
+// data they reference, for a fixed number of frames. Install right after the
+// loader so resource creation is part of the stream; the replay then rebuilds
+// every object it uses. Calls made through entry points not listed in
+// GLCaptureOp are not recorded. GL must only be called from one thread.
+class GLCapture {
+public:
+    GLCapture();
+    ~GLCapture();
+
+    bool Begin(const std::string& path, int frameCount, int width, int height);
+    void Stop();
+    bool IsActive() const { return m_active; }
+
+    void BeginFrame(double time, double deltaTime);
+    // Writes the frame out; stops once frameCount frames are recorded
+    void EndFrame();
+    void RecordInput(GLCaptureInputType type, int a, int b, double x = 0.0, double y = 0.0);
+
+    static const char* GetOpName(GLCaptureOp op);
+    // Bytes of client pixel data glTexImage2D/glReadPixels touch
+    static size_t PixelDataSize(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint alignment);
+
+private:
+    bool m_active;
+    int m_frame;
+    int m_frameCount;
+    double m_startTime;
+    size_t m_bytesWritten;
+    std::string m_path;
+};
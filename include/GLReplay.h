@@ -0,0 +1,91 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "GLCapture.h"
+
+// Re-executes a GLCapture stream on the current context as fast as possible,
+// timing every call and frame. Object names, syncs and uniform locations are
+// remapped to the ones this context hands out; client pointers are served
+// from the stream. Recorded input and timestamps are reported alongside.
+class GLReplay {
+public:
+    struct Options {
+        bool finishFrames = false;  // glFinish at frame end so CPU frame time includes the GPU
+        bool finishCalls = false;   // glFinish after every call to attribute GPU time per call
+        bool dump = false;          // Print every record while replaying
+    };
+
+    GLReplay();
+    ~GLReplay();
+
+    bool Load(const std::string& path);
+    int GetWidth() const { return m_header.width; }
+    int GetHeight() const { return m_header.height; }
+
+    bool Run(const Options& options);
+    std::string Report() const;
+    bool WriteFrameCsv(const std::string& path) const;
+
+private:
+    struct OpStats {
+        uint64_t count = 0;
+        double totalMs = 0.0;
+        double maxMs = 0.0;
+    };
+
+    struct FrameStats {
+        int frame = 0;
+        double time = 0.0;        // Application time when recorded
+        double recordedMs = 0.0;  // Frame delta when recorded
+        double cpuMs = 0.0;
+        double gpuMs = -1.0;      // -1 when timestamps are unavailable
+        int calls = 0;
+        int draws = 0;
+        int inputs = 0;
+        GLuint queries[2] = { 0, 0 };
+    };
+
+    // Returns false for malformed records
+    bool Execute(GLCaptureOp op, const uint8_t* data, size_t size);
+    void BeginFrame(int frame, double time, double deltaTime);
+    void EndFrame();
+    void ResolveGpuTimes();
+    void Release();
+
+    static GLuint MapName(const std::unordered_map<GLuint, GLuint>& names, GLuint name);
+    GLint MapLocation(GLint location) const;
+
+    GLCaptureHeader m_header;
+    std::vector<uint8_t> m_data;
+    Options m_options;
+
+    // Recorded name -> replay name
+    std::unordered_map<GLuint, GLuint> m_buffers;
+    std::unordered_map<GLuint, GLuint> m_textures;
+    std::unordered_map<GLuint, GLuint> m_vertexArrays;
+    std::unordered_map<GLuint, GLuint> m_framebuffers;
+    std::unordered_map<GLuint, GLuint> m_renderbuffers;
+    std::unordered_map<GLuint, GLuint> m_queries;
+    std::unordered_map<GLuint, GLuint> m_programs;  // Programs and shaders share a namespace
+    std::unordered_map<uint64_t, GLsync> m_syncs;
+    std::map<std::pair<GLuint, GLint>, GLint> m_locations;  // (recorded program, location)
+    std::map<std::pair<GLuint, GLuint>, GLuint> m_blockIndices;  // (recorded program, uniform block index)
+    std::map<GLenum, void*> m_mapped;
+    GLuint m_currentProgram;  // Recorded name
+    std::vector<uint8_t> m_scratch;
+
+    OpStats m_opStats[static_cast<size_t>(GLCaptureOp::Count)];
+    std::vector<FrameStats> m_frames;
+    bool m_inFrame;
+    double m_frameStart;
+    double m_setupMs;
+    double m_totalMs;
+    int m_setupInputs;
+    bool m_timestamps;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+// Power-of-two buddy allocator over an offset range. Only bookkeeping: it never
+// touches GL, so the same allocator can manage any buffer.
+class BuddyAllocator {
+public:
+    BuddyAllocator(uint32_t size, uint32_t minBlock);
+
+    // Returns the offset of a block of at least `size` bytes
+    bool Allocate(uint32_t size, uint32_t& offset);
+    void Free(uint32_t offset);
+
+    uint32_t GetSize() const { return m_size; }
+    uint32_t GetUsed() const { return m_used; }
+    uint32_t GetLargestFree() const;
+    size_t GetFreeBlockCount() const;
+    size_t GetAllocationCount() const { return m_allocated.size(); }
+
+private:
+    int OrderFor(uint32_t size) const;
+    uint32_t BlockSize(int order) const { return m_minBlock << order; }
+
+    uint32_t m_size;
+    uint32_t m_minBlock;
+    int m_maxOrder;
+    uint32_t m_used;
+    std::vector<std::set<uint32_t>> m_freeLists;  // Per order, lowest address first
+    std::map<uint32_t, int> m_allocated;          // Offset -> order
+};
+
+enum class GpuBufferKind { Vertex = 0, Index = 1 };
+
+// A range inside one of the shared buffers
+struct GpuAllocation {
+    GpuBufferKind kind = GpuBufferKind::Vertex;
+    int pool = -1;
+    uint32_t block = 0;   // Start of the buddy block
+    uint32_t offset = 0;  // Aligned start of the data inside the block
+    uint32_t size = 0;
+
+    bool IsValid() const { return pool >= 0; }
+};
+
+// Suballocates vertex and index data from a few large GL buffers, adding a pool
+// when the existing ones are full (pools are kept for reuse). Frees are
+// queued behind a fence and only returned to the allocator once the GPU has
+// finished the frame that last used them, so nothing stalls or gets
+// overwritten while still in flight.
+class GpuMemory {
+public:
+    GpuMemory();
+    ~GpuMemory();
+
+    bool Initialize(uint32_t vertexPoolSize = 16u << 20, uint32_t indexPoolSize = 4u << 20);
+    void Shutdown();
+
+    // `alignment` lets callers address the data by element (base vertex, first index)
+    GpuAllocation Allocate(GpuBufferKind kind, uint32_t size, uint32_t alignment);
+    void Upload(const GpuAllocation& allocation, const void* data, uint32_t size);
+    void Free(const GpuAllocation& allocation);
+
+    // Fences this frame's frees and releases those the GPU is done with
+    void EndFrame();
+
+    GLuint GetBuffer(GpuBufferKind kind, int pool) const;
+    int GetPoolCount(GpuBufferKind kind) const;
+
+    // Occupancy and fragmentation of every pool
+    std::string Report() const;
+
+private:
+    static constexpr uint32_t kMinBlock = 256;
+
+    struct Pool {
+        GLuint buffer = 0;
+        std::unique_ptr<BuddyAllocator> allocator;
+        uint64_t requestedBytes = 0;
+    };
+
+    struct PendingFrees {
+        GLsync fence = nullptr;
+        std::vector<GpuAllocation> allocations;
+    };
+
+    int CreatePool(GpuBufferKind kind, uint32_t size);
+    void Release(const GpuAllocation& allocation);
+
+    std::vector<Pool> m_pools[2];
+    uint32_t m_poolSize[2];
+    std::vector<GpuAllocation> m_frameFrees;
+    std::deque<PendingFrees> m_pending;
+};
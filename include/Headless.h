@@ -0,0 +1,8 @@
+#pragma once
+
+// Renders the test scene with the software Renderer backend, without a window
+// or GL context, and writes the last frame as a binary PPM. Options:
+//   --size WxH    framebuffer size (default 800x600)
+//   --frames N    frames to render and time (default 60)
+//   --output PATH image written after the last frame (default frame.ppm)
+int RunHeadless(int argc, char** argv);
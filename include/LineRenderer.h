@@ -0,0 +1,63 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Shader;
+
+enum class LineCap : uint32_t { Butt = 0, Square = 1, Round = 2 };
+enum class LineJoin { Round, None };
+
+// GPU line and point engine. Every segment is stored once as an instance record
+// and expanded to a screen-space quad in the vertex shader, which gives
+// arbitrary widths, caps, round joins and analytic anti-aliasing regardless of
+// the driver's glLineWidth/glPointSize limits. Points are zero-length segments.
+class LineRenderer {
+public:
+    LineRenderer();
+    ~LineRenderer();
+
+    bool Initialize();
+    void Shutdown();
+
+    void SetTransform(const glm::mat4& transform) { m_transform = transform; }
+    // Size of the viewport being drawn into; widths are in its pixels
+    void SetViewportSize(const glm::vec2& size) { m_viewportSize = size; }
+    void SetCap(LineCap cap) { m_cap = cap; }
+    void SetJoin(LineJoin join) { m_join = join; }
+
+    // Vertices use the Renderer layout: position xyz + color rgb per vertex
+    void DrawSegments(const float* vertices, int segmentCount, float width);
+    void DrawStrip(const float* vertices, int count, bool closed, float width);
+    void DrawPoints(const float* vertices, int count, float size);
+
+private:
+    struct Instance {
+        float start[3];
+        float end[3];
+        uint32_t startColor;  // RGBA8
+        uint32_t endColor;
+        float width;          // Pixels
+        uint32_t caps;        // Start cap in bits 0-1, end cap in bits 2-3
+    };
+
+    static uint32_t PackColor(const float* rgb);
+    void Push(const float* a, const float* b, float width, LineCap startCap, LineCap endCap);
+    void Flush();
+
+    std::unique_ptr<Shader> m_shader;
+    GLuint m_VAO;
+    GLuint m_cornerVBO;    // Static unit quad
+    GLuint m_instanceVBO;  // Streamed ring of instance records
+    GLsizeiptr m_capacity;
+    GLsizeiptr m_offset;
+
+    std::vector<Instance> m_instances;
+    glm::mat4 m_transform;
+    glm::vec2 m_viewportSize;
+    LineCap m_cap;
+    LineJoin m_join;
+};
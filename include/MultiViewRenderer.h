@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Bounds.h"
+#include "Camera.h"
+
+class Renderer;
+class Shader;
+
+// Draws unit cubes placed by world matrices into a grid of viewports, one
+// camera per viewport. Culling runs once per frame: a box around every view
+// frustum rejects what no view can see, then each survivor is tested against
+// the views and gets a bit per view that sees it. The camera matrices live in
+// one uniform block, and a single instanced draw covers all views: the
+// geometry shader sends each instance to its view's viewport
+// (gl_ViewportIndex) and drops the views whose bit is not set.
+class MultiViewRenderer {
+public:
+    static constexpr int kMaxViews = 16;  // Matches MAX_VIEWS in vertex_multiview.glsl
+
+    // PerView issues one culled draw per viewport instead, for comparison
+    enum class Mode { SingleDraw, PerView };
+
+    struct Stats {
+        int views = 0;
+        size_t objects = 0;         // Tested by Cull
+        size_t unionCulled = 0;     // Rejected by the box around all frusta
+        size_t visible = 0;         // Seen by at least one view
+        size_t viewInstances = 0;   // Sum over views of the objects each sees
+        int draws = 0;
+        double cullMs = 0.0;
+        double submitMs = 0.0;      // CPU time of Render
+    };
+
+    MultiViewRenderer();
+    ~MultiViewRenderer();
+
+    bool Initialize();
+    void Shutdown();
+
+    // Lays count views out in a grid over the target and sets each camera's
+    // aspect ratio; camera placement is left to the caller
+    void SetViewCount(int count, int width, int height);
+    int GetViewCount() const { return m_viewCount; }
+    Camera& GetCamera(int view) { return m_cameras[view]; }
+
+    void SetMode(Mode mode) { m_mode = mode; }
+    Mode GetMode() const { return m_mode; }
+
+    // Lighting uniforms go here; view and projection come from the uniform block
+    const Shader& GetShader() const { return *m_shader; }
+
+    void Cull(const std::vector<AABB>& bounds, const std::vector<uint32_t>& slots);
+    // Draws what Cull kept. PerView mode draws with perViewShader (the
+    // vertex_instanced.glsl program). Restores the viewport it found.
+    void Render(Renderer& renderer, const glm::mat4* world, const glm::vec3* colors, const Shader& perViewShader);
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    static constexpr GLuint kViewsBinding = 0;  // Uniform buffer binding point
+
+    std::unique_ptr<Shader> m_shader;
+    GLuint m_viewBuffer;  // std140: views[kMaxViews], projections[kMaxViews]
+
+    int m_viewCount;
+    Mode m_mode;
+    Camera m_cameras[kMaxViews];
+    glm::vec4 m_viewports[kMaxViews];  // x, y, width, height
+    glm::vec4 m_planes[kMaxViews][6];  // Inward-facing, from each view's frustum
+
+    std::vector<uint32_t> m_visible;     // Slots
+    std::vector<uint32_t> m_viewMasks;   // Per slot
+    std::vector<uint32_t> m_viewSlots;   // PerView mode, rebuilt per view
+
+    Stats m_stats;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Bounds.h"
+
+class Camera;
+class Renderer;
+class Shader;
+
+enum class PickMethod { GPU, CPU };
+
+struct PickResult {
+    static constexpr uint32_t kNoHit = 0xFFFFFFFFu;
+
+    PickMethod method = PickMethod::CPU;
+    uint32_t id = kNoHit;     // Caller's ID of the object under the cursor
+    int x = 0, y = 0;         // Window pixel, top-left origin
+    float distance = 0.0f;    // CPU: along the ray from the near plane
+    double latencyMs = 0.0;   // From the request until the result was known
+    int latencyFrames = 0;    // GPU: Update calls between request and result
+};
+
+// Click-to-select for unit cubes placed by world matrices (the scene's
+// renderables). Objects are addressed by slot; ids[slot] is what results report.
+// GPU: object IDs are drawn into a small integer target covering only the
+// pixels around the cursor, read back through a PBO and collected once a fence
+// says the copy is done, so nothing ever waits on the GPU.
+// CPU: a ray through the pixel, built from the camera matrices, traverses a
+// BVH over the objects' world bounds and is tested exactly against each cube.
+class ObjectPicker {
+public:
+    struct Stats {
+        size_t gpuRequests = 0;
+        size_t gpuDropped = 0;      // Every readback slot was busy
+        size_t gpuCandidates = 0;   // Objects drawn by the last GPU request
+        size_t cpuTested = 0;       // Exact cube tests by the last CPU pick
+        size_t bvhNodes = 0;
+        double bvhBuildMs = 0.0;    // Last rebuild or refit
+        bool bvhRefit = false;      // The last change only refitted the boxes
+    };
+
+    ObjectPicker();
+    ~ObjectPicker();
+
+    bool Initialize();
+    void Shutdown();
+
+    // Draws the IDs of the objects near the pixel and queues their readback.
+    // Restores the framebuffer and viewport it found. Returns false when every
+    // readback slot is still in flight.
+    bool RequestGPU(int x, int y, int width, int height, const Camera& camera, Renderer& renderer,
+                    const std::vector<glm::mat4>& world, const std::vector<AABB>& bounds,
+                    const std::vector<uint32_t>& slots, const std::vector<uint32_t>& ids);
+    // Collects finished readbacks without waiting; call once per frame
+    void Update(std::vector<PickResult>& results);
+    bool IsPending() const;
+
+    // Nearest object along the ray through the pixel. The BVH is refitted or
+    // rebuilt when version differs from the last call.
+    PickResult PickCPU(int x, int y, int width, int height, const Camera& camera,
+                       const std::vector<glm::mat4>& world, const std::vector<AABB>& bounds,
+                       const std::vector<uint32_t>& slots, const std::vector<uint32_t>& ids, unsigned int version);
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    static constexpr int kRegionSize = 9;      // Odd, so the cursor pixel is the center
+    static constexpr int kReadbackSlots = 3;
+    static constexpr uint32_t kLeafSize = 4;
+
+    struct Readback {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        int x = 0, y = 0;
+        int frame = 0;
+        std::chrono::high_resolution_clock::time_point start;
+    };
+
+    // Internal nodes keep their left child right after them and the right one at first
+    struct BvhNode {
+        AABB bounds;
+        uint32_t first = 0;
+        uint32_t count = 0;  // Objects in a leaf, 0 for internal nodes
+    };
+
+    void BuildBvh(const std::vector<AABB>& bounds, const std::vector<uint32_t>& slots);
+    uint32_t BuildNode(const std::vector<AABB>& bounds, uint32_t begin, uint32_t end);
+    void RefitBvh(const std::vector<AABB>& bounds);
+
+    std::unique_ptr<Shader> m_shader;
+    GLuint m_framebuffer;
+    GLuint m_idRenderbuffer;     // R32UI, ID + 1 with 0 for background
+    GLuint m_depthRenderbuffer;
+    Readback m_readbacks[kReadbackSlots];
+    int m_frame;
+    std::vector<uint32_t> m_candidates;
+    std::vector<glm::vec3> m_idAttributes;  // ID + 1 in x, streamed as the instance color
+
+    std::vector<BvhNode> m_bvh;
+    std::vector<uint32_t> m_bvhSource;      // Slots the tree was built from
+    std::vector<uint32_t> m_bvhSlots;       // The same, in leaf order
+    std::vector<glm::vec3> m_centroids;     // Per slot, while building
+    unsigned int m_bvhVersion;
+    bool m_bvhValid;
+
+    Stats m_stats;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "Bounds.h"
+
+// Per-frame culling counters. Fragment counts come from occlusion queries
+// and lag a couple of frames behind so reading them never stalls the GPU.
+struct OcclusionStats {
+    int objectsTested = 0;
+    int objectsCulled = 0;
+    GLuint64 fragmentsRasterized = 0;  // Samples passing GL_LESS in submission order (shading cost without a pre-pass)
+    GLuint64 fragmentsShaded = 0;      // Samples actually shaded by the color pass
+    GLuint64 fragmentsSaved = 0;       // Overdraw removed by the depth pre-pass
+};
+
+// Hierarchical-Z occlusion culler. The depth buffer of a previous frame is read
+// back asynchronously, reprojected on the CPU into the current view and reduced
+// into a max-depth pyramid that object bounds are tested against.
+class OcclusionCuller {
+public:
+    enum class Pass { Prepass = 0, Shading = 1 };
+
+    OcclusionCuller();
+    ~OcclusionCuller();
+
+    bool Initialize(int width, int height);
+    void Resize(int width, int height);
+    void Shutdown();
+
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+    bool IsEnabled() const { return m_enabled; }
+
+    // Collects finished readbacks/queries and rebuilds the pyramid for this view
+    void BeginFrame(const glm::mat4& viewProjection);
+    // Conservative test: returns false only when the box is certainly hidden
+    bool IsVisible(const AABB& bounds);
+    // Queues an asynchronous readback of the currently bound depth buffer
+    void EndFrame();
+
+    // Occlusion queries wrapped around the pre-pass and the shading pass
+    void BeginQuery(Pass pass);
+    void EndQuery(Pass pass);
+
+    const OcclusionStats& GetStats() const { return m_stats; }
+
+private:
+    static constexpr int kReadbackSlots = 3;
+    static constexpr int kQueryFrames = 3;
+    static constexpr int kCellSize = 4;  // Framebuffer pixels per base pyramid texel
+
+    struct ReadbackSlot {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        glm::mat4 viewProjection{1.0f};
+        unsigned long long frame = 0;
+    };
+
+    struct QueryFrame {
+        GLuint queries[2] = {0, 0};
+        bool issued[2] = {false, false};
+    };
+
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<float> depth;
+    };
+
+    void CreateReadbackBuffers();
+    void DestroyReadbackBuffers();
+    bool ConsumeReadback();
+    void CollectQueries();
+    void Reproject(const glm::mat4& viewProjection);
+    void BuildPyramid();
+
+    bool m_enabled;
+    int m_width, m_height;
+    int m_cellsX, m_cellsY;
+    unsigned long long m_frame;
+
+    ReadbackSlot m_slots[kReadbackSlots];
+    QueryFrame m_queryFrames[kQueryFrames];
+    int m_queryFrame;
+
+    // Max depth per cell of the most recent readback, in that frame's view
+    std::vector<float> m_sourceDepth;
+    glm::mat4 m_sourceViewProjection;
+    bool m_hasSource;
+
+    std::vector<Level> m_pyramid;
+    glm::mat4 m_viewProjection;
+
+    OcclusionStats m_stats;
+};
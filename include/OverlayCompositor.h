@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Renderer;
+class Shader;
+
+// Retained, layered 2D overlay. Each layer records a display list of points and
+// lines (same interleaved position/color format as Renderer) and owns an
+// offscreen target that is re-rasterized only when its contents change. All
+// layers are then composited over the 3D result in one full-screen pass.
+class OverlayCompositor {
+public:
+    static constexpr int kMaxLayers = 8;
+
+    OverlayCompositor();
+    ~OverlayCompositor();
+
+    bool Initialize(int width, int height);
+    void Resize(int width, int height);
+    void Shutdown();
+
+    // Layers are composited in creation order; returns -1 when full
+    int AddLayer(const std::string& name);
+    void SetLayerVisible(int layer, bool visible);
+
+    // Display list recording. Replaces the layer's previous contents; the layer
+    // is only marked dirty when the new list differs from the old one.
+    void BeginLayer(int layer);
+    void SetLineWidth(float width);
+    void SetPointSize(float size);
+    void AddPoints(const float* vertices, int count);
+    void AddLines(const float* vertices, int count);
+    void AddLineStrip(const float* vertices, int count);
+    void AddLineLoop(const float* vertices, int count);
+    void EndLayer();
+
+    // Re-rasterizes dirty layers with the given 2D shader
+    void Rasterize(Renderer& renderer, const Shader& shader);
+    // Blends all visible layers over the currently bound framebuffer
+    void Composite();
+
+    // Bumps whenever any layer's contents or visibility change
+    unsigned int GetVersion() const { return m_version; }
+    int GetLayersRasterized() const { return m_layersRasterized; }
+
+private:
+    enum class Primitive { Points, Lines, LineStrip, LineLoop };
+
+    struct Command {
+        Primitive primitive;
+        int first;   // First vertex in the layer's vertex array
+        int count;   // Same meaning as the matching Renderer call
+        float size;  // Line width or point size
+
+        bool operator==(const Command& other) const {
+            return primitive == other.primitive && first == other.first && count == other.count && size == other.size;
+        }
+    };
+
+    struct Layer {
+        std::string name;
+        std::vector<float> vertices;
+        std::vector<Command> commands;
+        GLuint framebuffer = 0;
+        GLuint texture = 0;
+        bool visible = true;
+        bool dirty = true;
+    };
+
+    void Record(Primitive primitive, const float* vertices, int vertexCount, int count);
+    void CreateTarget(Layer& layer);
+    void DestroyTarget(Layer& layer);
+
+    std::vector<Layer> m_layers;
+    int m_width, m_height;
+
+    // Recording state
+    int m_recording;
+    std::vector<float> m_pendingVertices;
+    std::vector<Command> m_pendingCommands;
+    float m_lineWidth;
+    float m_pointSize;
+
+    std::unique_ptr<Shader> m_compositeShader;
+    GLuint m_emptyVAO;  // Full-screen triangle is generated from gl_VertexID
+
+    unsigned int m_version;
+    int m_layersRasterized;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Shader;
+
+// std430 layout shared with the particle compute shaders and the vertex layout
+struct Particle {
+    glm::vec4 positionLife;      // xyz position, w seconds left
+    glm::vec4 velocityLifetime;  // xyz velocity, w total lifetime
+};
+
+struct ParticleEmitter {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+    float rate = 100000.0f;  // Particles per second
+    float speed = 6.0f;
+    float spread = 0.3f;     // 0 = straight up, 1 = hemisphere
+    float lifetime = 2.5f;   // Maximum; each particle lives 50-100% of it
+    float drag = 0.3f;
+};
+
+// GPU: particles live in two SSBOs. Compute shaders integrate and compact the
+// survivors from one into the other, then append new particles. The alive
+// count is written on the GPU into an indirect draw command and the next
+// frame's dispatch arguments, so the CPU never sees per-particle data.
+// CPU: the same simulation on a vector, uploaded for drawing. It is the
+// fallback below GL 4.3, the reference for verification, and a throughput
+// baseline.
+enum class ParticleBackend { GPU, CPU };
+
+class ParticleSystem {
+public:
+    struct Stats {
+        size_t alive = 0;     // GPU: read back a few frames late
+        size_t emitted = 0;
+        size_t capacity = 0;
+        double updateMs = 0.0;  // CPU time of the last Update (submission only on the GPU)
+    };
+
+    ParticleSystem();
+    ~ParticleSystem();
+
+    // The GPU backend needs compute shaders (GL 4.3); otherwise the CPU one is used
+    bool Initialize(size_t capacity, ParticleBackend backend);
+    void Shutdown();
+
+    ParticleBackend GetBackend() const { return m_backend; }
+    ParticleEmitter& GetEmitter() { return m_emitter; }
+
+    // Integrates, drops dead particles and emits rate * deltaTime new ones
+    void Update(float deltaTime);
+    // Additive, depth-tested points; leaves depth writes and blending as it found them
+    void Draw(const glm::mat4& view, const glm::mat4& projection);
+
+    const Stats& GetStats() const { return m_stats; }
+
+    // Steps a GPU system and the CPU reference side by side from the same seed
+    // and compares alive counts and mean position. Stalls; for testing.
+    static bool Verify(size_t capacity, int steps, float deltaTime);
+
+    // One reference step: integrate and compact in place, then emit
+    static void Simulate(std::vector<Particle>& particles, size_t capacity, const ParticleEmitter& emitter,
+                         uint32_t emitBase, uint32_t emitCount, float deltaTime);
+
+private:
+    static constexpr int kReadbackSlots = 3;
+    static constexpr GLuint kGroupSize = 256;  // Matches local_size_x in the compute shaders
+
+    void UpdateGPU(uint32_t emitCount, float deltaTime);
+    void CollectAliveCount();
+    bool ReadParticles(std::vector<Particle>& particles);
+    void SetupVertexArray(GLuint vao, GLuint buffer);
+
+    ParticleBackend m_backend;
+    ParticleEmitter m_emitter;
+    size_t m_capacity;
+    uint32_t m_emitted;
+    float m_emitAccumulator;
+
+    // GPU state
+    std::unique_ptr<Shader> m_updateShader;
+    std::unique_ptr<Shader> m_emitShader;
+    std::unique_ptr<Shader> m_finalizeShader;
+    GLuint m_particleBuffers[2];
+    GLuint m_counterBuffer;  // Two draw commands, then the update dispatch arguments
+    int m_current;           // Buffer holding this frame's particles
+    GLuint m_readbackBuffers[kReadbackSlots];
+    GLsync m_readbackFences[kReadbackSlots];
+    int m_readbackNext;
+
+    // CPU state
+    std::vector<Particle> m_particles;
+    GLuint m_cpuBuffer;
+
+    std::unique_ptr<Shader> m_drawShader;
+    GLuint m_vertexArrays[3];  // One per particle buffer, then the CPU upload buffer
+    Stats m_stats;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+class Renderer;
+
+// View-dependent simplification of large line strips. Data with monotonic x
+// (time series) is decimated to first/min/max/last per pixel column; general
+// polylines are thinned with Douglas-Peucker or Visvalingam-Whyatt. All the
+// expensive work happens once in SetData: a min/max pyramid or a per-vertex
+// importance, so zooming and panning only touch the visible, coarsest level.
+class PolylineCache {
+public:
+    enum class Method { Auto, MinMax, DouglasPeucker, Visvalingam };
+
+    struct Stats {
+        size_t sourceVertices = 0;
+        size_t outputVertices = 0;
+        int level = -1;       // Pyramid or importance level used, -1 for raw samples
+        bool reused = false;  // View unchanged, previous result returned
+    };
+
+    PolylineCache();
+
+    // Vertices use the Renderer layout: position xyz + color rgb per vertex.
+    // Auto picks MinMax when x is non-decreasing, Douglas-Peucker otherwise.
+    void SetData(const float* vertices, size_t count, Method method = Method::Auto);
+    void SetData(std::vector<float>&& vertices, Method method = Method::Auto);
+    // Maximum deviation allowed, in pixels
+    void SetTolerance(float pixels);
+
+    // The result may hold several strips when separate parts of the line are
+    // visible; GetStripStarts gives the first vertex of each
+    const std::vector<float>& Simplify(const glm::mat4& viewProjection, int viewportWidth, int viewportHeight);
+    const std::vector<size_t>& GetStripStarts() const { return m_stripStarts; }
+    void Draw(Renderer& renderer, const glm::mat4& viewProjection, int viewportWidth, int viewportHeight);
+
+    Method GetMethod() const { return m_method; }
+    size_t GetVertexCount() const { return m_vertices.size() / 6; }
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    struct Bucket {
+        uint32_t minIndex;
+        uint32_t maxIndex;
+    };
+
+    // Bounds of a run of kLevelChunk consecutive segments of an importance level
+    struct Chunk {
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+    };
+
+    struct Level {
+        std::vector<uint32_t> indices;
+        std::vector<Chunk> chunks;
+    };
+
+    static constexpr uint32_t kBaseBucket = 8;
+    static constexpr size_t kMaxCachedLevels = 8;
+    static constexpr size_t kLevelChunk = 64;
+
+    glm::vec3 Position(size_t index) const;
+    float X(size_t index) const { return m_vertices[index * 6]; }
+    float Y(size_t index) const { return m_vertices[index * 6 + 1]; }
+    void AppendVertex(size_t index);
+    bool IsVisible(const Chunk& chunk, const glm::mat4& viewProjection) const;
+
+    void Build();
+    void BuildMinMaxPyramid();
+    void BuildDouglasPeuckerImportance();
+    void BuildVisvalingamImportance();
+
+    void SimplifyMinMax(const glm::mat4& viewProjection, int viewportWidth);
+    void SimplifyByImportance(const glm::mat4& viewProjection, int viewportWidth, int viewportHeight);
+    const Level& GetLevel(int level);
+
+    std::vector<float> m_vertices;
+    Method m_method;
+    float m_tolerance;
+    glm::vec3 m_boundsMin, m_boundsMax;
+
+    // MinMax: level k groups kBaseBucket << k samples per bucket
+    std::vector<std::vector<Bucket>> m_pyramid;
+
+    // Douglas-Peucker / Visvalingam: per-vertex significance in world units,
+    // and the surviving indices for each power-of-two threshold seen so far
+    std::vector<float> m_importance;
+    std::map<int, Level> m_levels;
+
+    // Result of the last call
+    std::vector<float> m_output;
+    std::vector<size_t> m_stripStarts;
+    glm::mat4 m_lastViewProjection;
+    int m_lastWidth, m_lastHeight;
+    bool m_outputValid;
+    Stats m_stats;
+};
@@ -1,19 +1,78 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "GpuMemory.h"
+#include "LineRenderer.h"
+#include "SoftwareRasterizer.h"
+
+class Shader;
+
+// Indexed geometry living in the shared GPU buffers. Vertices use the Renderer
+// layout: position xyz + color (or normal) xyz.
+struct Mesh {
+    GpuAllocation vertices;
+    GpuAllocation indices;
+    GLsizei indexCount = 0;
+    GLint baseVertex = 0;
+    int cpuMesh = -1;  // Software backend copy
+};
+
+// OpenGL draws through the current context. Software rasterizes on the CPU
+// without any GL calls, reading uniforms recorded by the current Shader (which
+// must be created in software mode); results are available from ReadPixels.
+enum class RenderBackend { OpenGL, Software };
 
 class Renderer {
 public:
-    Renderer();
+    explicit Renderer(RenderBackend backend = RenderBackend::OpenGL);
     ~Renderer();
 
     bool Initialize();
     void Clear(float r = 0.2f, float g = 0.3f, float b = 0.3f, float a = 1.0f);
+    // Releases geometry freed in earlier frames once the GPU is done with it
+    void EndFrame();
+
+    RenderBackend GetBackend() const { return m_backend; }
+    // Framebuffer size. The software backend renders at it; on the GL backend
+    // it is the viewport that line widths and point sizes are measured in.
+    void Resize(int width, int height);
+    // Completes queued software rendering; no-op on the GL backend
+    void Finish();
+    // RGBA8, bottom row first
+    bool ReadPixels(std::vector<uint8_t>& pixels, int& width, int& height);
+    const SoftwareRasterizer* GetSoftwareRasterizer() const { return m_software.get(); }
+    
+    // Mesh management
+    Mesh CreateMesh(const float* vertices, int vertexCount, const unsigned int* indices, int indexCount);
+    void DrawMesh(const Mesh& mesh, GLenum mode = GL_TRIANGLES);
+    void DestroyMesh(Mesh& mesh);
+    const GpuMemory& GetGpuMemory() const { return m_gpuMemory; }
     void DrawTriangle();
     
     // 3D rendering
     void DrawCube(float size = 1.0f);
     void DrawCubeWireframe(float size = 1.0f);
+
+    // Draws count copies of a mesh in one call, for vertex_instanced.glsl. World
+    // matrices and colors are gathered through indices (all entries in order
+    // when null) straight into a streamed instance buffer.
+    void DrawMeshInstanced(const Mesh& mesh, const glm::mat4* models, const glm::vec3* colors,
+                           const uint32_t* indices, int count);
+    void DrawCubeInstanced(const glm::mat4* models, const glm::vec3* colors, const uint32_t* indices, int count);
+    // One draw for several viewports, for vertex_multiview.glsl: every object is
+    // streamed once and instanced viewCount times (gl_InstanceID % viewCount is
+    // the view); viewMasks[index] has a bit per view that should draw it.
+    // OpenGL backend only.
+    void DrawMeshMultiView(const Mesh& mesh, const glm::mat4* models, const glm::vec3* colors, const uint32_t* viewMasks,
+                           const uint32_t* indices, int count, int viewCount);
+    void DrawCubeMultiView(const glm::mat4* models, const glm::vec3* colors, const uint32_t* viewMasks,
+                           const uint32_t* indices, int count, int viewCount);
     
     // Point rendering
     void DrawPoint(float x, float y, float z = 0.0f);
@@ -28,6 +87,18 @@ public:
     // Utility functions
     void SetPointSize(float size);
     void SetLineWidth(float width);
+    void SetLineCap(LineCap cap);
+    void SetLineJoin(LineJoin join);
+    
+    // Points and lines are expanded to anti-aliased quads on the GPU by default.
+    // That path uses its own program, so it needs the full model-view-projection
+    // transform; the native GL_POINTS/GL_LINES path uses the bound shader instead.
+    // A viewport size of 0 means the Resize size, for drawing into smaller
+    // targets. Both go back to identity and the Resize size at EndFrame, so a
+    // caller that never sets them draws in normalized device coordinates.
+    void SetTransform(const glm::mat4& transform, int viewportWidth = 0, int viewportHeight = 0);
+    void SetInstancedLines(bool enabled);
+    bool IsInstancedLines() const { return m_instancedLines; }
     
     // Shape drawing utilities
     void DrawGrid(int gridSize, float spacing);
@@ -40,16 +111,45 @@ private:
     void SetupTriangle();
     void SetupPointsAndLines();
     void SetupCube();
+    GLuint GetMeshVAO(int vertexPool, int indexPool);
+    GLuint GetInstancedVAO(int vertexPool, int indexPool);
+    GLuint GetMultiViewVAO(int vertexPool, int indexPool);
+    SoftwareRasterizer::Material GetSoftwareMaterial(const Shader* shader) const;
+    
+    RenderBackend m_backend;
+    std::unique_ptr<SoftwareRasterizer> m_software;
+    struct CpuMesh {
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+    };
+    std::vector<CpuMesh> m_cpuMeshes;
+    glm::mat4 m_transform;
+    int m_viewportWidth, m_viewportHeight;
+    
+    // Shared vertex/index buffers and one VAO per pool pair
+    GpuMemory m_gpuMemory;
+    std::map<std::pair<int, int>, GLuint> m_meshVAOs;
+
+    // Per-instance model matrix + color, rewritten by every instanced draw
+    std::map<std::pair<int, int>, GLuint> m_instancedVAOs;
+    GLuint m_instanceVBO;
+    size_t m_instanceCapacity;
+
+    // Same plus a view mask, with the divisor set to the view count per draw
+    std::map<std::pair<int, int>, GLuint> m_multiViewVAOs;
+    int m_multiViewDivisor;
     
-    GLuint m_VAO;  // Vertex Array Object
-    GLuint m_VBO;  // Vertex Buffer Object
+    Mesh m_triangle;
     
     // VAO/VBO for dynamic point and line rendering
     GLuint m_dynamicVAO;
     GLuint m_dynamicVBO;
     
-    // VAO/VBO/EBO for cube rendering
-    GLuint m_cubeVAO;
-    GLuint m_cubeVBO;
-    GLuint m_cubeEBO;
+    Mesh m_cube;
+    
+    // Instanced line/point engine
+    std::unique_ptr<LineRenderer> m_lineRenderer;
+    bool m_instancedLines;
+    float m_lineWidth;
+    float m_pointSize;
 };
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Bounds.h"
+
+class ThreadPool;
+
+// Transform hierarchy kept in parallel arrays sorted by depth, so every parent
+// sits before its children. Only nodes whose local transform changed, and
+// their subtrees, are recomputed; large depth levels are split across worker
+// threads. Nodes are addressed by stable handles, the arrays by slot. Slots
+// move only when nodes are added out of depth order or removed.
+class SceneGraph {
+public:
+    using Node = uint32_t;
+    static constexpr Node kNone = 0xFFFFFFFFu;
+
+    enum Flags : uint8_t {
+        Renderable = 1 << 0,  // Drawn as a cube; otherwise a pure transform
+        Dynamic = 1 << 1      // Never occlusion culled, only acts as an occluder
+    };
+
+    struct Stats {
+        size_t nodes = 0;
+        size_t updated = 0;   // World matrices recomputed by the last Update
+        size_t levels = 0;
+        size_t batches = 0;   // Jobs handed to worker threads
+        double updateMs = 0.0;
+    };
+
+    SceneGraph();
+    ~SceneGraph();
+
+    void Reserve(size_t count);
+    void Clear();
+
+    Node AddNode(Node parent, const glm::mat4& local, uint8_t flags = Renderable,
+                 const AABB& localBounds = { glm::vec3(-0.5f), glm::vec3(0.5f) });
+    // Removes the node and its whole subtree
+    void Remove(Node node);
+
+    void SetLocalTransform(Node node, const glm::mat4& local);
+    void SetColor(Node node, const glm::vec3& color);
+    void SetTexture(Node node, int texture);
+
+    // Recomputes world matrices and bounds of changed subtrees
+    void Update();
+
+    size_t GetSlot(Node node) const { return m_slots[node]; }
+    const glm::mat4& GetWorldTransform(Node node) const { return m_world[m_slots[node]]; }
+    const AABB& GetWorldBounds(Node node) const { return m_worldBounds[m_slots[node]]; }
+    // Whether the last Update moved this slot's world matrix
+    bool HasChanged(size_t slot) const { return m_changedUpdate[slot] == m_updateIndex; }
+
+    // Slot-ordered arrays, valid after Update
+    size_t GetCount() const { return m_nodes.size(); }
+    const std::vector<Node>& GetNodes() const { return m_nodes; }
+    const std::vector<glm::mat4>& GetWorldMatrices() const { return m_world; }
+    const std::vector<AABB>& GetWorldBounds() const { return m_worldBounds; }
+    const std::vector<glm::vec3>& GetColors() const { return m_colors; }
+    const std::vector<int>& GetTextures() const { return m_textures; }
+    const std::vector<uint8_t>& GetFlags() const { return m_flags; }
+
+    // Bumps whenever an Update moved, added or removed anything
+    unsigned int GetVersion() const { return m_version; }
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    static constexpr uint8_t kRemoved = 1 << 7;
+    static constexpr size_t kParallelLevel = 4096;  // Smaller levels stay on the calling thread
+    static constexpr size_t kMinBatch = 1024;
+
+    void SortByDepth();
+    size_t UpdateRange(size_t begin, size_t end);
+    void MarkDirty(size_t slot);
+
+    // Per slot
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_parents;  // Parent slot or kNone
+    std::vector<uint32_t> m_depths;
+    std::vector<glm::mat4> m_local;
+    std::vector<glm::mat4> m_world;
+    std::vector<AABB> m_localBounds;
+    std::vector<AABB> m_worldBounds;
+    std::vector<glm::vec3> m_colors;
+    std::vector<int> m_textures;
+    std::vector<uint8_t> m_flags;
+    std::vector<uint8_t> m_localDirty;
+    std::vector<uint32_t> m_changedUpdate;  // Update index that last moved the world matrix
+
+    // Per node
+    std::vector<uint32_t> m_slots;
+    std::vector<Node> m_freeNodes;
+
+    std::vector<size_t> m_levelStarts;  // First slot of each depth, plus the end
+    bool m_layoutDirty;
+    uint32_t m_minDirtyDepth;
+    uint32_t m_updateIndex;
+    unsigned int m_version;
+
+    std::unique_ptr<ThreadPool> m_pool;
+    Stats m_stats;
+};
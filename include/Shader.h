@@ -4,10 +4,15 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 class Shader {
 public:
     Shader(const std::string& vertexPath, const std::string& fragmentPath);
+    Shader(const std::string& vertexPath, const std::string& geometryPath, const std::string& fragmentPath);
+    // Compute program; needs GL 4.3
+    explicit Shader(const std::string& computePath);
     ~Shader();
 
     void Use() const;
@@ -17,16 +22,34 @@ public:
     void SetBool(const std::string& name, bool value) const;
     void SetInt(const std::string& name, int value) const;
     void SetFloat(const std::string& name, float value) const;
+    void SetVec2(const std::string& name, const glm::vec2& value) const;
     void SetVec3(const std::string& name, const glm::vec3& value) const;
     void SetMat4(const std::string& name, const glm::mat4& value) const;
     void SetMat4(const std::string& name, const float* value) const;
+    // Points the named uniform block at a GL_UNIFORM_BUFFER binding point
+    void SetUniformBlock(const std::string& name, GLuint binding) const;
 
     GLuint GetID() const { return m_program; }
 
+    // Software rendering: no GL program is created and uniform values are kept
+    // on the CPU for the software Renderer backend to read
+    static void SetSoftwareMode(bool enabled) { s_softwareMode = enabled; }
+    static bool IsSoftwareMode() { return s_softwareMode; }
+    static const Shader* GetCurrent() { return s_current; }
+    // Returns false if the uniform was never set
+    bool GetUniform(const std::string& name, float* value, size_t count) const;
+
 private:
+    void Link(const std::string& vertexCode, const std::string& geometryCode, const std::string& fragmentCode);
     GLuint CompileShader(const std::string& source, GLenum type) const;
     std::string ReadFile(const std::string& filePath) const;
     void CheckCompileErrors(GLuint shader, const std::string& type) const;
 
+    void Record(const std::string& name, const float* value, size_t count) const;
+
     GLuint m_program;
+    mutable std::unordered_map<std::string, std::vector<float>> m_uniforms;
+
+    static bool s_softwareMode;
+    static const Shader* s_current;
 };
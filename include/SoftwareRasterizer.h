@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "ThreadPool.h"
+
+// Tiled CPU rasterizer used by the software Renderer backend. Draw calls only
+// transform, clip and bin primitives into screen tiles; Flush rasterizes the
+// tiles in parallel, each worker owning its tiles' color and depth, with edge
+// functions evaluated four pixels at a time (SSE2, scalar fallback elsewhere).
+// Shading matches fragment.glsl for lit geometry and vertex colors otherwise.
+class SoftwareRasterizer {
+public:
+    struct Material {
+        bool lit = false;
+        glm::vec3 lightPos = glm::vec3(0.0f);
+        glm::vec3 lightColor = glm::vec3(1.0f);
+        glm::vec3 objectColor = glm::vec3(1.0f);
+    };
+
+    struct Stats {
+        size_t triangles = 0;    // Binned in the last flush, including line and point quads
+        size_t binEntries = 0;   // Triangle-tile pairs
+        double flushMs = 0.0;
+    };
+
+    explicit SoftwareRasterizer(size_t threadCount = 0);
+
+    void Resize(int width, int height);
+    void Clear(const glm::vec4& color);
+
+    // Vertices are position xyz + normal (lit) or color (unlit) xyz
+    void DrawTriangles(const float* vertices, const unsigned int* indices, int indexCount,
+                       const glm::mat4& model, const glm::mat4& viewProjection, const Material& material);
+    // Vertices are position xyz + color rgb; widths and sizes are in pixels
+    void DrawLines(const float* vertices, int segmentCount, float width, const glm::mat4& transform);
+    void DrawPoints(const float* vertices, int count, float size, const glm::mat4& transform);
+
+    void Flush();
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    // RGBA8, bottom row first like glReadPixels
+    const std::vector<uint32_t>& GetColor() const { return m_color; }
+    const Stats& GetStats() const { return m_stats; }
+    size_t GetThreadCount() const { return m_pool.GetThreadCount(); }
+
+private:
+    static constexpr int kTileSize = 64;
+
+    struct Vertex {
+        glm::vec4 clip;
+        glm::vec3 world;
+        glm::vec3 attribute;  // Normal or color
+    };
+
+    struct ScreenVertex {
+        float x, y, z, invW;
+        glm::vec3 world;
+        glm::vec3 attribute;
+    };
+
+    struct Triangle {
+        float edgeA[3], edgeB[3], edgeC[3];  // Edge opposite each vertex: A*x + B*y + C
+        float invArea;
+        float z[3], invW[3];
+        glm::vec3 world[3];      // Pre-multiplied by 1/w
+        glm::vec3 attribute[3];  // Pre-multiplied by 1/w
+        int minX, minY, maxX, maxY;
+        int material;            // -1: unlit vertex color
+    };
+
+    int AddMaterial(const Material& material);
+    void ClipAndSetup(const Vertex& a, const Vertex& b, const Vertex& c, int material);
+    ScreenVertex ToScreen(const Vertex& vertex) const;
+    void SetupTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, int material);
+    void RasterizeTile(int tileX, int tileY);
+    void ShadePixel(const Triangle& triangle, float b0, float b1, float b2, int x, int y, uint32_t* color, float* depth) const;
+
+    int m_width, m_height;
+    int m_tilesX, m_tilesY;
+    std::vector<uint32_t> m_color;
+    std::vector<float> m_depth;
+    bool m_clearPending;
+    uint32_t m_clearColor;
+
+    std::vector<Triangle> m_triangles;
+    std::vector<Material> m_materials;
+    std::vector<std::vector<uint32_t>> m_bins;
+    ThreadPool m_pool;
+    Stats m_stats;
+};
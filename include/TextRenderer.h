@@ -0,0 +1,147 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "BitmapFont.h"
+
+class Shader;
+
+enum class TextSpace : uint32_t {
+    Screen = 0,     // Position in pixels from the top-left corner, size in pixels
+    Billboard = 1,  // World position, constant size in pixels
+    World = 2       // World position, size in world units, facing the camera
+};
+
+// Signed-distance-field text. The embedded bitmap font is turned into SDF atlas
+// pages once and cached on disk. Labels are retained: each string is laid out
+// once (shared through a layout cache), and all glyph quads on screen are drawn
+// with one instanced draw per atlas page. Per-label position, size and color
+// live in a texture buffer, so moving labels never touches glyph data.
+class TextRenderer {
+public:
+    struct Stats {
+        size_t labels = 0;
+        size_t glyphs = 0;         // Glyph quads in the instance buffer
+        size_t draws = 0;          // Draw calls issued by the last Draw
+        size_t cachedLayouts = 0;
+        size_t layoutHits = 0;     // Since the last ResetCounters
+        size_t layoutMisses = 0;
+        size_t rebuilds = 0;       // Full glyph buffer rebuilds
+        size_t patches = 0;        // Text changes written in place
+        double rebuildMs = 0.0;    // CPU cost of the last rebuild
+        double atlasMs = 0.0;      // Time to load or generate the atlas
+        bool atlasFromCache = false;
+    };
+
+    TextRenderer();
+    ~TextRenderer();
+
+    // Loads the atlas from cachePath, or generates it and writes it there
+    bool Initialize(const std::string& cachePath);
+    void Shutdown();
+
+    // Lines are separated by '\n'; size is the line height. The pivot is the
+    // point of the text box placed at position, (0, 0) top-left to (1, 1) bottom-right.
+    int AddLabel(const std::string& text, const glm::vec3& position, float size, const glm::vec4& color,
+                 TextSpace space = TextSpace::Billboard, const glm::vec2& pivot = glm::vec2(0.5f, 1.0f));
+    void RemoveLabel(int label);
+    void SetLabelText(int label, const std::string& text);
+    void SetLabelPosition(int label, const glm::vec3& position);
+    void SetLabelColor(int label, const glm::vec4& color);
+    void Clear();
+
+    // Text box size in line heights
+    glm::vec2 Measure(const std::string& text);
+
+    // Blended over the current framebuffer without depth testing
+    void Draw(const glm::mat4& view, const glm::mat4& projection, int width, int height);
+
+    // Bumps whenever what Draw would show changes, except through camera movement
+    unsigned int GetVersion() const { return m_version; }
+    const Stats& GetStats() const { return m_stats; }
+    void ResetCounters();
+
+    // Builds every atlas page, page after page of kPageSize x kPageSize R8 texels
+    static void GenerateAtlas(std::vector<uint8_t>& pixels);
+
+private:
+    static constexpr int kScale = 2;      // Atlas texels per font pixel
+    static constexpr int kSpread = 8;     // Distance range in atlas texels, also the cell padding
+    static constexpr int kCellWidth = BitmapFont::kGlyphWidth * kScale + 2 * kSpread;
+    static constexpr int kCellHeight = BitmapFont::kGlyphHeight * kScale + 2 * kSpread;
+    static constexpr int kPageSize = 512;
+    static constexpr int kCellsPerRow = kPageSize / kCellWidth;
+    static constexpr int kCellsPerPage = kCellsPerRow * (kPageSize / kCellHeight);
+    static constexpr int kPageCount = (BitmapFont::kGlyphCount + kCellsPerPage - 1) / kCellsPerPage;
+    static constexpr size_t kMaxCachedLayouts = 4096;  // Unreferenced layouts are dropped past this
+
+    // Glyph placement in line heights, relative to the text box's top-left
+    struct LayoutGlyph {
+        uint16_t glyph;
+        float x, y;
+    };
+
+    struct Layout {
+        std::vector<LayoutGlyph> glyphs;
+        std::vector<uint32_t> pageCounts;
+        glm::vec2 size = glm::vec2(0.0f);
+        uint32_t references = 0;
+    };
+
+    // One glyph quad; 28 bytes
+    struct GlyphInstance {
+        uint32_t label;     // Label index, TextSpace in the top two bits
+        float rect[4];      // Offset from the anchor and size, in line heights
+        uint16_t uv[4];     // Atlas rectangle, normalized
+    };
+
+    struct Label {
+        Layout* layout = nullptr;
+        glm::vec2 pivot = glm::vec2(0.0f);
+        TextSpace space = TextSpace::Screen;
+        std::vector<uint32_t> firstInstance;  // Per page, valid until the next rebuild
+        bool alive = false;
+    };
+
+    static uint64_t AtlasKey();
+    bool LoadAtlas(const std::string& path, std::vector<uint8_t>& pixels) const;
+    void SaveAtlas(const std::string& path, const std::vector<uint8_t>& pixels) const;
+
+    Layout* AcquireLayout(const std::string& text);
+    void ReleaseLayout(Layout* layout);
+    // Appends each glyph to the cursor of its page
+    void WriteGlyphs(const Label& label, int index, GlyphInstance** cursors) const;
+    void WriteRecord(int label, const glm::vec3& position, float size, const glm::vec4& color);
+    void RebuildGlyphs();
+    void Upload();
+
+    std::unique_ptr<Shader> m_shader;
+    std::vector<GLuint> m_pages;
+    GLuint m_vertexArray;
+    GLuint m_instanceBuffer;
+    size_t m_instanceCapacity;
+    GLuint m_recordBuffer;   // Two RGBA32F texels per label: position + size, color
+    GLuint m_recordTexture;
+    size_t m_recordCapacity;
+
+    std::unordered_map<std::string, Layout> m_layouts;
+    std::vector<Label> m_labels;
+    std::vector<int> m_freeLabels;
+    std::vector<glm::vec4> m_records;
+
+    std::vector<GlyphInstance> m_instances;  // Grouped by page
+    std::vector<size_t> m_pageStarts;        // First instance of each page, plus the end
+    uint16_t m_texRects[BitmapFont::kGlyphCount][4];  // Atlas rectangle per glyph, normalized
+    bool m_glyphsDirty;
+    std::vector<std::pair<size_t, size_t>> m_instanceDirty;  // Per page, instances to upload
+    size_t m_recordDirtyBegin, m_recordDirtyEnd;
+
+    unsigned int m_version;
+    Stats m_stats;
+};
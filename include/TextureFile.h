@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// S3TC / sRGB-S3TC enums come from extensions the GL loader may not include
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+// Read-only memory mapping of a whole file. Uses mmap / MapViewOfFile, and
+// falls back to reading the file into memory where mapping is unavailable.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    // Asks the OS to page in a range ahead of use
+    void Prefetch(size_t offset, size_t size) const;
+
+    const uint8_t* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    std::vector<uint8_t> m_fallback;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+// A block-compressed (BCn) image with its mip chain, parsed in place from a
+// mapped DDS or KTX2 file
+class TextureFile {
+public:
+    struct Level {
+        size_t offset = 0;
+        size_t size = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    bool Load(const std::string& path);
+
+    GLenum GetFormat() const { return m_format; }
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetLevelCount() const { return static_cast<int>(m_levels.size()); }
+    const Level& GetLevel(int level) const { return m_levels[level]; }
+    const uint8_t* GetLevelData(int level) const { return m_file.GetData() + m_levels[level].offset; }
+    const MappedFile& GetFile() const { return m_file; }
+
+    static size_t BlockBytes(GLenum format);
+    static size_t LevelBytes(GLenum format, int width, int height);
+    // Whether the current context can sample the format
+    static bool IsFormatSupported(GLenum format);
+
+private:
+    // Limits on header values, checked before any size math
+    static constexpr uint32_t kMaxDimension = 65536;
+    static constexpr uint32_t kMaxLevels = 32;
+
+    bool ParseDDS();
+    bool ParseKTX2();
+    bool ValidateLevels() const;
+
+    std::string m_path;
+    MappedFile m_file;
+    GLenum m_format = 0;
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<Level> m_levels;
+};
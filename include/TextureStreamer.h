@@ -0,0 +1,113 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "TextureFile.h"
+#include "ThreadPool.h"
+
+class Camera;
+
+// Streams block-compressed textures without load hitches. Files are mapped and
+// parsed on a loader thread pool, which also pre-faults mip data ahead of use.
+// The render thread uploads through a ring of PBOs under a per-frame byte
+// budget, coarsest levels first, refining each texture towards the level its
+// on-screen size needs. A residency budget evicts least recently used textures
+// down to their small mip tail.
+class TextureStreamer {
+public:
+    using Handle = int;
+
+    struct Stats {
+        int textures = 0;
+        int pendingLoads = 0;
+        size_t residentBytes = 0;
+        size_t uploadedBytes = 0;  // This frame
+        int levelsUploaded = 0;    // This frame, including mip tails and evictions
+        int evictions = 0;         // Since the last ResetCounters
+        int stalledFrames = 0;     // Frames that skipped uploading because the PBO was still in use
+    };
+
+    TextureStreamer();
+    ~TextureStreamer();
+
+    bool Initialize(size_t residencyBudget = 256u << 20, size_t uploadBudget = 4u << 20, size_t loaderThreads = 2);
+    void Shutdown();
+
+    // Starts loading in the background; the same path returns the same handle
+    Handle Request(const std::string& path);
+
+    // Binds whatever is resident and records the use for LRU and mip selection.
+    // Returns false while nothing is resident yet.
+    bool Bind(Handle handle, GLuint unit, const glm::vec3& center, float radius);
+
+    // Once per frame: finishes loads, uploads within budget and evicts
+    void Update(const Camera& camera, int viewportHeight);
+
+    const Stats& GetStats() const { return m_stats; }
+    void ResetCounters();
+
+private:
+    static constexpr int kPboCount = 3;
+    static constexpr int kTailSize = 64;  // Levels this small stay resident
+
+    enum class State { Loading, Ready, Failed };
+
+    struct Texture {
+        std::string path;
+        State state = State::Loading;
+        std::unique_ptr<TextureFile> file;
+        GLuint texture = 0;
+        int tailLevel = 0;
+        int residentLevel = 0;  // Finest level uploaded; levelCount when none
+        int targetLevel = 0;
+        size_t residentBytes = 0;
+        float screenPixels = 0.0f;  // Largest on-screen size seen this frame
+        unsigned long long lastUsed = 0;
+        std::atomic<int> prefetchedLevel{ 0 };  // Finest level already paged in
+        int prefetchRequested = 0;
+    };
+
+    struct Upload {
+        Texture* texture;
+        int level;
+        size_t offset;
+    };
+
+    struct Pbo {
+        GLuint buffer = 0;
+        size_t size = 0;
+        GLsync fence = nullptr;
+    };
+
+    void FinishLoads();
+    void CreateTexture(Texture& texture);
+    void SelectLevels();
+    void UploadLevels();
+    bool MakeRoom(size_t bytes);
+    void Evict(Texture& texture);
+    void UploadDirect(Texture& texture, int finestLevel);
+
+    std::vector<std::unique_ptr<Texture>> m_textures;
+    std::unique_ptr<ThreadPool> m_loaders;
+    std::mutex m_loadedMutex;
+    std::vector<std::pair<Handle, std::unique_ptr<TextureFile>>> m_loaded;
+
+    Pbo m_pbos[kPboCount];
+    int m_pboIndex;
+
+    size_t m_residencyBudget;
+    size_t m_uploadBudget;
+    unsigned long long m_frame;
+
+    // Camera state from the last Update, used to size Bind() calls
+    glm::vec3 m_cameraPosition;
+    float m_pixelScale;
+
+    Stats m_stats;
+};
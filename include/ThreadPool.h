@@ -0,0 +1,36 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads draining a FIFO of jobs
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount = 0);  // 0 = hardware concurrency - 1
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> job);
+    // Blocks until every submitted job has finished
+    void Wait();
+
+    size_t GetThreadCount() const { return m_threads.size(); }
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_jobAvailable;
+    std::condition_variable m_idle;
+    size_t m_active;
+    bool m_stopping;
+};
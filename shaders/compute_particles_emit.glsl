@@ -0,0 +1,67 @@
+#version 430 core
+
+// Appends emitCount new particles after the survivors, up to capacity
+layout (local_size_x = 256) in;
+
+struct Particle {
+    vec4 positionLife;
+    vec4 velocityLifetime;
+};
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+
+layout (std430, binding = 1) writeonly buffer Destination { Particle destination[]; };
+layout (std430, binding = 2) buffer Counters {
+    DrawCommand draws[2];
+    uint dispatchX, dispatchY, dispatchZ;
+};
+
+uniform int dst;
+uniform int emitBase;  // Particles emitted before this frame; seeds the random numbers
+uniform int emitCount;
+uniform int capacity;
+uniform vec3 emitterPosition;
+uniform float speed;
+uniform float spread;
+uniform float lifetime;
+
+// Must match ParticleSystem.cpp bit for bit
+uint Hash(uint x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float Random(inout uint state) {
+    state = Hash(state);
+    return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uint(emitCount)) {
+        return;
+    }
+    uint slot = draws[dst].count + index;
+    if (slot >= uint(capacity)) {
+        return;
+    }
+
+    uint state = Hash(uint(emitBase) + index);
+    float theta = 6.2831853 * Random(state);
+    float cosPhi = 1.0 - spread * Random(state);
+    float sinPhi = sqrt(max(1.0 - cosPhi * cosPhi, 0.0));
+    vec3 direction = vec3(cos(theta) * sinPhi, cosPhi, sin(theta) * sinPhi);
+    vec3 velocity = direction * (speed * (0.75 + 0.5 * Random(state)));
+    float life = lifetime * (0.5 + 0.5 * Random(state));
+
+    destination[slot] = Particle(vec4(emitterPosition, life), vec4(velocity, life));
+}
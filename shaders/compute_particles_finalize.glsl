@@ -0,0 +1,31 @@
+#version 430 core
+
+// Single invocation: settles the alive count, writes the draw command and the
+// next update's dispatch size, and empties the buffer that was just consumed
+layout (local_size_x = 1) in;
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+
+layout (std430, binding = 2) buffer Counters {
+    DrawCommand draws[2];
+    uint dispatchX, dispatchY, dispatchZ;
+};
+
+uniform int src;
+uniform int dst;
+uniform int emitCount;
+uniform int capacity;
+
+void main() {
+    uint alive = min(draws[dst].count + uint(emitCount), uint(capacity));
+    draws[dst] = DrawCommand(alive, 1u, 0u, 0u);
+    dispatchX = (alive + 255u) / 256u;
+    dispatchY = 1u;
+    dispatchZ = 1u;
+    draws[src].count = 0u;
+}
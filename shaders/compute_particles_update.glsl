@@ -0,0 +1,49 @@
+#version 430 core
+
+// Integrates live particles and appends the survivors to the other buffer
+layout (local_size_x = 256) in;
+
+struct Particle {
+    vec4 positionLife;
+    vec4 velocityLifetime;
+};
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer Source { Particle source[]; };
+layout (std430, binding = 1) writeonly buffer Destination { Particle destination[]; };
+layout (std430, binding = 2) buffer Counters {
+    DrawCommand draws[2];
+    uint dispatchX, dispatchY, dispatchZ;
+};
+
+uniform int src;
+uniform int dst;
+uniform float deltaTime;
+uniform vec3 gravity;
+uniform float drag;
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= draws[src].count) {
+        return;
+    }
+
+    Particle particle = source[index];
+    float life = particle.positionLife.w - deltaTime;
+    if (life <= 0.0) {
+        return;
+    }
+
+    // Same operation order as ParticleSystem::Simulate
+    vec3 velocity = (particle.velocityLifetime.xyz + gravity * deltaTime) * max(1.0 - drag * deltaTime, 0.0);
+    vec3 position = particle.positionLife.xyz + velocity * deltaTime;
+
+    uint slot = atomicAdd(draws[dst].count, 1u);
+    destination[slot] = Particle(vec4(position, life), vec4(velocity, particle.velocityLifetime.w));
+}
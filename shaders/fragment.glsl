@@ -1,25 +1,73 @@
 #version 410 core
 
+#define MAX_CASCADES 4
+
 in vec3 FragPos;
 in vec3 Normal;
+in vec3 LocalPos;
+in vec3 LocalNormal;
+in vec3 ObjectColor;
+in float ViewDepth;
 
 uniform vec3 lightPos;
 uniform vec3 lightColor;
-uniform vec3 objectColor;
+uniform sampler2D diffuseTexture;
+uniform bool useTexture;
+
+// Cascaded shadow maps (see CascadedShadowMap); no shadows when cascadeCount is 0
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 lightMatrices[MAX_CASCADES];
+uniform float cascadeSplits[MAX_CASCADES];  // Far view distance of each cascade
+uniform float normalOffsets[MAX_CASCADES];  // Receiver offset against acne, about a texel
+uniform int cascadeCount;
 
 out vec4 FragColor;
 
+float ShadowFactor(vec3 norm) {
+    if (cascadeCount == 0 || ViewDepth > cascadeSplits[cascadeCount - 1]) {
+        return 1.0;
+    }
+    int cascade = 0;
+    while (cascade < cascadeCount - 1 && ViewDepth > cascadeSplits[cascade]) {
+        ++cascade;
+    }
+
+    vec3 position = FragPos + norm * normalOffsets[cascade];
+    vec3 coords = (lightMatrices[cascade] * vec4(position, 1.0)).xyz * 0.5 + 0.5;
+    if (any(lessThan(coords, vec3(0.0))) || any(greaterThan(coords, vec3(1.0)))) {
+        return 1.0;
+    }
+
+    // 3x3 PCF on top of the hardware's bilinear comparison
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texel, cascade, coords.z));
+        }
+    }
+    return lit / 9.0;
+}
+
 void main() {
     // Ambient lighting
     float ambientStrength = 0.1;
     vec3 ambient = ambientStrength * lightColor;
     
-    // Diffuse lighting
+    // Diffuse lighting, attenuated by the shadow maps
     vec3 norm = normalize(Normal);
     vec3 lightDir = normalize(lightPos - FragPos);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * lightColor;
+    vec3 diffuse = diff * ShadowFactor(norm) * lightColor;
+    
+    // Box mapping from object space, the meshes carry no texture coordinates
+    vec3 albedo = ObjectColor;
+    if (useTexture) {
+        vec3 axis = abs(LocalNormal);
+        vec2 uv = axis.x > axis.y && axis.x > axis.z ? LocalPos.zy : (axis.y > axis.z ? LocalPos.xz : LocalPos.xy);
+        albedo *= texture(diffuseTexture, uv + 0.5).rgb;
+    }
     
-    vec3 result = (ambient + diffuse) * objectColor;
+    vec3 result = (ambient + diffuse) * albedo;
     FragColor = vec4(result, 1.0);
 }
@@ -0,0 +1,20 @@
+#version 410 core
+
+#define MAX_LAYERS 8
+
+in vec2 TexCoord;
+
+uniform sampler2D layers[MAX_LAYERS];
+uniform int layerCount;
+
+out vec4 FragColor;
+
+void main() {
+    // Layers hold premultiplied color; stack them back to front
+    vec4 result = vec4(0.0);
+    for (int i = 0; i < layerCount; ++i) {
+        vec4 layer = texture(layers[i], TexCoord);
+        result = layer + result * (1.0 - layer.a);
+    }
+    FragColor = result;
+}
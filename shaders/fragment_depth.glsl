@@ -0,0 +1,5 @@
+#version 410 core
+
+// Depth-only pre-pass: color writes are masked off, nothing to output
+void main() {
+}
@@ -0,0 +1,38 @@
+#version 410 core
+
+noperspective in vec2 LineCoord;
+flat in float SegmentLength;
+flat in float HalfWidth;
+flat in float AlphaScale;
+flat in uint Caps;
+in vec4 LineColor;
+
+out vec4 FragColor;
+
+const uint CAP_BUTT = 0u;
+const uint CAP_SQUARE = 1u;
+const uint CAP_ROUND = 2u;
+
+void main() {
+    // Signed distance past the nearest segment end (negative inside the segment)
+    bool nearStart = LineCoord.x < SegmentLength * 0.5;
+    float past = nearStart ? -LineCoord.x : LineCoord.x - SegmentLength;
+    uint cap = nearStart ? (Caps & 3u) : ((Caps >> 2) & 3u);
+    float across = abs(LineCoord.y);
+
+    // Analytic coverage with a one pixel wide ramp
+    float coverage;
+    if (cap == CAP_ROUND) {
+        float dist = length(vec2(max(past, 0.0), across));
+        coverage = clamp(HalfWidth + 0.5 - dist, 0.0, 1.0);
+    } else {
+        float extension = cap == CAP_SQUARE ? HalfWidth : 0.0;
+        coverage = clamp(HalfWidth + 0.5 - across, 0.0, 1.0) * clamp(extension + 0.5 - past, 0.0, 1.0);
+    }
+
+    coverage *= AlphaScale;
+    if (coverage <= 0.0) {
+        discard;
+    }
+    FragColor = vec4(LineColor.rgb, LineColor.a * coverage);
+}
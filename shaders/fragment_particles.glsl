@@ -0,0 +1,15 @@
+#version 410 core
+
+in vec4 Color;
+
+out vec4 FragColor;
+
+void main() {
+    // Round, soft-edged points; blended additively
+    vec2 offset = gl_PointCoord - vec2(0.5);
+    float falloff = 1.0 - 4.0 * dot(offset, offset);
+    if (falloff <= 0.0) {
+        discard;
+    }
+    FragColor = vec4(Color.rgb * Color.a * falloff, 1.0);
+}
@@ -0,0 +1,10 @@
+#version 410 core
+
+flat in uint ObjectID;
+
+// R32UI target; 0 is background
+out uint PickID;
+
+void main() {
+    PickID = ObjectID;
+}
@@ -0,0 +1,23 @@
+#version 410 core
+
+in vec2 TexCoord;
+in vec4 TextColor;
+
+uniform sampler2D atlas;
+uniform float outline;  // Dark halo width in distance units, 0 for none
+
+out vec4 FragColor;
+
+void main() {
+    // 0.5 is the glyph edge; scaling the ramp by the screen-space derivative
+    // keeps it about one pixel wide at any magnification
+    float distance = texture(atlas, TexCoord).r;
+    float width = max(fwidth(distance) * 0.6, 1e-4);
+    float fill = smoothstep(0.5 - width, 0.5 + width, distance);
+    float halo = smoothstep(0.5 - outline - width, 0.5 - outline + width, distance);
+    float alpha = max(fill, halo) * TextColor.a;
+    if (alpha < 0.004) {
+        discard;
+    }
+    FragColor = vec4(TextColor.rgb * fill, alpha);
+}
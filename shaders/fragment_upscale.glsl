@@ -0,0 +1,28 @@
+#version 410 core
+
+in vec2 TexCoord;
+
+uniform sampler2D sceneColor;  // Rendered at a fraction of the output size
+uniform float sharpness;       // 0 plain bilinear, 1 strongest
+
+out vec4 FragColor;
+
+// Bilinear upscale followed by contrast-adaptive sharpening: the neighbours one
+// source texel away are subtracted, less where local contrast is already high
+// so edges do not ring
+void main() {
+    vec2 texel = 1.0 / vec2(textureSize(sceneColor, 0));
+    vec3 center = texture(sceneColor, TexCoord).rgb;
+    vec3 north = texture(sceneColor, TexCoord + vec2(0.0, texel.y)).rgb;
+    vec3 south = texture(sceneColor, TexCoord - vec2(0.0, texel.y)).rgb;
+    vec3 east = texture(sceneColor, TexCoord + vec2(texel.x, 0.0)).rgb;
+    vec3 west = texture(sceneColor, TexCoord - vec2(texel.x, 0.0)).rgb;
+
+    vec3 low = min(center, min(min(north, south), min(east, west)));
+    vec3 high = max(center, max(max(north, south), max(east, west)));
+    vec3 amount = sqrt(clamp(min(low, 1.0 - high) / max(high, vec3(1e-4)), 0.0, 1.0));
+    vec3 weight = amount * (-0.2 * sharpness);
+
+    vec3 result = (center + (north + south + east + west) * weight) / (1.0 + 4.0 * weight);
+    FragColor = vec4(clamp(result, 0.0, 1.0), 1.0);
+}
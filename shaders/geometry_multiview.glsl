@@ -0,0 +1,40 @@
+#version 410 core
+
+// Routes each triangle to its view's viewport and drops the ones culled for it
+layout (triangles) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+in vec3 vFragPos[];
+in vec3 vNormal[];
+in vec3 vLocalPos[];
+in vec3 vLocalNormal[];
+in vec3 vObjectColor[];
+in float vViewDepth[];
+flat in int vView[];
+flat in uint vVisible[];
+
+// What fragment.glsl reads
+out vec3 FragPos;
+out vec3 Normal;
+out vec3 LocalPos;
+out vec3 LocalNormal;
+out vec3 ObjectColor;
+out float ViewDepth;
+
+void main() {
+    if (vVisible[0] == 0u) {
+        return;
+    }
+    for (int i = 0; i < 3; ++i) {
+        gl_Position = gl_in[i].gl_Position;
+        gl_ViewportIndex = vView[0];
+        FragPos = vFragPos[i];
+        Normal = vNormal[i];
+        LocalPos = vLocalPos[i];
+        LocalNormal = vLocalNormal[i];
+        ObjectColor = vObjectColor[i];
+        ViewDepth = vViewDepth[i];
+        EmitVertex();
+    }
+    EndPrimitive();
+}
@@ -6,13 +6,26 @@ layout (location = 1) in vec3 aNormal;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform vec3 objectColor;
 
 out vec3 FragPos;
 out vec3 Normal;
+out vec3 LocalPos;
+out vec3 LocalNormal;
+out vec3 ObjectColor;
+out float ViewDepth;  // Selects the shadow cascade
+
+// Shared with vertex_depth.glsl so pre-pass depth matches exactly
+invariant gl_Position;
 
 void main() {
     FragPos = vec3(model * vec4(aPos, 1.0));
     Normal = mat3(transpose(inverse(model))) * aNormal;
+    LocalPos = aPos;
+    LocalNormal = aNormal;
+    ObjectColor = objectColor;
+    
+    ViewDepth = -(view * vec4(FragPos, 1.0)).z;
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
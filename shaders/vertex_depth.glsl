@@ -0,0 +1,15 @@
+#version 410 core
+
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// Must match vertex.glsl exactly so the shading pass can test with GL_LEQUAL
+invariant gl_Position;
+
+void main() {
+    vec3 FragPos = vec3(model * vec4(aPos, 1.0));
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,31 @@
+#version 410 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec3 aColor;
+layout (location = 3) in mat4 aModel;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec3 LocalPos;
+out vec3 LocalNormal;
+out vec3 ObjectColor;
+out float ViewDepth;  // Selects the shadow cascade
+
+// Shared with vertex_depth_instanced.glsl so pre-pass depth matches exactly
+invariant gl_Position;
+
+void main() {
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(aModel))) * aNormal;
+    LocalPos = aPos;
+    LocalNormal = aNormal;
+    ObjectColor = aColor;
+    
+    ViewDepth = -(view * vec4(FragPos, 1.0)).z;
+    
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
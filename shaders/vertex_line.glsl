@@ -0,0 +1,73 @@
+#version 410 core
+
+// Quad corner: x selects the segment end (0 = start, 1 = end), y the side (-1/1)
+layout (location = 0) in vec2 aCorner;
+
+// Per-instance segment record
+layout (location = 1) in vec3 aStart;
+layout (location = 2) in vec3 aEnd;
+layout (location = 3) in vec4 aStartColor;
+layout (location = 4) in vec4 aEndColor;
+layout (location = 5) in float aWidth;
+layout (location = 6) in uint aCaps;
+
+uniform mat4 transform;
+uniform vec2 viewportSize;
+
+noperspective out vec2 LineCoord;  // Pixels along / across the segment
+flat out float SegmentLength;
+flat out float HalfWidth;
+flat out float AlphaScale;
+flat out uint Caps;
+out vec4 LineColor;
+
+const uint CAP_BUTT = 0u;
+
+void main() {
+    vec4 clipStart = transform * vec4(aStart, 1.0);
+    vec4 clipEnd = transform * vec4(aEnd, 1.0);
+
+    // Clip against the near plane before the perspective divide
+    const float nearW = 1e-5;
+    if (clipStart.w < nearW && clipEnd.w < nearW) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+    if (clipStart.w < nearW) {
+        clipStart = mix(clipStart, clipEnd, (nearW - clipStart.w) / (clipEnd.w - clipStart.w));
+    } else if (clipEnd.w < nearW) {
+        clipEnd = mix(clipEnd, clipStart, (nearW - clipEnd.w) / (clipStart.w - clipEnd.w));
+    }
+
+    vec3 ndcStart = clipStart.xyz / clipStart.w;
+    vec3 ndcEnd = clipEnd.xyz / clipEnd.w;
+    vec2 screenStart = (ndcStart.xy * 0.5 + 0.5) * viewportSize;
+    vec2 screenEnd = (ndcEnd.xy * 0.5 + 0.5) * viewportSize;
+
+    vec2 delta = screenEnd - screenStart;
+    float len = length(delta);
+    vec2 dir = len > 1e-4 ? delta / len : vec2(1.0, 0.0);
+    vec2 normal = vec2(-dir.y, dir.x);
+
+    // Sub-pixel widths are drawn one pixel wide and faded instead
+    float width = max(aWidth, 1.0);
+    float halfWidth = width * 0.5;
+    uint cap = aCorner.x < 0.5 ? (aCaps & 3u) : ((aCaps >> 2) & 3u);
+
+    // Grow the quad by one pixel for the anti-aliased fringe
+    float across = halfWidth + 1.0;
+    float along = (cap == CAP_BUTT ? 0.0 : halfWidth) + 1.0;
+
+    vec2 base = aCorner.x < 0.5 ? screenStart - dir * along : screenEnd + dir * along;
+    vec2 screen = base + normal * aCorner.y * across;
+
+    LineCoord = vec2(aCorner.x < 0.5 ? -along : len + along, aCorner.y * across);
+    SegmentLength = len;
+    HalfWidth = halfWidth;
+    AlphaScale = min(aWidth, 1.0);
+    Caps = aCaps;
+    LineColor = mix(aStartColor, aEndColor, aCorner.x);
+
+    float depth = mix(ndcStart.z, ndcEnd.z, aCorner.x);
+    gl_Position = vec4(screen / viewportSize * 2.0 - 1.0, depth, 1.0);
+}
@@ -0,0 +1,42 @@
+#version 410 core
+
+#define MAX_VIEWS 16
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec3 aColor;
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in uint aViewMask;  // Bit per view that sees the object
+
+// One camera per viewport (see MultiViewRenderer)
+layout (std140) uniform Views {
+    mat4 views[MAX_VIEWS];
+    mat4 projections[MAX_VIEWS];
+};
+uniform int viewCount;
+
+out vec3 vFragPos;
+out vec3 vNormal;
+out vec3 vLocalPos;
+out vec3 vLocalNormal;
+out vec3 vObjectColor;
+out float vViewDepth;
+flat out int vView;
+flat out uint vVisible;
+
+void main() {
+    // Instance attributes advance once per viewCount instances, one instance per view
+    int view = gl_InstanceID % viewCount;
+    vView = view;
+    vVisible = (aViewMask >> uint(view)) & 1u;
+
+    vFragPos = vec3(aModel * vec4(aPos, 1.0));
+    vNormal = mat3(transpose(inverse(aModel))) * aNormal;
+    vLocalPos = aPos;
+    vLocalNormal = aNormal;
+    vObjectColor = aColor;
+
+    vViewDepth = -(views[view] * vec4(vFragPos, 1.0)).z;
+
+    gl_Position = projections[view] * views[view] * vec4(vFragPos, 1.0);
+}
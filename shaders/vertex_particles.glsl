@@ -0,0 +1,20 @@
+#version 410 core
+
+layout (location = 0) in vec4 aPositionLife;
+layout (location = 1) in vec4 aVelocityLifetime;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float pointSize;  // Pixels at one unit of distance
+
+out vec4 Color;
+
+void main() {
+    vec4 viewPos = view * vec4(aPositionLife.xyz, 1.0);
+    gl_Position = projection * viewPos;
+    gl_PointSize = clamp(pointSize / max(-viewPos.z, 0.001), 1.0, 16.0);
+
+    // Hot and bright when young, fading to dim red
+    float age = 1.0 - aPositionLife.w / aVelocityLifetime.w;
+    Color = vec4(mix(vec3(1.0, 0.85, 0.4), vec3(0.8, 0.15, 0.05), age), 1.0 - age);
+}
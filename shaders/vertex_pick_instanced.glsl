@@ -0,0 +1,14 @@
+#version 410 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec3 aColor;  // Object ID + 1 in x (see ObjectPicker)
+layout (location = 3) in mat4 aModel;
+
+uniform mat4 viewProjection;
+
+flat out uint ObjectID;
+
+void main() {
+    ObjectID = uint(aColor.x);
+    gl_Position = viewProjection * aModel * vec4(aPos, 1.0);
+}
@@ -0,0 +1,41 @@
+#version 410 core
+
+// Per glyph quad; TextRenderer::GlyphInstance
+layout (location = 0) in uint aLabel;     // Label index, TextSpace in the top two bits
+layout (location = 1) in vec4 aRect;      // Offset from the anchor and size, in line heights
+layout (location = 2) in vec4 aTexRect;   // Atlas rectangle
+
+uniform samplerBuffer labels;  // Two texels per label: position + size, color
+uniform mat4 viewProjection;
+uniform vec3 cameraRight;
+uniform vec3 cameraUp;
+uniform vec2 viewport;
+
+out vec2 TexCoord;
+out vec4 TextColor;
+
+void main() {
+    // Triangle strip corner from the vertex index
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    int label = int(aLabel & 0x3FFFFFFFu);
+    uint space = aLabel >> 30;
+    vec4 anchor = texelFetch(labels, label * 2);
+    TextColor = texelFetch(labels, label * 2 + 1);
+    TexCoord = mix(aTexRect.xy, aTexRect.zw, corner);
+
+    // Layout runs right and down from the anchor
+    vec2 offset = (aRect.xy + corner * aRect.zw) * anchor.w;
+    if (space == 0u) {
+        // Screen: whole-pixel anchors keep small text sharp
+        vec2 pixel = floor(anchor.xy + 0.5) + offset;
+        gl_Position = vec4(pixel.x / viewport.x * 2.0 - 1.0, 1.0 - pixel.y / viewport.y * 2.0, 0.0, 1.0);
+    } else if (space == 1u) {
+        // Billboard: pixel offsets applied after projection
+        gl_Position = viewProjection * vec4(anchor.xyz, 1.0);
+        gl_Position.xy += vec2(offset.x, -offset.y) * 2.0 / viewport * gl_Position.w;
+    } else {
+        // World: camera-facing quad sized in world units
+        vec3 position = anchor.xyz + cameraRight * offset.x - cameraUp * offset.y;
+        gl_Position = viewProjection * vec4(position, 1.0);
+    }
+}
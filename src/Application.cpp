@@ -2,21 +2,66 @@
 #include "Renderer.h"
 #include "Shader.h"
 #include "Camera.h"
+#include "OcclusionCuller.h"
+#include "FrameCache.h"
+#include "FrameGraph.h"
+#include "OverlayCompositor.h"
+#include "PolylineCache.h"
+#include "TextureStreamer.h"
+#include "GLCapture.h"
+#include "FrameRecorder.h"
+#include "ParticleSystem.h"
+#include "TextRenderer.h"
+#include "CascadedShadowMap.h"
+#include "ObjectPicker.h"
+#include "MultiViewRenderer.h"
+#include "DynamicResolution.h"
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <filesystem>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+namespace {
+// Point light for diffuse shading; shadows come from a directional light through it towards the origin
+const glm::vec3 kLightPosition(1.2f, 1.0f, 2.0f);
+}
+
 Application::Application(int width, int height, const char* title)
-    : m_window(nullptr), m_width(width), m_height(height), m_title(title), m_shouldClose(false), m_time(0.0f),
-      m_firstMouse(true), m_rightMousePressed(false), m_lastX(width / 2.0f), m_lastY(height / 2.0f), m_cameraSpeed(2.5f) {
+    : m_window(nullptr), m_width(width), m_height(height), m_title(title), m_hudLayer(-1), m_spinnerLayer(-1), m_captureFrames(0),
+      m_recordPath("recording.y4m"), m_recordOnStart(false),
+      m_rotatingCube(SceneGraph::kNone), m_swarm(SceneGraph::kNone),
+      m_labelsEnabled(false), m_hudLabel(-1), m_shadowsEnabled(false), m_casterSceneCount(0),
+      m_pickRequested(false), m_pickX(0), m_pickY(0), m_cursorX(0.0), m_cursorY(0.0), m_selected(SceneGraph::kNone), m_selectedColor(0.0f),
+      m_multiViewCount(0), m_benchOnStart(false), m_benchViews(0), m_benchFrame(0), m_benchCullMs(0.0), m_benchSubmitMs(0.0), m_benchGpuMs(0.0),
+      m_dynamicResolutionEnabled(false),
+      m_particlesVerified(false), m_frameDelta(0.0f), m_depthPrepass(false), m_statsTimer(0.0f), m_statsCpuClock(0),
+      m_sceneVersion(0), m_sceneAnimating(true), m_overlayAnimating(true), m_overlayTime(0.0f),
+      m_shouldClose(false), m_time(0.0f), m_firstMouse(true), m_rightMousePressed(false), m_lastX(width / 2.0f), m_lastY(height / 2.0f), m_cameraSpeed(2.5f) {
 }
 
 Application::~Application() {
     Shutdown();
 }
 
+void Application::SetCapture(const std::string& path, int frameCount) {
+    m_capturePath = path;
+    m_captureFrames = frameCount;
+}
+
+void Application::SetDynamicResolution(bool enabled, const DynamicResolution::Settings& settings) {
+    m_dynamicResolutionEnabled = enabled;
+    m_dynamicResolutionSettings = settings;
+}
+
+void Application::SetRecordPath(const std::string& path) {
+    m_recordPath = path;
+    m_recordOnStart = true;
+}
+
 bool Application::Initialize() {
     // Set GLFW error callback
     glfwSetErrorCallback(ErrorCallback);
@@ -27,15 +72,19 @@ bool Application::Initialize() {
         return false;
     }
 
-    // Configure GLFW for OpenGL 4.5 Core Profile
+    // Configure GLFW for OpenGL 4.5 Core Profile (compute particles need 4.3)
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
 
-    // Create window
+    // Create window; macOS stops at 4.1, so fall back to it
     m_window = glfwCreateWindow(m_width, m_height, m_title, nullptr, nullptr);
+    if (!m_window) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+        m_window = glfwCreateWindow(m_width, m_height, m_title, nullptr, nullptr);
+    }
     if (!m_window) {
         std::cerr << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -50,6 +99,8 @@ bool Application::Initialize() {
     glfwSetFramebufferSizeCallback(m_window, FramebufferSizeCallback);
     glfwSetCursorPosCallback(m_window, MouseCallback);
     glfwSetMouseButtonCallback(m_window, MouseButtonCallback);
+    glfwSetKeyCallback(m_window, KeyCallback);
+    glfwSetWindowRefreshCallback(m_window, WindowRefreshCallback);
     
     // Keep cursor visible by default (Unity-style)
 
@@ -59,6 +110,14 @@ bool Application::Initialize() {
         return false;
     }
 
+    // Capture starts before any GL object exists so the replay can rebuild them
+    if (!m_capturePath.empty()) {
+        m_capture = std::make_unique<GLCapture>();
+        if (!m_capture->Begin(m_capturePath, m_captureFrames, m_width, m_height)) {
+            m_capture.reset();
+        }
+    }
+
     // Print OpenGL information
     std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
     std::cout << "GLSL Version: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << std::endl;
@@ -77,15 +136,111 @@ bool Application::Initialize() {
         std::cerr << "Failed to initialize renderer" << std::endl;
         return false;
     }
+    m_renderer->Resize(m_width, m_height);
 
     // Load shaders
     m_shader = std::make_unique<Shader>("shaders/vertex.glsl", "shaders/fragment.glsl");
     m_shader2D = std::make_unique<Shader>("shaders/vertex_2d.glsl", "shaders/fragment_2d.glsl");
+    m_depthShader = std::make_unique<Shader>("shaders/vertex_depth.glsl", "shaders/fragment_depth.glsl");
+    m_instancedShader = std::make_unique<Shader>("shaders/vertex_instanced.glsl", "shaders/fragment.glsl");
+    m_instancedDepthShader = std::make_unique<Shader>("shaders/vertex_depth_instanced.glsl", "shaders/fragment_depth.glsl");
 
     // Initialize camera
     m_camera = std::make_unique<Camera>(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f);
     m_camera->SetAspectRatio((float)m_width / (float)m_height);
 
+    // Hierarchical-Z occlusion culling (toggled with F2)
+    m_occlusionCuller = std::make_unique<OcclusionCuller>();
+    m_occlusionCuller->Initialize(m_width, m_height);
+    m_occlusionCuller->SetEnabled(false);
+
+    // Damage-tracking frame cache (toggled with F3)
+    m_frameCache = std::make_unique<FrameCache>();
+    if (!m_frameCache->Initialize(m_width, m_height)) {
+        std::cerr << "Failed to initialize frame cache" << std::endl;
+        return false;
+    }
+
+    // Pass scheduling for the frame (dumped with F5)
+    m_frameGraph = std::make_unique<FrameGraph>();
+
+    // Retained 2D overlay layers
+    m_overlay = std::make_unique<OverlayCompositor>();
+    if (!m_overlay->Initialize(m_width, m_height)) {
+        std::cerr << "Failed to initialize overlay compositor" << std::endl;
+        return false;
+    }
+
+    // Distance-field text; the atlas is generated on first run and cached
+    m_text = std::make_unique<TextRenderer>();
+    if (!m_text->Initialize("text_atlas.cache")) {
+        std::cerr << "Failed to initialize text renderer" << std::endl;
+        return false;
+    }
+
+    // Cascaded shadow maps; the scene shaders sample them from texture unit 1
+    m_shadows = std::make_unique<CascadedShadowMap>();
+    if (m_shadows->Initialize(2048, CascadedShadowMap::kMaxCascades)) {
+        m_shadows->SetLightDirection(-kLightPosition);
+        m_shadowsEnabled = true;
+    } else {
+        m_shadows.reset();
+    }
+    for (Shader* shader : { m_shader.get(), m_instancedShader.get() }) {
+        shader->Use();
+        shader->SetInt("shadowMap", 1);
+        shader->SetInt("cascadeCount", 0);
+    }
+
+    // Click-to-select; without it left clicks do nothing
+    m_picker = std::make_unique<ObjectPicker>();
+    if (!m_picker->Initialize()) {
+        m_picker.reset();
+    }
+
+    // Scene resolution driven by GPU frame time (R)
+    m_dynamicResolution = std::make_unique<DynamicResolution>();
+    if (m_dynamicResolution->Initialize(m_width, m_height)) {
+        m_dynamicResolution->SetSettings(m_dynamicResolutionSettings);
+        ApplyRenderSize();
+    } else {
+        m_dynamicResolution.reset();
+        m_dynamicResolutionEnabled = false;
+    }
+
+    // Several cameras in one pass (F12); needs 16 viewports and geometry shaders
+    m_multiView = std::make_unique<MultiViewRenderer>();
+    if (!m_multiView->Initialize()) {
+        m_multiView.reset();
+    }
+
+    // Background texture loading and mip streaming
+    m_textureStreamer = std::make_unique<TextureStreamer>();
+    m_textureStreamer->Initialize();
+
+    SetupTestScene();
+    SetupTextures();
+    SetupOverlay();
+
+    // Asynchronous framebuffer recording (toggled with F7)
+    m_recorder = std::make_unique<FrameRecorder>();
+    if (m_recordOnStart) {
+        m_recorder->Start(m_recordPath, m_width, m_height);
+    }
+
+    // The sweep runs on the swarm so there is enough to cull and draw
+    if (m_benchOnStart && m_multiView) {
+        if (m_swarm == SceneGraph::kNone) {
+            SetupSwarm();
+        }
+        std::cout << "Multi-view bench: " << m_scene->GetCount() << " nodes, 30 warm-up + 120 measured frames per row" << std::endl;
+        std::cout << "views | mode        | draws | view instances | cull ms | submit ms | GPU ms" << std::endl;
+        m_benchViews = 1;
+        m_benchFrame = 0;
+        m_multiView->SetMode(MultiViewRenderer::Mode::SingleDraw);
+        ConfigureMultiView(1);
+    }
+
     return true;
 }
 
@@ -98,6 +253,10 @@ void Application::Run() {
         float deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
         lastTime = currentTime;
 
+        if (m_capture) {
+            m_capture->BeginFrame(m_time, deltaTime);
+        }
+
         // Process input
         ProcessInput();
 
@@ -105,11 +264,26 @@ void Application::Run() {
         Update(deltaTime);
 
         // Render
-        Render();
+        bool presented = Render();
+        m_renderer->EndFrame();
 
         // Swap buffers and poll events
-        glfwSwapBuffers(m_window);
-        glfwPollEvents();
+        if (presented) {
+            glfwSwapBuffers(m_window);
+        }
+        if (m_capture) {
+            m_capture->EndFrame();
+        }
+
+        // Idle frames block until input arrives instead of spinning. Keep polling
+        // while the camera is being dragged so held WASD keys move it smoothly.
+        if (!presented && !m_rightMousePressed) {
+            auto waitStart = std::chrono::high_resolution_clock::now();
+            glfwWaitEventsTimeout(0.25);
+            m_frameCache->RecordIdle(std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - waitStart).count());
+        } else {
+            glfwPollEvents();
+        }
     }
 }
 
@@ -146,66 +320,913 @@ void Application::ProcessInput() {
 }
 
 void Application::Update(float deltaTime) {
-    m_time += deltaTime;
+    m_frameDelta = m_sceneAnimating ? deltaTime : 0.0f;
+    if (m_sceneAnimating) {
+        m_time += deltaTime;
+    }
+    if (m_particles && m_sceneAnimating) {
+        ++m_sceneVersion;
+    }
+    if (m_overlayAnimating) {
+        m_overlayTime += deltaTime;
+    }
+
+    // Finish background loads and stream mip levels; new detail is a scene change
+    m_textureStreamer->Update(*m_camera, m_height);
+    if (m_textureStreamer->GetStats().levelsUploaded > 0) {
+        ++m_sceneVersion;
+    }
+
+    if (m_benchViews > 0) {
+        StepMultiViewBench();
+    }
+
+    // New frame times may move the scene resolution
+    const FrameGraph::FrameTiming& frameTiming = m_frameGraph->GetFrameTiming();
+    if (m_dynamicResolution && frameTiming.valid && m_dynamicResolution->Update(frameTiming.frame, frameTiming.gpuMs)) {
+        const DynamicResolution::Stats& stats = m_dynamicResolution->GetStats();
+        std::cout << "Resolution scale " << m_dynamicResolution->GetScale() << " (" << m_dynamicResolution->GetWidth()
+                  << "x" << m_dynamicResolution->GetHeight() << "): GPU frame " << stats.changeGpuMs << " ms, target "
+                  << m_dynamicResolution->GetSettings().targetMs << " ms" << std::endl;
+        ApplyRenderSize();
+    }
+
+    // Collect finished pick readbacks; keep frames coming until they are all in
+    if (m_picker) {
+        m_pickResults.clear();
+        m_picker->Update(m_pickResults);
+        for (const PickResult& result : m_pickResults) {
+            bool hit = result.id != PickResult::kNoHit;
+            std::cout << "Pick (GPU): " << (hit ? "node " + std::to_string(result.id) : std::string("nothing"))
+                      << " after " << result.latencyFrames << " frames, " << result.latencyMs << " ms"
+                      << " | " << m_picker->GetStats().gpuCandidates << " candidates drawn"
+                      << " | CPU " << (result.id == m_cpuPick.id ? "agrees" : "differs") << std::endl;
+            SelectNode(hit ? result.id : SceneGraph::kNone);
+        }
+        if (m_picker->IsPending()) {
+            m_frameCache->RequestPresent();
+        }
+    }
+
+    // Hand finished readbacks to the encoder; a recording needs every frame presented
+    m_recorder->Update();
+    if (m_recorder->IsRecording()) {
+        m_frameCache->RequestPresent();
+    }
+
+    // Report culling counters once per second while either feature is on
+    m_statsTimer += deltaTime;
+    if (m_statsTimer >= 1.0f) {
+        m_statsTimer = 0.0f;
+        if (m_depthPrepass || m_occlusionCuller->IsEnabled()) {
+            const OcclusionStats& stats = m_occlusionCuller->GetStats();
+            std::cout << "Occlusion: culled " << stats.objectsCulled << "/" << stats.objectsTested << " objects"
+                      << " | fragments shaded " << stats.fragmentsShaded
+                      << " | saved by pre-pass " << stats.fragmentsSaved << std::endl;
+        }
+
+        if (m_swarm != SceneGraph::kNone) {
+            const SceneGraph::Stats& stats = m_scene->GetStats();
+            std::cout << "Scene: " << stats.nodes << " nodes in " << stats.levels << " levels"
+                      << " | updated " << stats.updated << " in " << stats.updateMs << " ms"
+                      << " (" << stats.batches << " worker batches)"
+                      << " | drawn " << m_visibleInstanced.size() + m_visibleTextured.size() << std::endl;
+        }
+
+        if (m_multiViewCount > 0 && m_benchViews == 0) {
+            const MultiViewRenderer::Stats& stats = m_multiView->GetStats();
+            bool single = m_multiView->GetMode() == MultiViewRenderer::Mode::SingleDraw;
+            auto timing = m_frameGraph->GetTimings().find("MultiView");
+            std::cout << "Multi-view: " << stats.views << " views, " << (single ? "single draw" : "draw per view")
+                      << " | culled once in " << stats.cullMs << " ms (outside all views " << stats.unionCulled
+                      << " of " << stats.objects << ", visible " << stats.visible << ", view instances " << stats.viewInstances << ")"
+                      << " | submit " << stats.submitMs << " ms, " << stats.draws << " draws";
+            if (timing != m_frameGraph->GetTimings().end()) {
+                std::cout << " | GPU " << timing->second.gpuMs << " ms";
+            }
+            std::cout << std::endl;
+        }
+
+        if (m_dynamicResolutionEnabled) {
+            const DynamicResolution::Stats& stats = m_dynamicResolution->GetStats();
+            auto timing = m_frameGraph->GetTimings().find("Upscale");
+            std::cout << "Resolution: scale " << m_dynamicResolution->GetScale() << " (" << m_dynamicResolution->GetWidth()
+                      << "x" << m_dynamicResolution->GetHeight() << ") | GPU frame " << stats.gpuMs << " ms"
+                      << " (target " << m_dynamicResolution->GetSettings().targetMs << " ms)"
+                      << " | changes " << stats.changes;
+            if (timing != m_frameGraph->GetTimings().end()) {
+                std::cout << " | upscale " << timing->second.gpuMs << " ms GPU";
+            }
+            std::cout << std::endl;
+        }
+
+        if (m_particles) {
+            const ParticleSystem::Stats& stats = m_particles->GetStats();
+            auto timing = m_frameGraph->GetTimings().find("Particles");
+            bool gpu = m_particles->GetBackend() == ParticleBackend::GPU;
+            std::cout << "Particles (" << (gpu ? "GPU" : "CPU") << "): " << stats.alive << "/" << stats.capacity << " alive"
+                      << " | update " << stats.updateMs << " ms CPU";
+            if (timing != m_frameGraph->GetTimings().end()) {
+                std::cout << ", " << timing->second.gpuMs << " ms GPU";
+            }
+            std::cout << std::endl;
+        }
+
+        if (m_shadowsEnabled) {
+            const CascadedShadowMap::Stats& stats = m_shadows->GetStats();
+            std::cout << "Shadows:";
+            for (int cascade = 0; cascade < stats.cascades; ++cascade) {
+                std::cout << (cascade == 0 ? " " : " | ") << "cascade " << cascade << " (to " << stats.splits[cascade] << ") ";
+                if (stats.work[cascade] == CascadedShadowMap::CascadeWork::Skip) {
+                    std::cout << "cached";
+                    continue;
+                }
+                bool full = stats.work[cascade] == CascadedShadowMap::CascadeWork::Full;
+                std::cout << (full ? "static " + std::to_string(stats.staticCasters[cascade]) + " + " : std::string())
+                          << "dynamic " << stats.dynamicCasters[cascade];
+                auto timing = m_frameGraph->GetTimings().find("Shadow" + std::to_string(cascade));
+                if (timing != m_frameGraph->GetTimings().end()) {
+                    std::cout << ", " << timing->second.cpuMs << " ms CPU, " << timing->second.gpuMs << " ms GPU";
+                }
+            }
+            std::cout << " | skipped " << stats.skipped << " cascade updates"
+                      << " | static re-renders " << stats.staticRenders << std::endl;
+            m_shadows->ResetCounters();
+        }
+
+        if (m_labelsEnabled) {
+            const TextRenderer::Stats& stats = m_text->GetStats();
+            std::cout << "Text: " << stats.labels << " labels, " << stats.glyphs << " glyphs in " << stats.draws << " draws"
+                      << " | layouts cached " << stats.cachedLayouts << " (hits " << stats.layoutHits
+                      << ", misses " << stats.layoutMisses << ")"
+                      << " | rebuilds " << stats.rebuilds << " (last " << stats.rebuildMs << " ms)"
+                      << ", in place " << stats.patches << std::endl;
+
+            std::string hud = "Labels " + std::to_string(stats.labels) + "  glyphs " + std::to_string(stats.glyphs)
+                + "  draws " + std::to_string(stats.draws);
+            m_text->SetLabelText(m_hudLabel, hud);
+            m_text->ResetCounters();
+        }
+
+        if (m_trace) {
+            const PolylineCache::Stats& stats = m_trace->GetStats();
+            std::cout << "Trace: " << stats.sourceVertices << " samples -> " << stats.outputVertices
+                      << " vertices (level " << stats.level << ")" << std::endl;
+        }
+
+        const TextureStreamer::Stats& textureStats = m_textureStreamer->GetStats();
+        if (textureStats.textures > 0) {
+            std::cout << "Textures: " << textureStats.textures << " (" << textureStats.pendingLoads << " loading)"
+                      << " | resident " << textureStats.residentBytes / 1024 << " KiB"
+                      << " | evictions " << textureStats.evictions
+                      << " | stalled uploads " << textureStats.stalledFrames << std::endl;
+        }
+        m_textureStreamer->ResetCounters();
+
+        if (m_recorder->IsRecording()) {
+            FrameRecorder::Stats stats = m_recorder->GetStats();
+            std::cout << "Recording: " << stats.written << "/" << stats.captured << " frames written"
+                      << " | queued " << stats.queuedFrames
+                      << " | dropped busy " << stats.droppedBusy << ", queue " << stats.droppedQueue
+                      << ", size " << stats.droppedSize
+                      << " | latency avg " << stats.averageLatencyMs << " ms, max " << stats.maxLatencyMs << " ms" << std::endl;
+        }
+
+        std::clock_t cpuClock = std::clock();
+        double cpuSeconds = static_cast<double>(cpuClock - m_statsCpuClock) / CLOCKS_PER_SEC;
+        m_statsCpuClock = cpuClock;
+        if (m_frameCache->IsEnabled()) {
+            const FrameCacheStats& stats = m_frameCache->GetStats();
+            std::cout << "Frame cache: full " << stats.framesFull << " | overlay " << stats.framesOverlay
+                      << " | skipped " << stats.framesSkipped << " | idle " << stats.idleSeconds << "s"
+                      << " | CPU " << (cpuSeconds * 100.0) << "%"
+                      << " | est. CPU saved " << stats.EstimatedCpuSavedMs() << " ms" << std::endl;
+        }
+        m_frameCache->ResetCounters();
+    }
 }
 
-void Application::Render() {
-    // Clear the screen
-    m_renderer->Clear(0.1f, 0.1f, 0.15f, 1.0f);
+DamageState Application::GetDamageState() const {
+    DamageState state;
+    state.cameraVersion = m_camera->GetVersion();
+    state.sceneVersion = m_sceneVersion;
+    state.overlayVersion = m_overlay->GetVersion() + m_text->GetVersion();
+    state.sceneAnimating = m_sceneAnimating;
+    state.overlayAnimating = m_overlayAnimating;
+    return state;
+}
+
+bool Application::Render() {
+    auto start = std::chrono::high_resolution_clock::now();
+    DamageState damage = GetDamageState();
+    FrameAction action = m_frameCache->Decide(damage);
+
+    if (action == FrameAction::Skip) {
+        m_frameCache->RecordFrame(action, 0.0);
+        return false;
+    }
+
+    // Declare this frame's passes; the graph binds each pass target and times it
+    bool cached = m_frameCache->IsEnabled();
+    m_frameGraph->Reset();
+    FrameGraph::Handle backbuffer = m_frameGraph->ImportFramebuffer("Backbuffer", 0, m_width, m_height);
+    FrameGraph::Handle sceneTarget = cached
+        ? m_frameGraph->ImportFramebuffer("FrameCache", m_frameCache->GetFramebuffer(), m_width, m_height)
+        : backbuffer;
+
+    // Multi-view lays its viewports out at full size, so it is never scaled
+    bool scaled = m_dynamicResolutionEnabled && action == FrameAction::Full && m_multiViewCount == 0;
+    FrameGraph::Handle scaledColor = -1;
+
+    // Simulation only touches its own buffers; drawn inside the scene pass
+    if (m_particles) {
+        m_frameGraph->AddPass("Particles",
+            [&](FrameGraph::Builder& builder) {
+                builder.SetSideEffect();
+            },
+            [&](const FrameGraph::Resources&) {
+                m_particles->Update(m_frameDelta);
+            });
+    }
+
+    if (action == FrameAction::Full) {
+        UpdateScene();
+
+        if (m_multiViewCount > 0) {
+            m_frameGraph->AddPass("MultiView",
+                [&](FrameGraph::Builder& builder) {
+                    builder.Write(sceneTarget);
+                },
+                [&](const FrameGraph::Resources&) {
+                    m_renderer->Clear(0.1f, 0.1f, 0.15f, 1.0f);
+                    RenderMultiView();
+                    if (cached) {
+                        m_frameCache->EndScene(damage);
+                    }
+                });
+        } else {
+            // One pass per cascade with work to do, so each is timed on its own
+            if (m_shadowsEnabled) {
+                PrepareShadows();
+                for (int cascade = 0; cascade < m_shadows->GetCascadeCount(); ++cascade) {
+                    if (m_shadows->GetWork(cascade) == CascadedShadowMap::CascadeWork::Skip) {
+                        continue;
+                    }
+                    m_frameGraph->AddPass("Shadow" + std::to_string(cascade),
+                        [&](FrameGraph::Builder& builder) {
+                            builder.SetSideEffect();
+                        },
+                        [this, cascade](const FrameGraph::Resources&) {
+                            m_shadows->RenderCascade(cascade, *m_renderer, *m_instancedDepthShader,
+                                                     m_scene->GetWorldMatrices().data(), m_scene->GetColors().data());
+                        });
+                }
+            }
+
+            if (scaled) {
+                // Smaller transient targets, then sharpened up into the full-size scene target
+                m_frameGraph->AddPass("Scene",
+                    [&](FrameGraph::Builder& builder) {
+                        int width = m_dynamicResolution->GetWidth();
+                        int height = m_dynamicResolution->GetHeight();
+                        scaledColor = builder.Write(builder.Create("ScaledColor", { width, height, GL_RGBA8 }));
+                        builder.Write(builder.Create("ScaledDepth", { width, height, GL_DEPTH_COMPONENT24, true }));
+                    },
+                    [&](const FrameGraph::Resources&) {
+                        m_renderer->Clear(0.1f, 0.1f, 0.15f, 1.0f);
+                        RenderTestScene();
+                    });
+                m_frameGraph->AddPass("Upscale",
+                    [&](FrameGraph::Builder& builder) {
+                        builder.Read(scaledColor);
+                        builder.Write(sceneTarget);
+                    },
+                    [&](const FrameGraph::Resources& resources) {
+                        m_dynamicResolution->Upscale(resources.GetTexture(scaledColor));
+                        if (cached) {
+                            m_frameCache->EndScene(damage);
+                        }
+                    });
+            } else {
+                m_frameGraph->AddPass("Scene",
+                    [&](FrameGraph::Builder& builder) {
+                        builder.Write(sceneTarget);
+                    },
+                    [&](const FrameGraph::Resources&) {
+                        // Clear the screen
+                        m_renderer->Clear(0.1f, 0.1f, 0.15f, 1.0f);
+
+                        RenderTestScene();
+
+                        if (cached) {
+                            m_frameCache->EndScene(damage);
+                        }
+                    });
+            }
+        }
+    }
+
+    if (cached) {
+        m_frameGraph->AddPass("Present",
+            [&](FrameGraph::Builder& builder) {
+                builder.Read(sceneTarget, FrameGraphAccess::Copy);
+                builder.Write(backbuffer, FrameGraphAccess::Copy);
+            },
+            [&](const FrameGraph::Resources&) {
+                m_frameCache->Present();
+            });
+    }
+
+    // Draws into its own small target, read back a few frames later
+    if (m_pickRequested) {
+        m_pickRequested = false;
+        m_frameGraph->AddPass("Pick",
+            [&](FrameGraph::Builder& builder) {
+                builder.SetSideEffect();
+            },
+            [&](const FrameGraph::Resources&) {
+                RequestPick();
+            });
+    }
+
+    m_frameGraph->AddPass("Overlay",
+        [&](FrameGraph::Builder& builder) {
+            builder.Write(backbuffer);
+        },
+        [&](const FrameGraph::Resources&) {
+            RenderOverlay();
+        });
+
+    if (m_recorder->IsRecording()) {
+        m_frameGraph->AddPass("Record",
+            [&](FrameGraph::Builder& builder) {
+                builder.Read(backbuffer, FrameGraphAccess::Copy);
+                builder.SetSideEffect();
+            },
+            [&](const FrameGraph::Resources&) {
+                m_recorder->Capture(m_width, m_height);
+            });
+    }
+
+    m_frameGraph->Compile();
+    unsigned long long frame = m_frameGraph->GetFrame();
+    m_frameGraph->Execute();
+    if (m_dynamicResolution) {
+        m_dynamicResolution->EndFrame(frame, scaled);
+    }
+    m_frameCache->MarkPresented(damage);
 
-    RenderTestScene();
+    double cpuMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    m_frameCache->RecordFrame(action, cpuMs);
+    return true;
+}
+
+void Application::SetupTestScene() {
+    m_scene = std::make_unique<SceneGraph>();
+
+    // Rotating cube in front of the camera
+    m_rotatingCube = m_scene->AddNode(SceneGraph::kNone, glm::mat4(1.0f), SceneGraph::Renderable | SceneGraph::Dynamic);
+    m_scene->SetColor(m_rotatingCube, glm::vec3(1.0f, 0.5f, 0.31f));
+
+    // Large wall acting as the main occluder
+    glm::mat4 wall = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -4.0f));
+    wall = glm::scale(wall, glm::vec3(6.0f, 4.0f, 0.5f));
+    m_scene->SetColor(m_scene->AddNode(SceneGraph::kNone, wall), glm::vec3(0.6f, 0.6f, 0.65f));
+
+    // Field of small cubes behind the wall, mostly hidden from the start position
+    const int columns = 16;
+    const int rows = 10;
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            glm::vec3 position((x - (columns - 1) * 0.5f) * 0.6f, (y - (rows - 1) * 0.5f) * 0.6f, -8.0f);
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+            model = glm::scale(model, glm::vec3(0.4f));
+            glm::vec3 color(0.3f + 0.7f * x / columns, 0.3f + 0.7f * y / rows, 0.8f);
+            m_scene->SetColor(m_scene->AddNode(SceneGraph::kNone, model), color);
+        }
+    }
+    m_scene->Update();
+}
+
+void Application::SetupSwarm() {
+    // Rings of orbiting satellites, each carrying a ring of small cubes. Only
+    // rings and satellites are animated; the cubes follow through the hierarchy.
+    const int rings = 48;
+    const int satellitesPerRing = 24;
+    const int cubesPerSatellite = 24;
+    const float twoPi = 6.2831853f;
+    m_scene->Reserve(m_scene->GetCount() + rings * satellitesPerRing * (cubesPerSatellite + 1) + rings + 1);
+
+    m_swarm = m_scene->AddNode(SceneGraph::kNone, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -16.0f)), 0);
+    m_swarmRings.clear();
+    m_swarmSatellites.clear();
+    for (int ring = 0; ring < rings; ++ring) {
+        m_swarmRings.push_back(m_scene->AddNode(m_swarm, glm::mat4(1.0f), 0));
+    }
+    for (int ring = 0; ring < rings; ++ring) {
+        for (int satellite = 0; satellite < satellitesPerRing; ++satellite) {
+            m_swarmSatellites.push_back(m_scene->AddNode(m_swarmRings[ring], glm::mat4(1.0f), 0));
+        }
+    }
+    for (size_t satellite = 0; satellite < m_swarmSatellites.size(); ++satellite) {
+        float hue = static_cast<float>(satellite / satellitesPerRing) / rings;
+        glm::vec3 color(0.5f + 0.5f * cos(twoPi * hue), 0.5f + 0.5f * cos(twoPi * (hue + 0.33f)), 0.5f + 0.5f * cos(twoPi * (hue + 0.67f)));
+        for (int cube = 0; cube < cubesPerSatellite; ++cube) {
+            glm::mat4 local = glm::rotate(glm::mat4(1.0f), twoPi * cube / cubesPerSatellite, glm::vec3(0.0f, 0.0f, 1.0f));
+            local = glm::translate(local, glm::vec3(0.3f, 0.0f, 0.0f));
+            local = glm::scale(local, glm::vec3(0.05f));
+            m_scene->SetColor(m_scene->AddNode(m_swarmSatellites[satellite], local), color);
+        }
+    }
+    AnimateScene();
+}
+
+void Application::AnimateScene() {
+    m_scene->SetLocalTransform(m_rotatingCube, glm::rotate(glm::mat4(1.0f), m_time * glm::radians(50.0f), glm::vec3(0.5f, 1.0f, 0.0f)));
+    if (m_swarm == SceneGraph::kNone) {
+        return;
+    }
+
+    const float twoPi = 6.2831853f;
+    for (size_t ring = 0; ring < m_swarmRings.size(); ++ring) {
+        float phase = static_cast<float>(ring);
+        glm::vec3 axis = glm::normalize(glm::vec3(sin(phase), 1.0f, cos(phase * 0.7f)));
+        m_scene->SetLocalTransform(m_swarmRings[ring],
+            glm::rotate(glm::mat4(1.0f), phase * 2.4f + m_time * 0.1f * (1 + ring % 3), axis));
+    }
+    size_t perRing = m_swarmSatellites.size() / m_swarmRings.size();
+    for (size_t satellite = 0; satellite < m_swarmSatellites.size(); ++satellite) {
+        size_t ring = satellite / perRing;
+        float angle = twoPi * (satellite % perRing) / perRing + m_time * 0.5f;
+        glm::mat4 local = glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.0f, 1.0f, 0.0f));
+        local = glm::translate(local, glm::vec3(3.0f + 0.04f * ring, 0.0f, 0.0f));
+        m_scene->SetLocalTransform(m_swarmSatellites[satellite], glm::rotate(local, m_time * 2.0f, glm::vec3(1.0f, 0.0f, 0.0f)));
+    }
+}
+
+void Application::UpdateScene() {
+    // Only changed subtrees are recomputed
+    if (m_sceneAnimating) {
+        AnimateScene();
+    }
+    m_scene->Update();
+}
+
+void Application::PrepareShadows() {
+    // Casters moved by this Update are redrawn every frame. One starting or
+    // stopping to move, or any node count change, invalidates the cached static depth.
+    const std::vector<SceneGraph::Node>& nodes = m_scene->GetNodes();
+    const std::vector<uint8_t>& flags = m_scene->GetFlags();
+    bool staticChanged = m_scene->GetCount() != m_casterSceneCount;
+    m_casterSceneCount = m_scene->GetCount();
+    m_staticCasters.clear();
+    m_dynamicCasters.clear();
+    for (size_t slot = 0; slot < m_scene->GetCount(); ++slot) {
+        if (!(flags[slot] & SceneGraph::Renderable)) {
+            continue;
+        }
+        SceneGraph::Node node = nodes[slot];
+        if (node >= m_casterMoving.size()) {
+            m_casterMoving.resize(node + 1, 2);
+        }
+        uint8_t moving = (flags[slot] & SceneGraph::Dynamic) || m_scene->HasChanged(slot) ? 1 : 0;
+        if (m_casterMoving[node] != moving) {
+            m_casterMoving[node] = moving;
+            staticChanged = true;
+        }
+        (moving ? m_dynamicCasters : m_staticCasters).push_back(static_cast<uint32_t>(slot));
+    }
+    if (staticChanged) {
+        m_shadows->InvalidateStatic();
+    }
+    m_shadows->Update(*m_camera, m_scene->GetWorldBounds(), m_staticCasters, m_dynamicCasters);
+}
+
+void Application::SetupTextures() {
+    // Any DDS/KTX2 files in textures/ are spread over the static cubes
+    std::vector<TextureStreamer::Handle> textures;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("textures", error)) {
+        std::string extension = entry.path().extension().string();
+        if (extension == ".dds" || extension == ".ktx2") {
+            textures.push_back(m_textureStreamer->Request(entry.path().string()));
+        }
+    }
+    if (textures.empty()) {
+        return;
+    }
+
+    std::sort(textures.begin(), textures.end());
+    size_t next = 0;
+    const std::vector<uint8_t>& flags = m_scene->GetFlags();
+    for (size_t slot = 0; slot < m_scene->GetCount(); ++slot) {
+        if (flags[slot] == SceneGraph::Renderable) {
+            m_scene->SetTexture(m_scene->GetNodes()[slot], textures[next++ % textures.size()]);
+        }
+    }
+}
+
+void Application::DrawSceneObjects(const Shader& shader, const Shader& instancedShader, bool withColor) {
+    const std::vector<glm::mat4>& world = m_scene->GetWorldMatrices();
+    const std::vector<AABB>& bounds = m_scene->GetWorldBounds();
+    if (!m_visibleTextured.empty()) {
+        shader.Use();
+        for (uint32_t slot : m_visibleTextured) {
+            shader.SetMat4("model", world[slot]);
+            if (withColor) {
+                shader.SetVec3("objectColor", m_scene->GetColors()[slot]);
+                bool textured = m_textureStreamer->Bind(m_scene->GetTextures()[slot], 0, bounds[slot].GetCenter(),
+                                                        glm::length(bounds[slot].GetExtents()));
+                shader.SetBool("useTexture", textured);
+            }
+            m_renderer->DrawCube(1.0f);
+        }
+    }
+
+    // Everything untextured in one draw, read straight from the scene arrays
+    if (!m_visibleInstanced.empty()) {
+        instancedShader.Use();
+        if (withColor) {
+            instancedShader.SetBool("useTexture", false);
+        }
+        m_renderer->DrawCubeInstanced(world.data(), m_scene->GetColors().data(), m_visibleInstanced.data(),
+                                      static_cast<int>(m_visibleInstanced.size()));
+    }
 }
 
 void Application::RenderTestScene() {
     // === 3D CUBE RENDERING ===
-    // Set up matrices for 3D rendering
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::rotate(model, m_time * glm::radians(50.0f), glm::vec3(0.5f, 1.0f, 0.0f));
-    
     glm::mat4 view = m_camera->GetViewMatrix();
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)m_width / (float)m_height, 0.1f, 100.0f);
+    glm::mat4 projection = m_camera->GetProjectionMatrix();
 
-    // Use 3D Shader
-    m_shader->Use();
-    
-    // Set uniforms
-    m_shader->SetMat4("model", model);
-    m_shader->SetMat4("view", view);
-    m_shader->SetMat4("projection", projection);
-    
-    // Set lighting uniforms
-    m_shader->SetVec3("lightPos", glm::vec3(1.2f, 1.0f, 2.0f));
-    m_shader->SetVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
-    m_shader->SetVec3("objectColor", glm::vec3(1.0f, 0.5f, 0.31f));
-    
-    // Draw rotating cube
-    m_renderer->DrawCube(1.0f);
+    // Cull static objects against last frame's reprojected depth
+    m_occlusionCuller->BeginFrame(projection * view);
+    m_visibleTextured.clear();
+    m_visibleInstanced.clear();
+    const std::vector<uint8_t>& flags = m_scene->GetFlags();
+    const std::vector<AABB>& bounds = m_scene->GetWorldBounds();
+    const std::vector<int>& textures = m_scene->GetTextures();
+    for (size_t slot = 0; slot < m_scene->GetCount(); ++slot) {
+        if (!(flags[slot] & SceneGraph::Renderable)) {
+            continue;
+        }
+        if ((flags[slot] & SceneGraph::Dynamic) || m_occlusionCuller->IsVisible(bounds[slot])) {
+            (textures[slot] >= 0 ? m_visibleTextured : m_visibleInstanced).push_back(static_cast<uint32_t>(slot));
+        }
+    }
+
+    // Depth-only pre-pass so the shading pass touches each pixel once
+    if (m_depthPrepass) {
+        for (Shader* shader : { m_depthShader.get(), m_instancedDepthShader.get() }) {
+            shader->Use();
+            shader->SetMat4("view", view);
+            shader->SetMat4("projection", projection);
+        }
+
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        m_occlusionCuller->BeginQuery(OcclusionCuller::Pass::Prepass);
+        DrawSceneObjects(*m_depthShader, *m_instancedDepthShader, false);
+        m_occlusionCuller->EndQuery(OcclusionCuller::Pass::Prepass);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+        glDepthFunc(GL_LEQUAL);
+        glDepthMask(GL_FALSE);
+    }
+
+    // Use 3D Shaders
+    for (Shader* shader : { m_shader.get(), m_instancedShader.get() }) {
+        shader->Use();
+        
+        // Set uniforms
+        shader->SetMat4("view", view);
+        shader->SetMat4("projection", projection);
+        
+        // Set lighting uniforms
+        shader->SetVec3("lightPos", kLightPosition);
+        shader->SetVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
+        if (m_shadowsEnabled) {
+            m_shadows->Bind(*shader, 1);
+        } else {
+            shader->SetInt("cascadeCount", 0);
+        }
+    }
     
-    // === 2D OVERLAY ELEMENTS ===
-    // Switch to 2D shader and identity matrices for 2D overlay elements
+    // Draw the cubes that survived culling
+    m_occlusionCuller->BeginQuery(OcclusionCuller::Pass::Shading);
+    DrawSceneObjects(*m_shader, *m_instancedShader, true);
+    m_occlusionCuller->EndQuery(OcclusionCuller::Pass::Shading);
+
+    if (m_depthPrepass) {
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+    }
+
+    if (m_particles) {
+        m_particles->Draw(view, projection);
+    }
+
+    if (m_trace) {
+        RenderTrace(projection * view);
+    }
+
+    // Capture this frame's depth for next frame's culling before the overlay is drawn
+    m_occlusionCuller->EndFrame();
+}
+
+void Application::SetupOverlay() {
+    m_hudLayer = m_overlay->AddLayer("hud");
+    m_spinnerLayer = m_overlay->AddLayer("spinner");
+
+    // Static ring framing the spinner; recorded once and never re-rasterized
+    const int segments = 48;
+    std::vector<float> ring;
+    for (int i = 0; i < segments; ++i) {
+        float angle = 2.0f * 3.14159f * i / segments;
+        ring.insert(ring.end(), {
+            -0.7f + 0.18f * std::cos(angle), 0.7f + 0.18f * std::sin(angle), 0.0f,  0.4f, 0.4f, 0.45f
+        });
+    }
+    m_overlay->BeginLayer(m_hudLayer);
+    m_overlay->AddLineLoop(ring.data(), segments);
+    m_overlay->EndLayer();
+}
+
+void Application::RenderTrace(const glm::mat4& viewProjection) {
+    // Used by the native line path; the instanced path takes the transform directly
     m_shader2D->Use();
-    glm::mat4 identity = glm::mat4(1.0f);
-    glm::mat4 ortho = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
-    m_shader2D->SetMat4("model", identity);
-    m_shader2D->SetMat4("view", identity);
-    m_shader2D->SetMat4("projection", ortho);
-    
+    m_shader2D->SetMat4("model", glm::mat4(1.0f));
+    m_shader2D->SetMat4("view", m_camera->GetViewMatrix());
+    m_shader2D->SetMat4("projection", m_camera->GetProjectionMatrix());
+
+    // Drawn inside the scene pass, which is smaller under dynamic resolution
+    int width = m_width;
+    int height = m_height;
+    if (m_dynamicResolutionEnabled && m_multiViewCount == 0) {
+        width = m_dynamicResolution->GetWidth();
+        height = m_dynamicResolution->GetHeight();
+    }
+    m_renderer->SetTransform(viewProjection, width, height);
+    m_renderer->SetLineWidth(1.5f);
+    m_trace->Draw(*m_renderer, viewProjection, width, height);
+}
+
+void Application::RenderOverlay() {
+    // === 2D OVERLAY ELEMENTS ===
     // === ANIMATED ELEMENTS (from AnimatedDemo) ===
-    // Animated spinning lines in corner
-    m_renderer->SetLineWidth(2.0f);
+    // Animated spinning lines in corner. Re-recording an unchanged list is a
+    // no-op, so the layer is only re-rasterized while the animation runs.
     const int numLines = 8;
+    float vertices[numLines * 12];
     for (int i = 0; i < numLines; ++i) {
-        float angle = (2.0f * 3.14159f * i / numLines) + m_time;
+        float angle = (2.0f * 3.14159f * i / numLines) + m_overlayTime;
         float x1 = -0.7f;
         float y1 = 0.7f;
         float x2 = x1 + 0.15f * cos(angle);
         float y2 = y1 + 0.15f * sin(angle);
         
-        m_renderer->DrawLine(x1, y1, 0.0f, x2, y2, 0.0f);
+        float segment[] = {
+            x1, y1, 0.0f, 1.0f, 1.0f, 1.0f,
+            x2, y2, 0.0f, 1.0f, 1.0f, 1.0f
+        };
+        std::copy(segment, segment + 12, vertices + i * 12);
+    }
+    m_overlay->BeginLayer(m_spinnerLayer);
+    m_overlay->SetLineWidth(2.0f);
+    m_overlay->AddLines(vertices, numLines);
+    m_overlay->EndLayer();
+
+    // Rasterize changed layers, then blend them all over the 3D result at once
+    m_overlay->Rasterize(*m_renderer, *m_shader2D);
+    m_overlay->Composite();
+
+    // All labels and HUD text in one draw per atlas page
+    UpdateLabels();
+    m_text->Draw(m_camera->GetViewMatrix(), m_camera->GetProjectionMatrix(), m_width, m_height);
+}
+
+void Application::UpdateLabels() {
+    if (!m_labelsEnabled) {
+        return;
+    }
+
+    // Drop labels of removed nodes
+    for (size_t node = 0; node < m_nodeLabels.size(); ++node) {
+        if (m_nodeLabels[node] >= 0 && m_scene->GetSlot(static_cast<SceneGraph::Node>(node)) == SceneGraph::kNone) {
+            m_text->RemoveLabel(m_nodeLabels[node]);
+            m_nodeLabels[node] = -1;
+        }
+    }
+
+    // Label every renderable node just above its bounds; unchanged positions cost nothing
+    const std::vector<SceneGraph::Node>& nodes = m_scene->GetNodes();
+    const std::vector<uint8_t>& flags = m_scene->GetFlags();
+    const std::vector<AABB>& bounds = m_scene->GetWorldBounds();
+    for (size_t slot = 0; slot < m_scene->GetCount(); ++slot) {
+        if (!(flags[slot] & SceneGraph::Renderable)) {
+            continue;
+        }
+        SceneGraph::Node node = nodes[slot];
+        if (node >= m_nodeLabels.size()) {
+            m_nodeLabels.resize(node + 1, -1);
+        }
+        glm::vec3 position = bounds[slot].GetCenter() + glm::vec3(0.0f, bounds[slot].GetExtents().y, 0.0f);
+        if (m_nodeLabels[node] < 0) {
+            glm::vec3 color = glm::mix(m_scene->GetColors()[slot], glm::vec3(1.0f), 0.5f);
+            m_nodeLabels[node] = m_text->AddLabel("#" + std::to_string(node), position, 14.0f, glm::vec4(color, 1.0f));
+        } else {
+            m_text->SetLabelPosition(m_nodeLabels[node], position);
+        }
+    }
+}
+
+void Application::RequestPick() {
+    // Objects are what the scene shows right now, so the matrices match the frame on screen
+    const std::vector<SceneGraph::Node>& nodes = m_scene->GetNodes();
+    const std::vector<uint8_t>& flags = m_scene->GetFlags();
+    m_pickSlots.clear();
+    m_pickIds.assign(m_scene->GetCount(), PickResult::kNoHit);
+    for (size_t slot = 0; slot < m_scene->GetCount(); ++slot) {
+        if (flags[slot] & SceneGraph::Renderable) {
+            m_pickSlots.push_back(static_cast<uint32_t>(slot));
+            m_pickIds[slot] = nodes[slot];
+        }
+    }
+
+    m_cpuPick = m_picker->PickCPU(m_pickX, m_pickY, m_width, m_height, *m_camera, m_scene->GetWorldMatrices(),
+                                  m_scene->GetWorldBounds(), m_pickSlots, m_pickIds, m_scene->GetVersion());
+    const ObjectPicker::Stats& stats = m_picker->GetStats();
+    std::cout << "Pick (CPU): " << (m_cpuPick.id != PickResult::kNoHit ? "node " + std::to_string(m_cpuPick.id) : std::string("nothing"))
+              << " in " << m_cpuPick.latencyMs << " ms"
+              << " | BVH " << stats.bvhNodes << " nodes, last " << (stats.bvhRefit ? "refit " : "build ") << stats.bvhBuildMs << " ms"
+              << " | " << stats.cpuTested << " cubes tested" << std::endl;
+
+    if (!m_picker->RequestGPU(m_pickX, m_pickY, m_width, m_height, *m_camera, *m_renderer, m_scene->GetWorldMatrices(),
+                              m_scene->GetWorldBounds(), m_pickSlots, m_pickIds)) {
+        std::cout << "Pick (GPU): dropped, every readback is still in flight" << std::endl;
+    }
+}
+
+void Application::SelectNode(SceneGraph::Node node) {
+    // Handles of removed nodes read back as kNone slots
+    if (m_selected != SceneGraph::kNone && m_scene->GetSlot(m_selected) != SceneGraph::kNone) {
+        m_scene->SetColor(m_selected, m_selectedColor);
+    }
+    m_selected = SceneGraph::kNone;
+    if (node != SceneGraph::kNone && m_scene->GetSlot(node) != SceneGraph::kNone) {
+        m_selected = node;
+        m_selectedColor = m_scene->GetColors()[m_scene->GetSlot(node)];
+        m_scene->SetColor(node, glm::vec3(1.0f, 1.0f, 0.2f));
+    }
+    ++m_sceneVersion;
+}
+
+void Application::ApplyRenderSize() {
+    // Next frame's culling reads back depth at the size the scene is rendered at
+    if (m_dynamicResolutionEnabled) {
+        m_occlusionCuller->Resize(m_dynamicResolution->GetWidth(), m_dynamicResolution->GetHeight());
+    } else {
+        m_occlusionCuller->Resize(m_width, m_height);
+    }
+}
+
+void Application::ConfigureMultiView(int views) {
+    // The other cameras circle the scene; view 0 is synced to m_camera every frame
+    m_multiViewCount = views;
+    if (views > 0) {
+        for (int view = 1; view < views; ++view) {
+            Camera& camera = m_multiView->GetCamera(view);
+            camera.SetPerspective(m_camera->GetFOV(), 1.0f, m_camera->GetNearPlane(), m_camera->GetFarPlane());
+            camera.OrbitAround(glm::vec3(0.0f), 10.0f, view % 2 ? 35.0f : 15.0f, 360.0f * view / views);
+        }
+        m_multiView->SetViewCount(views, m_width, m_height);
+    }
+    ++m_sceneVersion;
+}
+
+void Application::RenderMultiView() {
+    Camera& first = m_multiView->GetCamera(0);
+    first.LookAt(m_camera->GetPosition(), m_camera->GetTarget(), m_camera->GetUp());
+    first.SetPerspective(m_camera->GetFOV(), first.GetAspectRatio(), m_camera->GetNearPlane(), m_camera->GetFarPlane());
+
+    // Every renderable is drawn untextured and unshadowed in this mode
+    const std::vector<uint8_t>& flags = m_scene->GetFlags();
+    m_multiViewSlots.clear();
+    for (size_t slot = 0; slot < m_scene->GetCount(); ++slot) {
+        if (flags[slot] & SceneGraph::Renderable) {
+            m_multiViewSlots.push_back(static_cast<uint32_t>(slot));
+        }
+    }
+    m_multiView->Cull(m_scene->GetWorldBounds(), m_multiViewSlots);
+
+    for (const Shader* shader : { &m_multiView->GetShader(), static_cast<const Shader*>(m_instancedShader.get()) }) {
+        shader->Use();
+        shader->SetVec3("lightPos", kLightPosition);
+        shader->SetVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
+        shader->SetInt("cascadeCount", 0);
+        shader->SetBool("useTexture", false);
+    }
+    m_multiView->Render(*m_renderer, m_scene->GetWorldMatrices().data(), m_scene->GetColors().data(), *m_instancedShader);
+}
+
+void Application::StepMultiViewBench() {
+    // Timings lag a few frames, so the first frames of each row are not counted
+    const int warmupFrames = 30;
+    const int measuredFrames = 120;
+    m_frameCache->RequestPresent();
+    if (m_benchFrame >= warmupFrames) {
+        const MultiViewRenderer::Stats& stats = m_multiView->GetStats();
+        m_benchCullMs += stats.cullMs;
+        m_benchSubmitMs += stats.submitMs;
+        auto timing = m_frameGraph->GetTimings().find("MultiView");
+        if (timing != m_frameGraph->GetTimings().end()) {
+            m_benchGpuMs += timing->second.gpuMs;
+        }
+    }
+    if (++m_benchFrame < warmupFrames + measuredFrames) {
+        return;
+    }
+
+    const MultiViewRenderer::Stats& stats = m_multiView->GetStats();
+    bool single = m_multiView->GetMode() == MultiViewRenderer::Mode::SingleDraw;
+    char row[160];
+    std::snprintf(row, sizeof(row), "%5d | %-11s | %5d | %14zu | %7.3f | %9.3f | %6.3f", m_benchViews,
+                  single ? "single draw" : "per view", stats.draws, stats.viewInstances,
+                  m_benchCullMs / measuredFrames, m_benchSubmitMs / measuredFrames, m_benchGpuMs / measuredFrames);
+    std::cout << row << std::endl;
+    m_benchFrame = 0;
+    m_benchCullMs = m_benchSubmitMs = m_benchGpuMs = 0.0;
+
+    // Each view count in both modes, then back to the normal view
+    if (single) {
+        m_multiView->SetMode(MultiViewRenderer::Mode::PerView);
+    } else if (m_benchViews < MultiViewRenderer::kMaxViews) {
+        m_multiView->SetMode(MultiViewRenderer::Mode::SingleDraw);
+        ConfigureMultiView(++m_benchViews);
+    } else {
+        m_multiView->SetMode(MultiViewRenderer::Mode::SingleDraw);
+        m_benchViews = 0;
+        ConfigureMultiView(0);
+        std::cout << "Multi-view bench done" << std::endl;
     }
 }
 
 void Application::Shutdown() {
+    // Drain the encoder while the context is still alive
+    if (m_recorder) {
+        m_recorder->Stop();
+        m_recorder.reset();
+    }
+    if (m_capture) {
+        m_capture->Stop();
+        m_capture.reset();
+    }
+    m_particles.reset();
+    if (m_multiView) {
+        m_multiView->Shutdown();
+        m_multiView.reset();
+    }
+    if (m_dynamicResolution) {
+        m_dynamicResolution->Shutdown();
+        m_dynamicResolution.reset();
+    }
+    if (m_picker) {
+        m_picker->Shutdown();
+        m_picker.reset();
+    }
+    if (m_shadows) {
+        m_shadows->Shutdown();
+        m_shadows.reset();
+    }
+    if (m_textureStreamer) {
+        m_textureStreamer->Shutdown();
+        m_textureStreamer.reset();
+    }
+
+    if (m_frameGraph) {
+        m_frameGraph->Shutdown();
+        m_frameGraph.reset();
+    }
+
+    if (m_text) {
+        m_text->Shutdown();
+        m_text.reset();
+    }
+
+    if (m_overlay) {
+        m_overlay->Shutdown();
+        m_overlay.reset();
+    }
+
+    if (m_frameCache) {
+        m_frameCache->Shutdown();
+        m_frameCache.reset();
+    }
+
+    if (m_occlusionCuller) {
+        m_occlusionCuller->Shutdown();
+        m_occlusionCuller.reset();
+    }
+
     if (m_renderer) {
         m_renderer->Shutdown();
         m_renderer.reset();
@@ -221,6 +1242,11 @@ void Application::Shutdown() {
         m_shader2D.reset();
     }
 
+    if (m_depthShader) {
+        m_depthShader->Delete();
+        m_depthShader.reset();
+    }
+
     if (m_window) {
         glfwDestroyWindow(m_window);
         m_window = nullptr;
@@ -231,14 +1257,32 @@ void Application::Shutdown() {
 
 void Application::FramebufferSizeCallback(GLFWwindow* window, int width, int height) {
     auto* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    if (app->m_capture) {
+        app->m_capture->RecordInput(GLCaptureInputType::Resize, width, height);
+    }
     app->m_width = width;
     app->m_height = height;
     glViewport(0, 0, width, height);
+    app->m_renderer->Resize(width, height);
     app->m_camera->SetAspectRatio((float)width / (float)height);
+    if (app->m_dynamicResolution) {
+        app->m_dynamicResolution->Resize(width, height);
+    }
+    app->ApplyRenderSize();
+    app->m_frameCache->Resize(width, height);
+    app->m_overlay->Resize(width, height);
+    if (app->m_multiViewCount > 0) {
+        app->m_multiView->SetViewCount(app->m_multiViewCount, width, height);
+    }
 }
 
 void Application::MouseCallback(GLFWwindow* window, double xpos, double ypos) {
     auto* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    if (app->m_capture) {
+        app->m_capture->RecordInput(GLCaptureInputType::CursorPos, 0, 0, xpos, ypos);
+    }
+    app->m_cursorX = xpos;
+    app->m_cursorY = ypos;
     
     // Only process mouse movement when right mouse button is pressed
     if (!app->m_rightMousePressed) {
@@ -298,6 +1342,9 @@ void Application::MouseCallback(GLFWwindow* window, double xpos, double ypos) {
 
 void Application::MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
     auto* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    if (app->m_capture) {
+        app->m_capture->RecordInput(GLCaptureInputType::MouseButton, button, action);
+    }
     
     if (button == GLFW_MOUSE_BUTTON_RIGHT) {
         if (action == GLFW_PRESS) {
@@ -310,9 +1357,160 @@ void Application::MouseButtonCallback(GLFWwindow* window, int button, int action
             // Re-enable cursor when releasing right-click
             glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
         }
+    } else if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && app->m_picker && !app->m_rightMousePressed
+               && app->m_multiViewCount == 0) {
+        // The cursor is in window coordinates, which differ from pixels on high-DPI displays
+        int windowWidth, windowHeight;
+        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        if (windowWidth > 0 && windowHeight > 0) {
+            app->m_pickX = static_cast<int>(app->m_cursorX * app->m_width / windowWidth);
+            app->m_pickY = static_cast<int>(app->m_cursorY * app->m_height / windowHeight);
+            app->m_pickRequested = true;
+            app->m_frameCache->RequestPresent();
+        }
+    }
+}
+
+void Application::KeyCallback(GLFWwindow* window, int key, int /*scancode*/, int action, int mods) {
+    auto* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    if (app->m_capture) {
+        app->m_capture->RecordInput(GLCaptureInputType::Key, key, action);
+    }
+
+    if (action != GLFW_PRESS) {
+        return;
+    }
+
+    if (key == GLFW_KEY_F1) {
+        app->m_depthPrepass = !app->m_depthPrepass;
+        std::cout << "Depth pre-pass: " << (app->m_depthPrepass ? "on" : "off") << std::endl;
+        ++app->m_sceneVersion;
+    } else if (key == GLFW_KEY_F2) {
+        app->m_occlusionCuller->SetEnabled(!app->m_occlusionCuller->IsEnabled());
+        std::cout << "Occlusion culling: " << (app->m_occlusionCuller->IsEnabled() ? "on" : "off") << std::endl;
+        ++app->m_sceneVersion;
+    } else if (key == GLFW_KEY_F3) {
+        app->m_frameCache->SetEnabled(!app->m_frameCache->IsEnabled());
+        std::cout << "Damage tracking: " << (app->m_frameCache->IsEnabled() ? "on" : "off") << std::endl;
+    } else if (key == GLFW_KEY_F4) {
+        if (app->m_trace) {
+            app->m_trace.reset();
+        } else {
+            // Noisy two million sample signal in front of the wall
+            const size_t samples = 2000000;
+            std::vector<float> vertices;
+            vertices.reserve(samples * 6);
+            unsigned int seed = 1;
+            for (size_t i = 0; i < samples; ++i) {
+                seed = seed * 1664525u + 1013904223u;
+                float x = -3.0f + 6.0f * i / samples;
+                float noise = (seed >> 8) / 16777216.0f - 0.5f;
+                float y = 0.5f * sin(x * 3.0f) + 0.1f * noise;
+                vertices.insert(vertices.end(), { x, y, -2.0f, 0.2f, 0.9f, 0.4f });
+            }
+            app->m_trace = std::make_unique<PolylineCache>();
+            app->m_trace->SetData(std::move(vertices));
+        }
+        std::cout << "Trace: " << (app->m_trace ? "on" : "off") << std::endl;
+        ++app->m_sceneVersion;
+    } else if (key == GLFW_KEY_F5) {
+        std::cout << app->m_frameGraph->Dump();
+    } else if (key == GLFW_KEY_F6) {
+        std::cout << app->m_renderer->GetGpuMemory().Report();
+    } else if (key == GLFW_KEY_F7) {
+        if (app->m_recorder->IsRecording()) {
+            app->m_recorder->Stop();
+        } else {
+            app->m_recorder->Start(app->m_recordPath, app->m_width, app->m_height);
+        }
+    } else if (key == GLFW_KEY_F8) {
+        if (app->m_swarm != SceneGraph::kNone) {
+            app->SelectNode(SceneGraph::kNone);
+            app->m_scene->Remove(app->m_swarm);
+            app->m_swarm = SceneGraph::kNone;
+        } else {
+            app->SetupSwarm();
+        }
+        std::cout << "Swarm: " << (app->m_swarm != SceneGraph::kNone ? "on" : "off") << std::endl;
+        ++app->m_sceneVersion;
+    } else if (key == GLFW_KEY_F9) {
+        // Off -> GPU -> CPU -> off
+        if (!app->m_particles) {
+            if (!app->m_particlesVerified) {
+                ParticleSystem::Verify(16384, 240, 1.0f / 60.0f);
+                app->m_particlesVerified = true;
+            }
+            app->m_particles = std::make_unique<ParticleSystem>();
+            app->m_particles->Initialize(500000, ParticleBackend::GPU);
+        } else if (app->m_particles->GetBackend() == ParticleBackend::GPU) {
+            app->m_particles = std::make_unique<ParticleSystem>();
+            app->m_particles->Initialize(500000, ParticleBackend::CPU);
+        } else {
+            app->m_particles.reset();
+        }
+        if (app->m_particles) {
+            ParticleEmitter& emitter = app->m_particles->GetEmitter();
+            emitter.position = glm::vec3(0.0f, -2.0f, -2.5f);
+            emitter.rate = 150000.0f;
+        }
+        std::cout << "Particles: " << (!app->m_particles ? "off"
+            : (app->m_particles->GetBackend() == ParticleBackend::GPU ? "GPU" : "CPU")) << std::endl;
+        ++app->m_sceneVersion;
+    } else if (key == GLFW_KEY_F10) {
+        app->m_labelsEnabled = !app->m_labelsEnabled;
+        app->m_text->Clear();
+        app->m_nodeLabels.clear();
+        app->m_hudLabel = -1;
+        if (app->m_labelsEnabled) {
+            app->m_hudLabel = app->m_text->AddLabel("Labels", glm::vec3(10.0f, 10.0f, 0.0f), 20.0f, glm::vec4(1.0f),
+                                                    TextSpace::Screen, glm::vec2(0.0f));
+        }
+        std::cout << "Labels: " << (app->m_labelsEnabled ? "on" : "off") << std::endl;
+    } else if (key == GLFW_KEY_F11) {
+        if (app->m_shadows) {
+            // Nothing is cached while off, so start over
+            app->m_shadowsEnabled = !app->m_shadowsEnabled;
+            app->m_shadows->InvalidateStatic();
+            app->m_casterMoving.clear();
+            std::cout << "Shadows: " << (app->m_shadowsEnabled ? "on" : "off") << std::endl;
+            ++app->m_sceneVersion;
+        }
+    } else if (key == GLFW_KEY_F12) {
+        // Off -> 4 -> 9 -> 16 views; with Shift, single draw <-> a draw per view
+        if (app->m_multiView && app->m_benchViews == 0) {
+            if (mods & GLFW_MOD_SHIFT) {
+                bool single = app->m_multiView->GetMode() == MultiViewRenderer::Mode::SingleDraw;
+                app->m_multiView->SetMode(single ? MultiViewRenderer::Mode::PerView : MultiViewRenderer::Mode::SingleDraw);
+                std::cout << "Multi-view mode: " << (single ? "draw per view" : "single draw") << std::endl;
+                ++app->m_sceneVersion;
+            } else {
+                int views = app->m_multiViewCount == 0 ? 4 : (app->m_multiViewCount < 9 ? 9 : (app->m_multiViewCount < 16 ? 16 : 0));
+                app->ConfigureMultiView(views);
+                std::cout << "Multi-view: " << (views > 0 ? std::to_string(views) + " views" : std::string("off")) << std::endl;
+            }
+        }
+    } else if (key == GLFW_KEY_R) {
+        if (app->m_dynamicResolution) {
+            app->m_dynamicResolutionEnabled = !app->m_dynamicResolutionEnabled;
+            const DynamicResolution::Settings& settings = app->m_dynamicResolution->GetSettings();
+            std::cout << "Dynamic resolution: " << (app->m_dynamicResolutionEnabled ? "on" : "off")
+                      << " (scale " << settings.minScale << "-" << settings.maxScale
+                      << ", target " << settings.targetMs << " ms)" << std::endl;
+            app->ApplyRenderSize();
+            ++app->m_sceneVersion;
+        }
+    } else if (key == GLFW_KEY_P) {
+        app->m_sceneAnimating = !app->m_sceneAnimating;
+    } else if (key == GLFW_KEY_O) {
+        app->m_overlayAnimating = !app->m_overlayAnimating;
     }
 }
 
+void Application::WindowRefreshCallback(GLFWwindow* window) {
+    auto* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
+    app->m_frameCache->RequestPresent();
+}
+
 void Application::ErrorCallback(int error, const char* description) {
     std::cerr << "GLFW Error " << error << ": " << description << std::endl;
 }
@@ -13,6 +13,7 @@ Camera::Camera(float fov, float aspectRatio, float nearPlane, float farPlane)
     , m_projectionMatrix(1.0f)
     , m_viewDirty(true)
     , m_projectionDirty(true)
+    , m_version(0)
 {
 }
 
@@ -28,6 +29,7 @@ Camera::Camera(const glm::vec3& position, const glm::vec3& up, float yaw, float
     , m_projectionMatrix(1.0f)
     , m_viewDirty(true)
     , m_projectionDirty(true)
+    , m_version(0)
 {
     // Calculate initial target based on yaw and pitch
     glm::vec3 direction;
@@ -40,11 +42,13 @@ Camera::Camera(const glm::vec3& position, const glm::vec3& up, float yaw, float
 void Camera::SetPosition(const glm::vec3& position) {
     m_position = position;
     m_viewDirty = true;
+    ++m_version;
 }
 
 void Camera::SetTarget(const glm::vec3& target) {
     m_target = target;
     m_viewDirty = true;
+    ++m_version;
 }
 
 void Camera::LookAt(const glm::vec3& eye, const glm::vec3& center, const glm::vec3& up) {
@@ -52,6 +56,7 @@ void Camera::LookAt(const glm::vec3& eye, const glm::vec3& center, const glm::ve
     m_target = center;
     m_up = up;
     m_viewDirty = true;
+    ++m_version;
 }
 
 void Camera::SetPerspective(float fov, float aspectRatio, float nearPlane, float farPlane) {
@@ -60,17 +65,20 @@ void Camera::SetPerspective(float fov, float aspectRatio, float nearPlane, float
     m_nearPlane = nearPlane;
     m_farPlane = farPlane;
     m_projectionDirty = true;
+    ++m_version;
 }
 
 void Camera::SetAspectRatio(float aspectRatio) {
     m_aspectRatio = aspectRatio;
     m_projectionDirty = true;
+    ++m_version;
 }
 
 void Camera::Translate(const glm::vec3& offset) {
     m_position += offset;
     m_target += offset;
     m_viewDirty = true;
+    ++m_version;
 }
 
 void Camera::Rotate(float pitch, float yaw, float roll) {
@@ -89,6 +97,7 @@ void Camera::Rotate(float pitch, float yaw, float roll) {
     }
     
     m_viewDirty = true;
+    ++m_version;
 }
 
 void Camera::OrbitAround(const glm::vec3& target, float distance, float pitch, float yaw) {
@@ -103,6 +112,7 @@ void Camera::OrbitAround(const glm::vec3& target, float distance, float pitch, f
     m_position.z = target.z + distance * cos(pitchRad) * cos(yawRad);
     
     m_viewDirty = true;
+    ++m_version;
 }
 
 const glm::mat4& Camera::GetViewMatrix() const {
@@ -0,0 +1,265 @@
+#include "CascadedShadowMap.h"
+#include "Camera.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+// Cascades move in steps of this many texels, and are widened by one step, so
+// small camera motion keeps the projection (and the cached static layer) unchanged
+constexpr float kSnapTexels = 64.0f;
+constexpr float kOffsetFactor = 1.5f;  // Slope-scaled depth bias while rendering casters
+constexpr float kOffsetUnits = 2.0f;
+constexpr float kNormalOffsetTexels = 1.5f;  // Receiver offset along the normal, in texels
+}
+
+CascadedShadowMap::CascadedShadowMap()
+    : m_resolution(0), m_cascadeCount(0), m_shadowDistance(40.0f),
+      m_lightDirection(glm::normalize(glm::vec3(-1.2f, -1.0f, -2.0f))), m_lightView(1.0f), m_staticVersion(0),
+      m_staticMap(0), m_shadowMap(0), m_framebuffers{ 0, 0 } {
+    SetLightDirection(m_lightDirection);
+}
+
+CascadedShadowMap::~CascadedShadowMap() {
+    Shutdown();
+}
+
+bool CascadedShadowMap::Initialize(int resolution, int cascades) {
+    m_resolution = std::max(resolution, 1);
+    m_cascadeCount = std::clamp(cascades, 1, kMaxCascades);
+
+    // Hardware depth comparison with bilinear filtering; lookups outside a
+    // cascade are rejected by the shader
+    for (GLuint* map : { &m_staticMap, &m_shadowMap }) {
+        glGenTextures(1, map);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, *map);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, m_resolution, m_resolution, m_cascadeCount, 0,
+                     GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // Depth-only targets; layers are attached as needed
+    glGenFramebuffers(2, m_framebuffers);
+    for (GLuint framebuffer : m_framebuffers) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_shadowMap, 0, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) {
+        std::cerr << "ERROR::SHADOW_MAP::FRAMEBUFFER_INCOMPLETE" << std::endl;
+        Shutdown();
+        return false;
+    }
+
+    for (Cascade& cascade : m_cascades) {
+        cascade = Cascade();
+    }
+    return true;
+}
+
+void CascadedShadowMap::Shutdown() {
+    if (m_framebuffers[0] != 0) {
+        glDeleteFramebuffers(2, m_framebuffers);
+        m_framebuffers[0] = m_framebuffers[1] = 0;
+    }
+    for (GLuint* map : { &m_staticMap, &m_shadowMap }) {
+        if (*map != 0) {
+            glDeleteTextures(1, map);
+            *map = 0;
+        }
+    }
+    m_cascadeCount = 0;
+}
+
+void CascadedShadowMap::SetShadowDistance(float distance) {
+    m_shadowDistance = std::max(distance, 0.1f);
+}
+
+void CascadedShadowMap::SetLightDirection(const glm::vec3& direction) {
+    glm::vec3 normalized = glm::normalize(direction);
+    glm::vec3 up = std::abs(normalized.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), normalized, up);
+    if (lightView != m_lightView) {
+        m_lightDirection = normalized;
+        m_lightView = lightView;
+        ++m_staticVersion;
+    }
+}
+
+void CascadedShadowMap::Update(const Camera& camera, const std::vector<AABB>& bounds,
+                               const std::vector<uint32_t>& staticCasters, const std::vector<uint32_t>& dynamicCasters) {
+    m_stats.cascades = m_cascadeCount;
+    float nearPlane = camera.GetNearPlane();
+    float farPlane = std::max(std::min(camera.GetFarPlane(), m_shadowDistance), nearPlane * 2.0f);
+
+    // Practical split scheme: a blend of uniform and logarithmic splits
+    float splitNear = nearPlane;
+    for (int i = 0; i < m_cascadeCount; ++i) {
+        float fraction = static_cast<float>(i + 1) / m_cascadeCount;
+        float uniform = nearPlane + (farPlane - nearPlane) * fraction;
+        float logarithmic = nearPlane * std::pow(farPlane / nearPlane, fraction);
+        float splitFar = uniform + (logarithmic - uniform) * kSplitLambda;
+        FitCascade(i, camera, splitNear, splitFar);
+        splitNear = splitFar;
+
+        Cascade& cascade = m_cascades[i];
+        bool cacheValid = cascade.cacheValid && cascade.cachedStaticVersion == m_staticVersion
+            && cascade.cachedViewProjection == cascade.viewProjection;
+        Cull(cascade.viewProjection, bounds, dynamicCasters, cascade.dynamicCasters);
+        if (!cacheValid) {
+            Cull(cascade.viewProjection, bounds, staticCasters, cascade.staticCasters);
+            cascade.work = CascadeWork::Full;
+        } else if (cascade.dynamicCasters.empty() && !cascade.hasDynamic) {
+            cascade.work = CascadeWork::Skip;
+            ++m_stats.skipped;
+        } else {
+            cascade.work = CascadeWork::Dynamic;
+        }
+
+        m_stats.work[i] = cascade.work;
+        m_stats.splits[i] = cascade.splitFar;
+        m_stats.dynamicCasters[i] = cascade.dynamicCasters.size();
+    }
+}
+
+void CascadedShadowMap::FitCascade(int index, const Camera& camera, float splitNear, float splitFar) {
+    Cascade& cascade = m_cascades[index];
+    cascade.splitFar = splitFar;
+
+    // Slice corners in world space
+    glm::mat4 cameraToWorld = glm::inverse(camera.GetViewMatrix());
+    float tanHalfFov = std::tan(glm::radians(camera.GetFOV()) * 0.5f);
+    glm::vec3 corners[8];
+    glm::vec3 center(0.0f);
+    for (int i = 0; i < 8; ++i) {
+        float distance = (i & 4) ? splitFar : splitNear;
+        float x = ((i & 1) ? 1.0f : -1.0f) * distance * tanHalfFov * camera.GetAspectRatio();
+        float y = ((i & 2) ? 1.0f : -1.0f) * distance * tanHalfFov;
+        corners[i] = glm::vec3(cameraToWorld * glm::vec4(x, y, -distance, 1.0f));
+        center += corners[i] / 8.0f;
+    }
+
+    // A bounding sphere keeps the projection size fixed as the camera turns
+    float radius = 0.0f;
+    for (const glm::vec3& corner : corners) {
+        radius = std::max(radius, glm::length(corner - center));
+    }
+    radius = std::ceil(radius * 16.0f) / 16.0f;
+
+    // Widen by one snap step, then move the center in whole steps of whole texels
+    float halfSize = radius / (1.0f - 2.0f * kSnapTexels / m_resolution);
+    cascade.texelSize = 2.0f * halfSize / m_resolution;
+    float step = cascade.texelSize * kSnapTexels;
+    glm::vec3 lightCenter = glm::vec3(m_lightView * glm::vec4(center, 1.0f));
+    lightCenter.x = std::floor(lightCenter.x / step) * step;
+    lightCenter.y = std::floor(lightCenter.y / step) * step;
+    lightCenter.z = std::floor(lightCenter.z / halfSize) * halfSize;
+
+    // The light looks down -z; casters up to kCasterReach towards it still count
+    glm::mat4 projection = glm::ortho(lightCenter.x - halfSize, lightCenter.x + halfSize,
+                                      lightCenter.y - halfSize, lightCenter.y + halfSize,
+                                      -(lightCenter.z + 2.0f * halfSize + kCasterReach),
+                                      -(lightCenter.z - 2.0f * halfSize));
+    cascade.viewProjection = projection * m_lightView;
+}
+
+void CascadedShadowMap::Cull(const glm::mat4& viewProjection, const std::vector<AABB>& bounds,
+                             const std::vector<uint32_t>& casters, std::vector<uint32_t>& result) {
+    result.clear();
+    for (uint32_t slot : casters) {
+        // The projection is orthographic, so the transformed box is exact enough
+        AABB clip = bounds[slot].Transform(viewProjection);
+        if (clip.max.x >= -1.0f && clip.min.x <= 1.0f && clip.max.y >= -1.0f && clip.min.y <= 1.0f
+            && clip.max.z >= -1.0f && clip.min.z <= 1.0f) {
+            result.push_back(slot);
+        }
+    }
+}
+
+void CascadedShadowMap::RenderCascade(int index, Renderer& renderer, const Shader& depthShader,
+                                      const glm::mat4* world, const glm::vec3* colors) {
+    Cascade& cascade = m_cascades[index];
+    if (cascade.work == CascadeWork::Skip) {
+        return;
+    }
+
+    GLint viewport[4];
+    GLint framebuffer = 0;
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    glViewport(0, 0, m_resolution, m_resolution);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(kOffsetFactor, kOffsetUnits);
+
+    depthShader.Use();
+    depthShader.SetMat4("view", glm::mat4(1.0f));
+    depthShader.SetMat4("projection", cascade.viewProjection);
+
+    if (cascade.work == CascadeWork::Full) {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[1]);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_staticMap, 0, index);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        DrawCasters(renderer, cascade.staticCasters, world, colors);
+
+        cascade.cachedViewProjection = cascade.viewProjection;
+        cascade.cachedStaticVersion = m_staticVersion;
+        cascade.cacheValid = true;
+        m_stats.staticCasters[index] = cascade.staticCasters.size();
+        ++m_stats.staticRenders;
+    }
+
+    // Sampled layer: the cached static depth with the dynamic casters on top
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffers[0]);
+    glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_staticMap, 0, index);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffers[1]);
+    glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_shadowMap, 0, index);
+    glBlitFramebuffer(0, 0, m_resolution, m_resolution, 0, 0, m_resolution, m_resolution,
+                      GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[1]);
+    DrawCasters(renderer, cascade.dynamicCasters, world, colors);
+    cascade.hasDynamic = !cascade.dynamicCasters.empty();
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void CascadedShadowMap::DrawCasters(Renderer& renderer, const std::vector<uint32_t>& casters,
+                                    const glm::mat4* world, const glm::vec3* colors) {
+    if (!casters.empty()) {
+        renderer.DrawCubeInstanced(world, colors, casters.data(), static_cast<int>(casters.size()));
+    }
+}
+
+void CascadedShadowMap::Bind(const Shader& shader, int unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_shadowMap);
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.SetInt("shadowMap", unit);
+    shader.SetInt("cascadeCount", m_cascadeCount);
+    for (int i = 0; i < m_cascadeCount; ++i) {
+        std::string index = "[" + std::to_string(i) + "]";
+        shader.SetMat4("lightMatrices" + index, m_cascades[i].viewProjection);
+        shader.SetFloat("cascadeSplits" + index, m_cascades[i].splitFar);
+        shader.SetFloat("normalOffsets" + index, m_cascades[i].texelSize * kNormalOffsetTexels);
+    }
+}
+
+void CascadedShadowMap::ResetCounters() {
+    m_stats.skipped = 0;
+    m_stats.staticRenders = 0;
+}
@@ -0,0 +1,126 @@
+#include "DynamicResolution.h"
+#include "Shader.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+DynamicResolution::DynamicResolution()
+    : m_scale(1.0f), m_width(0), m_height(0), m_renderWidth(0), m_renderHeight(0), m_emptyVAO(0) {
+}
+
+DynamicResolution::~DynamicResolution() {
+    Shutdown();
+}
+
+bool DynamicResolution::Initialize(int width, int height) {
+    m_shader = std::make_unique<Shader>("shaders/vertex_composite.glsl", "shaders/fragment_upscale.glsl");
+    if (m_shader->GetID() == 0) {
+        std::cerr << "ERROR::DYNAMIC_RESOLUTION::SHADER_FAILED" << std::endl;
+        m_shader.reset();
+        return false;
+    }
+    m_shader->Use();
+    m_shader->SetInt("sceneColor", 0);
+
+    glGenVertexArrays(1, &m_emptyVAO);
+
+    m_width = width;
+    m_height = height;
+    SetSettings(m_settings);
+    return true;
+}
+
+void DynamicResolution::Shutdown() {
+    for (FrameRecord& record : m_frames) {
+        record = FrameRecord();
+    }
+    if (m_emptyVAO != 0) {
+        glDeleteVertexArrays(1, &m_emptyVAO);
+        m_emptyVAO = 0;
+    }
+    if (m_shader) {
+        m_shader->Delete();
+        m_shader.reset();
+    }
+}
+
+void DynamicResolution::SetSettings(const Settings& settings) {
+    m_settings = settings;
+    m_settings.minScale = std::clamp(settings.minScale, 0.25f, 2.0f);
+    m_settings.maxScale = std::clamp(settings.maxScale, m_settings.minScale, 2.0f);
+    m_settings.targetMs = std::max(settings.targetMs, 1.0f);
+    m_settings.sharpness = std::clamp(settings.sharpness, 0.0f, 1.0f);
+    ApplyScale(m_settings.maxScale);
+}
+
+void DynamicResolution::Resize(int width, int height) {
+    m_width = width;
+    m_height = height;
+    ApplyScale(m_scale);
+}
+
+void DynamicResolution::ApplyScale(float scale) {
+    m_scale = std::clamp(scale, m_settings.minScale, m_settings.maxScale);
+    m_renderWidth = std::max(1, static_cast<int>(std::lround(m_width * m_scale)));
+    m_renderHeight = std::max(1, static_cast<int>(std::lround(m_height * m_scale)));
+    m_stats.gpuMs = 0.0;
+    m_stats.samples = 0;
+}
+
+void DynamicResolution::EndFrame(unsigned long long frame, bool scaled) {
+    FrameRecord& record = m_frames[frame % kHistoryFrames];
+    record.frame = frame;
+    record.pending = true;
+    record.scaled = scaled;
+    record.scale = m_scale;
+}
+
+bool DynamicResolution::Update(unsigned long long frame, double gpuMs) {
+    // Frames older than kHistoryFrames have been overwritten
+    FrameRecord& record = m_frames[frame % kHistoryFrames];
+    if (!record.pending || record.frame != frame) {
+        return false;
+    }
+    record.pending = false;
+
+    // Frames from before the last change say nothing about this scale
+    if (!record.scaled || record.scale != m_scale) {
+        return false;
+    }
+    m_stats.gpuMs = m_stats.samples == 0 ? gpuMs : m_stats.gpuMs + (gpuMs - m_stats.gpuMs) * 0.25;
+    if (++m_stats.samples < kSettleSamples) {
+        return false;
+    }
+
+    // GPU time mostly follows the pixel count, which goes with the square of the scale
+    float scale = m_scale;
+    if (m_stats.gpuMs > m_settings.targetMs) {
+        float fit = m_scale * std::sqrt(static_cast<float>(m_settings.targetMs / m_stats.gpuMs));
+        scale = std::floor(fit / kScaleStep) * kScaleStep;
+    } else if (m_stats.gpuMs < m_settings.targetMs * kHeadroom) {
+        scale = (std::round(m_scale / kScaleStep) + 1.0f) * kScaleStep;
+    }
+    scale = std::clamp(scale, m_settings.minScale, m_settings.maxScale);
+    if (std::abs(scale - m_scale) <= kScaleStep * 0.5f) {
+        return false;
+    }
+    m_stats.changeGpuMs = m_stats.gpuMs;
+    ApplyScale(scale);
+    ++m_stats.changes;
+    return true;
+}
+
+void DynamicResolution::Upscale(GLuint sceneTexture) const {
+    glDisable(GL_DEPTH_TEST);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sceneTexture);
+
+    m_shader->Use();
+    m_shader->SetFloat("sharpness", m_settings.sharpness);
+    glBindVertexArray(m_emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glEnable(GL_DEPTH_TEST);
+}
@@ -0,0 +1,152 @@
+#include "FrameCache.h"
+#include <algorithm>
+#include <iostream>
+
+double FrameCacheStats::EstimatedCpuSavedMs() const {
+    double overlaySaving = std::max(0.0, fullFrameMs - overlayFrameMs);
+    return framesSkipped * fullFrameMs + framesOverlay * overlaySaving;
+}
+
+FrameCache::FrameCache()
+    : m_enabled(false), m_valid(false), m_needsPresent(true), m_width(0), m_height(0),
+      m_framebuffer(0), m_colorTexture(0), m_depthRenderbuffer(0),
+      m_cameraVersion(0), m_sceneVersion(0), m_overlayVersion(0) {
+}
+
+FrameCache::~FrameCache() {
+    Shutdown();
+}
+
+bool FrameCache::Initialize(int width, int height) {
+    m_width = std::max(width, 1);
+    m_height = std::max(height, 1);
+    CreateTarget();
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR::FRAMECACHE::FRAMEBUFFER_INCOMPLETE" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return true;
+}
+
+void FrameCache::Resize(int width, int height) {
+    DestroyTarget();
+    m_width = std::max(width, 1);
+    m_height = std::max(height, 1);
+    CreateTarget();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    m_valid = false;
+}
+
+void FrameCache::Shutdown() {
+    DestroyTarget();
+}
+
+void FrameCache::SetEnabled(bool enabled) {
+    m_enabled = enabled;
+    m_valid = false;
+    m_needsPresent = true;
+}
+
+void FrameCache::CreateTarget() {
+    glGenTextures(1, &m_colorTexture);
+    glBindTexture(GL_TEXTURE_2D, m_colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Same format as the default framebuffer so depth can be blitted across
+    glGenRenderbuffers(1, &m_depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width, m_height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbuffer);
+}
+
+void FrameCache::DestroyTarget() {
+    if (m_framebuffer != 0) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        m_framebuffer = 0;
+    }
+    if (m_colorTexture != 0) {
+        glDeleteTextures(1, &m_colorTexture);
+        m_colorTexture = 0;
+    }
+    if (m_depthRenderbuffer != 0) {
+        glDeleteRenderbuffers(1, &m_depthRenderbuffer);
+        m_depthRenderbuffer = 0;
+    }
+}
+
+FrameAction FrameCache::Decide(const DamageState& state) const {
+    if (!m_enabled) {
+        return FrameAction::Full;
+    }
+
+    bool sceneDirty = !m_valid || state.sceneAnimating
+        || state.cameraVersion != m_cameraVersion
+        || state.sceneVersion != m_sceneVersion;
+    if (sceneDirty) {
+        return FrameAction::Full;
+    }
+
+    bool overlayDirty = m_needsPresent || state.overlayAnimating
+        || state.overlayVersion != m_overlayVersion;
+    return overlayDirty ? FrameAction::Overlay : FrameAction::Skip;
+}
+
+void FrameCache::BeginScene() {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+}
+
+void FrameCache::EndScene(const DamageState& state) {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    m_cameraVersion = state.cameraVersion;
+    m_sceneVersion = state.sceneVersion;
+    m_valid = true;
+}
+
+void FrameCache::Present() {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height,
+                      GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void FrameCache::MarkPresented(const DamageState& state) {
+    m_overlayVersion = state.overlayVersion;
+    m_needsPresent = false;
+}
+
+void FrameCache::RecordFrame(FrameAction action, double cpuMs) {
+    // Exponential moving average keeps the estimate responsive to scene changes
+    const double smoothing = 0.1;
+    switch (action) {
+    case FrameAction::Full:
+        ++m_stats.framesFull;
+        m_stats.fullFrameMs = m_stats.fullFrameMs == 0.0 ? cpuMs : m_stats.fullFrameMs + (cpuMs - m_stats.fullFrameMs) * smoothing;
+        break;
+    case FrameAction::Overlay:
+        ++m_stats.framesOverlay;
+        m_stats.overlayFrameMs = m_stats.overlayFrameMs == 0.0 ? cpuMs : m_stats.overlayFrameMs + (cpuMs - m_stats.overlayFrameMs) * smoothing;
+        break;
+    case FrameAction::Skip:
+        ++m_stats.framesSkipped;
+        break;
+    }
+}
+
+void FrameCache::ResetCounters() {
+    m_stats.framesFull = 0;
+    m_stats.framesOverlay = 0;
+    m_stats.framesSkipped = 0;
+    m_stats.idleSeconds = 0.0;
+}
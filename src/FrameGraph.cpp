@@ -0,0 +1,669 @@
+#include "FrameGraph.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <queue>
+#include <sstream>
+
+namespace {
+
+const char* AccessName(FrameGraphAccess access) {
+    switch (access) {
+    case FrameGraphAccess::Attachment: return "attachment";
+    case FrameGraphAccess::Sampled: return "sampled";
+    case FrameGraphAccess::Storage: return "storage";
+    case FrameGraphAccess::Copy: return "copy";
+    }
+    return "?";
+}
+
+// Barrier bits needed to make storage writes visible to a later access
+GLbitfield BarrierFor(FrameGraphAccess access) {
+    switch (access) {
+    case FrameGraphAccess::Attachment: return GL_FRAMEBUFFER_BARRIER_BIT;
+    case FrameGraphAccess::Sampled: return GL_TEXTURE_FETCH_BARRIER_BIT;
+    case FrameGraphAccess::Storage: return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+    case FrameGraphAccess::Copy: return GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT;
+    }
+    return 0;
+}
+
+// Pixel transfer format/type matching an internal format, for glTexImage2D
+void TransferFormat(GLenum internalFormat, GLenum& format, GLenum& type) {
+    switch (internalFormat) {
+    case GL_DEPTH_COMPONENT24:
+    case GL_DEPTH_COMPONENT32F:
+        format = GL_DEPTH_COMPONENT;
+        type = GL_FLOAT;
+        break;
+    case GL_DEPTH24_STENCIL8:
+        format = GL_DEPTH_STENCIL;
+        type = GL_UNSIGNED_INT_24_8;
+        break;
+    case GL_R32UI:
+        format = GL_RED_INTEGER;
+        type = GL_UNSIGNED_INT;
+        break;
+    case GL_R8:
+    case GL_R16F:
+    case GL_R32F:
+        format = GL_RED;
+        type = GL_FLOAT;
+        break;
+    case GL_RG16F:
+    case GL_RG32F:
+        format = GL_RG;
+        type = GL_FLOAT;
+        break;
+    default:
+        format = GL_RGBA;
+        type = GL_UNSIGNED_BYTE;
+        break;
+    }
+}
+
+} // namespace
+
+// Builder
+FrameGraph::Handle FrameGraph::Builder::Create(const std::string& name, const FrameGraphTextureDesc& desc) {
+    ResourceNode resource;
+    resource.name = name;
+    resource.desc = desc;
+    m_graph.m_resources.push_back(resource);
+    return static_cast<Handle>(m_graph.m_resources.size()) - 1;
+}
+
+FrameGraph::Handle FrameGraph::Builder::Read(Handle resource, FrameGraphAccess access) {
+    m_graph.m_passes[m_pass].reads.push_back({ resource, access });
+    m_graph.m_resources[resource].readers.push_back(m_pass);
+    return resource;
+}
+
+FrameGraph::Handle FrameGraph::Builder::Write(Handle resource, FrameGraphAccess access) {
+    m_graph.m_passes[m_pass].writes.push_back({ resource, access });
+    m_graph.m_resources[resource].writers.push_back(m_pass);
+    return resource;
+}
+
+void FrameGraph::Builder::SetSideEffect() {
+    m_graph.m_passes[m_pass].sideEffect = true;
+}
+
+GLuint FrameGraph::Resources::GetTexture(Handle resource) const {
+    const ResourceNode& node = m_graph.m_resources[resource];
+    if (node.imported) {
+        return node.importedFramebuffer ? 0 : node.importedObject;
+    }
+    return node.physical >= 0 ? m_graph.m_physicals[node.physical].object : 0;
+}
+
+// FrameGraph
+FrameGraph::FrameGraph()
+    : m_compiled(false), m_frame(0), m_timerFrame(0) {
+}
+
+FrameGraph::~FrameGraph() {
+    Shutdown();
+}
+
+void FrameGraph::Reset() {
+    m_resources.clear();
+    m_passes.clear();
+    m_order.clear();
+    m_compiled = false;
+}
+
+FrameGraph::Handle FrameGraph::ImportFramebuffer(const std::string& name, GLuint framebuffer, int width, int height) {
+    ResourceNode resource;
+    resource.name = name;
+    resource.desc.width = width;
+    resource.desc.height = height;
+    resource.imported = true;
+    resource.importedFramebuffer = true;
+    resource.importedObject = framebuffer;
+    m_resources.push_back(resource);
+    return static_cast<Handle>(m_resources.size()) - 1;
+}
+
+FrameGraph::Handle FrameGraph::ImportTexture(const std::string& name, GLuint texture, const FrameGraphTextureDesc& desc) {
+    ResourceNode resource;
+    resource.name = name;
+    resource.desc = desc;
+    resource.imported = true;
+    resource.importedObject = texture;
+    m_resources.push_back(resource);
+    return static_cast<Handle>(m_resources.size()) - 1;
+}
+
+void FrameGraph::AddPass(const std::string& name, const SetupFunc& setup, const ExecuteFunc& execute) {
+    PassNode pass;
+    pass.name = name;
+    pass.execute = execute;
+    m_passes.push_back(pass);
+
+    Builder builder(*this, static_cast<int>(m_passes.size()) - 1);
+    setup(builder);
+}
+
+void FrameGraph::Compile() {
+    CullPasses();
+    SortPasses();
+    AllocateResources();
+    ComputeBarriers();
+    ReleaseIdlePhysicals();
+    m_compiled = true;
+}
+
+// Reference counting from the outputs back: a pass survives if something it
+// writes is read by a surviving pass, is imported (visible outside the frame),
+// or it was flagged as having side effects
+void FrameGraph::CullPasses() {
+    for (PassNode& pass : m_passes) {
+        pass.refCount = static_cast<int>(pass.writes.size()) + (pass.sideEffect ? 1 : 0);
+        pass.culled = false;
+    }
+
+    std::vector<int> unused;
+    for (size_t i = 0; i < m_resources.size(); ++i) {
+        ResourceNode& resource = m_resources[i];
+        resource.refCount = static_cast<int>(resource.readers.size()) + (resource.imported ? 1 : 0);
+        if (resource.refCount == 0) {
+            unused.push_back(static_cast<int>(i));
+        }
+    }
+
+    auto cull = [&](PassNode& pass) {
+        pass.culled = true;
+        for (const auto& read : pass.reads) {
+            if (--m_resources[read.first].refCount == 0) {
+                unused.push_back(read.first);
+            }
+        }
+    };
+
+    for (PassNode& pass : m_passes) {
+        if (pass.refCount == 0) {
+            cull(pass);
+        }
+    }
+
+    while (!unused.empty()) {
+        int resource = unused.back();
+        unused.pop_back();
+        for (int writer : m_resources[resource].writers) {
+            PassNode& pass = m_passes[writer];
+            if (!pass.culled && --pass.refCount == 0) {
+                cull(pass);
+            }
+        }
+    }
+}
+
+// Dependencies follow declaration order per resource: a read waits for the last
+// write, a write waits for the last write and every read since. Passes are then
+// sorted topologically, preferring declaration order among ready passes.
+void FrameGraph::SortPasses() {
+    const int passCount = static_cast<int>(m_passes.size());
+    std::vector<int> lastWriter(m_resources.size(), -1);
+    std::vector<std::vector<int>> readersSinceWrite(m_resources.size());
+
+    for (int i = 0; i < passCount; ++i) {
+        PassNode& pass = m_passes[i];
+        pass.dependencies.clear();
+        if (pass.culled) {
+            continue;
+        }
+        for (const auto& read : pass.reads) {
+            if (lastWriter[read.first] >= 0) {
+                pass.dependencies.push_back(lastWriter[read.first]);
+            }
+        }
+        for (const auto& write : pass.writes) {
+            if (lastWriter[write.first] >= 0) {
+                pass.dependencies.push_back(lastWriter[write.first]);
+            }
+            for (int reader : readersSinceWrite[write.first]) {
+                if (reader != i) {
+                    pass.dependencies.push_back(reader);
+                }
+            }
+        }
+        for (const auto& read : pass.reads) {
+            readersSinceWrite[read.first].push_back(i);
+        }
+        for (const auto& write : pass.writes) {
+            lastWriter[write.first] = i;
+            readersSinceWrite[write.first].clear();
+        }
+
+        std::sort(pass.dependencies.begin(), pass.dependencies.end());
+        pass.dependencies.erase(std::unique(pass.dependencies.begin(), pass.dependencies.end()), pass.dependencies.end());
+    }
+
+    std::vector<int> pending(passCount, 0);
+    std::vector<std::vector<int>> dependents(passCount);
+    for (int i = 0; i < passCount; ++i) {
+        for (int dependency : m_passes[i].dependencies) {
+            ++pending[i];
+            dependents[dependency].push_back(i);
+        }
+    }
+
+    std::priority_queue<int, std::vector<int>, std::greater<int>> ready;
+    for (int i = 0; i < passCount; ++i) {
+        if (!m_passes[i].culled && pending[i] == 0) {
+            ready.push(i);
+        }
+    }
+
+    m_order.clear();
+    while (!ready.empty()) {
+        int pass = ready.top();
+        ready.pop();
+        m_order.push_back(pass);
+        for (int dependent : dependents[pass]) {
+            if (--pending[dependent] == 0) {
+                ready.push(dependent);
+            }
+        }
+    }
+}
+
+// Transients get a lifetime [first use, last use] in execution order and are
+// packed greedily onto physical objects of the same description whose previous
+// owner has already finished
+void FrameGraph::AllocateResources() {
+    for (ResourceNode& resource : m_resources) {
+        resource.firstUse = -1;
+        resource.lastUse = -1;
+        resource.physical = -1;
+    }
+
+    for (int index = 0; index < static_cast<int>(m_order.size()); ++index) {
+        const PassNode& pass = m_passes[m_order[index]];
+        auto touch = [&](int handle) {
+            ResourceNode& resource = m_resources[handle];
+            if (resource.firstUse < 0) {
+                resource.firstUse = index;
+            }
+            resource.lastUse = index;
+        };
+        for (const auto& read : pass.reads) {
+            touch(read.first);
+        }
+        for (const auto& write : pass.writes) {
+            touch(write.first);
+        }
+    }
+
+    for (PhysicalResource& physical : m_physicals) {
+        physical.busyUntil = -1;
+    }
+
+    for (int index = 0; index < static_cast<int>(m_order.size()); ++index) {
+        for (size_t handle = 0; handle < m_resources.size(); ++handle) {
+            ResourceNode& resource = m_resources[handle];
+            if (resource.imported || resource.firstUse != index) {
+                continue;
+            }
+
+            for (size_t i = 0; i < m_physicals.size(); ++i) {
+                PhysicalResource& physical = m_physicals[i];
+                if (physical.busyUntil < index && physical.desc == resource.desc) {
+                    resource.physical = static_cast<int>(i);
+                    break;
+                }
+            }
+
+            if (resource.physical < 0) {
+                PhysicalResource physical;
+                physical.desc = resource.desc;
+                GLenum format, type;
+                TransferFormat(resource.desc.format, format, type);
+                if (resource.desc.renderbuffer) {
+                    glGenRenderbuffers(1, &physical.object);
+                    glBindRenderbuffer(GL_RENDERBUFFER, physical.object);
+                    glRenderbufferStorage(GL_RENDERBUFFER, resource.desc.format, resource.desc.width, resource.desc.height);
+                    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+                } else {
+                    glGenTextures(1, &physical.object);
+                    glBindTexture(GL_TEXTURE_2D, physical.object);
+                    glTexImage2D(GL_TEXTURE_2D, 0, resource.desc.format, resource.desc.width, resource.desc.height, 0, format, type, nullptr);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                    glBindTexture(GL_TEXTURE_2D, 0);
+                }
+                m_physicals.push_back(physical);
+                resource.physical = static_cast<int>(m_physicals.size()) - 1;
+            }
+
+            m_physicals[resource.physical].busyUntil = resource.lastUse;
+            m_physicals[resource.physical].lastFrame = m_frame;
+        }
+    }
+}
+
+// GL orders attachment writes and later texture fetches on its own; only
+// incoherent storage writes (image load/store, SSBOs) need explicit barriers
+void FrameGraph::ComputeBarriers() {
+    std::vector<bool> storageWritten(m_resources.size(), false);
+    for (int passIndex : m_order) {
+        PassNode& pass = m_passes[passIndex];
+        pass.barriers = 0;
+        auto check = [&](const std::pair<int, FrameGraphAccess>& access) {
+            if (storageWritten[access.first]) {
+                pass.barriers |= BarrierFor(access.second);
+                storageWritten[access.first] = false;
+            }
+        };
+        for (const auto& read : pass.reads) {
+            check(read);
+        }
+        for (const auto& write : pass.writes) {
+            check(write);
+        }
+        for (const auto& write : pass.writes) {
+            if (write.second == FrameGraphAccess::Storage) {
+                storageWritten[write.first] = true;
+            }
+        }
+    }
+}
+
+void FrameGraph::ReleaseIdlePhysicals() {
+    bool released = false;
+    for (size_t i = 0; i < m_physicals.size(); ++i) {
+        if (m_frame - m_physicals[i].lastFrame > kPhysicalIdleFrames) {
+            if (m_physicals[i].desc.renderbuffer) {
+                glDeleteRenderbuffers(1, &m_physicals[i].object);
+            } else {
+                glDeleteTextures(1, &m_physicals[i].object);
+            }
+            m_physicals[i].object = 0;
+            released = true;
+        }
+    }
+    if (!released) {
+        return;
+    }
+
+    // Compact, remapping this frame's assignments
+    std::vector<int> remap(m_physicals.size(), -1);
+    std::vector<PhysicalResource> kept;
+    for (size_t i = 0; i < m_physicals.size(); ++i) {
+        if (m_physicals[i].object != 0) {
+            remap[i] = static_cast<int>(kept.size());
+            kept.push_back(m_physicals[i]);
+        }
+    }
+    m_physicals.swap(kept);
+    for (ResourceNode& resource : m_resources) {
+        if (resource.physical >= 0) {
+            resource.physical = remap[resource.physical];
+        }
+    }
+    DestroyFramebuffers();
+}
+
+// Framebuffer for a pass: the imported target it renders to, or a cached FBO
+// built from its transient attachments
+GLuint FrameGraph::GetPassFramebuffer(const PassNode& pass, int& width, int& height) {
+    std::vector<GLuint> key;
+    std::vector<const ResourceNode*> attachments;
+    for (const auto& write : pass.writes) {
+        if (write.second != FrameGraphAccess::Attachment) {
+            continue;
+        }
+        const ResourceNode& resource = m_resources[write.first];
+        width = resource.desc.width;
+        height = resource.desc.height;
+        if (resource.importedFramebuffer) {
+            return resource.importedObject;
+        }
+        attachments.push_back(&resource);
+        key.push_back(resource.imported ? resource.importedObject : m_physicals[resource.physical].object);
+    }
+    if (attachments.empty()) {
+        return static_cast<GLuint>(-1);
+    }
+
+    auto found = m_framebuffers.find(key);
+    if (found != m_framebuffers.end()) {
+        return found->second;
+    }
+
+    GLuint framebuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    std::vector<GLenum> drawBuffers;
+    for (size_t i = 0; i < attachments.size(); ++i) {
+        const ResourceNode& resource = *attachments[i];
+        GLenum attachment;
+        if (resource.desc.format == GL_DEPTH24_STENCIL8) {
+            attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+        } else if (IsDepthFormat(resource.desc.format)) {
+            attachment = GL_DEPTH_ATTACHMENT;
+        } else {
+            attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(drawBuffers.size());
+            drawBuffers.push_back(attachment);
+        }
+
+        if (resource.desc.renderbuffer) {
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, key[i]);
+        } else {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, key[i], 0);
+        }
+    }
+    if (drawBuffers.empty()) {
+        glDrawBuffer(GL_NONE);
+    } else {
+        glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+    }
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR::FRAMEGRAPH::FRAMEBUFFER_INCOMPLETE " << pass.name << std::endl;
+    }
+
+    m_framebuffers[key] = framebuffer;
+    return framebuffer;
+}
+
+void FrameGraph::Execute() {
+    if (!m_compiled) {
+        Compile();
+    }
+
+    const bool memoryBarriers = GLAD_GL_VERSION_4_2 && glMemoryBarrier != nullptr;
+    const int slot = m_timerFrame % kTimerFrames;
+
+    // Collect the results from kTimerFrames ago without stalling. The frame's
+    // total only counts when every pass it ran has finished.
+    double frameGpuMs = 0.0;
+    bool frameIssued = false, frameComplete = true;
+    for (auto& entry : m_timers) {
+        TimerQueries& timer = entry.second;
+        if (!timer.issued[slot]) {
+            continue;
+        }
+        timer.issued[slot] = false;
+        frameIssued = true;
+        GLint available = 0;
+        glGetQueryObjectiv(timer.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            frameComplete = false;
+            continue;
+        }
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(timer.queries[slot], GL_QUERY_RESULT, &elapsed);
+        m_timings[entry.first].gpuMs = elapsed / 1.0e6;
+        frameGpuMs += elapsed / 1.0e6;
+    }
+    if (frameIssued && frameComplete) {
+        m_frameTiming.frame = m_timerFrameNumbers[slot];
+        m_frameTiming.gpuMs = frameGpuMs;
+        m_frameTiming.valid = true;
+    }
+    m_timerFrameNumbers[slot] = m_frame;
+
+    for (int passIndex : m_order) {
+        PassNode& pass = m_passes[passIndex];
+        TimerQueries& timer = m_timers[pass.name];
+        if (timer.queries[0] == 0) {
+            glGenQueries(kTimerFrames, timer.queries);
+        }
+
+        if (pass.barriers != 0 && memoryBarriers) {
+            glMemoryBarrier(pass.barriers);
+        }
+
+        int width = 0, height = 0;
+        GLuint framebuffer = GetPassFramebuffer(pass, width, height);
+        if (framebuffer != static_cast<GLuint>(-1)) {
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+            glViewport(0, 0, width, height);
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        glBeginQuery(GL_TIME_ELAPSED, timer.queries[slot]);
+        pass.execute(Resources(*this, framebuffer == static_cast<GLuint>(-1) ? 0 : framebuffer));
+        glEndQuery(GL_TIME_ELAPSED);
+        timer.issued[slot] = true;
+        m_timings[pass.name].cpuMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    ++m_timerFrame;
+    ++m_frame;
+}
+
+void FrameGraph::Shutdown() {
+    DestroyFramebuffers();
+    for (PhysicalResource& physical : m_physicals) {
+        if (physical.desc.renderbuffer) {
+            glDeleteRenderbuffers(1, &physical.object);
+        } else {
+            glDeleteTextures(1, &physical.object);
+        }
+    }
+    m_physicals.clear();
+    for (auto& entry : m_timers) {
+        if (entry.second.queries[0] != 0) {
+            glDeleteQueries(kTimerFrames, entry.second.queries);
+        }
+    }
+    m_timers.clear();
+    m_timings.clear();
+    m_frameTiming = FrameTiming();
+    Reset();
+}
+
+void FrameGraph::DestroyFramebuffers() {
+    for (auto& entry : m_framebuffers) {
+        glDeleteFramebuffers(1, &entry.second);
+    }
+    m_framebuffers.clear();
+}
+
+size_t FrameGraph::BytesPerPixel(GLenum format) {
+    switch (format) {
+    case GL_R8: return 1;
+    case GL_R16F: return 2;
+    case GL_RGBA16F:
+    case GL_RG32F: return 8;
+    case GL_RGBA32F: return 16;
+    default: return 4;
+    }
+}
+
+bool FrameGraph::IsDepthFormat(GLenum format) {
+    return format == GL_DEPTH_COMPONENT24 || format == GL_DEPTH_COMPONENT32F || format == GL_DEPTH24_STENCIL8;
+}
+
+size_t FrameGraph::GetTransientBytes() const {
+    size_t bytes = 0;
+    for (const ResourceNode& resource : m_resources) {
+        if (!resource.imported && resource.physical >= 0) {
+            bytes += static_cast<size_t>(resource.desc.width) * resource.desc.height * BytesPerPixel(resource.desc.format);
+        }
+    }
+    return bytes;
+}
+
+size_t FrameGraph::GetAllocatedBytes() const {
+    size_t bytes = 0;
+    for (const PhysicalResource& physical : m_physicals) {
+        bytes += static_cast<size_t>(physical.desc.width) * physical.desc.height * BytesPerPixel(physical.desc.format);
+    }
+    return bytes;
+}
+
+std::string FrameGraph::Dump() const {
+    std::ostringstream out;
+    out << "Frame graph: " << m_order.size() << "/" << m_passes.size() << " passes, "
+        << m_resources.size() << " resources, transients " << GetTransientBytes() / 1024 << " KiB"
+        << " in " << GetAllocatedBytes() / 1024 << " KiB allocated" << std::endl;
+
+    for (size_t index = 0; index < m_order.size(); ++index) {
+        const PassNode& pass = m_passes[m_order[index]];
+        out << "  [" << index << "] " << pass.name;
+        auto timing = m_timings.find(pass.name);
+        if (timing != m_timings.end()) {
+            out << "  cpu " << timing->second.cpuMs << " ms, gpu " << timing->second.gpuMs << " ms";
+        }
+        out << std::endl;
+        for (const auto& read : pass.reads) {
+            out << "      read  " << m_resources[read.first].name << " (" << AccessName(read.second) << ")" << std::endl;
+        }
+        for (const auto& write : pass.writes) {
+            out << "      write " << m_resources[write.first].name << " (" << AccessName(write.second) << ")" << std::endl;
+        }
+        if (pass.barriers != 0) {
+            out << "      barrier 0x" << std::hex << pass.barriers << std::dec << std::endl;
+        }
+    }
+
+    for (const PassNode& pass : m_passes) {
+        if (pass.culled) {
+            out << "  culled " << pass.name << std::endl;
+        }
+    }
+
+    for (const ResourceNode& resource : m_resources) {
+        out << "  " << resource.name;
+        if (resource.imported) {
+            out << " imported";
+        } else if (resource.physical >= 0) {
+            out << " " << resource.desc.width << "x" << resource.desc.height
+                << " -> physical #" << resource.physical << " [" << resource.firstUse << ", " << resource.lastUse << "]";
+        } else {
+            out << " unused";
+        }
+        out << std::endl;
+    }
+    return out.str();
+}
+
+std::string FrameGraph::DumpGraphviz() const {
+    std::ostringstream out;
+    out << "digraph FrameGraph {" << std::endl;
+    out << "  rankdir=LR;" << std::endl;
+    for (size_t i = 0; i < m_passes.size(); ++i) {
+        const PassNode& pass = m_passes[i];
+        out << "  p" << i << " [shape=box, label=\"" << pass.name << "\"" << (pass.culled ? ", style=dashed" : "") << "];" << std::endl;
+    }
+    for (size_t i = 0; i < m_resources.size(); ++i) {
+        const ResourceNode& resource = m_resources[i];
+        out << "  r" << i << " [shape=ellipse, label=\"" << resource.name << "\"" << (resource.imported ? ", style=bold" : "") << "];" << std::endl;
+    }
+    for (size_t i = 0; i < m_passes.size(); ++i) {
+        for (const auto& read : m_passes[i].reads) {
+            out << "  r" << read.first << " -> p" << i << ";" << std::endl;
+        }
+        for (const auto& write : m_passes[i].writes) {
+            out << "  p" << i << " -> r" << write.first << ";" << std::endl;
+        }
+    }
+    out << "}" << std::endl;
+    return out.str();
+}
@@ -0,0 +1,407 @@
+#include "FrameRecorder.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// PNG pieces: CRC-32 for chunks and Adler-32 for the zlib stream
+uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    static uint32_t table[256] = {};
+    static bool initialized = false;
+    if (!initialized) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        initialized = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void PutBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void PutChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+    PutBigEndian(out, static_cast<uint32_t>(data.size()));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    PutBigEndian(out, Crc32(out.data() + start, out.size() - start));
+}
+
+// Uncompressed (stored) deflate: the encoder thread stays cheap and
+// predictable, and the files are still valid PNGs for any viewer
+void EncodePNG(const std::vector<uint8_t>& rgba, int width, int height, std::vector<uint8_t>& out) {
+    std::vector<uint8_t> scanlines;
+    scanlines.reserve(static_cast<size_t>(width * 3 + 1) * height);
+    for (int y = height - 1; y >= 0; --y) {
+        scanlines.push_back(0);  // No filter
+        const uint8_t* row = rgba.data() + static_cast<size_t>(y) * width * 4;
+        for (int x = 0; x < width; ++x) {
+            scanlines.insert(scanlines.end(), row + x * 4, row + x * 4 + 3);
+        }
+    }
+
+    std::vector<uint8_t> zlib = { 0x78, 0x01 };
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : scanlines) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    size_t offset = 0;
+    do {
+        size_t length = std::min<size_t>(scanlines.size() - offset, 65535);
+        bool last = offset + length == scanlines.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(static_cast<uint8_t>(length));
+        zlib.push_back(static_cast<uint8_t>(length >> 8));
+        zlib.push_back(static_cast<uint8_t>(~length));
+        zlib.push_back(static_cast<uint8_t>(~length >> 8));
+        zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + length);
+        offset += length;
+    } while (offset < scanlines.size());
+    PutBigEndian(zlib, (b << 16) | a);
+
+    static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.assign(signature, signature + sizeof(signature));
+    std::vector<uint8_t> header;
+    PutBigEndian(header, static_cast<uint32_t>(width));
+    PutBigEndian(header, static_cast<uint32_t>(height));
+    header.insert(header.end(), { 8, 2, 0, 0, 0 });  // 8-bit RGB
+    PutChunk(out, "IHDR", header);
+    PutChunk(out, "IDAT", zlib);
+    PutChunk(out, "IEND", {});
+}
+
+// Limited-range (16-235 luma, 16-240 chroma) BT.601 4:2:0, which is what
+// players assume for Y4M. Chroma is averaged over each 2x2 block.
+void EncodeY4MFrame(const std::vector<uint8_t>& rgba, int width, int height, std::vector<uint8_t>& out) {
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    static const char marker[] = "FRAME\n";
+    out.assign(marker, marker + 6);
+    out.resize(6 + static_cast<size_t>(width) * height + 2 * static_cast<size_t>(chromaWidth) * chromaHeight);
+    uint8_t* yPlane = out.data() + 6;
+    uint8_t* uPlane = yPlane + static_cast<size_t>(width) * height;
+    uint8_t* vPlane = uPlane + static_cast<size_t>(chromaWidth) * chromaHeight;
+
+    auto pixel = [&](int x, int y) {
+        // Source rows are bottom first
+        return rgba.data() + (static_cast<size_t>(height - 1 - y) * width + x) * 4;
+    };
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* p = pixel(x, y);
+            yPlane[y * width + x] = static_cast<uint8_t>((66 * p[0] + 129 * p[1] + 25 * p[2] + 4224) >> 8);
+        }
+    }
+    for (int cy = 0; cy < chromaHeight; ++cy) {
+        for (int cx = 0; cx < chromaWidth; ++cx) {
+            int r = 0, g = 0, b = 0, count = 0;
+            for (int dy = 0; dy < 2; ++dy) {
+                for (int dx = 0; dx < 2; ++dx) {
+                    int x = std::min(cx * 2 + dx, width - 1);
+                    int y = std::min(cy * 2 + dy, height - 1);
+                    const uint8_t* p = pixel(x, y);
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                    ++count;
+                }
+            }
+            r /= count;
+            g /= count;
+            b /= count;
+            uPlane[cy * chromaWidth + cx] = static_cast<uint8_t>((-38 * r - 74 * g + 112 * b + 32896) >> 8);
+            vPlane[cy * chromaWidth + cx] = static_cast<uint8_t>((112 * r - 94 * g - 18 * b + 32896) >> 8);
+        }
+    }
+}
+
+void EncodeRaw(const std::vector<uint8_t>& rgba, int width, int height, std::vector<uint8_t>& out) {
+    out.resize(static_cast<size_t>(width) * height * 3);
+    uint8_t* dst = out.data();
+    for (int y = height - 1; y >= 0; --y) {
+        const uint8_t* row = rgba.data() + static_cast<size_t>(y) * width * 4;
+        for (int x = 0; x < width; ++x) {
+            *dst++ = row[x * 4 + 0];
+            *dst++ = row[x * 4 + 1];
+            *dst++ = row[x * 4 + 2];
+        }
+    }
+}
+
+bool EndsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+FrameRecorder::FrameRecorder()
+    : m_recording(false), m_format(RecordFormat::Y4M), m_width(0), m_height(0), m_fps(60),
+      m_readSlot(0), m_inFlight(0), m_frameIndex(0), m_stopping(false), m_totalLatencyMs(0.0) {
+}
+
+FrameRecorder::~FrameRecorder() {
+    Stop();
+}
+
+RecordFormat FrameRecorder::FormatFromPath(const std::string& path) {
+    if (EndsWith(path, ".y4m")) {
+        return RecordFormat::Y4M;
+    }
+    if (EndsWith(path, ".png")) {
+        return RecordFormat::PNG;
+    }
+    return RecordFormat::Raw;
+}
+
+bool FrameRecorder::Start(const std::string& path, int width, int height, int fps, size_t maxQueuedFrames) {
+    if (m_recording) {
+        Stop();
+    }
+    if (width <= 0 || height <= 0) {
+        std::cerr << "ERROR::FRAME_RECORDER::INVALID_SIZE" << std::endl;
+        return false;
+    }
+
+    m_format = FormatFromPath(path);
+    m_path = path;
+    m_width = width;
+    m_height = height;
+    m_fps = std::max(fps, 1);
+
+    if (m_format != RecordFormat::PNG) {
+        m_file.open(path, std::ios::binary);
+        if (!m_file.is_open()) {
+            std::cerr << "ERROR::FRAME_RECORDER::FILE_NOT_WRITABLE: " << path << std::endl;
+            return false;
+        }
+        if (m_format == RecordFormat::Y4M) {
+            m_file << "YUV4MPEG2 W" << width << " H" << height << " F" << m_fps << ":1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n";
+        }
+    }
+
+    const size_t frameBytes = static_cast<size_t>(width) * height * 4;
+    for (Slot& slot : m_slots) {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // The pool bounds memory held for the encoder
+    m_framePool.clear();
+    m_freeFrames.clear();
+    m_queue.clear();
+    for (size_t i = 0; i < std::max<size_t>(maxQueuedFrames, 1); ++i) {
+        m_framePool.push_back(std::make_unique<Frame>());
+        m_framePool.back()->pixels.resize(frameBytes);
+        m_freeFrames.push_back(m_framePool.back().get());
+    }
+
+    m_readSlot = 0;
+    m_inFlight = 0;
+    m_frameIndex = 0;
+    m_stats = Stats();
+    m_totalLatencyMs = 0.0;
+    m_stopping = false;
+    m_encoder = std::thread(&FrameRecorder::EncoderLoop, this);
+    m_recording = true;
+
+    std::cout << "Recording " << width << "x" << height << " to " << path << std::endl;
+    return true;
+}
+
+void FrameRecorder::Stop() {
+    if (!m_recording) {
+        return;
+    }
+
+    // Finish what the GPU already has; this is the only place that waits
+    while (m_inFlight > 0) {
+        Slot& slot = m_slots[m_readSlot];
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        Deliver(slot, true);
+        m_readSlot = (m_readSlot + 1) % kPboCount;
+        --m_inFlight;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_queueChanged.notify_all();
+    m_encoder.join();
+    m_file.close();
+
+    for (Slot& slot : m_slots) {
+        glDeleteBuffers(1, &slot.pbo);
+        slot = Slot();
+    }
+    m_framePool.clear();
+    m_freeFrames.clear();
+    m_recording = false;
+
+    Stats stats = GetStats();
+    std::cout << "Recording stopped: " << stats.written << " frames written to " << m_path
+              << " | dropped " << stats.droppedBusy + stats.droppedQueue + stats.droppedSize
+              << " | latency avg " << stats.averageLatencyMs << " ms, max " << stats.maxLatencyMs << " ms" << std::endl;
+}
+
+void FrameRecorder::Update() {
+    if (!m_recording) {
+        return;
+    }
+
+    // Oldest first, so frames reach the encoder in order
+    while (m_inFlight > 0) {
+        Slot& slot = m_slots[m_readSlot];
+        GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        Deliver(slot, false);
+        m_readSlot = (m_readSlot + 1) % kPboCount;
+        --m_inFlight;
+    }
+}
+
+void FrameRecorder::Capture(int width, int height) {
+    if (!m_recording) {
+        return;
+    }
+    Update();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (width != m_width || height != m_height) {
+        ++m_stats.droppedSize;
+        return;
+    }
+    if (m_inFlight == kPboCount) {
+        ++m_stats.droppedBusy;
+        return;
+    }
+
+    Slot& slot = m_slots[(m_readSlot + m_inFlight) % kPboCount];
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.issued = Clock::now();
+    ++m_inFlight;
+    ++m_stats.captured;
+}
+
+// Copies a completed readback into a pool frame and queues it for encoding
+void FrameRecorder::Deliver(Slot& slot, bool wait) {
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    Frame* frame = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (wait) {
+            m_queueChanged.wait(lock, [this]() { return !m_freeFrames.empty(); });
+        }
+        if (m_freeFrames.empty()) {
+            ++m_stats.droppedQueue;
+            return;
+        }
+        frame = m_freeFrames.back();
+        m_freeFrames.pop_back();
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frame->pixels.size(), GL_MAP_READ_BIT);
+    if (pixels != nullptr) {
+        std::memcpy(frame->pixels.data(), pixels, frame->pixels.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (pixels == nullptr) {
+        m_freeFrames.push_back(frame);
+        ++m_stats.droppedQueue;
+        return;
+    }
+    frame->index = m_frameIndex++;
+    frame->issued = slot.issued;
+    m_queue.push_back(frame);
+    m_queueChanged.notify_all();
+}
+
+void FrameRecorder::EncoderLoop() {
+    for (;;) {
+        Frame* frame = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queueChanged.wait(lock, [this]() { return !m_queue.empty() || m_stopping; });
+            if (m_queue.empty()) {
+                return;
+            }
+            frame = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        bool written = Encode(*frame);
+        double latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - frame->issued).count();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (written) {
+                ++m_stats.written;
+                m_totalLatencyMs += latencyMs;
+                m_stats.maxLatencyMs = std::max(m_stats.maxLatencyMs, latencyMs);
+            }
+            m_freeFrames.push_back(frame);
+        }
+        m_queueChanged.notify_all();
+    }
+}
+
+bool FrameRecorder::Encode(const Frame& frame) {
+    switch (m_format) {
+    case RecordFormat::Y4M:
+        EncodeY4MFrame(frame.pixels, m_width, m_height, m_encodeBuffer);
+        break;
+    case RecordFormat::Raw:
+        EncodeRaw(frame.pixels, m_width, m_height, m_encodeBuffer);
+        break;
+    case RecordFormat::PNG: {
+        EncodePNG(frame.pixels, m_width, m_height, m_encodeBuffer);
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), "_%06d.png", frame.index);
+        std::string path = m_path.substr(0, m_path.size() - 4) + suffix;
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(m_encodeBuffer.data()), m_encodeBuffer.size());
+        return static_cast<bool>(file);
+    }
+    }
+
+    m_file.write(reinterpret_cast<const char*>(m_encodeBuffer.data()), m_encodeBuffer.size());
+    return static_cast<bool>(m_file);
+}
+
+FrameRecorder::Stats FrameRecorder::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.averageLatencyMs = stats.written > 0 ? m_totalLatencyMs / stats.written : 0.0;
+    stats.queuedFrames = m_queue.size();
+    return stats;
+}
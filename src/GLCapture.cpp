@@ -0,0 +1,894 @@
+#include "GLCapture.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+// Original glad entry points while the capture is installed
+struct RealFunctions {
+#define GL_CAPTURE_REAL(name) decltype(glad_gl##name) name = nullptr;
+    GL_CAPTURE_FUNCTIONS(GL_CAPTURE_REAL)
+#undef GL_CAPTURE_REAL
+};
+
+struct Mapping {
+    void* pointer;
+    GLsizeiptr length;
+    GLbitfield access;
+};
+
+struct CaptureState {
+    std::ofstream file;
+    std::vector<uint8_t> stream;
+    size_t recordStart = 0;
+
+    // State needed to tell offsets from client pointers and size pixel data
+    GLuint unpackBuffer = 0;
+    GLuint packBuffer = 0;
+    GLint unpackAlignment = 4;
+    std::map<GLenum, Mapping> mapped;
+};
+
+RealFunctions s_real;
+CaptureState s_state;
+bool s_installed = false;
+
+template <typename T>
+void Put(const T& value) {
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "only scalars are written directly");
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    s_state.stream.insert(s_state.stream.end(), bytes, bytes + sizeof(T));
+}
+
+void PutPointer(const void* pointer) {
+    Put(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer)));
+}
+
+void PutBytes(const void* data, size_t size) {
+    Put(static_cast<uint64_t>(size));
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    s_state.stream.insert(s_state.stream.end(), bytes, bytes + size);
+}
+
+// Client memory, or an offset into the buffer bound to the pixel target
+void PutData(const void* data, size_t size, GLuint boundBuffer = 0) {
+    if (boundBuffer != 0) {
+        Put(GLCaptureData::Offset);
+        PutPointer(data);
+    } else if (data == nullptr) {
+        Put(GLCaptureData::Null);
+    } else {
+        Put(GLCaptureData::Bytes);
+        PutBytes(data, size);
+    }
+}
+
+void BeginRecord(GLCaptureOp op) {
+    Put(static_cast<uint16_t>(op));
+    s_state.recordStart = s_state.stream.size();
+    Put(static_cast<uint32_t>(0));
+}
+
+void EndRecord() {
+    uint32_t size = static_cast<uint32_t>(s_state.stream.size() - s_state.recordStart - sizeof(uint32_t));
+    std::memcpy(s_state.stream.data() + s_state.recordStart, &size, sizeof(size));
+}
+
+template <typename... Args>
+void Record(GLCaptureOp op, const Args&... args) {
+    BeginRecord(op);
+    (Put(args), ...);
+    EndRecord();
+}
+
+using Op = GLCaptureOp;
+
+void APIENTRY CaptureActiveTexture(GLenum texture) {
+    Record(Op::ActiveTexture, texture);
+    s_real.ActiveTexture(texture);
+}
+
+void APIENTRY CaptureAttachShader(GLuint program, GLuint shader) {
+    Record(Op::AttachShader, program, shader);
+    s_real.AttachShader(program, shader);
+}
+
+void APIENTRY CaptureBeginQuery(GLenum target, GLuint id) {
+    Record(Op::BeginQuery, target, id);
+    s_real.BeginQuery(target, id);
+}
+
+void APIENTRY CaptureBindBuffer(GLenum target, GLuint buffer) {
+    if (target == GL_PIXEL_UNPACK_BUFFER) {
+        s_state.unpackBuffer = buffer;
+    } else if (target == GL_PIXEL_PACK_BUFFER) {
+        s_state.packBuffer = buffer;
+    }
+    Record(Op::BindBuffer, target, buffer);
+    s_real.BindBuffer(target, buffer);
+}
+
+void APIENTRY CaptureBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    Record(Op::BindBufferBase, target, index, buffer);
+    s_real.BindBufferBase(target, index, buffer);
+}
+
+void APIENTRY CaptureBindFramebuffer(GLenum target, GLuint framebuffer) {
+    Record(Op::BindFramebuffer, target, framebuffer);
+    s_real.BindFramebuffer(target, framebuffer);
+}
+
+void APIENTRY CaptureBindRenderbuffer(GLenum target, GLuint renderbuffer) {
+    Record(Op::BindRenderbuffer, target, renderbuffer);
+    s_real.BindRenderbuffer(target, renderbuffer);
+}
+
+void APIENTRY CaptureBindTexture(GLenum target, GLuint texture) {
+    Record(Op::BindTexture, target, texture);
+    s_real.BindTexture(target, texture);
+}
+
+void APIENTRY CaptureBindVertexArray(GLuint array) {
+    Record(Op::BindVertexArray, array);
+    s_real.BindVertexArray(array);
+}
+
+void APIENTRY CaptureBlendFunc(GLenum sfactor, GLenum dfactor) {
+    Record(Op::BlendFunc, sfactor, dfactor);
+    s_real.BlendFunc(sfactor, dfactor);
+}
+
+void APIENTRY CaptureBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
+    Record(Op::BlendFuncSeparate, srcRGB, dstRGB, srcAlpha, dstAlpha);
+    s_real.BlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+}
+
+void APIENTRY CaptureBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0,
+                                     GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) {
+    Record(Op::BlitFramebuffer, srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+    s_real.BlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+}
+
+void APIENTRY CaptureBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    BeginRecord(Op::BufferData);
+    Put(target);
+    Put(static_cast<int64_t>(size));
+    Put(usage);
+    PutData(data, size);
+    EndRecord();
+    s_real.BufferData(target, size, data, usage);
+}
+
+void APIENTRY CaptureBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    BeginRecord(Op::BufferSubData);
+    Put(target);
+    Put(static_cast<int64_t>(offset));
+    PutData(data, size);
+    EndRecord();
+    s_real.BufferSubData(target, offset, size, data);
+}
+
+void APIENTRY CaptureClear(GLbitfield mask) {
+    Record(Op::Clear, mask);
+    s_real.Clear(mask);
+}
+
+// Depth and stencil clear one value, color buffers four
+void APIENTRY CaptureClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat* value) {
+    BeginRecord(Op::ClearBufferfv);
+    Put(buffer);
+    Put(drawbuffer);
+    PutBytes(value, (buffer == GL_COLOR ? 4 : 1) * sizeof(GLfloat));
+    EndRecord();
+    s_real.ClearBufferfv(buffer, drawbuffer, value);
+}
+
+void APIENTRY CaptureClearBufferuiv(GLenum buffer, GLint drawbuffer, const GLuint* value) {
+    BeginRecord(Op::ClearBufferuiv);
+    Put(buffer);
+    Put(drawbuffer);
+    PutBytes(value, 4 * sizeof(GLuint));
+    EndRecord();
+    s_real.ClearBufferuiv(buffer, drawbuffer, value);
+}
+
+void APIENTRY CaptureClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    Record(Op::ClearColor, red, green, blue, alpha);
+    s_real.ClearColor(red, green, blue, alpha);
+}
+
+GLenum APIENTRY CaptureClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+    GLenum result = s_real.ClientWaitSync(sync, flags, timeout);
+    BeginRecord(Op::ClientWaitSync);
+    PutPointer(sync);
+    Put(flags);
+    Put(timeout);
+    Put(result);
+    EndRecord();
+    return result;
+}
+
+void APIENTRY CaptureColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {
+    Record(Op::ColorMask, red, green, blue, alpha);
+    s_real.ColorMask(red, green, blue, alpha);
+}
+
+void APIENTRY CaptureCompileShader(GLuint shader) {
+    Record(Op::CompileShader, shader);
+    s_real.CompileShader(shader);
+}
+
+void APIENTRY CaptureCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height,
+                                          GLint border, GLsizei imageSize, const void* data) {
+    BeginRecord(Op::CompressedTexImage2D);
+    Put(target);
+    Put(level);
+    Put(internalformat);
+    Put(width);
+    Put(height);
+    Put(border);
+    Put(imageSize);
+    PutData(data, imageSize, s_state.unpackBuffer);
+    EndRecord();
+    s_real.CompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data);
+}
+
+void APIENTRY CaptureCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset,
+                                       GLsizeiptr size) {
+    Record(Op::CopyBufferSubData, readTarget, writeTarget, static_cast<int64_t>(readOffset), static_cast<int64_t>(writeOffset),
+           static_cast<int64_t>(size));
+    s_real.CopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+}
+
+GLuint APIENTRY CaptureCreateProgram() {
+    GLuint program = s_real.CreateProgram();
+    Record(Op::CreateProgram, program);
+    return program;
+}
+
+GLuint APIENTRY CaptureCreateShader(GLenum type) {
+    GLuint shader = s_real.CreateShader(type);
+    Record(Op::CreateShader, type, shader);
+    return shader;
+}
+
+void RecordNames(GLCaptureOp op, GLsizei n, const GLuint* names) {
+    BeginRecord(op);
+    PutBytes(names, n * sizeof(GLuint));
+    EndRecord();
+}
+
+void APIENTRY CaptureDeleteBuffers(GLsizei n, const GLuint* buffers) {
+    for (GLsizei i = 0; i < n; ++i) {
+        if (buffers[i] == s_state.unpackBuffer) {
+            s_state.unpackBuffer = 0;
+        }
+        if (buffers[i] == s_state.packBuffer) {
+            s_state.packBuffer = 0;
+        }
+    }
+    RecordNames(Op::DeleteBuffers, n, buffers);
+    s_real.DeleteBuffers(n, buffers);
+}
+
+void APIENTRY CaptureDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
+    RecordNames(Op::DeleteFramebuffers, n, framebuffers);
+    s_real.DeleteFramebuffers(n, framebuffers);
+}
+
+void APIENTRY CaptureDeleteProgram(GLuint program) {
+    Record(Op::DeleteProgram, program);
+    s_real.DeleteProgram(program);
+}
+
+void APIENTRY CaptureDeleteQueries(GLsizei n, const GLuint* ids) {
+    RecordNames(Op::DeleteQueries, n, ids);
+    s_real.DeleteQueries(n, ids);
+}
+
+void APIENTRY CaptureDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
+    RecordNames(Op::DeleteRenderbuffers, n, renderbuffers);
+    s_real.DeleteRenderbuffers(n, renderbuffers);
+}
+
+void APIENTRY CaptureDeleteShader(GLuint shader) {
+    Record(Op::DeleteShader, shader);
+    s_real.DeleteShader(shader);
+}
+
+void APIENTRY CaptureDeleteSync(GLsync sync) {
+    BeginRecord(Op::DeleteSync);
+    PutPointer(sync);
+    EndRecord();
+    s_real.DeleteSync(sync);
+}
+
+void APIENTRY CaptureDeleteTextures(GLsizei n, const GLuint* textures) {
+    RecordNames(Op::DeleteTextures, n, textures);
+    s_real.DeleteTextures(n, textures);
+}
+
+void APIENTRY CaptureDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
+    RecordNames(Op::DeleteVertexArrays, n, arrays);
+    s_real.DeleteVertexArrays(n, arrays);
+}
+
+void APIENTRY CaptureDepthFunc(GLenum func) {
+    Record(Op::DepthFunc, func);
+    s_real.DepthFunc(func);
+}
+
+void APIENTRY CaptureDepthMask(GLboolean flag) {
+    Record(Op::DepthMask, flag);
+    s_real.DepthMask(flag);
+}
+
+void APIENTRY CaptureDisable(GLenum cap) {
+    Record(Op::Disable, cap);
+    s_real.Disable(cap);
+}
+
+void APIENTRY CaptureDispatchCompute(GLuint groupsX, GLuint groupsY, GLuint groupsZ) {
+    Record(Op::DispatchCompute, groupsX, groupsY, groupsZ);
+    s_real.DispatchCompute(groupsX, groupsY, groupsZ);
+}
+
+void APIENTRY CaptureDispatchComputeIndirect(GLintptr indirect) {
+    Record(Op::DispatchComputeIndirect, static_cast<int64_t>(indirect));
+    s_real.DispatchComputeIndirect(indirect);
+}
+
+void APIENTRY CaptureDrawArrays(GLenum mode, GLint first, GLsizei count) {
+    Record(Op::DrawArrays, mode, first, count);
+    s_real.DrawArrays(mode, first, count);
+}
+
+void APIENTRY CaptureDrawArraysIndirect(GLenum mode, const void* indirect) {
+    BeginRecord(Op::DrawArraysIndirect);
+    Put(mode);
+    PutPointer(indirect);
+    EndRecord();
+    s_real.DrawArraysIndirect(mode, indirect);
+}
+
+void APIENTRY CaptureDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount) {
+    Record(Op::DrawArraysInstanced, mode, first, count, instancecount);
+    s_real.DrawArraysInstanced(mode, first, count, instancecount);
+}
+
+void APIENTRY CaptureDrawBuffer(GLenum buf) {
+    Record(Op::DrawBuffer, buf);
+    s_real.DrawBuffer(buf);
+}
+
+void APIENTRY CaptureDrawBuffers(GLsizei n, const GLenum* bufs) {
+    BeginRecord(Op::DrawBuffers);
+    PutBytes(bufs, n * sizeof(GLenum));
+    EndRecord();
+    s_real.DrawBuffers(n, bufs);
+}
+
+void APIENTRY CaptureDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex) {
+    BeginRecord(Op::DrawElementsBaseVertex);
+    Put(mode);
+    Put(count);
+    Put(type);
+    PutPointer(indices);
+    Put(basevertex);
+    EndRecord();
+    s_real.DrawElementsBaseVertex(mode, count, type, indices, basevertex);
+}
+
+void APIENTRY CaptureDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices,
+                                                     GLsizei instancecount, GLint basevertex) {
+    BeginRecord(Op::DrawElementsInstancedBaseVertex);
+    Put(mode);
+    Put(count);
+    Put(type);
+    PutPointer(indices);
+    Put(instancecount);
+    Put(basevertex);
+    EndRecord();
+    s_real.DrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex);
+}
+
+void APIENTRY CaptureEnable(GLenum cap) {
+    Record(Op::Enable, cap);
+    s_real.Enable(cap);
+}
+
+void APIENTRY CaptureEnableVertexAttribArray(GLuint index) {
+    Record(Op::EnableVertexAttribArray, index);
+    s_real.EnableVertexAttribArray(index);
+}
+
+void APIENTRY CaptureEndQuery(GLenum target) {
+    Record(Op::EndQuery, target);
+    s_real.EndQuery(target);
+}
+
+GLsync APIENTRY CaptureFenceSync(GLenum condition, GLbitfield flags) {
+    GLsync sync = s_real.FenceSync(condition, flags);
+    BeginRecord(Op::FenceSync);
+    Put(condition);
+    Put(flags);
+    PutPointer(sync);
+    EndRecord();
+    return sync;
+}
+
+void APIENTRY CaptureFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer) {
+    Record(Op::FramebufferRenderbuffer, target, attachment, renderbuffertarget, renderbuffer);
+    s_real.FramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+}
+
+void APIENTRY CaptureFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) {
+    Record(Op::FramebufferTexture2D, target, attachment, textarget, texture, level);
+    s_real.FramebufferTexture2D(target, attachment, textarget, texture, level);
+}
+
+void APIENTRY CaptureFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer) {
+    Record(Op::FramebufferTextureLayer, target, attachment, texture, level, layer);
+    s_real.FramebufferTextureLayer(target, attachment, texture, level, layer);
+}
+
+// Generated names are recorded after the call so replay can map them
+void APIENTRY CaptureGenBuffers(GLsizei n, GLuint* buffers) {
+    s_real.GenBuffers(n, buffers);
+    RecordNames(Op::GenBuffers, n, buffers);
+}
+
+void APIENTRY CaptureGenFramebuffers(GLsizei n, GLuint* framebuffers) {
+    s_real.GenFramebuffers(n, framebuffers);
+    RecordNames(Op::GenFramebuffers, n, framebuffers);
+}
+
+void APIENTRY CaptureGenQueries(GLsizei n, GLuint* ids) {
+    s_real.GenQueries(n, ids);
+    RecordNames(Op::GenQueries, n, ids);
+}
+
+void APIENTRY CaptureGenRenderbuffers(GLsizei n, GLuint* renderbuffers) {
+    s_real.GenRenderbuffers(n, renderbuffers);
+    RecordNames(Op::GenRenderbuffers, n, renderbuffers);
+}
+
+void APIENTRY CaptureGenTextures(GLsizei n, GLuint* textures) {
+    s_real.GenTextures(n, textures);
+    RecordNames(Op::GenTextures, n, textures);
+}
+
+void APIENTRY CaptureGenVertexArrays(GLsizei n, GLuint* arrays) {
+    s_real.GenVertexArrays(n, arrays);
+    RecordNames(Op::GenVertexArrays, n, arrays);
+}
+
+void APIENTRY CaptureGenerateMipmap(GLenum target) {
+    Record(Op::GenerateMipmap, target);
+    s_real.GenerateMipmap(target);
+}
+
+// Query reads are kept for the stalls they cause; replay discards the results
+void APIENTRY CaptureGetQueryObjectiv(GLuint id, GLenum pname, GLint* params) {
+    Record(Op::GetQueryObjectiv, id, pname);
+    s_real.GetQueryObjectiv(id, pname, params);
+}
+
+void APIENTRY CaptureGetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params) {
+    Record(Op::GetQueryObjectuiv, id, pname);
+    s_real.GetQueryObjectuiv(id, pname, params);
+}
+
+void APIENTRY CaptureGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) {
+    Record(Op::GetQueryObjectui64v, id, pname);
+    s_real.GetQueryObjectui64v(id, pname, params);
+}
+
+GLuint APIENTRY CaptureGetUniformBlockIndex(GLuint program, const GLchar* name) {
+    GLuint index = s_real.GetUniformBlockIndex(program, name);
+    BeginRecord(Op::GetUniformBlockIndex);
+    Put(program);
+    PutBytes(name, std::strlen(name));
+    Put(index);
+    EndRecord();
+    return index;
+}
+
+GLint APIENTRY CaptureGetUniformLocation(GLuint program, const GLchar* name) {
+    GLint location = s_real.GetUniformLocation(program, name);
+    BeginRecord(Op::GetUniformLocation);
+    Put(program);
+    PutBytes(name, std::strlen(name));
+    Put(location);
+    EndRecord();
+    return location;
+}
+
+void APIENTRY CaptureLineWidth(GLfloat width) {
+    Record(Op::LineWidth, width);
+    s_real.LineWidth(width);
+}
+
+void APIENTRY CaptureLinkProgram(GLuint program) {
+    Record(Op::LinkProgram, program);
+    s_real.LinkProgram(program);
+}
+
+void* APIENTRY CaptureMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    void* pointer = s_real.MapBufferRange(target, offset, length, access);
+    s_state.mapped[target] = { pointer, length, access };
+    Record(Op::MapBufferRange, target, static_cast<int64_t>(offset), static_cast<int64_t>(length), access);
+    return pointer;
+}
+
+void APIENTRY CaptureMemoryBarrier(GLbitfield barriers) {
+    Record(Op::MemoryBarrier, barriers);
+    s_real.MemoryBarrier(barriers);
+}
+
+void APIENTRY CapturePixelStorei(GLenum pname, GLint param) {
+    if (pname == GL_UNPACK_ALIGNMENT) {
+        s_state.unpackAlignment = param;
+    }
+    Record(Op::PixelStorei, pname, param);
+    s_real.PixelStorei(pname, param);
+}
+
+void APIENTRY CapturePointSize(GLfloat size) {
+    Record(Op::PointSize, size);
+    s_real.PointSize(size);
+}
+
+void APIENTRY CapturePolygonMode(GLenum face, GLenum mode) {
+    Record(Op::PolygonMode, face, mode);
+    s_real.PolygonMode(face, mode);
+}
+
+void APIENTRY CapturePolygonOffset(GLfloat factor, GLfloat units) {
+    Record(Op::PolygonOffset, factor, units);
+    s_real.PolygonOffset(factor, units);
+}
+
+void APIENTRY CaptureQueryCounter(GLuint id, GLenum target) {
+    Record(Op::QueryCounter, id, target);
+    s_real.QueryCounter(id, target);
+}
+
+void APIENTRY CaptureReadBuffer(GLenum src) {
+    Record(Op::ReadBuffer, src);
+    s_real.ReadBuffer(src);
+}
+
+// Readback into client memory is replayed into scratch memory
+void APIENTRY CaptureReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels) {
+    BeginRecord(Op::ReadPixels);
+    Put(x);
+    Put(y);
+    Put(width);
+    Put(height);
+    Put(format);
+    Put(type);
+    Put(s_state.packBuffer != 0 ? GLCaptureData::Offset : GLCaptureData::Null);
+    PutPointer(s_state.packBuffer != 0 ? pixels : nullptr);
+    EndRecord();
+    s_real.ReadPixels(x, y, width, height, format, type, pixels);
+}
+
+void APIENTRY CaptureRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height) {
+    Record(Op::RenderbufferStorage, target, internalformat, width, height);
+    s_real.RenderbufferStorage(target, internalformat, width, height);
+}
+
+void APIENTRY CaptureShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) {
+    BeginRecord(Op::ShaderSource);
+    Put(shader);
+    Put(count);
+    for (GLsizei i = 0; i < count; ++i) {
+        size_t size = length != nullptr && length[i] >= 0 ? static_cast<size_t>(length[i]) : std::strlen(string[i]);
+        PutBytes(string[i], size);
+    }
+    EndRecord();
+    s_real.ShaderSource(shader, count, string, length);
+}
+
+void APIENTRY CaptureTexBuffer(GLenum target, GLenum internalformat, GLuint buffer) {
+    Record(Op::TexBuffer, target, internalformat, buffer);
+    s_real.TexBuffer(target, internalformat, buffer);
+}
+
+void APIENTRY CaptureTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+                                GLint border, GLenum format, GLenum type, const void* pixels) {
+    BeginRecord(Op::TexImage2D);
+    Put(target);
+    Put(level);
+    Put(internalformat);
+    Put(width);
+    Put(height);
+    Put(border);
+    Put(format);
+    Put(type);
+    PutData(pixels, GLCapture::PixelDataSize(width, height, format, type, s_state.unpackAlignment), s_state.unpackBuffer);
+    EndRecord();
+    s_real.TexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+}
+
+void APIENTRY CaptureTexImage3D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+                                GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels) {
+    BeginRecord(Op::TexImage3D);
+    Put(target);
+    Put(level);
+    Put(internalformat);
+    Put(width);
+    Put(height);
+    Put(depth);
+    Put(border);
+    Put(format);
+    Put(type);
+    PutData(pixels, GLCapture::PixelDataSize(width, height, format, type, s_state.unpackAlignment) * depth,
+            s_state.unpackBuffer);
+    EndRecord();
+    s_real.TexImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels);
+}
+
+void APIENTRY CaptureTexParameteri(GLenum target, GLenum pname, GLint param) {
+    Record(Op::TexParameteri, target, pname, param);
+    s_real.TexParameteri(target, pname, param);
+}
+
+void APIENTRY CaptureUniform1f(GLint location, GLfloat v0) {
+    Record(Op::Uniform1f, location, v0);
+    s_real.Uniform1f(location, v0);
+}
+
+void APIENTRY CaptureUniform1i(GLint location, GLint v0) {
+    Record(Op::Uniform1i, location, v0);
+    s_real.Uniform1i(location, v0);
+}
+
+void RecordUniform(GLCaptureOp op, GLint location, GLsizei count, const GLfloat* value, size_t components) {
+    BeginRecord(op);
+    Put(location);
+    Put(count);
+    PutBytes(value, count * components * sizeof(GLfloat));
+    EndRecord();
+}
+
+void APIENTRY CaptureUniform2fv(GLint location, GLsizei count, const GLfloat* value) {
+    RecordUniform(Op::Uniform2fv, location, count, value, 2);
+    s_real.Uniform2fv(location, count, value);
+}
+
+void APIENTRY CaptureUniform3fv(GLint location, GLsizei count, const GLfloat* value) {
+    RecordUniform(Op::Uniform3fv, location, count, value, 3);
+    s_real.Uniform3fv(location, count, value);
+}
+
+void APIENTRY CaptureUniformBlockBinding(GLuint program, GLuint index, GLuint binding) {
+    Record(Op::UniformBlockBinding, program, index, binding);
+    s_real.UniformBlockBinding(program, index, binding);
+}
+
+void APIENTRY CaptureUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    BeginRecord(Op::UniformMatrix4fv);
+    Put(location);
+    Put(count);
+    Put(transpose);
+    PutBytes(value, count * 16 * sizeof(GLfloat));
+    EndRecord();
+    s_real.UniformMatrix4fv(location, count, transpose, value);
+}
+
+// Whatever was written through the mapping is recorded before it goes away
+GLboolean APIENTRY CaptureUnmapBuffer(GLenum target) {
+    BeginRecord(Op::UnmapBuffer);
+    Put(target);
+    auto found = s_state.mapped.find(target);
+    if (found != s_state.mapped.end() && (found->second.access & GL_MAP_WRITE_BIT) != 0) {
+        PutData(found->second.pointer, found->second.length);
+    } else {
+        Put(GLCaptureData::Null);
+    }
+    EndRecord();
+    if (found != s_state.mapped.end()) {
+        s_state.mapped.erase(found);
+    }
+    return s_real.UnmapBuffer(target);
+}
+
+void APIENTRY CaptureUseProgram(GLuint program) {
+    Record(Op::UseProgram, program);
+    s_real.UseProgram(program);
+}
+
+void APIENTRY CaptureVertexAttribDivisor(GLuint index, GLuint divisor) {
+    Record(Op::VertexAttribDivisor, index, divisor);
+    s_real.VertexAttribDivisor(index, divisor);
+}
+
+void APIENTRY CaptureVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) {
+    BeginRecord(Op::VertexAttribIPointer);
+    Put(index);
+    Put(size);
+    Put(type);
+    Put(stride);
+    PutPointer(pointer);
+    EndRecord();
+    s_real.VertexAttribIPointer(index, size, type, stride, pointer);
+}
+
+void APIENTRY CaptureVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) {
+    BeginRecord(Op::VertexAttribPointer);
+    Put(index);
+    Put(size);
+    Put(type);
+    Put(normalized);
+    Put(stride);
+    PutPointer(pointer);
+    EndRecord();
+    s_real.VertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+void APIENTRY CaptureViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    Record(Op::Viewport, x, y, width, height);
+    s_real.Viewport(x, y, width, height);
+}
+
+void APIENTRY CaptureViewportArrayv(GLuint first, GLsizei count, const GLfloat* v) {
+    BeginRecord(Op::ViewportArrayv);
+    Put(first);
+    Put(count);
+    PutBytes(v, count * 4 * sizeof(GLfloat));
+    EndRecord();
+    s_real.ViewportArrayv(first, count, v);
+}
+
+double Now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+GLCapture::GLCapture() : m_active(false), m_frame(0), m_frameCount(0), m_startTime(0.0), m_bytesWritten(0) {
+}
+
+GLCapture::~GLCapture() {
+    Stop();
+}
+
+bool GLCapture::Begin(const std::string& path, int frameCount, int width, int height) {
+    if (s_installed) {
+        std::cerr << "ERROR::GL_CAPTURE::ALREADY_ACTIVE" << std::endl;
+        return false;
+    }
+
+    s_state = CaptureState();
+    s_state.file.open(path, std::ios::binary);
+    if (!s_state.file.is_open()) {
+        std::cerr << "ERROR::GL_CAPTURE::FILE_NOT_WRITABLE: " << path << std::endl;
+        return false;
+    }
+
+    GLCaptureHeader header;
+    header.width = width;
+    header.height = height;
+    s_state.file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Entry points the driver lacks stay null
+#define GL_CAPTURE_INSTALL(name) \
+    s_real.name = glad_gl##name; \
+    if (glad_gl##name != nullptr) { glad_gl##name = Capture##name; }
+    GL_CAPTURE_FUNCTIONS(GL_CAPTURE_INSTALL)
+#undef GL_CAPTURE_INSTALL
+    s_installed = true;
+
+    m_active = true;
+    m_frame = 0;
+    m_frameCount = std::max(frameCount, 1);
+    m_startTime = Now();
+    m_bytesWritten = sizeof(header);
+    m_path = path;
+    std::cout << "GL capture: recording " << m_frameCount << " frames to " << path << std::endl;
+    return true;
+}
+
+void GLCapture::Stop() {
+    if (!m_active) {
+        return;
+    }
+
+    // Only restore entry points that still point at the capture layer
+#define GL_CAPTURE_UNINSTALL(name) \
+    if (glad_gl##name == Capture##name) { glad_gl##name = s_real.name; }
+    GL_CAPTURE_FUNCTIONS(GL_CAPTURE_UNINSTALL)
+#undef GL_CAPTURE_UNINSTALL
+    s_installed = false;
+
+    s_state.file.write(reinterpret_cast<const char*>(s_state.stream.data()), s_state.stream.size());
+    m_bytesWritten += s_state.stream.size();
+    s_state.file.close();
+    s_state = CaptureState();
+    m_active = false;
+
+    std::cout << "GL capture: " << m_frame << " frames, " << m_bytesWritten / 1024 << " KiB written to " << m_path << std::endl;
+}
+
+void GLCapture::BeginFrame(double time, double deltaTime) {
+    if (m_active) {
+        Record(Op::FrameBegin, static_cast<int32_t>(m_frame), time, deltaTime);
+    }
+}
+
+void GLCapture::EndFrame() {
+    if (!m_active) {
+        return;
+    }
+
+    Record(Op::FrameEnd);
+    s_state.file.write(reinterpret_cast<const char*>(s_state.stream.data()), s_state.stream.size());
+    m_bytesWritten += s_state.stream.size();
+    s_state.stream.clear();
+
+    if (++m_frame >= m_frameCount) {
+        Stop();
+    }
+}
+
+void GLCapture::RecordInput(GLCaptureInputType type, int a, int b, double x, double y) {
+    if (m_active) {
+        Record(Op::Input, type, Now() - m_startTime, static_cast<int32_t>(a), static_cast<int32_t>(b), x, y);
+    }
+}
+
+const char* GLCapture::GetOpName(GLCaptureOp op) {
+    static const char* const names[] = {
+        "FrameBegin", "FrameEnd", "Input",
+#define GL_CAPTURE_NAME(name) "gl" #name,
+        GL_CAPTURE_FUNCTIONS(GL_CAPTURE_NAME)
+#undef GL_CAPTURE_NAME
+    };
+    size_t index = static_cast<size_t>(op);
+    return index < static_cast<size_t>(GLCaptureOp::Count) ? names[index] : "Unknown";
+}
+
+size_t GLCapture::PixelDataSize(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint alignment) {
+    size_t components = 4;
+    switch (format) {
+    case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX: case GL_DEPTH_STENCIL:
+        components = 1;
+        break;
+    case GL_RG: case GL_RG_INTEGER:
+        components = 2;
+        break;
+    case GL_RGB: case GL_BGR: case GL_RGB_INTEGER:
+        components = 3;
+        break;
+    default:
+        break;
+    }
+
+    size_t componentSize = 1;
+    switch (type) {
+    case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+        componentSize = 2;
+        break;
+    case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT:
+        componentSize = 4;
+        break;
+    case GL_UNSIGNED_INT_24_8: case GL_UNSIGNED_INT_8_8_8_8: case GL_UNSIGNED_INT_2_10_10_10_REV:
+        components = 1;
+        componentSize = 4;
+        break;
+    default:
+        break;
+    }
+
+    size_t align = alignment > 0 ? static_cast<size_t>(alignment) : 1;
+    size_t row = (width * components * componentSize + align - 1) / align * align;
+    return row * height;
+}
@@ -0,0 +1,1023 @@
+#include "GLReplay.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+double Now() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Bounds-checked view over one record's payload
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_offset(0), m_failed(false) {}
+
+    template <typename T>
+    T Get() {
+        T value{};
+        if (m_offset + sizeof(T) > m_size) {
+            m_failed = true;
+            return value;
+        }
+        std::memcpy(&value, m_data + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return value;
+    }
+
+    const uint8_t* GetBytes(uint64_t& size) {
+        size = Get<uint64_t>();
+        if (m_failed || m_offset + size > m_size) {
+            m_failed = true;
+            size = 0;
+            return nullptr;
+        }
+        const uint8_t* bytes = m_data + m_offset;
+        m_offset += size;
+        return bytes;
+    }
+
+    // Pixel or buffer data: null, an offset into a bound buffer, or inline bytes
+    const void* GetData() {
+        GLCaptureData kind = Get<GLCaptureData>();
+        if (kind == GLCaptureData::Offset) {
+            return reinterpret_cast<const void*>(static_cast<uintptr_t>(Get<uint64_t>()));
+        }
+        if (kind == GLCaptureData::Bytes) {
+            uint64_t size = 0;
+            return GetBytes(size);
+        }
+        return nullptr;
+    }
+
+    std::vector<GLuint> GetNames() {
+        uint64_t size = 0;
+        const uint8_t* bytes = GetBytes(size);
+        std::vector<GLuint> names(size / sizeof(GLuint));
+        if (bytes != nullptr && !names.empty()) {
+            std::memcpy(names.data(), bytes, names.size() * sizeof(GLuint));
+        }
+        return names;
+    }
+
+    bool Failed() const { return m_failed; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset;
+    bool m_failed;
+};
+
+std::vector<GLuint> MapNames(const std::unordered_map<GLuint, GLuint>& names, const std::vector<GLuint>& recorded) {
+    std::vector<GLuint> mapped(recorded.size());
+    for (size_t i = 0; i < recorded.size(); ++i) {
+        auto found = names.find(recorded[i]);
+        mapped[i] = found != names.end() ? found->second : 0;
+    }
+    return mapped;
+}
+
+// glGen* into the map, recorded name -> new name
+template <typename GenFunction>
+void Generate(std::unordered_map<GLuint, GLuint>& names, const std::vector<GLuint>& recorded, GenFunction gen) {
+    std::vector<GLuint> created(recorded.size());
+    gen(static_cast<GLsizei>(created.size()), created.data());
+    for (size_t i = 0; i < recorded.size(); ++i) {
+        names[recorded[i]] = created[i];
+    }
+}
+
+template <typename DeleteFunction>
+void Delete(std::unordered_map<GLuint, GLuint>& names, const std::vector<GLuint>& recorded, DeleteFunction del) {
+    std::vector<GLuint> mapped = MapNames(names, recorded);
+    del(static_cast<GLsizei>(mapped.size()), mapped.data());
+    for (GLuint name : recorded) {
+        names.erase(name);
+    }
+}
+
+bool IsDraw(GLCaptureOp op) {
+    return op == GLCaptureOp::DrawArrays || op == GLCaptureOp::DrawArraysIndirect || op == GLCaptureOp::DrawArraysInstanced
+        || op == GLCaptureOp::DrawElementsBaseVertex
+        || op == GLCaptureOp::DrawElementsInstancedBaseVertex;
+}
+
+} // namespace
+
+GLReplay::GLReplay()
+    : m_currentProgram(0), m_inFrame(false), m_frameStart(0.0), m_setupMs(0.0), m_totalMs(0.0), m_setupInputs(0),
+      m_timestamps(false) {
+}
+
+GLReplay::~GLReplay() {
+    Release();
+}
+
+bool GLReplay::Load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::GL_REPLAY::FILE_NOT_FOUND: " << path << std::endl;
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    file.seekg(0);
+    if (size < static_cast<std::streamsize>(sizeof(GLCaptureHeader))) {
+        std::cerr << "ERROR::GL_REPLAY::FILE_TOO_SHORT: " << path << std::endl;
+        return false;
+    }
+
+    file.read(reinterpret_cast<char*>(&m_header), sizeof(m_header));
+    if (m_header.magic != kGLCaptureMagic || m_header.version != kGLCaptureVersion) {
+        std::cerr << "ERROR::GL_REPLAY::UNSUPPORTED_FORMAT: " << path << std::endl;
+        return false;
+    }
+
+    m_data.resize(static_cast<size_t>(size) - sizeof(GLCaptureHeader));
+    file.read(reinterpret_cast<char*>(m_data.data()), m_data.size());
+    return static_cast<bool>(file);
+}
+
+bool GLReplay::Run(const Options& options) {
+    m_options = options;
+    m_frames.clear();
+    for (OpStats& stats : m_opStats) {
+        stats = OpStats();
+    }
+    m_inFrame = false;
+    m_setupMs = 0.0;
+    m_setupInputs = 0;
+    m_timestamps = glad_glQueryCounter != nullptr && glad_glGetQueryObjectui64v != nullptr;
+
+    double runStart = Now();
+    double setupStart = runStart;
+    size_t offset = 0;
+    while (offset + sizeof(uint16_t) + sizeof(uint32_t) <= m_data.size()) {
+        uint16_t rawOp = 0;
+        uint32_t size = 0;
+        std::memcpy(&rawOp, m_data.data() + offset, sizeof(rawOp));
+        std::memcpy(&size, m_data.data() + offset + sizeof(rawOp), sizeof(size));
+        offset += sizeof(rawOp) + sizeof(size);
+        if (offset + size > m_data.size()) {
+            std::cerr << "ERROR::GL_REPLAY::TRUNCATED_RECORD at byte " << offset << std::endl;
+            break;
+        }
+
+        GLCaptureOp op = static_cast<GLCaptureOp>(rawOp);
+        if (m_options.dump) {
+            std::cout << (m_inFrame ? "  " : "") << GLCapture::GetOpName(op) << " (" << size << " bytes)" << std::endl;
+        }
+
+        if (op == GLCaptureOp::FrameBegin && !m_inFrame && m_frames.empty()) {
+            m_setupMs = Now() - setupStart;
+        }
+
+        double callStart = Now();
+        bool ok = Execute(op, m_data.data() + offset, size);
+        if (ok && m_options.finishCalls && op > GLCaptureOp::Input) {
+            glFinish();
+        }
+        double callMs = Now() - callStart;
+        offset += size;
+
+        if (!ok) {
+            std::cerr << "ERROR::GL_REPLAY::MALFORMED_RECORD: " << GLCapture::GetOpName(op) << std::endl;
+            break;
+        }
+
+        if (op > GLCaptureOp::Input && op < GLCaptureOp::Count) {
+            OpStats& stats = m_opStats[static_cast<size_t>(op)];
+            ++stats.count;
+            stats.totalMs += callMs;
+            stats.maxMs = std::max(stats.maxMs, callMs);
+            if (m_inFrame) {
+                ++m_frames.back().calls;
+                m_frames.back().draws += IsDraw(op) ? 1 : 0;
+            }
+        }
+    }
+
+    if (m_frames.empty()) {
+        m_setupMs = Now() - setupStart;
+    }
+    glFinish();
+    m_totalMs = Now() - runStart;
+    ResolveGpuTimes();
+    Release();
+    return !m_frames.empty();
+}
+
+void GLReplay::BeginFrame(int frame, double time, double deltaTime) {
+    FrameStats stats;
+    stats.frame = frame;
+    stats.time = time;
+    stats.recordedMs = deltaTime * 1000.0;
+    if (m_timestamps) {
+        glGenQueries(2, stats.queries);
+        glQueryCounter(stats.queries[0], GL_TIMESTAMP);
+    }
+    m_frames.push_back(stats);
+    m_inFrame = true;
+    m_frameStart = Now();
+}
+
+void GLReplay::EndFrame() {
+    if (!m_inFrame) {
+        return;
+    }
+    FrameStats& stats = m_frames.back();
+    if (m_timestamps) {
+        glQueryCounter(stats.queries[1], GL_TIMESTAMP);
+    }
+    if (m_options.finishFrames) {
+        glFinish();
+    }
+    stats.cpuMs = Now() - m_frameStart;
+    m_inFrame = false;
+}
+
+void GLReplay::ResolveGpuTimes() {
+    for (FrameStats& stats : m_frames) {
+        if (stats.queries[0] == 0) {
+            continue;
+        }
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(stats.queries[0], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(stats.queries[1], GL_QUERY_RESULT, &end);
+        stats.gpuMs = (end - begin) / 1e6;
+        glDeleteQueries(2, stats.queries);
+        stats.queries[0] = stats.queries[1] = 0;
+    }
+}
+
+// Frees whatever the stream left alive so repeated runs start clean
+void GLReplay::Release() {
+    for (auto& entry : m_syncs) {
+        glDeleteSync(entry.second);
+    }
+    m_syncs.clear();
+    m_mapped.clear();
+
+    auto release = [](std::unordered_map<GLuint, GLuint>& names, auto del) {
+        for (auto& entry : names) {
+            del(1, &entry.second);
+        }
+        names.clear();
+    };
+    release(m_buffers, glDeleteBuffers);
+    release(m_textures, glDeleteTextures);
+    release(m_vertexArrays, glDeleteVertexArrays);
+    release(m_framebuffers, glDeleteFramebuffers);
+    release(m_renderbuffers, glDeleteRenderbuffers);
+    release(m_queries, glDeleteQueries);
+    for (auto& entry : m_programs) {
+        if (glIsProgram(entry.second)) {
+            glDeleteProgram(entry.second);
+        } else {
+            glDeleteShader(entry.second);
+        }
+    }
+    m_programs.clear();
+    m_locations.clear();
+    m_blockIndices.clear();
+    m_currentProgram = 0;
+}
+
+GLuint GLReplay::MapName(const std::unordered_map<GLuint, GLuint>& names, GLuint name) {
+    if (name == 0) {
+        return 0;
+    }
+    auto found = names.find(name);
+    return found != names.end() ? found->second : 0;
+}
+
+GLint GLReplay::MapLocation(GLint location) const {
+    if (location < 0) {
+        return location;
+    }
+    auto found = m_locations.find({ m_currentProgram, location });
+    return found != m_locations.end() ? found->second : -1;
+}
+
+bool GLReplay::Execute(GLCaptureOp op, const uint8_t* data, size_t size) {
+    using Op = GLCaptureOp;
+    Reader r(data, size);
+
+    switch (op) {
+    case Op::FrameBegin: {
+        int32_t frame = r.Get<int32_t>();
+        double time = r.Get<double>();
+        double deltaTime = r.Get<double>();
+        BeginFrame(frame, time, deltaTime);
+        break;
+    }
+    case Op::FrameEnd:
+        EndFrame();
+        break;
+    case Op::Input: {
+        GLCaptureInputType type = r.Get<GLCaptureInputType>();
+        double time = r.Get<double>();
+        int32_t a = r.Get<int32_t>();
+        int32_t b = r.Get<int32_t>();
+        double x = r.Get<double>();
+        double y = r.Get<double>();
+        if (m_inFrame) {
+            ++m_frames.back().inputs;
+        } else {
+            ++m_setupInputs;
+        }
+        if (m_options.dump) {
+            static const char* const types[] = { "key", "mouse button", "cursor", "resize" };
+            std::cout << "  input " << types[std::min<size_t>(static_cast<size_t>(type), 3)] << " at " << time << "s: "
+                      << a << " " << b << " " << x << " " << y << std::endl;
+        }
+        break;
+    }
+
+    case Op::ActiveTexture:
+        glActiveTexture(r.Get<GLenum>());
+        break;
+    case Op::AttachShader: {
+        GLuint program = r.Get<GLuint>();
+        GLuint shader = r.Get<GLuint>();
+        glAttachShader(MapName(m_programs, program), MapName(m_programs, shader));
+        break;
+    }
+    case Op::BeginQuery: {
+        GLenum target = r.Get<GLenum>();
+        glBeginQuery(target, MapName(m_queries, r.Get<GLuint>()));
+        break;
+    }
+    case Op::BindBuffer: {
+        GLenum target = r.Get<GLenum>();
+        glBindBuffer(target, MapName(m_buffers, r.Get<GLuint>()));
+        break;
+    }
+    case Op::BindBufferBase: {
+        GLenum target = r.Get<GLenum>();
+        GLuint index = r.Get<GLuint>();
+        glBindBufferBase(target, index, MapName(m_buffers, r.Get<GLuint>()));
+        break;
+    }
+    case Op::BindFramebuffer: {
+        GLenum target = r.Get<GLenum>();
+        glBindFramebuffer(target, MapName(m_framebuffers, r.Get<GLuint>()));
+        break;
+    }
+    case Op::BindRenderbuffer: {
+        GLenum target = r.Get<GLenum>();
+        glBindRenderbuffer(target, MapName(m_renderbuffers, r.Get<GLuint>()));
+        break;
+    }
+    case Op::BindTexture: {
+        GLenum target = r.Get<GLenum>();
+        glBindTexture(target, MapName(m_textures, r.Get<GLuint>()));
+        break;
+    }
+    case Op::BindVertexArray:
+        glBindVertexArray(MapName(m_vertexArrays, r.Get<GLuint>()));
+        break;
+    case Op::BlendFunc: {
+        GLenum source = r.Get<GLenum>();
+        glBlendFunc(source, r.Get<GLenum>());
+        break;
+    }
+    case Op::BlendFuncSeparate: {
+        GLenum srcRGB = r.Get<GLenum>();
+        GLenum dstRGB = r.Get<GLenum>();
+        GLenum srcAlpha = r.Get<GLenum>();
+        GLenum dstAlpha = r.Get<GLenum>();
+        glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+        break;
+    }
+    case Op::BlitFramebuffer: {
+        GLint v[8];
+        for (GLint& value : v) {
+            value = r.Get<GLint>();
+        }
+        GLbitfield mask = r.Get<GLbitfield>();
+        GLenum filter = r.Get<GLenum>();
+        glBlitFramebuffer(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], mask, filter);
+        break;
+    }
+    case Op::BufferData: {
+        GLenum target = r.Get<GLenum>();
+        int64_t bufferSize = r.Get<int64_t>();
+        GLenum usage = r.Get<GLenum>();
+        const void* bytes = r.GetData();
+        glBufferData(target, static_cast<GLsizeiptr>(bufferSize), bytes, usage);
+        break;
+    }
+    case Op::BufferSubData: {
+        GLenum target = r.Get<GLenum>();
+        int64_t bufferOffset = r.Get<int64_t>();
+        r.Get<GLCaptureData>();
+        uint64_t bytesSize = 0;
+        const uint8_t* bytes = r.GetBytes(bytesSize);
+        glBufferSubData(target, static_cast<GLintptr>(bufferOffset), static_cast<GLsizeiptr>(bytesSize), bytes);
+        break;
+    }
+    case Op::Clear:
+        glClear(r.Get<GLbitfield>());
+        break;
+    case Op::ClearBufferfv:
+    case Op::ClearBufferuiv: {
+        GLenum buffer = r.Get<GLenum>();
+        GLint drawbuffer = r.Get<GLint>();
+        uint64_t valueSize = 0;
+        const uint8_t* value = r.GetBytes(valueSize);
+        if (op == Op::ClearBufferfv) {
+            glClearBufferfv(buffer, drawbuffer, reinterpret_cast<const GLfloat*>(value));
+        } else {
+            glClearBufferuiv(buffer, drawbuffer, reinterpret_cast<const GLuint*>(value));
+        }
+        break;
+    }
+    case Op::ClearColor: {
+        GLfloat c[4];
+        for (GLfloat& value : c) {
+            value = r.Get<GLfloat>();
+        }
+        glClearColor(c[0], c[1], c[2], c[3]);
+        break;
+    }
+    case Op::ClientWaitSync: {
+        uint64_t sync = r.Get<uint64_t>();
+        GLbitfield flags = r.Get<GLbitfield>();
+        GLuint64 timeout = r.Get<GLuint64>();
+        auto found = m_syncs.find(sync);
+        if (found != m_syncs.end()) {
+            glClientWaitSync(found->second, flags, timeout);
+        }
+        break;
+    }
+    case Op::ColorMask: {
+        GLboolean c[4];
+        for (GLboolean& value : c) {
+            value = r.Get<GLboolean>();
+        }
+        glColorMask(c[0], c[1], c[2], c[3]);
+        break;
+    }
+    case Op::CompileShader:
+        glCompileShader(MapName(m_programs, r.Get<GLuint>()));
+        break;
+    case Op::CompressedTexImage2D: {
+        GLenum target = r.Get<GLenum>();
+        GLint level = r.Get<GLint>();
+        GLenum internalformat = r.Get<GLenum>();
+        GLsizei width = r.Get<GLsizei>();
+        GLsizei height = r.Get<GLsizei>();
+        GLint border = r.Get<GLint>();
+        GLsizei imageSize = r.Get<GLsizei>();
+        const void* bytes = r.GetData();
+        glCompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, bytes);
+        break;
+    }
+    case Op::CopyBufferSubData: {
+        GLenum readTarget = r.Get<GLenum>();
+        GLenum writeTarget = r.Get<GLenum>();
+        int64_t readOffset = r.Get<int64_t>();
+        int64_t writeOffset = r.Get<int64_t>();
+        int64_t size = r.Get<int64_t>();
+        glCopyBufferSubData(readTarget, writeTarget, static_cast<GLintptr>(readOffset), static_cast<GLintptr>(writeOffset),
+                            static_cast<GLsizeiptr>(size));
+        break;
+    }
+    case Op::CreateProgram:
+        m_programs[r.Get<GLuint>()] = glCreateProgram();
+        break;
+    case Op::CreateShader: {
+        GLenum type = r.Get<GLenum>();
+        m_programs[r.Get<GLuint>()] = glCreateShader(type);
+        break;
+    }
+    case Op::DeleteBuffers:
+        Delete(m_buffers, r.GetNames(), glDeleteBuffers);
+        break;
+    case Op::DeleteFramebuffers:
+        Delete(m_framebuffers, r.GetNames(), glDeleteFramebuffers);
+        break;
+    case Op::DeleteProgram: {
+        GLuint program = r.Get<GLuint>();
+        glDeleteProgram(MapName(m_programs, program));
+        m_programs.erase(program);
+        break;
+    }
+    case Op::DeleteQueries:
+        Delete(m_queries, r.GetNames(), glDeleteQueries);
+        break;
+    case Op::DeleteRenderbuffers:
+        Delete(m_renderbuffers, r.GetNames(), glDeleteRenderbuffers);
+        break;
+    case Op::DeleteShader: {
+        GLuint shader = r.Get<GLuint>();
+        glDeleteShader(MapName(m_programs, shader));
+        m_programs.erase(shader);
+        break;
+    }
+    case Op::DeleteSync: {
+        auto found = m_syncs.find(r.Get<uint64_t>());
+        if (found != m_syncs.end()) {
+            glDeleteSync(found->second);
+            m_syncs.erase(found);
+        }
+        break;
+    }
+    case Op::DeleteTextures:
+        Delete(m_textures, r.GetNames(), glDeleteTextures);
+        break;
+    case Op::DeleteVertexArrays:
+        Delete(m_vertexArrays, r.GetNames(), glDeleteVertexArrays);
+        break;
+    case Op::DepthFunc:
+        glDepthFunc(r.Get<GLenum>());
+        break;
+    case Op::DepthMask:
+        glDepthMask(r.Get<GLboolean>());
+        break;
+    case Op::Disable:
+        glDisable(r.Get<GLenum>());
+        break;
+    case Op::DispatchCompute: {
+        GLuint groupsX = r.Get<GLuint>();
+        GLuint groupsY = r.Get<GLuint>();
+        GLuint groupsZ = r.Get<GLuint>();
+        if (glad_glDispatchCompute != nullptr) {
+            glDispatchCompute(groupsX, groupsY, groupsZ);
+        }
+        break;
+    }
+    case Op::DispatchComputeIndirect: {
+        int64_t indirect = r.Get<int64_t>();
+        if (glad_glDispatchComputeIndirect != nullptr) {
+            glDispatchComputeIndirect(static_cast<GLintptr>(indirect));
+        }
+        break;
+    }
+    case Op::DrawArrays: {
+        GLenum mode = r.Get<GLenum>();
+        GLint first = r.Get<GLint>();
+        GLsizei count = r.Get<GLsizei>();
+        glDrawArrays(mode, first, count);
+        break;
+    }
+    case Op::DrawArraysIndirect: {
+        GLenum mode = r.Get<GLenum>();
+        const void* indirect = reinterpret_cast<const void*>(static_cast<uintptr_t>(r.Get<uint64_t>()));
+        if (glad_glDrawArraysIndirect != nullptr) {
+            glDrawArraysIndirect(mode, indirect);
+        }
+        break;
+    }
+    case Op::DrawArraysInstanced: {
+        GLenum mode = r.Get<GLenum>();
+        GLint first = r.Get<GLint>();
+        GLsizei count = r.Get<GLsizei>();
+        GLsizei instances = r.Get<GLsizei>();
+        glDrawArraysInstanced(mode, first, count, instances);
+        break;
+    }
+    case Op::DrawBuffer:
+        glDrawBuffer(r.Get<GLenum>());
+        break;
+    case Op::DrawBuffers: {
+        std::vector<GLuint> buffers = r.GetNames();
+        glDrawBuffers(static_cast<GLsizei>(buffers.size()), buffers.data());
+        break;
+    }
+    case Op::DrawElementsBaseVertex: {
+        GLenum mode = r.Get<GLenum>();
+        GLsizei count = r.Get<GLsizei>();
+        GLenum type = r.Get<GLenum>();
+        const void* indices = reinterpret_cast<const void*>(static_cast<uintptr_t>(r.Get<uint64_t>()));
+        GLint baseVertex = r.Get<GLint>();
+        glDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+        break;
+    }
+    case Op::DrawElementsInstancedBaseVertex: {
+        GLenum mode = r.Get<GLenum>();
+        GLsizei count = r.Get<GLsizei>();
+        GLenum type = r.Get<GLenum>();
+        const void* indices = reinterpret_cast<const void*>(static_cast<uintptr_t>(r.Get<uint64_t>()));
+        GLsizei instances = r.Get<GLsizei>();
+        GLint baseVertex = r.Get<GLint>();
+        glDrawElementsInstancedBaseVertex(mode, count, type, indices, instances, baseVertex);
+        break;
+    }
+    case Op::Enable:
+        glEnable(r.Get<GLenum>());
+        break;
+    case Op::EnableVertexAttribArray:
+        glEnableVertexAttribArray(r.Get<GLuint>());
+        break;
+    case Op::EndQuery:
+        glEndQuery(r.Get<GLenum>());
+        break;
+    case Op::FenceSync: {
+        GLenum condition = r.Get<GLenum>();
+        GLbitfield flags = r.Get<GLbitfield>();
+        m_syncs[r.Get<uint64_t>()] = glFenceSync(condition, flags);
+        break;
+    }
+    case Op::FramebufferRenderbuffer: {
+        GLenum target = r.Get<GLenum>();
+        GLenum attachment = r.Get<GLenum>();
+        GLenum renderbufferTarget = r.Get<GLenum>();
+        GLuint renderbuffer = MapName(m_renderbuffers, r.Get<GLuint>());
+        glFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+        break;
+    }
+    case Op::FramebufferTexture2D: {
+        GLenum target = r.Get<GLenum>();
+        GLenum attachment = r.Get<GLenum>();
+        GLenum textureTarget = r.Get<GLenum>();
+        GLuint texture = MapName(m_textures, r.Get<GLuint>());
+        GLint level = r.Get<GLint>();
+        glFramebufferTexture2D(target, attachment, textureTarget, texture, level);
+        break;
+    }
+    case Op::FramebufferTextureLayer: {
+        GLenum target = r.Get<GLenum>();
+        GLenum attachment = r.Get<GLenum>();
+        GLuint texture = MapName(m_textures, r.Get<GLuint>());
+        GLint level = r.Get<GLint>();
+        GLint layer = r.Get<GLint>();
+        glFramebufferTextureLayer(target, attachment, texture, level, layer);
+        break;
+    }
+    case Op::GenBuffers:
+        Generate(m_buffers, r.GetNames(), glGenBuffers);
+        break;
+    case Op::GenFramebuffers:
+        Generate(m_framebuffers, r.GetNames(), glGenFramebuffers);
+        break;
+    case Op::GenQueries:
+        Generate(m_queries, r.GetNames(), glGenQueries);
+        break;
+    case Op::GenRenderbuffers:
+        Generate(m_renderbuffers, r.GetNames(), glGenRenderbuffers);
+        break;
+    case Op::GenTextures:
+        Generate(m_textures, r.GetNames(), glGenTextures);
+        break;
+    case Op::GenVertexArrays:
+        Generate(m_vertexArrays, r.GetNames(), glGenVertexArrays);
+        break;
+    case Op::GenerateMipmap:
+        glGenerateMipmap(r.Get<GLenum>());
+        break;
+    case Op::GetQueryObjectiv: {
+        GLuint id = MapName(m_queries, r.Get<GLuint>());
+        GLint result = 0;
+        glGetQueryObjectiv(id, r.Get<GLenum>(), &result);
+        break;
+    }
+    case Op::GetQueryObjectuiv: {
+        GLuint id = MapName(m_queries, r.Get<GLuint>());
+        GLuint result = 0;
+        glGetQueryObjectuiv(id, r.Get<GLenum>(), &result);
+        break;
+    }
+    case Op::GetQueryObjectui64v: {
+        GLuint id = MapName(m_queries, r.Get<GLuint>());
+        GLuint64 result = 0;
+        glGetQueryObjectui64v(id, r.Get<GLenum>(), &result);
+        break;
+    }
+    case Op::GetUniformBlockIndex: {
+        GLuint program = r.Get<GLuint>();
+        uint64_t nameSize = 0;
+        const uint8_t* nameBytes = r.GetBytes(nameSize);
+        GLuint index = r.Get<GLuint>();
+        std::string name(reinterpret_cast<const char*>(nameBytes), nameSize);
+        if (index != GL_INVALID_INDEX) {
+            m_blockIndices[{ program, index }] = glGetUniformBlockIndex(MapName(m_programs, program), name.c_str());
+        }
+        break;
+    }
+    case Op::GetUniformLocation: {
+        GLuint program = r.Get<GLuint>();
+        uint64_t nameSize = 0;
+        const uint8_t* nameBytes = r.GetBytes(nameSize);
+        GLint location = r.Get<GLint>();
+        std::string name(reinterpret_cast<const char*>(nameBytes), nameSize);
+        if (location >= 0) {
+            m_locations[{ program, location }] = glGetUniformLocation(MapName(m_programs, program), name.c_str());
+        }
+        break;
+    }
+    case Op::LineWidth:
+        glLineWidth(r.Get<GLfloat>());
+        break;
+    case Op::LinkProgram:
+        glLinkProgram(MapName(m_programs, r.Get<GLuint>()));
+        break;
+    case Op::MapBufferRange: {
+        GLenum target = r.Get<GLenum>();
+        int64_t mapOffset = r.Get<int64_t>();
+        int64_t length = r.Get<int64_t>();
+        GLbitfield access = r.Get<GLbitfield>();
+        m_mapped[target] = glMapBufferRange(target, static_cast<GLintptr>(mapOffset), static_cast<GLsizeiptr>(length), access);
+        break;
+    }
+    case Op::MemoryBarrier: {
+        GLbitfield barriers = r.Get<GLbitfield>();
+        if (glad_glMemoryBarrier != nullptr) {
+            glMemoryBarrier(barriers);
+        }
+        break;
+    }
+    case Op::PixelStorei: {
+        GLenum pname = r.Get<GLenum>();
+        glPixelStorei(pname, r.Get<GLint>());
+        break;
+    }
+    case Op::PointSize:
+        glPointSize(r.Get<GLfloat>());
+        break;
+    case Op::PolygonMode: {
+        GLenum face = r.Get<GLenum>();
+        glPolygonMode(face, r.Get<GLenum>());
+        break;
+    }
+    case Op::PolygonOffset: {
+        GLfloat factor = r.Get<GLfloat>();
+        glPolygonOffset(factor, r.Get<GLfloat>());
+        break;
+    }
+    case Op::QueryCounter: {
+        GLuint id = r.Get<GLuint>();
+        glQueryCounter(MapName(m_queries, id), r.Get<GLenum>());
+        break;
+    }
+    case Op::ReadBuffer:
+        glReadBuffer(r.Get<GLenum>());
+        break;
+    case Op::ReadPixels: {
+        GLint x = r.Get<GLint>();
+        GLint y = r.Get<GLint>();
+        GLsizei width = r.Get<GLsizei>();
+        GLsizei height = r.Get<GLsizei>();
+        GLenum format = r.Get<GLenum>();
+        GLenum type = r.Get<GLenum>();
+        GLCaptureData kind = r.Get<GLCaptureData>();
+        uint64_t pixelOffset = r.Get<uint64_t>();
+        void* pixels = reinterpret_cast<void*>(static_cast<uintptr_t>(pixelOffset));
+        if (kind != GLCaptureData::Offset) {
+            m_scratch.resize(GLCapture::PixelDataSize(width, height, format, type, 8));
+            pixels = m_scratch.data();
+        }
+        glReadPixels(x, y, width, height, format, type, pixels);
+        break;
+    }
+    case Op::RenderbufferStorage: {
+        GLenum target = r.Get<GLenum>();
+        GLenum internalformat = r.Get<GLenum>();
+        GLsizei width = r.Get<GLsizei>();
+        GLsizei height = r.Get<GLsizei>();
+        glRenderbufferStorage(target, internalformat, width, height);
+        break;
+    }
+    case Op::ShaderSource: {
+        GLuint shader = MapName(m_programs, r.Get<GLuint>());
+        GLsizei count = r.Get<GLsizei>();
+        std::vector<const GLchar*> strings;
+        std::vector<GLint> lengths;
+        for (GLsizei i = 0; i < count && !r.Failed(); ++i) {
+            uint64_t length = 0;
+            strings.push_back(reinterpret_cast<const GLchar*>(r.GetBytes(length)));
+            lengths.push_back(static_cast<GLint>(length));
+        }
+        glShaderSource(shader, static_cast<GLsizei>(strings.size()), strings.data(), lengths.data());
+        break;
+    }
+    case Op::TexBuffer: {
+        GLenum target = r.Get<GLenum>();
+        GLenum internalformat = r.Get<GLenum>();
+        glTexBuffer(target, internalformat, MapName(m_buffers, r.Get<GLuint>()));
+        break;
+    }
+    case Op::TexImage2D: {
+        GLenum target = r.Get<GLenum>();
+        GLint level = r.Get<GLint>();
+        GLint internalformat = r.Get<GLint>();
+        GLsizei width = r.Get<GLsizei>();
+        GLsizei height = r.Get<GLsizei>();
+        GLint border = r.Get<GLint>();
+        GLenum format = r.Get<GLenum>();
+        GLenum type = r.Get<GLenum>();
+        const void* pixels = r.GetData();
+        glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+        break;
+    }
+    case Op::TexImage3D: {
+        GLenum target = r.Get<GLenum>();
+        GLint level = r.Get<GLint>();
+        GLint internalformat = r.Get<GLint>();
+        GLsizei width = r.Get<GLsizei>();
+        GLsizei height = r.Get<GLsizei>();
+        GLsizei depth = r.Get<GLsizei>();
+        GLint border = r.Get<GLint>();
+        GLenum format = r.Get<GLenum>();
+        GLenum type = r.Get<GLenum>();
+        const void* pixels = r.GetData();
+        glTexImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels);
+        break;
+    }
+    case Op::TexParameteri: {
+        GLenum target = r.Get<GLenum>();
+        GLenum pname = r.Get<GLenum>();
+        glTexParameteri(target, pname, r.Get<GLint>());
+        break;
+    }
+    case Op::Uniform1f: {
+        GLint location = MapLocation(r.Get<GLint>());
+        glUniform1f(location, r.Get<GLfloat>());
+        break;
+    }
+    case Op::Uniform1i: {
+        GLint location = MapLocation(r.Get<GLint>());
+        glUniform1i(location, r.Get<GLint>());
+        break;
+    }
+    case Op::Uniform2fv:
+    case Op::Uniform3fv: {
+        GLint location = MapLocation(r.Get<GLint>());
+        GLsizei count = r.Get<GLsizei>();
+        uint64_t valueSize = 0;
+        const GLfloat* value = reinterpret_cast<const GLfloat*>(r.GetBytes(valueSize));
+        if (op == Op::Uniform2fv) {
+            glUniform2fv(location, count, value);
+        } else {
+            glUniform3fv(location, count, value);
+        }
+        break;
+    }
+    case Op::UniformBlockBinding: {
+        GLuint program = r.Get<GLuint>();
+        GLuint index = r.Get<GLuint>();
+        GLuint binding = r.Get<GLuint>();
+        auto found = m_blockIndices.find({ program, index });
+        if (found != m_blockIndices.end() && found->second != GL_INVALID_INDEX) {
+            glUniformBlockBinding(MapName(m_programs, program), found->second, binding);
+        }
+        break;
+    }
+    case Op::UniformMatrix4fv: {
+        GLint location = MapLocation(r.Get<GLint>());
+        GLsizei count = r.Get<GLsizei>();
+        GLboolean transpose = r.Get<GLboolean>();
+        uint64_t valueSize = 0;
+        const GLfloat* value = reinterpret_cast<const GLfloat*>(r.GetBytes(valueSize));
+        glUniformMatrix4fv(location, count, transpose, value);
+        break;
+    }
+    case Op::UnmapBuffer: {
+        GLenum target = r.Get<GLenum>();
+        GLCaptureData kind = r.Get<GLCaptureData>();
+        auto found = m_mapped.find(target);
+        if (kind == GLCaptureData::Bytes) {
+            uint64_t bytesSize = 0;
+            const uint8_t* bytes = r.GetBytes(bytesSize);
+            if (found != m_mapped.end() && found->second != nullptr && bytes != nullptr) {
+                std::memcpy(found->second, bytes, bytesSize);
+            }
+        }
+        if (found != m_mapped.end()) {
+            m_mapped.erase(found);
+        }
+        glUnmapBuffer(target);
+        break;
+    }
+    case Op::UseProgram:
+        m_currentProgram = r.Get<GLuint>();
+        glUseProgram(MapName(m_programs, m_currentProgram));
+        break;
+    case Op::VertexAttribDivisor: {
+        GLuint index = r.Get<GLuint>();
+        glVertexAttribDivisor(index, r.Get<GLuint>());
+        break;
+    }
+    case Op::VertexAttribIPointer: {
+        GLuint index = r.Get<GLuint>();
+        GLint components = r.Get<GLint>();
+        GLenum type = r.Get<GLenum>();
+        GLsizei stride = r.Get<GLsizei>();
+        const void* pointer = reinterpret_cast<const void*>(static_cast<uintptr_t>(r.Get<uint64_t>()));
+        glVertexAttribIPointer(index, components, type, stride, pointer);
+        break;
+    }
+    case Op::VertexAttribPointer: {
+        GLuint index = r.Get<GLuint>();
+        GLint components = r.Get<GLint>();
+        GLenum type = r.Get<GLenum>();
+        GLboolean normalized = r.Get<GLboolean>();
+        GLsizei stride = r.Get<GLsizei>();
+        const void* pointer = reinterpret_cast<const void*>(static_cast<uintptr_t>(r.Get<uint64_t>()));
+        glVertexAttribPointer(index, components, type, normalized, stride, pointer);
+        break;
+    }
+    case Op::Viewport: {
+        GLint x = r.Get<GLint>();
+        GLint y = r.Get<GLint>();
+        GLsizei width = r.Get<GLsizei>();
+        GLsizei height = r.Get<GLsizei>();
+        glViewport(x, y, width, height);
+        break;
+    }
+    case Op::ViewportArrayv: {
+        GLuint first = r.Get<GLuint>();
+        GLsizei count = r.Get<GLsizei>();
+        uint64_t bytes = 0;
+        const uint8_t* values = r.GetBytes(bytes);
+        glViewportArrayv(first, count, reinterpret_cast<const GLfloat*>(values));
+        break;
+    }
+    default:
+        // Newer capture versions; skipped by size
+        break;
+    }
+
+    return !r.Failed();
+}
+
+std::string GLReplay::Report() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "Replayed " << m_frames.size() << " frames in " << m_totalMs << " ms (setup " << m_setupMs << " ms";
+    if (m_setupInputs > 0) {
+        out << ", " << m_setupInputs << " inputs";
+    }
+    out << ")\n";
+    if (m_frames.empty()) {
+        return out.str();
+    }
+
+    // Frame time distribution
+    std::vector<double> cpu;
+    for (const FrameStats& frame : m_frames) {
+        cpu.push_back(frame.cpuMs);
+    }
+    std::sort(cpu.begin(), cpu.end());
+    auto percentile = [&cpu](double p) { return cpu[std::min(cpu.size() - 1, static_cast<size_t>(p * cpu.size()))]; };
+    out << "CPU frame ms: min " << cpu.front() << "  p50 " << percentile(0.5) << "  p95 " << percentile(0.95)
+        << "  max " << cpu.back() << "\n";
+
+    // Slowest frames, with what was recorded for them
+    std::vector<const FrameStats*> slowest;
+    for (const FrameStats& frame : m_frames) {
+        slowest.push_back(&frame);
+    }
+    std::sort(slowest.begin(), slowest.end(), [](const FrameStats* a, const FrameStats* b) {
+        return std::max(a->cpuMs, a->gpuMs) > std::max(b->cpuMs, b->gpuMs);
+    });
+    slowest.resize(std::min<size_t>(slowest.size(), 10));
+    out << "Slowest frames:\n";
+    out << "  frame   recorded ms     cpu ms     gpu ms   calls  draws  inputs\n";
+    for (const FrameStats* frame : slowest) {
+        out << "  " << std::setw(5) << frame->frame << std::setw(14) << frame->recordedMs << std::setw(11) << frame->cpuMs
+            << std::setw(11) << frame->gpuMs << std::setw(8) << frame->calls << std::setw(7) << frame->draws
+            << std::setw(8) << frame->inputs << "\n";
+    }
+
+    // Per-call CPU cost, most expensive first
+    std::vector<size_t> ops;
+    for (size_t i = 0; i < static_cast<size_t>(GLCaptureOp::Count); ++i) {
+        if (m_opStats[i].count > 0) {
+            ops.push_back(i);
+        }
+    }
+    std::sort(ops.begin(), ops.end(), [this](size_t a, size_t b) { return m_opStats[a].totalMs > m_opStats[b].totalMs; });
+    out << "Calls" << (m_options.finishCalls ? " (with glFinish)" : "") << ":\n";
+    out << "  " << std::left << std::setw(28) << "call" << std::right << std::setw(9) << "count" << std::setw(12) << "total ms"
+        << std::setw(11) << "avg us" << std::setw(11) << "max us" << "\n";
+    for (size_t index : ops) {
+        const OpStats& stats = m_opStats[index];
+        out << "  " << std::left << std::setw(28) << GLCapture::GetOpName(static_cast<GLCaptureOp>(index)) << std::right
+            << std::setw(9) << stats.count << std::setw(12) << stats.totalMs << std::setw(11)
+            << stats.totalMs * 1000.0 / stats.count << std::setw(11) << stats.maxMs * 1000.0 << "\n";
+    }
+    return out.str();
+}
+
+bool GLReplay::WriteFrameCsv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::GL_REPLAY::CSV_NOT_WRITABLE: " << path << std::endl;
+        return false;
+    }
+    file << "frame,time,recorded_ms,cpu_ms,gpu_ms,calls,draws,inputs\n";
+    for (const FrameStats& frame : m_frames) {
+        file << frame.frame << "," << frame.time << "," << frame.recordedMs << "," << frame.cpuMs << "," << frame.gpuMs << ","
+             << frame.calls << "," << frame.draws << "," << frame.inputs << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,271 @@
+#include "GpuMemory.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+// BuddyAllocator
+BuddyAllocator::BuddyAllocator(uint32_t size, uint32_t minBlock)
+    : m_size(minBlock), m_minBlock(minBlock), m_maxOrder(0), m_used(0) {
+    while (m_size < size) {
+        m_size <<= 1;
+        ++m_maxOrder;
+    }
+    m_freeLists.resize(m_maxOrder + 1);
+    m_freeLists[m_maxOrder].insert(0);
+}
+
+int BuddyAllocator::OrderFor(uint32_t size) const {
+    int order = 0;
+    while (BlockSize(order) < size) {
+        ++order;
+    }
+    return order;
+}
+
+bool BuddyAllocator::Allocate(uint32_t size, uint32_t& offset) {
+    if (size == 0 || size > m_size) {
+        return false;
+    }
+
+    int order = OrderFor(size);
+    int found = order;
+    while (found <= m_maxOrder && m_freeLists[found].empty()) {
+        ++found;
+    }
+    if (found > m_maxOrder) {
+        return false;
+    }
+
+    // Split down to the requested order, keeping the low halves
+    uint32_t block = *m_freeLists[found].begin();
+    m_freeLists[found].erase(m_freeLists[found].begin());
+    while (found > order) {
+        --found;
+        m_freeLists[found].insert(block + BlockSize(found));
+    }
+
+    m_allocated[block] = order;
+    m_used += BlockSize(order);
+    offset = block;
+    return true;
+}
+
+void BuddyAllocator::Free(uint32_t offset) {
+    auto it = m_allocated.find(offset);
+    if (it == m_allocated.end()) {
+        std::cerr << "ERROR::BUDDYALLOCATOR::INVALID_FREE " << offset << std::endl;
+        return;
+    }
+
+    int order = it->second;
+    m_allocated.erase(it);
+    m_used -= BlockSize(order);
+
+    // Merge with free buddies as far up as possible
+    uint32_t block = offset;
+    while (order < m_maxOrder) {
+        uint32_t buddy = block ^ BlockSize(order);
+        auto free = m_freeLists[order].find(buddy);
+        if (free == m_freeLists[order].end()) {
+            break;
+        }
+        m_freeLists[order].erase(free);
+        block = std::min(block, buddy);
+        ++order;
+    }
+    m_freeLists[order].insert(block);
+}
+
+uint32_t BuddyAllocator::GetLargestFree() const {
+    for (int order = m_maxOrder; order >= 0; --order) {
+        if (!m_freeLists[order].empty()) {
+            return BlockSize(order);
+        }
+    }
+    return 0;
+}
+
+size_t BuddyAllocator::GetFreeBlockCount() const {
+    size_t count = 0;
+    for (const auto& list : m_freeLists) {
+        count += list.size();
+    }
+    return count;
+}
+
+// GpuMemory
+GpuMemory::GpuMemory() : m_poolSize{ 0, 0 } {
+}
+
+GpuMemory::~GpuMemory() {
+    Shutdown();
+}
+
+bool GpuMemory::Initialize(uint32_t vertexPoolSize, uint32_t indexPoolSize) {
+    m_poolSize[static_cast<int>(GpuBufferKind::Vertex)] = vertexPoolSize;
+    m_poolSize[static_cast<int>(GpuBufferKind::Index)] = indexPoolSize;
+    return CreatePool(GpuBufferKind::Vertex, vertexPoolSize) >= 0
+        && CreatePool(GpuBufferKind::Index, indexPoolSize) >= 0;
+}
+
+void GpuMemory::Shutdown() {
+    // Called at teardown, when nothing is in flight any more
+    for (PendingFrees& pending : m_pending) {
+        glDeleteSync(pending.fence);
+    }
+    m_pending.clear();
+    m_frameFrees.clear();
+
+    for (auto& pools : m_pools) {
+        for (Pool& pool : pools) {
+            if (pool.buffer != 0) {
+                glDeleteBuffers(1, &pool.buffer);
+            }
+        }
+        pools.clear();
+    }
+}
+
+int GpuMemory::CreatePool(GpuBufferKind kind, uint32_t size) {
+    Pool pool;
+    pool.allocator = std::make_unique<BuddyAllocator>(size, kMinBlock);
+
+    GLenum target = kind == GpuBufferKind::Vertex ? GL_ARRAY_BUFFER : GL_COPY_WRITE_BUFFER;
+    glGenBuffers(1, &pool.buffer);
+    glBindBuffer(target, pool.buffer);
+    glBufferData(target, pool.allocator->GetSize(), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(target, 0);
+    if (pool.buffer == 0) {
+        std::cerr << "ERROR::GPUMEMORY::BUFFER_CREATION_FAILED" << std::endl;
+        return -1;
+    }
+
+    auto& pools = m_pools[static_cast<int>(kind)];
+    pools.push_back(std::move(pool));
+    return static_cast<int>(pools.size()) - 1;
+}
+
+GpuAllocation GpuMemory::Allocate(GpuBufferKind kind, uint32_t size, uint32_t alignment) {
+    GpuAllocation allocation;
+    allocation.kind = kind;
+    alignment = std::max(alignment, 1u);
+    // Blocks start on kMinBlock boundaries; pad so the data can be aligned inside
+    uint32_t padded = size + (kMinBlock % alignment == 0 ? 0 : alignment - 1);
+
+    auto& pools = m_pools[static_cast<int>(kind)];
+    int poolIndex = -1;
+    uint32_t block = 0;
+    for (size_t i = 0; i < pools.size() && poolIndex < 0; ++i) {
+        if (pools[i].allocator->Allocate(padded, block)) {
+            poolIndex = static_cast<int>(i);
+        }
+    }
+
+    if (poolIndex < 0) {
+        uint32_t poolSize = std::max(m_poolSize[static_cast<int>(kind)], padded);
+        poolIndex = CreatePool(kind, poolSize);
+        if (poolIndex < 0 || !pools[poolIndex].allocator->Allocate(padded, block)) {
+            std::cerr << "ERROR::GPUMEMORY::OUT_OF_MEMORY " << size << " bytes" << std::endl;
+            return allocation;
+        }
+    }
+
+    allocation.pool = poolIndex;
+    allocation.block = block;
+    allocation.offset = (block + alignment - 1) / alignment * alignment;
+    allocation.size = size;
+    pools[poolIndex].requestedBytes += size;
+    return allocation;
+}
+
+void GpuMemory::Upload(const GpuAllocation& allocation, const void* data, uint32_t size) {
+    if (!allocation.IsValid()) {
+        return;
+    }
+    // The copy-write target leaves the VAO's element buffer binding alone
+    glBindBuffer(GL_COPY_WRITE_BUFFER, GetBuffer(allocation.kind, allocation.pool));
+    glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.offset, std::min(size, allocation.size), data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GpuMemory::Free(const GpuAllocation& allocation) {
+    if (allocation.IsValid()) {
+        m_frameFrees.push_back(allocation);
+    }
+}
+
+void GpuMemory::EndFrame() {
+    if (!m_frameFrees.empty()) {
+        PendingFrees pending;
+        pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        pending.allocations.swap(m_frameFrees);
+        m_pending.push_back(std::move(pending));
+    }
+
+    // Fences signal in order, so stop at the first one still pending
+    while (!m_pending.empty()) {
+        GLenum status = glClientWaitSync(m_pending.front().fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        glDeleteSync(m_pending.front().fence);
+        for (const GpuAllocation& allocation : m_pending.front().allocations) {
+            Release(allocation);
+        }
+        m_pending.pop_front();
+    }
+}
+
+void GpuMemory::Release(const GpuAllocation& allocation) {
+    Pool& pool = m_pools[static_cast<int>(allocation.kind)][allocation.pool];
+    pool.allocator->Free(allocation.block);
+    pool.requestedBytes -= allocation.size;
+}
+
+GLuint GpuMemory::GetBuffer(GpuBufferKind kind, int pool) const {
+    return m_pools[static_cast<int>(kind)][pool].buffer;
+}
+
+int GpuMemory::GetPoolCount(GpuBufferKind kind) const {
+    return static_cast<int>(m_pools[static_cast<int>(kind)].size());
+}
+
+std::string GpuMemory::Report() const {
+    std::ostringstream out;
+    const char* names[] = { "Vertex", "Index" };
+
+    for (int kind = 0; kind < 2; ++kind) {
+        for (size_t i = 0; i < m_pools[kind].size(); ++i) {
+            const Pool& pool = m_pools[kind][i];
+            const BuddyAllocator& allocator = *pool.allocator;
+            uint32_t free = allocator.GetSize() - allocator.GetUsed();
+            uint32_t largest = allocator.GetLargestFree();
+            // External: free space not usable by a single allocation.
+            // Internal: block rounding and alignment padding inside used blocks.
+            double external = free > 0 ? 100.0 * (1.0 - static_cast<double>(largest) / free) : 0.0;
+            double internal = allocator.GetUsed() > 0 ? 100.0 * (1.0 - static_cast<double>(pool.requestedBytes) / allocator.GetUsed()) : 0.0;
+
+            out << names[kind] << " pool " << i << ": "
+                << allocator.GetUsed() / 1024 << "/" << allocator.GetSize() / 1024 << " KiB used ("
+                << 100.0 * allocator.GetUsed() / allocator.GetSize() << "%), "
+                << allocator.GetAllocationCount() << " allocations, "
+                << allocator.GetFreeBlockCount() << " free blocks, largest " << largest / 1024 << " KiB, "
+                << "fragmentation external " << external << "% internal " << internal << "%" << std::endl;
+        }
+    }
+
+    size_t pendingCount = m_frameFrees.size();
+    uint64_t pendingBytes = 0;
+    for (const GpuAllocation& allocation : m_frameFrees) {
+        pendingBytes += allocation.size;
+    }
+    for (const PendingFrees& pending : m_pending) {
+        pendingCount += pending.allocations.size();
+        for (const GpuAllocation& allocation : pending.allocations) {
+            pendingBytes += allocation.size;
+        }
+    }
+    out << "Deferred frees: " << pendingCount << " (" << pendingBytes << " bytes) behind "
+        << m_pending.size() << " fences" << std::endl;
+    return out.str();
+}
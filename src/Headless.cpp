@@ -0,0 +1,151 @@
+#include "Headless.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "Camera.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+bool WritePPM(const std::string& path, const std::vector<uint8_t>& pixels, int width, int height) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::HEADLESS::OUTPUT_NOT_WRITABLE: " << path << std::endl;
+        return false;
+    }
+
+    // PPM is top row first; the framebuffer is bottom row first
+    file << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+    for (int y = height - 1; y >= 0; --y) {
+        const uint8_t* source = pixels.data() + static_cast<size_t>(y) * width * 4;
+        for (int x = 0; x < width; ++x) {
+            row[x * 3 + 0] = source[x * 4 + 0];
+            row[x * 3 + 1] = source[x * 4 + 1];
+            row[x * 3 + 2] = source[x * 4 + 2];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+    return true;
+}
+
+} // namespace
+
+int RunHeadless(int argc, char** argv) {
+    int width = 800;
+    int height = 600;
+    int frames = 60;
+    std::string output = "frame.ppm";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                std::cerr << "ERROR::HEADLESS::INVALID_SIZE: " << argv[i] << std::endl;
+                return -1;
+            }
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        }
+    }
+
+    Shader::SetSoftwareMode(true);
+    Shader shader("shaders/vertex.glsl", "shaders/fragment.glsl");
+    Shader shader2D("shaders/vertex_2d.glsl", "shaders/fragment_2d.glsl");
+
+    Renderer renderer(RenderBackend::Software);
+    renderer.Resize(width, height);
+    if (!renderer.Initialize()) {
+        std::cerr << "Failed to initialize software renderer" << std::endl;
+        return -1;
+    }
+
+    Camera camera;
+    camera.SetAspectRatio(static_cast<float>(width) / height);
+    camera.LookAt(glm::vec3(0.0f, 1.5f, 4.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+
+    // Same layout as the windowed test scene: a spinning cube, a wall and a
+    // field of small cubes behind it
+    std::vector<std::pair<glm::mat4, glm::vec3>> cubes;
+    glm::mat4 wall = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -4.0f));
+    cubes.push_back({ glm::scale(wall, glm::vec3(6.0f, 4.0f, 0.5f)), glm::vec3(0.6f, 0.6f, 0.65f) });
+    const int columns = 16;
+    const int rows = 10;
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            glm::vec3 position((x - (columns - 1) * 0.5f) * 0.6f, (y - (rows - 1) * 0.5f) * 0.6f + 2.5f, -8.0f);
+            glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(0.4f));
+            cubes.push_back({ model, glm::vec3(0.3f + 0.7f * x / columns, 0.3f + 0.7f * y / rows, 0.8f) });
+        }
+    }
+
+    const SoftwareRasterizer* rasterizer = renderer.GetSoftwareRasterizer();
+    double totalMs = 0.0;
+    double flushMs = 0.0;
+    for (int frame = 0; frame < frames; ++frame) {
+        auto start = std::chrono::high_resolution_clock::now();
+        float time = frame / 60.0f;
+
+        renderer.Clear();
+
+        shader.Use();
+        shader.SetMat4("view", camera.GetViewMatrix());
+        shader.SetMat4("projection", camera.GetProjectionMatrix());
+        shader.SetVec3("lightPos", glm::vec3(1.2f, 1.0f, 2.0f));
+        shader.SetVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
+
+        glm::mat4 spinning = glm::rotate(glm::mat4(1.0f), time, glm::vec3(0.5f, 1.0f, 0.0f));
+        shader.SetMat4("model", spinning);
+        shader.SetVec3("objectColor", glm::vec3(1.0f, 0.5f, 0.31f));
+        renderer.DrawCube();
+        for (const auto& cube : cubes) {
+            shader.SetMat4("model", cube.first);
+            shader.SetVec3("objectColor", cube.second);
+            renderer.DrawCube();
+        }
+
+        // Floor grid, circle and points through the line/point path
+        glm::mat4 floor = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
+                                      glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        shader2D.Use();
+        renderer.SetTransform(camera.GetViewProjectionMatrix() * floor);
+        renderer.SetLineWidth(1.5f);
+        renderer.DrawGrid(20, 0.5f);
+        renderer.SetLineWidth(3.0f);
+        renderer.DrawCircle(0.0f, 0.0f, 2.0f + 0.25f * std::sin(time * 2.0f), 64);
+        renderer.SetPointSize(6.0f);
+        for (int i = 0; i < 8; ++i) {
+            float angle = time + i * 3.14159f / 4.0f;
+            renderer.DrawPoint(1.5f * std::cos(angle), 1.5f * std::sin(angle), 0.1f);
+        }
+
+        renderer.Finish();
+        totalMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        flushMs += rasterizer->GetStats().flushMs;
+    }
+
+    const SoftwareRasterizer::Stats& stats = rasterizer->GetStats();
+    std::cout << "Software renderer: " << width << "x" << height << ", " << rasterizer->GetThreadCount() << " threads, "
+              << stats.triangles << " triangles, " << stats.binEntries << " bin entries" << std::endl;
+    std::cout << "Average frame: " << totalMs / frames << " ms (rasterization " << flushMs / frames << " ms) over "
+              << frames << " frames" << std::endl;
+
+    std::vector<uint8_t> pixels;
+    int outWidth = 0;
+    int outHeight = 0;
+    if (!renderer.ReadPixels(pixels, outWidth, outHeight) || !WritePPM(output, pixels, outWidth, outHeight)) {
+        return -1;
+    }
+    std::cout << "Wrote " << output << std::endl;
+    return 0;
+}
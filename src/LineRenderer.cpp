@@ -0,0 +1,186 @@
+#include "LineRenderer.h"
+#include "Shader.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+LineRenderer::LineRenderer()
+    : m_VAO(0), m_cornerVBO(0), m_instanceVBO(0), m_capacity(0), m_offset(0),
+      m_transform(1.0f), m_viewportSize(1.0f), m_cap(LineCap::Butt), m_join(LineJoin::Round) {
+}
+
+LineRenderer::~LineRenderer() {
+    Shutdown();
+}
+
+bool LineRenderer::Initialize() {
+    m_shader = std::make_unique<Shader>("shaders/vertex_line.glsl", "shaders/fragment_line.glsl");
+    if (m_shader->GetID() == 0) {
+        std::cerr << "ERROR::LINERENDERER::SHADER_NOT_AVAILABLE" << std::endl;
+        m_shader.reset();
+        return false;
+    }
+
+    // Unit quad drawn as a triangle strip: (end, side)
+    float corners[] = {
+        0.0f, -1.0f,
+        0.0f,  1.0f,
+        1.0f, -1.0f,
+        1.0f,  1.0f
+    };
+
+    glGenVertexArrays(1, &m_VAO);
+    glBindVertexArray(m_VAO);
+
+    glGenBuffers(1, &m_cornerVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_cornerVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Instance attributes advance once per quad; pointers are set at draw time
+    m_capacity = 1024 * 1024;
+    glGenBuffers(1, &m_instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, m_capacity, nullptr, GL_STREAM_DRAW);
+    for (GLuint location = 1; location <= 6; ++location) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+
+    glBindVertexArray(0);
+    return true;
+}
+
+void LineRenderer::Shutdown() {
+    if (m_instanceVBO != 0) {
+        glDeleteBuffers(1, &m_instanceVBO);
+        m_instanceVBO = 0;
+    }
+    if (m_cornerVBO != 0) {
+        glDeleteBuffers(1, &m_cornerVBO);
+        m_cornerVBO = 0;
+    }
+    if (m_VAO != 0) {
+        glDeleteVertexArrays(1, &m_VAO);
+        m_VAO = 0;
+    }
+    if (m_shader) {
+        m_shader->Delete();
+        m_shader.reset();
+    }
+}
+
+uint32_t LineRenderer::PackColor(const float* rgb) {
+    auto channel = [](float value) {
+        return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    return channel(rgb[0]) | (channel(rgb[1]) << 8) | (channel(rgb[2]) << 16) | (255u << 24);
+}
+
+void LineRenderer::Push(const float* a, const float* b, float width, LineCap startCap, LineCap endCap) {
+    Instance instance;
+    std::memcpy(instance.start, a, 3 * sizeof(float));
+    std::memcpy(instance.end, b, 3 * sizeof(float));
+    instance.startColor = PackColor(a + 3);
+    instance.endColor = PackColor(b + 3);
+    instance.width = width;
+    instance.caps = static_cast<uint32_t>(startCap) | (static_cast<uint32_t>(endCap) << 2);
+    m_instances.push_back(instance);
+}
+
+void LineRenderer::DrawSegments(const float* vertices, int segmentCount, float width) {
+    for (int i = 0; i < segmentCount; ++i) {
+        Push(vertices + i * 12, vertices + i * 12 + 6, width, m_cap, m_cap);
+    }
+    Flush();
+}
+
+void LineRenderer::DrawStrip(const float* vertices, int count, bool closed, float width) {
+    if (count < 2) {
+        return;
+    }
+
+    // Interior ends get round caps, which overlap into round joins
+    LineCap joinCap = m_join == LineJoin::Round ? LineCap::Round : LineCap::Butt;
+    int segments = closed ? count : count - 1;
+    for (int i = 0; i < segments; ++i) {
+        int next = (i + 1) % count;
+        LineCap startCap = (!closed && i == 0) ? m_cap : joinCap;
+        LineCap endCap = (!closed && i == segments - 1) ? m_cap : joinCap;
+        Push(vertices + i * 6, vertices + next * 6, width, startCap, endCap);
+    }
+    Flush();
+}
+
+void LineRenderer::DrawPoints(const float* vertices, int count, float size) {
+    for (int i = 0; i < count; ++i) {
+        Push(vertices + i * 6, vertices + i * 6, size, LineCap::Round, LineCap::Round);
+    }
+    Flush();
+}
+
+void LineRenderer::Flush() {
+    if (m_instances.empty()) {
+        return;
+    }
+
+    GLsizei count = static_cast<GLsizei>(m_instances.size());
+    GLsizeiptr size = static_cast<GLsizeiptr>(count * sizeof(Instance));
+
+    // Stream into a ring; orphan the storage whenever it wraps so the GPU can
+    // keep reading the previous contents without a sync
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    if (size > m_capacity) {
+        m_capacity = std::max(size, m_capacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, m_capacity, nullptr, GL_STREAM_DRAW);
+        m_offset = 0;
+    } else if (m_offset + size > m_capacity) {
+        glBufferData(GL_ARRAY_BUFFER, m_capacity, nullptr, GL_STREAM_DRAW);
+        m_offset = 0;
+    }
+
+    void* dst = glMapBufferRange(GL_ARRAY_BUFFER, m_offset, size,
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (dst == nullptr) {
+        m_instances.clear();
+        return;
+    }
+    std::memcpy(dst, m_instances.data(), size);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+
+    // No base instance in GL 4.1, so re-point the instance attributes instead
+    glBindVertexArray(m_VAO);
+    const GLsizei stride = sizeof(Instance);
+    const char* base = reinterpret_cast<const char*>(m_offset);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, base + offsetof(Instance, start));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, base + offsetof(Instance, end));
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, base + offsetof(Instance, startColor));
+    glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, base + offsetof(Instance, endColor));
+    glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, stride, base + offsetof(Instance, width));
+    glVertexAttribIPointer(6, 1, GL_UNSIGNED_INT, stride, base + offsetof(Instance, caps));
+
+    // Draw with our own program, then hand the caller's program back. Nothing
+    // is read back from GL: this runs once per overlay command.
+    const Shader* previous = Shader::GetCurrent();
+    m_shader->Use();
+    m_shader->SetMat4("transform", m_transform);
+    m_shader->SetVec2("viewportSize", m_viewportSize);
+
+    // Premultiplied-friendly blending so offscreen overlay layers stay correct;
+    // blending is off everywhere else, so it is left off
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+
+    glDisable(GL_BLEND);
+    glBindVertexArray(0);
+    if (previous != nullptr && previous != m_shader.get()) {
+        previous->Use();
+    }
+
+    m_offset += size;
+    m_instances.clear();
+}
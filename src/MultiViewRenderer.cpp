@@ -0,0 +1,178 @@
+#include "MultiViewRenderer.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+MultiViewRenderer::MultiViewRenderer()
+    : m_viewBuffer(0), m_viewCount(1), m_mode(Mode::SingleDraw), m_viewports(), m_planes() {
+}
+
+MultiViewRenderer::~MultiViewRenderer() {
+    Shutdown();
+}
+
+bool MultiViewRenderer::Initialize() {
+    GLint maxViewports = 0;
+    glGetIntegerv(GL_MAX_VIEWPORTS, &maxViewports);
+    if (maxViewports < kMaxViews) {
+        std::cerr << "ERROR::MULTI_VIEW::TOO_FEW_VIEWPORTS " << maxViewports << std::endl;
+        return false;
+    }
+
+    m_shader = std::make_unique<Shader>("shaders/vertex_multiview.glsl", "shaders/geometry_multiview.glsl",
+                                        "shaders/fragment.glsl");
+    if (m_shader->GetID() == 0) {
+        m_shader.reset();
+        return false;
+    }
+    m_shader->SetUniformBlock("Views", kViewsBinding);
+    m_shader->Use();
+    m_shader->SetInt("cascadeCount", 0);
+    m_shader->SetBool("useTexture", false);
+
+    glGenBuffers(1, &m_viewBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_viewBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, 2 * kMaxViews * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    return true;
+}
+
+void MultiViewRenderer::Shutdown() {
+    if (m_viewBuffer != 0) {
+        glDeleteBuffers(1, &m_viewBuffer);
+        m_viewBuffer = 0;
+    }
+    m_shader.reset();
+}
+
+void MultiViewRenderer::SetViewCount(int count, int width, int height) {
+    m_viewCount = std::clamp(count, 1, kMaxViews);
+    int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(m_viewCount))));
+    int rows = (m_viewCount + columns - 1) / columns;
+    float cellWidth = static_cast<float>(width) / columns;
+    float cellHeight = static_cast<float>(height) / rows;
+
+    // Row-major from the top left
+    for (int view = 0; view < m_viewCount; ++view) {
+        int column = view % columns;
+        int row = rows - 1 - view / columns;
+        m_viewports[view] = glm::vec4(std::floor(column * cellWidth), std::floor(row * cellHeight),
+                                      std::floor(cellWidth), std::floor(cellHeight));
+        m_cameras[view].SetAspectRatio(cellWidth / cellHeight);
+    }
+}
+
+void MultiViewRenderer::Cull(const std::vector<AABB>& bounds, const std::vector<uint32_t>& slots) {
+    auto start = std::chrono::high_resolution_clock::now();
+    m_stats = Stats();
+    m_stats.views = m_viewCount;
+    m_stats.objects = slots.size();
+
+    // Planes of every view (Gribb/Hartmann) and a box around all their frustum corners
+    AABB all = { glm::vec3(INFINITY), glm::vec3(-INFINITY) };
+    for (int view = 0; view < m_viewCount; ++view) {
+        glm::mat4 viewProjection = m_cameras[view].GetViewProjectionMatrix();
+        glm::mat4 transposed = glm::transpose(viewProjection);
+        for (int axis = 0; axis < 3; ++axis) {
+            m_planes[view][axis * 2] = transposed[3] + transposed[axis];
+            m_planes[view][axis * 2 + 1] = transposed[3] - transposed[axis];
+        }
+
+        glm::mat4 inverse = glm::inverse(viewProjection);
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec4 ndc((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f, 1.0f);
+            glm::vec4 world = inverse * ndc;
+            glm::vec3 point = glm::vec3(world) / world.w;
+            all.min = glm::min(all.min, point);
+            all.max = glm::max(all.max, point);
+        }
+    }
+
+    m_visible.clear();
+    m_viewMasks.resize(bounds.size());
+    for (uint32_t slot : slots) {
+        const AABB& box = bounds[slot];
+        if (box.max.x < all.min.x || box.min.x > all.max.x || box.max.y < all.min.y || box.min.y > all.max.y
+            || box.max.z < all.min.z || box.min.z > all.max.z) {
+            ++m_stats.unionCulled;
+            continue;
+        }
+
+        // Center and extents are shared by every view's test
+        glm::vec3 center = box.GetCenter();
+        glm::vec3 extents = box.GetExtents();
+        uint32_t mask = 0;
+        for (int view = 0; view < m_viewCount; ++view) {
+            bool inside = true;
+            for (const glm::vec4& plane : m_planes[view]) {
+                glm::vec3 normal(plane);
+                if (glm::dot(normal, center) + glm::dot(glm::abs(normal), extents) + plane.w < 0.0f) {
+                    inside = false;
+                    break;
+                }
+            }
+            mask |= inside ? 1u << view : 0u;
+        }
+        m_viewMasks[slot] = mask;
+        if (mask != 0) {
+            m_visible.push_back(slot);
+            m_stats.viewInstances += std::bitset<32>(mask).count();
+        }
+    }
+    m_stats.visible = m_visible.size();
+    m_stats.cullMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void MultiViewRenderer::Render(Renderer& renderer, const glm::mat4* world, const glm::vec3* colors,
+                               const Shader& perViewShader) {
+    auto start = std::chrono::high_resolution_clock::now();
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    if (m_mode == Mode::SingleDraw) {
+        glm::mat4 matrices[2 * kMaxViews];
+        for (int view = 0; view < m_viewCount; ++view) {
+            matrices[view] = m_cameras[view].GetViewMatrix();
+            matrices[kMaxViews + view] = m_cameras[view].GetProjectionMatrix();
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, m_viewBuffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(matrices), matrices);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, kViewsBinding, m_viewBuffer);
+        glViewportArrayv(0, m_viewCount, &m_viewports[0][0]);
+
+        m_shader->Use();
+        m_shader->SetInt("viewCount", m_viewCount);
+        renderer.DrawCubeMultiView(world, colors, m_viewMasks.data(), m_visible.data(),
+                                   static_cast<int>(m_visible.size()), m_viewCount);
+        m_stats.draws = m_visible.empty() ? 0 : 1;
+    } else {
+        perViewShader.Use();
+        for (int view = 0; view < m_viewCount; ++view) {
+            m_viewSlots.clear();
+            for (uint32_t slot : m_visible) {
+                if (m_viewMasks[slot] & (1u << view)) {
+                    m_viewSlots.push_back(slot);
+                }
+            }
+            if (m_viewSlots.empty()) {
+                continue;
+            }
+            const glm::vec4& rect = m_viewports[view];
+            glViewport(static_cast<GLint>(rect.x), static_cast<GLint>(rect.y),
+                       static_cast<GLsizei>(rect.z), static_cast<GLsizei>(rect.w));
+            perViewShader.SetMat4("view", m_cameras[view].GetViewMatrix());
+            perViewShader.SetMat4("projection", m_cameras[view].GetProjectionMatrix());
+            renderer.DrawCubeInstanced(world, colors, m_viewSlots.data(), static_cast<int>(m_viewSlots.size()));
+            ++m_stats.draws;
+        }
+    }
+
+    // Also resets every other viewport index to the same rectangle
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    m_stats.submitMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
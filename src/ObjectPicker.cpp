@@ -0,0 +1,391 @@
+#include "ObjectPicker.h"
+#include "Camera.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+// Slab test; returns the entry distance or infinity when the ray misses
+// within maxDistance
+float IntersectBox(const glm::vec3& origin, const glm::vec3& inverseDirection, const AABB& box, float maxDistance) {
+    glm::vec3 t0 = (box.min - origin) * inverseDirection;
+    glm::vec3 t1 = (box.max - origin) * inverseDirection;
+    glm::vec3 lower = glm::min(t0, t1);
+    glm::vec3 upper = glm::max(t0, t1);
+    float enter = std::max(std::max(lower.x, lower.y), std::max(lower.z, 0.0f));
+    float exit = std::min(std::min(upper.x, upper.y), std::min(upper.z, maxDistance));
+    return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+}
+
+// Conservative: false only when all corners are outside one clip plane
+bool InClipVolume(const glm::mat4& viewProjection, const AABB& box) {
+    int outside[6] = {};
+    for (int i = 0; i < 8; ++i) {
+        glm::vec3 corner((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z);
+        glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+        outside[0] += clip.x < -clip.w;
+        outside[1] += clip.x > clip.w;
+        outside[2] += clip.y < -clip.w;
+        outside[3] += clip.y > clip.w;
+        outside[4] += clip.z < -clip.w;
+        outside[5] += clip.z > clip.w;
+    }
+    for (int count : outside) {
+        if (count == 8) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+ObjectPicker::ObjectPicker()
+    : m_framebuffer(0), m_idRenderbuffer(0), m_depthRenderbuffer(0), m_frame(0), m_bvhVersion(0), m_bvhValid(false) {
+}
+
+ObjectPicker::~ObjectPicker() {
+    Shutdown();
+}
+
+bool ObjectPicker::Initialize() {
+    m_shader = std::make_unique<Shader>("shaders/vertex_pick_instanced.glsl", "shaders/fragment_pick.glsl");
+
+    glGenRenderbuffers(1, &m_idRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_idRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_R32UI, kRegionSize, kRegionSize);
+    glGenRenderbuffers(1, &m_depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, kRegionSize, kRegionSize);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_idRenderbuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) {
+        std::cerr << "ERROR::OBJECT_PICKER::FRAMEBUFFER_INCOMPLETE" << std::endl;
+        Shutdown();
+        return false;
+    }
+
+    for (Readback& readback : m_readbacks) {
+        glGenBuffers(1, &readback.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, kRegionSize * kRegionSize * sizeof(uint32_t), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void ObjectPicker::Shutdown() {
+    for (Readback& readback : m_readbacks) {
+        if (readback.fence != nullptr) {
+            glDeleteSync(readback.fence);
+            readback.fence = nullptr;
+        }
+        if (readback.pbo != 0) {
+            glDeleteBuffers(1, &readback.pbo);
+            readback.pbo = 0;
+        }
+    }
+    if (m_framebuffer != 0) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        m_framebuffer = 0;
+    }
+    for (GLuint* renderbuffer : { &m_idRenderbuffer, &m_depthRenderbuffer }) {
+        if (*renderbuffer != 0) {
+            glDeleteRenderbuffers(1, renderbuffer);
+            *renderbuffer = 0;
+        }
+    }
+    if (m_shader) {
+        m_shader->Delete();
+        m_shader.reset();
+    }
+}
+
+bool ObjectPicker::RequestGPU(int x, int y, int width, int height, const Camera& camera, Renderer& renderer,
+                              const std::vector<glm::mat4>& world, const std::vector<AABB>& bounds,
+                              const std::vector<uint32_t>& slots, const std::vector<uint32_t>& ids) {
+    auto start = std::chrono::high_resolution_clock::now();
+    ++m_stats.gpuRequests;
+    Readback* readback = nullptr;
+    for (Readback& candidate : m_readbacks) {
+        if (candidate.fence == nullptr) {
+            readback = &candidate;
+            break;
+        }
+    }
+    if (readback == nullptr || width <= 0 || height <= 0) {
+        ++m_stats.gpuDropped;
+        return false;
+    }
+
+    // Scale the projection so the region around the cursor fills the small target
+    float centerX = 2.0f * (x + 0.5f) / width - 1.0f;
+    float centerY = 1.0f - 2.0f * (y + 0.5f) / height;
+    glm::mat4 region = glm::scale(glm::mat4(1.0f), glm::vec3(static_cast<float>(width) / kRegionSize,
+                                                             static_cast<float>(height) / kRegionSize, 1.0f));
+    region = glm::translate(region, glm::vec3(-centerX, -centerY, 0.0f));
+    glm::mat4 viewProjection = region * camera.GetViewProjectionMatrix();
+
+    // Only objects reaching into the region are drawn, their ID + 1 in the color attribute
+    m_candidates.clear();
+    m_idAttributes.resize(world.size());
+    for (uint32_t slot : slots) {
+        if (InClipVolume(viewProjection, bounds[slot])) {
+            m_candidates.push_back(slot);
+            m_idAttributes[slot] = glm::vec3(static_cast<float>(ids[slot]) + 1.0f, 0.0f, 0.0f);
+        }
+    }
+    m_stats.gpuCandidates = m_candidates.size();
+
+    GLint viewport[4];
+    GLint framebuffer = 0;
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, kRegionSize, kRegionSize);
+    const GLuint background[4] = { 0, 0, 0, 0 };
+    const GLfloat farDepth = 1.0f;
+    glClearBufferuiv(GL_COLOR, 0, background);
+    glClearBufferfv(GL_DEPTH, 0, &farDepth);
+
+    if (!m_candidates.empty()) {
+        m_shader->Use();
+        m_shader->SetMat4("viewProjection", viewProjection);
+        renderer.DrawCubeInstanced(world.data(), m_idAttributes.data(), m_candidates.data(),
+                                   static_cast<int>(m_candidates.size()));
+    }
+
+    // Copied into the PBO on the GPU; the fence tells when it can be mapped
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+    glReadPixels(0, 0, kRegionSize, kRegionSize, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback->x = x;
+    readback->y = y;
+    readback->frame = m_frame;
+    readback->start = start;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    return true;
+}
+
+void ObjectPicker::Update(std::vector<PickResult>& results) {
+    ++m_frame;
+    for (Readback& readback : m_readbacks) {
+        if (readback.fence == nullptr) {
+            continue;
+        }
+        GLenum status = glClientWaitSync(readback.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            continue;
+        }
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+
+        PickResult result;
+        result.method = PickMethod::GPU;
+        result.x = readback.x;
+        result.y = readback.y;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+        const uint32_t* ids = static_cast<const uint32_t*>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, kRegionSize * kRegionSize * sizeof(uint32_t), GL_MAP_READ_BIT));
+        if (ids != nullptr) {
+            // The cursor pixel, or else the nearest covered pixel of the region
+            // so tiny objects can still be hit
+            const int center = kRegionSize / 2;
+            int best = std::numeric_limits<int>::max();
+            for (int row = 0; row < kRegionSize; ++row) {
+                for (int column = 0; column < kRegionSize; ++column) {
+                    uint32_t id = ids[row * kRegionSize + column];
+                    int distance = (row - center) * (row - center) + (column - center) * (column - center);
+                    if (id != 0 && distance < best) {
+                        best = distance;
+                        result.id = id - 1;
+                    }
+                }
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        result.latencyFrames = m_frame - readback.frame;
+        result.latencyMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - readback.start).count();
+        results.push_back(result);
+    }
+}
+
+bool ObjectPicker::IsPending() const {
+    for (const Readback& readback : m_readbacks) {
+        if (readback.fence != nullptr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+PickResult ObjectPicker::PickCPU(int x, int y, int width, int height, const Camera& camera,
+                                 const std::vector<glm::mat4>& world, const std::vector<AABB>& bounds,
+                                 const std::vector<uint32_t>& slots, const std::vector<uint32_t>& ids, unsigned int version) {
+    auto start = std::chrono::high_resolution_clock::now();
+    PickResult result;
+    result.method = PickMethod::CPU;
+    result.x = x;
+    result.y = y;
+    if (!m_bvhValid || version != m_bvhVersion) {
+        // Moved objects only need their boxes refitted; a different object set needs a new tree
+        if (m_bvhValid && slots == m_bvhSource) {
+            RefitBvh(bounds);
+        } else {
+            BuildBvh(bounds, slots);
+        }
+        m_bvhVersion = version;
+        m_bvhValid = true;
+    }
+
+    // Ray through the pixel center from the near to the far plane
+    float ndcX = 2.0f * (x + 0.5f) / std::max(width, 1) - 1.0f;
+    float ndcY = 1.0f - 2.0f * (y + 0.5f) / std::max(height, 1);
+    glm::mat4 inverse = glm::inverse(camera.GetViewProjectionMatrix());
+    glm::vec4 nearPoint = inverse * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverse * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    glm::vec3 direction = glm::vec3(farPoint) / farPoint.w - origin;
+    float length = glm::length(direction);
+    direction /= length;
+    glm::vec3 inverseDirection = 1.0f / direction;
+
+    // Front-to-back traversal, pruned by the closest exact hit so far
+    float closest = length;
+    m_stats.cpuTested = 0;
+    uint32_t stack[64];
+    int stackSize = 0;
+    if (!m_bvh.empty()) {
+        stack[stackSize++] = 0;
+    }
+    while (stackSize > 0) {
+        const BvhNode& node = m_bvh[stack[--stackSize]];
+        if (IntersectBox(origin, inverseDirection, node.bounds, closest) == std::numeric_limits<float>::infinity()) {
+            continue;
+        }
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                // Ray in the cube's space; the parameter is the same in both spaces
+                uint32_t slot = m_bvhSlots[i];
+                glm::mat4 toLocal = glm::inverse(world[slot]);
+                glm::vec3 localOrigin = glm::vec3(toLocal * glm::vec4(origin, 1.0f));
+                glm::vec3 localDirection = glm::vec3(toLocal * glm::vec4(direction, 0.0f));
+                float distance = IntersectBox(localOrigin, 1.0f / localDirection,
+                                              { glm::vec3(-0.5f), glm::vec3(0.5f) }, closest);
+                ++m_stats.cpuTested;
+                if (distance < closest) {
+                    closest = distance;
+                    result.id = ids[slot];
+                    result.distance = distance;
+                }
+            }
+            continue;
+        }
+
+        uint32_t left = static_cast<uint32_t>(&node - m_bvh.data()) + 1;
+        uint32_t right = node.first;
+        float leftDistance = IntersectBox(origin, inverseDirection, m_bvh[left].bounds, closest);
+        float rightDistance = IntersectBox(origin, inverseDirection, m_bvh[right].bounds, closest);
+        if (leftDistance > rightDistance) {
+            std::swap(left, right);
+            std::swap(leftDistance, rightDistance);
+        }
+        if (rightDistance != std::numeric_limits<float>::infinity() && stackSize < 64) {
+            stack[stackSize++] = right;
+        }
+        if (leftDistance != std::numeric_limits<float>::infinity() && stackSize < 64) {
+            stack[stackSize++] = left;
+        }
+    }
+
+    result.latencyMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    return result;
+}
+
+void ObjectPicker::BuildBvh(const std::vector<AABB>& bounds, const std::vector<uint32_t>& slots) {
+    auto start = std::chrono::high_resolution_clock::now();
+    m_bvh.clear();
+    m_bvhSource = slots;
+    m_bvhSlots = slots;
+    m_centroids.resize(bounds.size());
+    for (uint32_t slot : slots) {
+        m_centroids[slot] = bounds[slot].GetCenter();
+    }
+    if (!m_bvhSlots.empty()) {
+        m_bvh.reserve(2 * m_bvhSlots.size() / kLeafSize + 1);
+        BuildNode(bounds, 0, static_cast<uint32_t>(m_bvhSlots.size()));
+    }
+    m_stats.bvhNodes = m_bvh.size();
+    m_stats.bvhRefit = false;
+    m_stats.bvhBuildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Median split along the widest axis of the centroids
+uint32_t ObjectPicker::BuildNode(const std::vector<AABB>& bounds, uint32_t begin, uint32_t end) {
+    uint32_t index = static_cast<uint32_t>(m_bvh.size());
+    m_bvh.emplace_back();
+
+    AABB box = bounds[m_bvhSlots[begin]];
+    AABB centroids = { m_centroids[m_bvhSlots[begin]], m_centroids[m_bvhSlots[begin]] };
+    for (uint32_t i = begin + 1; i < end; ++i) {
+        uint32_t slot = m_bvhSlots[i];
+        box = { glm::min(box.min, bounds[slot].min), glm::max(box.max, bounds[slot].max) };
+        centroids = { glm::min(centroids.min, m_centroids[slot]), glm::max(centroids.max, m_centroids[slot]) };
+    }
+    m_bvh[index].bounds = box;
+
+    glm::vec3 extent = centroids.max - centroids.min;
+    if (end - begin <= kLeafSize || std::max(std::max(extent.x, extent.y), extent.z) <= 0.0f) {
+        m_bvh[index].first = begin;
+        m_bvh[index].count = end - begin;
+        return index;
+    }
+
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(m_bvhSlots.begin() + begin, m_bvhSlots.begin() + middle, m_bvhSlots.begin() + end,
+                     [this, axis](uint32_t a, uint32_t b) { return m_centroids[a][axis] < m_centroids[b][axis]; });
+    BuildNode(bounds, begin, middle);
+    uint32_t right = BuildNode(bounds, middle, end);
+    m_bvh[index].first = right;
+    return index;
+}
+
+// Children follow their parent in the array, so a reverse sweep sees them first
+void ObjectPicker::RefitBvh(const std::vector<AABB>& bounds) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t index = m_bvh.size(); index-- > 0;) {
+        BvhNode& node = m_bvh[index];
+        if (node.count > 0) {
+            node.bounds = bounds[m_bvhSlots[node.first]];
+            for (uint32_t i = node.first + 1; i < node.first + node.count; ++i) {
+                const AABB& box = bounds[m_bvhSlots[i]];
+                node.bounds = { glm::min(node.bounds.min, box.min), glm::max(node.bounds.max, box.max) };
+            }
+        } else {
+            const AABB& left = m_bvh[index + 1].bounds;
+            const AABB& right = m_bvh[node.first].bounds;
+            node.bounds = { glm::min(left.min, right.min), glm::max(left.max, right.max) };
+        }
+    }
+    m_stats.bvhRefit = true;
+    m_stats.bvhBuildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
@@ -0,0 +1,366 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+OcclusionCuller::OcclusionCuller()
+    : m_enabled(true), m_width(0), m_height(0), m_cellsX(0), m_cellsY(0), m_frame(0),
+      m_queryFrame(0), m_sourceViewProjection(1.0f), m_hasSource(false), m_viewProjection(1.0f) {
+}
+
+OcclusionCuller::~OcclusionCuller() {
+    Shutdown();
+}
+
+bool OcclusionCuller::Initialize(int width, int height) {
+    for (QueryFrame& frame : m_queryFrames) {
+        glGenQueries(2, frame.queries);
+    }
+    Resize(width, height);
+    return true;
+}
+
+void OcclusionCuller::Resize(int width, int height) {
+    DestroyReadbackBuffers();
+
+    m_width = std::max(width, 1);
+    m_height = std::max(height, 1);
+    m_cellsX = (m_width + kCellSize - 1) / kCellSize;
+    m_cellsY = (m_height + kCellSize - 1) / kCellSize;
+    m_sourceDepth.assign(m_cellsX * m_cellsY, 1.0f);
+    m_hasSource = false;
+    m_pyramid.clear();
+
+    CreateReadbackBuffers();
+}
+
+void OcclusionCuller::Shutdown() {
+    DestroyReadbackBuffers();
+    for (QueryFrame& frame : m_queryFrames) {
+        if (frame.queries[0] != 0) {
+            glDeleteQueries(2, frame.queries);
+            frame.queries[0] = frame.queries[1] = 0;
+        }
+        frame.issued[0] = frame.issued[1] = false;
+    }
+}
+
+void OcclusionCuller::CreateReadbackBuffers() {
+    GLsizeiptr size = static_cast<GLsizeiptr>(m_width) * m_height * sizeof(float);
+    for (ReadbackSlot& slot : m_slots) {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void OcclusionCuller::DestroyReadbackBuffers() {
+    for (ReadbackSlot& slot : m_slots) {
+        if (slot.fence != nullptr) {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        if (slot.pbo != 0) {
+            glDeleteBuffers(1, &slot.pbo);
+            slot.pbo = 0;
+        }
+    }
+}
+
+void OcclusionCuller::BeginFrame(const glm::mat4& viewProjection) {
+    ++m_frame;
+    m_stats.objectsTested = 0;
+    m_stats.objectsCulled = 0;
+    m_viewProjection = viewProjection;
+
+    m_queryFrame = (m_queryFrame + 1) % kQueryFrames;
+    CollectQueries();
+
+    if (!m_enabled) {
+        m_hasSource = false;
+        m_pyramid.clear();
+        return;
+    }
+
+    if (ConsumeReadback()) {
+        m_hasSource = true;
+    }
+
+    if (m_hasSource) {
+        Reproject(viewProjection);
+        BuildPyramid();
+    } else {
+        m_pyramid.clear();
+    }
+}
+
+bool OcclusionCuller::ConsumeReadback() {
+    // Pick the newest readback whose fence has signaled; never wait on the GPU
+    int newest = -1;
+    for (int i = 0; i < kReadbackSlots; ++i) {
+        ReadbackSlot& slot = m_slots[i];
+        if (slot.fence == nullptr) {
+            continue;
+        }
+        GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            continue;
+        }
+        if (newest < 0 || slot.frame > m_slots[newest].frame) {
+            newest = i;
+        }
+    }
+    if (newest < 0) {
+        return false;
+    }
+
+    // Older completed readbacks are stale now, recycle them
+    for (ReadbackSlot& slot : m_slots) {
+        if (slot.fence != nullptr && slot.frame < m_slots[newest].frame) {
+            GLenum status = glClientWaitSync(slot.fence, 0, 0);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+                glDeleteSync(slot.fence);
+                slot.fence = nullptr;
+            }
+        }
+    }
+
+    ReadbackSlot& slot = m_slots[newest];
+    GLsizeiptr size = static_cast<GLsizeiptr>(m_width) * m_height * sizeof(float);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const float* depth = static_cast<const float*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+    if (depth != nullptr) {
+        // Reduce to the farthest depth of each cell so the pyramid stays conservative
+        std::fill(m_sourceDepth.begin(), m_sourceDepth.end(), 0.0f);
+        for (int y = 0; y < m_height; ++y) {
+            const float* row = depth + static_cast<size_t>(y) * m_width;
+            float* cells = m_sourceDepth.data() + static_cast<size_t>(y / kCellSize) * m_cellsX;
+            for (int x = 0; x < m_width; ++x) {
+                float& cell = cells[x / kCellSize];
+                cell = std::max(cell, row[x]);
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        m_sourceViewProjection = slot.viewProjection;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    return depth != nullptr;
+}
+
+void OcclusionCuller::Reproject(const glm::mat4& viewProjection) {
+    if (m_pyramid.empty()) {
+        m_pyramid.resize(1);
+    }
+    Level& base = m_pyramid[0];
+    base.width = m_cellsX;
+    base.height = m_cellsY;
+
+    // Same view as the readback: no reprojection needed
+    if (viewProjection == m_sourceViewProjection) {
+        base.depth = m_sourceDepth;
+        return;
+    }
+
+    // Forward-splat each cell into the current view. Cells nothing lands in
+    // stay at -1 and become "far" below, which keeps disocclusions visible.
+    base.depth.assign(m_cellsX * m_cellsY, -1.0f);
+    glm::mat4 reprojection = viewProjection * glm::inverse(m_sourceViewProjection);
+
+    for (int cy = 0; cy < m_cellsY; ++cy) {
+        float ndcY = (std::min((cy + 0.5f) * kCellSize, static_cast<float>(m_height)) / m_height) * 2.0f - 1.0f;
+        for (int cx = 0; cx < m_cellsX; ++cx) {
+            float depth = m_sourceDepth[cy * m_cellsX + cx];
+            if (depth >= 1.0f) {
+                continue;
+            }
+            float ndcX = (std::min((cx + 0.5f) * kCellSize, static_cast<float>(m_width)) / m_width) * 2.0f - 1.0f;
+
+            glm::vec4 clip = reprojection * glm::vec4(ndcX, ndcY, depth * 2.0f - 1.0f, 1.0f);
+            if (clip.w <= 1e-6f) {
+                continue;
+            }
+            glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            if (ndc.x < -1.0f || ndc.x > 1.0f || ndc.y < -1.0f || ndc.y > 1.0f || ndc.z > 1.0f) {
+                continue;
+            }
+
+            int tx = std::min(static_cast<int>((ndc.x * 0.5f + 0.5f) * m_cellsX), m_cellsX - 1);
+            int ty = std::min(static_cast<int>((ndc.y * 0.5f + 0.5f) * m_cellsY), m_cellsY - 1);
+            float& target = base.depth[ty * m_cellsX + tx];
+            target = std::max(target, std::max(ndc.z * 0.5f + 0.5f, 0.0f));
+        }
+    }
+
+    for (float& depth : base.depth) {
+        if (depth < 0.0f) {
+            depth = 1.0f;
+        }
+    }
+}
+
+void OcclusionCuller::BuildPyramid() {
+    size_t levelIndex = 1;
+    while (m_pyramid[levelIndex - 1].width > 1 || m_pyramid[levelIndex - 1].height > 1) {
+        if (m_pyramid.size() <= levelIndex) {
+            m_pyramid.emplace_back();
+        }
+        const Level& src = m_pyramid[levelIndex - 1];
+        Level& dst = m_pyramid[levelIndex];
+        dst.width = std::max(1, (src.width + 1) / 2);
+        dst.height = std::max(1, (src.height + 1) / 2);
+        dst.depth.resize(dst.width * dst.height);
+
+        for (int y = 0; y < dst.height; ++y) {
+            int y0 = std::min(y * 2, src.height - 1);
+            int y1 = std::min(y * 2 + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                int x0 = std::min(x * 2, src.width - 1);
+                int x1 = std::min(x * 2 + 1, src.width - 1);
+                dst.depth[y * dst.width + x] = std::max(
+                    std::max(src.depth[y0 * src.width + x0], src.depth[y0 * src.width + x1]),
+                    std::max(src.depth[y1 * src.width + x0], src.depth[y1 * src.width + x1]));
+            }
+        }
+        ++levelIndex;
+    }
+    m_pyramid.resize(levelIndex);
+}
+
+bool OcclusionCuller::IsVisible(const AABB& bounds) {
+    ++m_stats.objectsTested;
+    if (!m_enabled || m_pyramid.empty()) {
+        return true;
+    }
+
+    // Project the box corners; anything crossing the near plane is kept
+    glm::vec2 rectMin(1e30f), rectMax(-1e30f);
+    float nearestDepth = 1.0f;
+    for (int i = 0; i < 8; ++i) {
+        glm::vec3 corner((i & 1) ? bounds.max.x : bounds.min.x,
+                         (i & 2) ? bounds.max.y : bounds.min.y,
+                         (i & 4) ? bounds.max.z : bounds.min.z);
+        glm::vec4 clip = m_viewProjection * glm::vec4(corner, 1.0f);
+        if (clip.w <= 1e-6f) {
+            return true;
+        }
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        rectMin = glm::min(rectMin, glm::vec2(ndc));
+        rectMax = glm::max(rectMax, glm::vec2(ndc));
+        nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+    }
+
+    // Entirely outside the screen
+    if (rectMax.x < -1.0f || rectMin.x > 1.0f || rectMax.y < -1.0f || rectMin.y > 1.0f) {
+        ++m_stats.objectsCulled;
+        return false;
+    }
+
+    const Level& base = m_pyramid[0];
+    float x0 = (std::max(rectMin.x, -1.0f) * 0.5f + 0.5f) * base.width;
+    float x1 = (std::min(rectMax.x, 1.0f) * 0.5f + 0.5f) * base.width;
+    float y0 = (std::max(rectMin.y, -1.0f) * 0.5f + 0.5f) * base.height;
+    float y1 = (std::min(rectMax.y, 1.0f) * 0.5f + 0.5f) * base.height;
+
+    // Choose the level where the rectangle spans at most two texels per axis
+    float extent = std::max(std::max(x1 - x0, y1 - y0), 1.0f);
+    int level = std::clamp(static_cast<int>(std::ceil(std::log2(extent))) - 1, 0, static_cast<int>(m_pyramid.size()) - 1);
+    const Level& lod = m_pyramid[level];
+    float scale = 1.0f / static_cast<float>(1 << level);
+
+    int ix0 = std::clamp(static_cast<int>(x0 * scale), 0, lod.width - 1);
+    int ix1 = std::clamp(static_cast<int>(x1 * scale), 0, lod.width - 1);
+    int iy0 = std::clamp(static_cast<int>(y0 * scale), 0, lod.height - 1);
+    int iy1 = std::clamp(static_cast<int>(y1 * scale), 0, lod.height - 1);
+
+    float occluderDepth = 0.0f;
+    for (int y = iy0; y <= iy1; ++y) {
+        for (int x = ix0; x <= ix1; ++x) {
+            occluderDepth = std::max(occluderDepth, lod.depth[y * lod.width + x]);
+        }
+    }
+
+    // Small bias absorbs reprojection and depth precision error
+    if (nearestDepth > occluderDepth + 1e-4f) {
+        ++m_stats.objectsCulled;
+        return false;
+    }
+    return true;
+}
+
+void OcclusionCuller::EndFrame() {
+    if (!m_enabled) {
+        return;
+    }
+
+    // Reuse a free slot, or the oldest in-flight one if the GPU is far behind
+    ReadbackSlot* target = nullptr;
+    for (ReadbackSlot& slot : m_slots) {
+        if (slot.fence == nullptr) {
+            target = &slot;
+            break;
+        }
+        if (target == nullptr || slot.frame < target->frame) {
+            target = &slot;
+        }
+    }
+    if (target->fence != nullptr) {
+        glDeleteSync(target->fence);
+        target->fence = nullptr;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, target->pbo);
+    glReadPixels(0, 0, m_width, m_height, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    target->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    target->viewProjection = m_viewProjection;
+    target->frame = m_frame;
+}
+
+void OcclusionCuller::BeginQuery(Pass pass) {
+    QueryFrame& frame = m_queryFrames[m_queryFrame];
+    int index = static_cast<int>(pass);
+    glBeginQuery(GL_SAMPLES_PASSED, frame.queries[index]);
+    frame.issued[index] = true;
+}
+
+void OcclusionCuller::EndQuery(Pass pass) {
+    (void)pass;
+    glEndQuery(GL_SAMPLES_PASSED);
+}
+
+void OcclusionCuller::CollectQueries() {
+    // The slot about to be reused was issued kQueryFrames - 1 frames ago
+    QueryFrame& frame = m_queryFrames[m_queryFrame];
+    const int prepass = static_cast<int>(Pass::Prepass);
+    const int shading = static_cast<int>(Pass::Shading);
+
+    if (frame.issued[shading]) {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(frame.queries[shading], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (frame.issued[prepass]) {
+            GLuint prepassAvailable = GL_FALSE;
+            glGetQueryObjectuiv(frame.queries[prepass], GL_QUERY_RESULT_AVAILABLE, &prepassAvailable);
+            available = available && prepassAvailable;
+        }
+
+        if (available) {
+            GLuint64 shaded = 0;
+            glGetQueryObjectui64v(frame.queries[shading], GL_QUERY_RESULT, &shaded);
+            GLuint64 rasterized = shaded;
+            if (frame.issued[prepass]) {
+                glGetQueryObjectui64v(frame.queries[prepass], GL_QUERY_RESULT, &rasterized);
+            }
+            m_stats.fragmentsShaded = shaded;
+            m_stats.fragmentsRasterized = rasterized;
+            m_stats.fragmentsSaved = rasterized > shaded ? rasterized - shaded : 0;
+        }
+    }
+
+    frame.issued[prepass] = false;
+    frame.issued[shading] = false;
+}
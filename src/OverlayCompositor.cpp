@@ -0,0 +1,260 @@
+#include "OverlayCompositor.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include <algorithm>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+OverlayCompositor::OverlayCompositor()
+    : m_width(0), m_height(0), m_recording(-1), m_lineWidth(1.0f), m_pointSize(1.0f),
+      m_emptyVAO(0), m_version(0), m_layersRasterized(0) {
+}
+
+OverlayCompositor::~OverlayCompositor() {
+    Shutdown();
+}
+
+bool OverlayCompositor::Initialize(int width, int height) {
+    m_width = std::max(width, 1);
+    m_height = std::max(height, 1);
+
+    m_compositeShader = std::make_unique<Shader>("shaders/vertex_composite.glsl", "shaders/fragment_composite.glsl");
+    if (m_compositeShader->GetID() == 0) {
+        return false;
+    }
+
+    // Sampler units never change, bind them once
+    m_compositeShader->Use();
+    for (int i = 0; i < kMaxLayers; ++i) {
+        m_compositeShader->SetInt("layers[" + std::to_string(i) + "]", i);
+    }
+    glUseProgram(0);
+
+    glGenVertexArrays(1, &m_emptyVAO);
+    return true;
+}
+
+void OverlayCompositor::Resize(int width, int height) {
+    m_width = std::max(width, 1);
+    m_height = std::max(height, 1);
+    for (Layer& layer : m_layers) {
+        DestroyTarget(layer);
+        CreateTarget(layer);
+        layer.dirty = true;
+    }
+    ++m_version;
+}
+
+void OverlayCompositor::Shutdown() {
+    for (Layer& layer : m_layers) {
+        DestroyTarget(layer);
+    }
+    m_layers.clear();
+
+    if (m_emptyVAO != 0) {
+        glDeleteVertexArrays(1, &m_emptyVAO);
+        m_emptyVAO = 0;
+    }
+    if (m_compositeShader) {
+        m_compositeShader->Delete();
+        m_compositeShader.reset();
+    }
+}
+
+int OverlayCompositor::AddLayer(const std::string& name) {
+    if (static_cast<int>(m_layers.size()) >= kMaxLayers) {
+        std::cerr << "ERROR::OVERLAY::TOO_MANY_LAYERS " << name << std::endl;
+        return -1;
+    }
+
+    Layer layer;
+    layer.name = name;
+    CreateTarget(layer);
+    m_layers.push_back(layer);
+    ++m_version;
+    return static_cast<int>(m_layers.size()) - 1;
+}
+
+void OverlayCompositor::SetLayerVisible(int layer, bool visible) {
+    if (m_layers[layer].visible != visible) {
+        m_layers[layer].visible = visible;
+        ++m_version;
+    }
+}
+
+void OverlayCompositor::CreateTarget(Layer& layer) {
+    glGenTextures(1, &layer.texture);
+    glBindTexture(GL_TEXTURE_2D, layer.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint previous = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+    glGenFramebuffers(1, &layer.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, layer.framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer.texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR::OVERLAY::FRAMEBUFFER_INCOMPLETE " << layer.name << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+}
+
+void OverlayCompositor::DestroyTarget(Layer& layer) {
+    if (layer.framebuffer != 0) {
+        glDeleteFramebuffers(1, &layer.framebuffer);
+        layer.framebuffer = 0;
+    }
+    if (layer.texture != 0) {
+        glDeleteTextures(1, &layer.texture);
+        layer.texture = 0;
+    }
+}
+
+// Display list recording
+void OverlayCompositor::BeginLayer(int layer) {
+    m_recording = layer;
+    m_pendingVertices.clear();
+    m_pendingCommands.clear();
+    m_lineWidth = 1.0f;
+    m_pointSize = 1.0f;
+}
+
+void OverlayCompositor::SetLineWidth(float width) {
+    m_lineWidth = width;
+}
+
+void OverlayCompositor::SetPointSize(float size) {
+    m_pointSize = size;
+}
+
+void OverlayCompositor::AddPoints(const float* vertices, int count) {
+    Record(Primitive::Points, vertices, count, count);
+}
+
+void OverlayCompositor::AddLines(const float* vertices, int count) {
+    Record(Primitive::Lines, vertices, count * 2, count);
+}
+
+void OverlayCompositor::AddLineStrip(const float* vertices, int count) {
+    Record(Primitive::LineStrip, vertices, count, count);
+}
+
+void OverlayCompositor::AddLineLoop(const float* vertices, int count) {
+    Record(Primitive::LineLoop, vertices, count, count);
+}
+
+void OverlayCompositor::Record(Primitive primitive, const float* vertices, int vertexCount, int count) {
+    float size = primitive == Primitive::Points ? m_pointSize : m_lineWidth;
+    int first = static_cast<int>(m_pendingVertices.size() / 6);
+    m_pendingVertices.insert(m_pendingVertices.end(), vertices, vertices + vertexCount * 6);
+    m_pendingCommands.push_back({ primitive, first, count, size });
+}
+
+void OverlayCompositor::EndLayer() {
+    Layer& layer = m_layers[m_recording];
+    m_recording = -1;
+
+    if (layer.vertices == m_pendingVertices && layer.commands == m_pendingCommands) {
+        return;
+    }
+
+    layer.vertices.swap(m_pendingVertices);
+    layer.commands.swap(m_pendingCommands);
+    layer.dirty = true;
+    ++m_version;
+}
+
+void OverlayCompositor::Rasterize(Renderer& renderer, const Shader& shader) {
+    m_layersRasterized = 0;
+
+    bool anyDirty = std::any_of(m_layers.begin(), m_layers.end(), [](const Layer& layer) { return layer.dirty; });
+    if (!anyDirty) {
+        return;
+    }
+
+    GLint previous = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+    glDisable(GL_DEPTH_TEST);
+
+    shader.Use();
+    glm::mat4 identity = glm::mat4(1.0f);
+    glm::mat4 ortho = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
+    shader.SetMat4("model", identity);
+    shader.SetMat4("view", identity);
+    shader.SetMat4("projection", ortho);
+    renderer.SetTransform(ortho);
+
+    for (Layer& layer : m_layers) {
+        if (!layer.dirty) {
+            continue;
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, layer.framebuffer);
+        glViewport(0, 0, m_width, m_height);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        for (const Command& command : layer.commands) {
+            const float* vertices = layer.vertices.data() + command.first * 6;
+            switch (command.primitive) {
+            case Primitive::Points:
+                renderer.SetPointSize(command.size);
+                renderer.DrawPoints(vertices, command.count);
+                break;
+            case Primitive::Lines:
+                renderer.SetLineWidth(command.size);
+                renderer.DrawLines(vertices, command.count);
+                break;
+            case Primitive::LineStrip:
+                renderer.SetLineWidth(command.size);
+                renderer.DrawLineStrip(vertices, command.count);
+                break;
+            case Primitive::LineLoop:
+                renderer.SetLineWidth(command.size);
+                renderer.DrawLineLoop(vertices, command.count);
+                break;
+            }
+        }
+
+        layer.dirty = false;
+        ++m_layersRasterized;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void OverlayCompositor::Composite() {
+    int count = 0;
+    for (const Layer& layer : m_layers) {
+        if (layer.visible && !layer.commands.empty()) {
+            glActiveTexture(GL_TEXTURE0 + count);
+            glBindTexture(GL_TEXTURE_2D, layer.texture);
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_compositeShader->Use();
+    m_compositeShader->SetInt("layerCount", count);
+    glBindVertexArray(m_emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+
+    for (int i = count - 1; i >= 0; --i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+}
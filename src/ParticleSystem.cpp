@@ -0,0 +1,383 @@
+#include "ParticleSystem.h"
+#include "Shader.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Counter buffer layout, shared with the compute shaders
+constexpr GLintptr kDrawCommandBytes = 4 * sizeof(GLuint);
+constexpr GLintptr kDispatchOffset = 2 * kDrawCommandBytes;
+constexpr GLsizeiptr kCounterBytes = kDispatchOffset + 4 * sizeof(GLuint);
+
+// Must match compute_particles_emit.glsl bit for bit
+uint32_t Hash(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float Random(uint32_t& state) {
+    state = Hash(state);
+    return static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+}
+
+} // namespace
+
+ParticleSystem::ParticleSystem()
+    : m_backend(ParticleBackend::CPU), m_capacity(0), m_emitted(0), m_emitAccumulator(0.0f),
+      m_particleBuffers{ 0, 0 }, m_counterBuffer(0), m_current(0), m_readbackBuffers{}, m_readbackFences{},
+      m_readbackNext(0), m_cpuBuffer(0), m_vertexArrays{ 0, 0, 0 } {
+}
+
+ParticleSystem::~ParticleSystem() {
+    Shutdown();
+}
+
+bool ParticleSystem::Initialize(size_t capacity, ParticleBackend backend) {
+    m_capacity = capacity;
+    m_emitted = 0;
+    m_emitAccumulator = 0.0f;
+    m_stats = Stats();
+    m_stats.capacity = capacity;
+
+    m_drawShader = std::make_unique<Shader>("shaders/vertex_particles.glsl", "shaders/fragment_particles.glsl");
+    if (m_drawShader->GetID() == 0) {
+        std::cerr << "ERROR::PARTICLE_SYSTEM::DRAW_SHADER_UNAVAILABLE" << std::endl;
+        return false;
+    }
+    glGenVertexArrays(3, m_vertexArrays);
+
+    if (backend == ParticleBackend::GPU && !GLAD_GL_VERSION_4_3) {
+        std::cerr << "Compute shaders need OpenGL 4.3, simulating particles on the CPU" << std::endl;
+        backend = ParticleBackend::CPU;
+    }
+    m_backend = backend;
+
+    if (m_backend == ParticleBackend::CPU) {
+        m_particles.clear();
+        m_particles.reserve(capacity);
+        glGenBuffers(1, &m_cpuBuffer);
+        SetupVertexArray(m_vertexArrays[2], m_cpuBuffer);
+        return true;
+    }
+
+    m_updateShader = std::make_unique<Shader>("shaders/compute_particles_update.glsl");
+    m_emitShader = std::make_unique<Shader>("shaders/compute_particles_emit.glsl");
+    m_finalizeShader = std::make_unique<Shader>("shaders/compute_particles_finalize.glsl");
+
+    glGenBuffers(2, m_particleBuffers);
+    for (int i = 0; i < 2; ++i) {
+        glBindBuffer(GL_ARRAY_BUFFER, m_particleBuffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Particle), nullptr, GL_DYNAMIC_DRAW);
+        SetupVertexArray(m_vertexArrays[i], m_particleBuffers[i]);
+    }
+
+    // Both buffers empty; the first update dispatches no groups
+    const GLuint counters[] = { 0, 1, 0, 0,  0, 1, 0, 0,  0, 1, 1, 0 };
+    glGenBuffers(1, &m_counterBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_counterBuffer);
+    glBufferData(GL_ARRAY_BUFFER, kCounterBytes, counters, GL_DYNAMIC_DRAW);
+
+    glGenBuffers(kReadbackSlots, m_readbackBuffers);
+    for (GLuint buffer : m_readbackBuffers) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(GLuint), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_current = 0;
+    return true;
+}
+
+void ParticleSystem::SetupVertexArray(GLuint vao, GLuint buffer) {
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)sizeof(glm::vec4));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ParticleSystem::Shutdown() {
+    for (GLsync& fence : m_readbackFences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    for (GLuint* buffer : { &m_particleBuffers[0], &m_particleBuffers[1], &m_counterBuffer, &m_cpuBuffer,
+                            &m_readbackBuffers[0], &m_readbackBuffers[1], &m_readbackBuffers[2] }) {
+        if (*buffer != 0) {
+            glDeleteBuffers(1, buffer);
+            *buffer = 0;
+        }
+    }
+    if (m_vertexArrays[0] != 0) {
+        glDeleteVertexArrays(3, m_vertexArrays);
+        std::fill(m_vertexArrays, m_vertexArrays + 3, 0);
+    }
+    m_updateShader.reset();
+    m_emitShader.reset();
+    m_finalizeShader.reset();
+    m_drawShader.reset();
+    m_particles.clear();
+    m_particles.shrink_to_fit();
+}
+
+void ParticleSystem::Update(float deltaTime) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    m_emitAccumulator += m_emitter.rate * deltaTime;
+    uint32_t emitCount = static_cast<uint32_t>(std::min<float>(m_emitAccumulator, static_cast<float>(m_capacity)));
+    m_emitAccumulator -= emitCount;
+
+    if (m_backend == ParticleBackend::GPU) {
+        UpdateGPU(emitCount, deltaTime);
+        CollectAliveCount();
+    } else {
+        Simulate(m_particles, m_capacity, m_emitter, m_emitted, emitCount, deltaTime);
+        m_stats.alive = m_particles.size();
+    }
+    m_emitted += emitCount;
+    m_stats.emitted += emitCount;
+    m_stats.updateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void ParticleSystem::UpdateGPU(uint32_t emitCount, float deltaTime) {
+    const int src = m_current;
+    const int dst = 1 - m_current;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_particleBuffers[src]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_particleBuffers[dst]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_counterBuffer);
+
+    // Integrate and compact; the group count was written by last frame's finalize
+    m_updateShader->Use();
+    m_updateShader->SetInt("src", src);
+    m_updateShader->SetInt("dst", dst);
+    m_updateShader->SetFloat("deltaTime", deltaTime);
+    m_updateShader->SetVec3("gravity", m_emitter.gravity);
+    m_updateShader->SetFloat("drag", m_emitter.drag);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, m_counterBuffer);
+    glDispatchComputeIndirect(kDispatchOffset);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    if (emitCount > 0) {
+        m_emitShader->Use();
+        m_emitShader->SetInt("dst", dst);
+        m_emitShader->SetInt("emitBase", static_cast<int>(m_emitted));
+        m_emitShader->SetInt("emitCount", static_cast<int>(emitCount));
+        m_emitShader->SetInt("capacity", static_cast<int>(m_capacity));
+        m_emitShader->SetVec3("emitterPosition", m_emitter.position);
+        m_emitShader->SetFloat("speed", m_emitter.speed);
+        m_emitShader->SetFloat("spread", m_emitter.spread);
+        m_emitShader->SetFloat("lifetime", m_emitter.lifetime);
+        glDispatchCompute((emitCount + kGroupSize - 1) / kGroupSize, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    m_finalizeShader->Use();
+    m_finalizeShader->SetInt("src", src);
+    m_finalizeShader->SetInt("dst", dst);
+    m_finalizeShader->SetInt("emitCount", static_cast<int>(emitCount));
+    m_finalizeShader->SetInt("capacity", static_cast<int>(m_capacity));
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT
+                    | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    for (GLuint binding = 0; binding < 3; ++binding) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+    }
+    m_current = dst;
+}
+
+// Copies the alive count into a small ring and reads the oldest copy once its fence has passed
+void ParticleSystem::CollectAliveCount() {
+    int slot = m_readbackNext;
+    if (m_readbackFences[slot] != nullptr) {
+        GLenum status = glClientWaitSync(m_readbackFences[slot], 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            return;  // GPU is more than kReadbackSlots frames behind; try again next frame
+        }
+        glDeleteSync(m_readbackFences[slot]);
+        m_readbackFences[slot] = nullptr;
+
+        glBindBuffer(GL_COPY_READ_BUFFER, m_readbackBuffers[slot]);
+        const void* count = glMapBufferRange(GL_COPY_READ_BUFFER, 0, sizeof(GLuint), GL_MAP_READ_BIT);
+        if (count != nullptr) {
+            GLuint alive = 0;
+            std::memcpy(&alive, count, sizeof(alive));
+            m_stats.alive = alive;
+            glUnmapBuffer(GL_COPY_READ_BUFFER);
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, m_counterBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_readbackBuffers[slot]);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, m_current * kDrawCommandBytes, 0, sizeof(GLuint));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    m_readbackFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_readbackNext = (slot + 1) % kReadbackSlots;
+}
+
+void ParticleSystem::Draw(const glm::mat4& view, const glm::mat4& projection) {
+    if (!m_drawShader) {
+        return;
+    }
+    if (m_backend == ParticleBackend::CPU) {
+        if (m_particles.empty()) {
+            return;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, m_cpuBuffer);
+        glBufferData(GL_ARRAY_BUFFER, m_particles.size() * sizeof(Particle), m_particles.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    m_drawShader->Use();
+    m_drawShader->SetMat4("view", view);
+    m_drawShader->SetMat4("projection", projection);
+    m_drawShader->SetFloat("pointSize", 20.0f);
+
+    GLboolean depthMask = GL_TRUE;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    GLboolean programPointSize = glIsEnabled(GL_PROGRAM_POINT_SIZE);
+    GLint blendFunc[4];
+    glGetIntegerv(GL_BLEND_SRC_RGB, &blendFunc[0]);
+    glGetIntegerv(GL_BLEND_DST_RGB, &blendFunc[1]);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &blendFunc[2]);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &blendFunc[3]);
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glDepthMask(GL_FALSE);
+
+    if (m_backend == ParticleBackend::GPU) {
+        glBindVertexArray(m_vertexArrays[m_current]);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_counterBuffer);
+        glDrawArraysIndirect(GL_POINTS, reinterpret_cast<const void*>(static_cast<uintptr_t>(m_current * kDrawCommandBytes)));
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    } else {
+        glBindVertexArray(m_vertexArrays[2]);
+        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(m_particles.size()));
+    }
+    glBindVertexArray(0);
+
+    glDepthMask(depthMask);
+    glBlendFuncSeparate(blendFunc[0], blendFunc[1], blendFunc[2], blendFunc[3]);
+    if (!blend) {
+        glDisable(GL_BLEND);
+    }
+    if (!programPointSize) {
+        glDisable(GL_PROGRAM_POINT_SIZE);
+    }
+}
+
+void ParticleSystem::Simulate(std::vector<Particle>& particles, size_t capacity, const ParticleEmitter& emitter,
+                              uint32_t emitBase, uint32_t emitCount, float deltaTime) {
+    // Integrate and compact in place (the GPU compacts in arbitrary order)
+    const float damping = std::max(1.0f - emitter.drag * deltaTime, 0.0f);
+    size_t alive = 0;
+    for (const Particle& particle : particles) {
+        float life = particle.positionLife.w - deltaTime;
+        if (life <= 0.0f) {
+            continue;
+        }
+        glm::vec3 velocity = (glm::vec3(particle.velocityLifetime) + emitter.gravity * deltaTime) * damping;
+        glm::vec3 position = glm::vec3(particle.positionLife) + velocity * deltaTime;
+        particles[alive++] = { glm::vec4(position, life), glm::vec4(velocity, particle.velocityLifetime.w) };
+    }
+    particles.resize(alive);
+
+    uint32_t count = static_cast<uint32_t>(std::min<size_t>(emitCount, capacity - std::min(alive, capacity)));
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t state = Hash(emitBase + i);
+        float theta = 6.2831853f * Random(state);
+        float cosPhi = 1.0f - emitter.spread * Random(state);
+        float sinPhi = std::sqrt(std::max(1.0f - cosPhi * cosPhi, 0.0f));
+        glm::vec3 direction(std::cos(theta) * sinPhi, cosPhi, std::sin(theta) * sinPhi);
+        glm::vec3 velocity = direction * (emitter.speed * (0.75f + 0.5f * Random(state)));
+        float life = emitter.lifetime * (0.5f + 0.5f * Random(state));
+        particles.push_back({ glm::vec4(emitter.position, life), glm::vec4(velocity, life) });
+    }
+}
+
+bool ParticleSystem::ReadParticles(std::vector<Particle>& particles) {
+    if (m_backend == ParticleBackend::CPU) {
+        particles = m_particles;
+        return true;
+    }
+
+    glFinish();
+    GLuint alive = 0;
+    glBindBuffer(GL_COPY_READ_BUFFER, m_counterBuffer);
+    const void* counters = glMapBufferRange(GL_COPY_READ_BUFFER, m_current * kDrawCommandBytes, sizeof(GLuint), GL_MAP_READ_BIT);
+    if (counters != nullptr) {
+        std::memcpy(&alive, counters, sizeof(alive));
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+    }
+    particles.resize(alive);
+    if (alive > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, m_particleBuffers[m_current]);
+        const void* data = glMapBufferRange(GL_COPY_READ_BUFFER, 0, alive * sizeof(Particle), GL_MAP_READ_BIT);
+        if (data == nullptr) {
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            return false;
+        }
+        std::memcpy(particles.data(), data, alive * sizeof(Particle));
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    return counters != nullptr;
+}
+
+bool ParticleSystem::Verify(size_t capacity, int steps, float deltaTime) {
+    ParticleSystem gpu;
+    if (!gpu.Initialize(capacity, ParticleBackend::GPU) || gpu.GetBackend() != ParticleBackend::GPU) {
+        return false;
+    }
+    ParticleSystem cpu;
+    cpu.Initialize(capacity, ParticleBackend::CPU);
+
+    // Emit faster than particles die so the capacity clamp is exercised too
+    gpu.GetEmitter().rate = cpu.GetEmitter().rate = capacity / (steps * deltaTime * 0.5f);
+    for (int step = 0; step < steps; ++step) {
+        gpu.Update(deltaTime);
+        cpu.Update(deltaTime);
+    }
+
+    std::vector<Particle> gpuParticles, cpuParticles;
+    if (!gpu.ReadParticles(gpuParticles) || !cpu.ReadParticles(cpuParticles)) {
+        std::cerr << "ERROR::PARTICLE_SYSTEM::VERIFY_READBACK_FAILED" << std::endl;
+        return false;
+    }
+
+    // Compaction order differs, so compare order-independent means of position and life
+    auto mean = [](const std::vector<Particle>& particles, int component) {
+        double sum = 0.0;
+        for (const Particle& particle : particles) {
+            sum += particle.positionLife[component];
+        }
+        return particles.empty() ? 0.0 : sum / particles.size();
+    };
+    double error = 0.0;
+    for (int component = 0; component < 4; ++component) {
+        error = std::max(error, std::abs(mean(gpuParticles, component) - mean(cpuParticles, component)));
+    }
+    // Fused multiply-adds on the GPU can move a death across a frame boundary
+    size_t countDifference = std::max(gpuParticles.size(), cpuParticles.size()) - std::min(gpuParticles.size(), cpuParticles.size());
+    bool match = countDifference <= capacity / 1000 && error < 1e-3;
+    std::cout << "Particles: GPU " << (match ? "matches" : "DIFFERS FROM") << " CPU reference after " << steps << " steps ("
+              << gpuParticles.size() << " vs " << cpuParticles.size() << " alive, mean error " << error << ")" << std::endl;
+    return match;
+}
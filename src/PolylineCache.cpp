@@ -0,0 +1,476 @@
+#include "PolylineCache.h"
+#include "Renderer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+PolylineCache::PolylineCache()
+    : m_method(Method::MinMax), m_tolerance(0.5f), m_boundsMin(0.0f), m_boundsMax(0.0f),
+      m_lastViewProjection(1.0f), m_lastWidth(0), m_lastHeight(0), m_outputValid(false) {
+}
+
+void PolylineCache::SetData(const float* vertices, size_t count, Method method) {
+    SetData(std::vector<float>(vertices, vertices + count * 6), method);
+}
+
+void PolylineCache::SetData(std::vector<float>&& vertices, Method method) {
+    m_vertices = std::move(vertices);
+    m_method = method;
+    Build();
+}
+
+void PolylineCache::SetTolerance(float pixels) {
+    m_tolerance = std::max(pixels, 0.01f);
+    m_outputValid = false;
+}
+
+glm::vec3 PolylineCache::Position(size_t index) const {
+    const float* v = &m_vertices[index * 6];
+    return glm::vec3(v[0], v[1], v[2]);
+}
+
+void PolylineCache::AppendVertex(size_t index) {
+    const float* v = &m_vertices[index * 6];
+    m_output.insert(m_output.end(), v, v + 6);
+}
+
+void PolylineCache::Build() {
+    size_t count = GetVertexCount();
+    m_pyramid.clear();
+    m_importance.clear();
+    m_levels.clear();
+    m_outputValid = false;
+    m_stats = Stats();
+    m_stats.sourceVertices = count;
+
+    if (count == 0) {
+        return;
+    }
+
+    m_boundsMin = m_boundsMax = Position(0);
+    bool monotonic = true;
+    for (size_t i = 1; i < count; ++i) {
+        glm::vec3 p = Position(i);
+        m_boundsMin = glm::min(m_boundsMin, p);
+        m_boundsMax = glm::max(m_boundsMax, p);
+        monotonic = monotonic && X(i) >= X(i - 1);
+    }
+
+    if (m_method == Method::Auto || (m_method == Method::MinMax && !monotonic)) {
+        m_method = monotonic ? Method::MinMax : Method::DouglasPeucker;
+    }
+
+    switch (m_method) {
+    case Method::MinMax:
+        BuildMinMaxPyramid();
+        break;
+    case Method::Visvalingam:
+        BuildVisvalingamImportance();
+        break;
+    default:
+        BuildDouglasPeuckerImportance();
+        break;
+    }
+}
+
+void PolylineCache::BuildMinMaxPyramid() {
+    uint32_t count = static_cast<uint32_t>(GetVertexCount());
+
+    // Level 0 straight from the samples
+    std::vector<Bucket> base;
+    base.reserve((count + kBaseBucket - 1) / kBaseBucket);
+    for (uint32_t first = 0; first < count; first += kBaseBucket) {
+        uint32_t last = std::min(first + kBaseBucket, count);
+        Bucket bucket = { first, first };
+        for (uint32_t i = first + 1; i < last; ++i) {
+            if (Y(i) < Y(bucket.minIndex)) bucket.minIndex = i;
+            if (Y(i) > Y(bucket.maxIndex)) bucket.maxIndex = i;
+        }
+        base.push_back(bucket);
+    }
+    m_pyramid.push_back(std::move(base));
+
+    // Each further level merges pairs of the previous one
+    while (m_pyramid.back().size() > 1) {
+        const std::vector<Bucket>& src = m_pyramid.back();
+        std::vector<Bucket> dst;
+        dst.reserve((src.size() + 1) / 2);
+        for (size_t i = 0; i < src.size(); i += 2) {
+            Bucket bucket = src[i];
+            if (i + 1 < src.size()) {
+                const Bucket& other = src[i + 1];
+                if (Y(other.minIndex) < Y(bucket.minIndex)) bucket.minIndex = other.minIndex;
+                if (Y(other.maxIndex) > Y(bucket.maxIndex)) bucket.maxIndex = other.maxIndex;
+            }
+            dst.push_back(bucket);
+        }
+        m_pyramid.push_back(std::move(dst));
+    }
+}
+
+void PolylineCache::BuildDouglasPeuckerImportance() {
+    size_t count = GetVertexCount();
+    const float infinity = std::numeric_limits<float>::infinity();
+    m_importance.assign(count, 0.0f);
+    m_importance[0] = infinity;
+    m_importance[count - 1] = infinity;
+
+    // A vertex survives tolerance t iff it and all its split ancestors exceed t,
+    // so clamping to the parent's value turns DP into a simple threshold test
+    struct Span { size_t first, last; float parent; };
+    std::vector<Span> stack;
+    stack.push_back({ 0, count - 1, infinity });
+
+    while (!stack.empty()) {
+        Span span = stack.back();
+        stack.pop_back();
+        if (span.last <= span.first + 1) {
+            continue;
+        }
+
+        glm::vec3 a = Position(span.first);
+        glm::vec3 ab = Position(span.last) - a;
+        float lengthSq = glm::dot(ab, ab);
+
+        float maxDistance = -1.0f;
+        size_t split = span.first + 1;
+        for (size_t i = span.first + 1; i < span.last; ++i) {
+            glm::vec3 ap = Position(i) - a;
+            float t = lengthSq > 0.0f ? std::clamp(glm::dot(ap, ab) / lengthSq, 0.0f, 1.0f) : 0.0f;
+            float distance = glm::length(ap - ab * t);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                split = i;
+            }
+        }
+
+        float importance = std::min(maxDistance, span.parent);
+        m_importance[split] = importance;
+        stack.push_back({ span.first, split, importance });
+        stack.push_back({ split, span.last, importance });
+    }
+}
+
+void PolylineCache::BuildVisvalingamImportance() {
+    size_t count = GetVertexCount();
+    const float infinity = std::numeric_limits<float>::infinity();
+    m_importance.assign(count, infinity);
+    if (count < 3) {
+        return;
+    }
+
+    std::vector<uint32_t> prev(count), next(count);
+    for (size_t i = 0; i < count; ++i) {
+        prev[i] = static_cast<uint32_t>(i == 0 ? 0 : i - 1);
+        next[i] = static_cast<uint32_t>(i + 1 < count ? i + 1 : count - 1);
+    }
+
+    // Effective area expressed as a length (sqrt of twice the triangle area)
+    // so both importance measures share the same threshold scale
+    auto area = [&](size_t i) {
+        glm::vec3 a = Position(prev[i]);
+        glm::vec3 b = Position(i);
+        glm::vec3 c = Position(next[i]);
+        return std::sqrt(glm::length(glm::cross(b - a, c - a)));
+    };
+
+    using Entry = std::pair<float, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    for (size_t i = 1; i + 1 < count; ++i) {
+        m_importance[i] = area(i);
+        heap.push({ m_importance[i], static_cast<uint32_t>(i) });
+    }
+
+    std::vector<bool> removed(count, false);
+    float minimumArea = 0.0f;
+    while (!heap.empty()) {
+        auto [value, index] = heap.top();
+        heap.pop();
+        if (removed[index] || value != m_importance[index]) {
+            continue;  // Stale entry
+        }
+
+        // Areas never decrease as points are removed, keeping levels nested
+        minimumArea = std::max(minimumArea, value);
+        m_importance[index] = minimumArea;
+        removed[index] = true;
+
+        uint32_t before = prev[index];
+        uint32_t after = next[index];
+        next[before] = after;
+        prev[after] = before;
+
+        for (uint32_t neighbor : { before, after }) {
+            if (neighbor != 0 && neighbor != count - 1 && !removed[neighbor]) {
+                m_importance[neighbor] = std::max(area(neighbor), minimumArea);
+                heap.push({ m_importance[neighbor], neighbor });
+            }
+        }
+    }
+}
+
+const std::vector<float>& PolylineCache::Simplify(const glm::mat4& viewProjection, int viewportWidth, int viewportHeight) {
+    if (m_outputValid && viewProjection == m_lastViewProjection
+        && viewportWidth == m_lastWidth && viewportHeight == m_lastHeight) {
+        m_stats.reused = true;
+        return m_output;
+    }
+
+    m_output.clear();
+    m_stripStarts.clear();
+    m_stats.reused = false;
+    m_stats.level = -1;
+    if (GetVertexCount() > 0 && viewportWidth > 0 && viewportHeight > 0) {
+        if (m_method == Method::MinMax) {
+            SimplifyMinMax(viewProjection, viewportWidth);
+        } else {
+            SimplifyByImportance(viewProjection, viewportWidth, viewportHeight);
+        }
+    }
+    if (m_stripStarts.empty() && !m_output.empty()) {
+        m_stripStarts.push_back(0);
+    }
+
+    m_stats.outputVertices = m_output.size() / 6;
+    m_lastViewProjection = viewProjection;
+    m_lastWidth = viewportWidth;
+    m_lastHeight = viewportHeight;
+    m_outputValid = true;
+    return m_output;
+}
+
+void PolylineCache::SimplifyMinMax(const glm::mat4& viewProjection, int viewportWidth) {
+    size_t count = GetVertexCount();
+
+    // Map data x to pixel columns through the projection of the data's x extent.
+    // Exact for plots facing the camera, which is what column decimation assumes.
+    glm::vec3 center = (m_boundsMin + m_boundsMax) * 0.5f;
+    glm::vec4 clipA = viewProjection * glm::vec4(m_boundsMin.x, center.y, center.z, 1.0f);
+    glm::vec4 clipB = viewProjection * glm::vec4(m_boundsMax.x, center.y, center.z, 1.0f);
+    float screenA = (clipA.x / clipA.w * 0.5f + 0.5f) * viewportWidth;
+    float screenB = (clipB.x / clipB.w * 0.5f + 0.5f) * viewportWidth;
+    float dataWidth = m_boundsMax.x - m_boundsMin.x;
+
+    if (clipA.w <= 0.0f || clipB.w <= 0.0f || dataWidth <= 0.0f || std::abs(screenB - screenA) < 1e-3f) {
+        for (size_t i = 0; i < count; ++i) {
+            AppendVertex(i);
+        }
+        return;
+    }
+
+    float pixelsPerUnit = (screenB - screenA) / dataWidth;
+    auto column = [&](size_t index) {
+        return static_cast<int>(std::floor(screenA + (X(index) - m_boundsMin.x) * pixelsPerUnit));
+    };
+
+    // Visible x range, then binary search the sample indices (x is sorted)
+    float xLeft = m_boundsMin.x + (0.0f - screenA) / pixelsPerUnit;
+    float xRight = m_boundsMin.x + (viewportWidth - screenA) / pixelsPerUnit;
+    if (xLeft > xRight) {
+        std::swap(xLeft, xRight);
+    }
+
+    auto lowerBound = [&](float x) {
+        size_t lo = 0, hi = count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (X(mid) < x) lo = mid + 1; else hi = mid;
+        }
+        return lo;
+    };
+    size_t first = lowerBound(xLeft);
+    size_t last = lowerBound(xRight);
+    // Keep one sample beyond each edge so the strip runs off screen
+    first = first > 0 ? first - 1 : 0;
+    last = std::min(last, count - 1);
+    if (first >= last) {
+        AppendVertex(first);
+        AppendVertex(last);
+        return;
+    }
+
+    size_t visible = last - first + 1;
+    size_t perColumn = visible / viewportWidth;
+
+    // Few enough samples: draw them as they are
+    if (perColumn < 2 * kBaseBucket) {
+        for (size_t i = first; i <= last; ++i) {
+            AppendVertex(i);
+        }
+        return;
+    }
+
+    // Coarsest level that still puts at least two buckets in each column
+    int level = 0;
+    while (level + 1 < static_cast<int>(m_pyramid.size()) && (static_cast<size_t>(kBaseBucket) << (level + 1)) * 2 <= perColumn) {
+        ++level;
+    }
+    m_stats.level = level;
+
+    const std::vector<Bucket>& buckets = m_pyramid[level];
+    size_t bucketSize = static_cast<size_t>(kBaseBucket) << level;
+
+    // Emit first, min, max and last of each column in index order
+    int currentColumn = 0;
+    size_t columnFirst = 0, columnLast = 0, minIndex = 0, maxIndex = 0;
+    bool open = false;
+    auto emit = [&]() {
+        size_t indices[4] = { columnFirst, minIndex, maxIndex, columnLast };
+        std::sort(indices, indices + 4);
+        size_t* end = std::unique(indices, indices + 4);
+        for (size_t* it = indices; it != end; ++it) {
+            AppendVertex(*it);
+        }
+    };
+
+    for (size_t b = first / bucketSize; b <= last / bucketSize; ++b) {
+        size_t bucketFirst = std::max(b * bucketSize, first);
+        size_t bucketLast = std::min((b + 1) * bucketSize - 1, last);
+        const Bucket& bucket = buckets[b];
+
+        // Partial buckets at the edges fall back to their clipped endpoints
+        size_t bucketMin = (bucket.minIndex >= bucketFirst && bucket.minIndex <= bucketLast) ? bucket.minIndex : bucketFirst;
+        size_t bucketMax = (bucket.maxIndex >= bucketFirst && bucket.maxIndex <= bucketLast) ? bucket.maxIndex : bucketLast;
+
+        int bucketColumn = column(bucketFirst);
+        if (open && bucketColumn != currentColumn) {
+            emit();
+            open = false;
+        }
+        if (!open) {
+            open = true;
+            currentColumn = bucketColumn;
+            columnFirst = bucketFirst;
+            minIndex = bucketMin;
+            maxIndex = bucketMax;
+        }
+        if (Y(bucketMin) < Y(minIndex)) minIndex = bucketMin;
+        if (Y(bucketMax) > Y(maxIndex)) maxIndex = bucketMax;
+        columnLast = bucketLast;
+    }
+    if (open) {
+        emit();
+    }
+}
+
+void PolylineCache::SimplifyByImportance(const glm::mat4& viewProjection, int viewportWidth, int viewportHeight) {
+    // World-space size of one pixel at the center of the data
+    glm::vec3 center = (m_boundsMin + m_boundsMax) * 0.5f;
+    glm::vec4 clip = viewProjection * glm::vec4(center, 1.0f);
+    float pixelSize = 0.0f;
+    if (clip.w > 0.0f) {
+        glm::mat4 inverse = glm::inverse(viewProjection);
+        glm::vec4 offsetClip = clip + glm::vec4(2.0f / viewportWidth * clip.w, 2.0f / viewportHeight * clip.w, 0.0f, 0.0f);
+        glm::vec4 offset = inverse * offsetClip;
+        pixelSize = glm::length(glm::vec3(offset) / offset.w - center) / std::sqrt(2.0f);
+    }
+
+    float threshold = pixelSize * m_tolerance;
+    if (threshold <= 0.0f) {
+        for (size_t i = 0; i < GetVertexCount(); ++i) {
+            AppendVertex(i);
+        }
+        return;
+    }
+
+    // Round the threshold down to a power of two so nearby zoom levels share a cache entry
+    int level = static_cast<int>(std::floor(std::log2(threshold)));
+    m_stats.level = level;
+    const Level& cached = GetLevel(level);
+    const std::vector<uint32_t>& indices = cached.indices;
+
+    // Emit the chunks that overlap the view, keeping one vertex beyond each
+    // edge so the strip runs off screen. Disjoint runs start a new strip.
+    size_t stripLast = 0;
+    bool open = false;
+    for (size_t c = 0; c < cached.chunks.size(); ++c) {
+        if (!IsVisible(cached.chunks[c], viewProjection)) {
+            continue;
+        }
+        size_t first = c * kLevelChunk;
+        size_t last = std::min(first + kLevelChunk, indices.size() - 1);
+        first = first > 0 ? first - 1 : 0;
+        last = std::min(last + 1, indices.size() - 1);
+
+        if (open && first <= stripLast + 1) {
+            first = stripLast + 1;
+        } else {
+            m_stripStarts.push_back(m_output.size() / 6);
+        }
+        for (size_t i = first; i <= last; ++i) {
+            AppendVertex(indices[i]);
+        }
+        stripLast = last;
+        open = true;
+    }
+}
+
+bool PolylineCache::IsVisible(const Chunk& chunk, const glm::mat4& viewProjection) const {
+    // Outside when all eight corners lie beyond the same clip plane
+    glm::vec4 corners[8];
+    for (int i = 0; i < 8; ++i) {
+        glm::vec3 corner((i & 1) ? chunk.boundsMax.x : chunk.boundsMin.x,
+                         (i & 2) ? chunk.boundsMax.y : chunk.boundsMin.y,
+                         (i & 4) ? chunk.boundsMax.z : chunk.boundsMin.z);
+        corners[i] = viewProjection * glm::vec4(corner, 1.0f);
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        bool allBelow = true, allAbove = true;
+        for (const glm::vec4& corner : corners) {
+            allBelow = allBelow && corner[axis] < -corner.w;
+            allAbove = allAbove && corner[axis] > corner.w;
+        }
+        if (allBelow || allAbove) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const PolylineCache::Level& PolylineCache::GetLevel(int level) {
+    auto it = m_levels.find(level);
+    if (it != m_levels.end()) {
+        return it->second;
+    }
+
+    // Keep the cache bounded by dropping the level farthest from this one
+    if (m_levels.size() >= kMaxCachedLevels) {
+        auto farthest = std::abs(m_levels.begin()->first - level) > std::abs(m_levels.rbegin()->first - level)
+            ? m_levels.begin() : std::prev(m_levels.end());
+        m_levels.erase(farthest);
+    }
+
+    float threshold = std::ldexp(1.0f, level);
+    Level result;
+    for (size_t i = 0; i < m_importance.size(); ++i) {
+        if (m_importance[i] > threshold) {
+            result.indices.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    // Chunk c bounds the segments starting at indices [c * kLevelChunk, (c + 1) * kLevelChunk)
+    size_t segments = result.indices.size() - 1;
+    for (size_t first = 0; first < segments; first += kLevelChunk) {
+        size_t last = std::min(first + kLevelChunk, segments);
+        Chunk chunk = { Position(result.indices[first]), Position(result.indices[first]) };
+        for (size_t i = first + 1; i <= last; ++i) {
+            glm::vec3 p = Position(result.indices[i]);
+            chunk.boundsMin = glm::min(chunk.boundsMin, p);
+            chunk.boundsMax = glm::max(chunk.boundsMax, p);
+        }
+        result.chunks.push_back(chunk);
+    }
+    return m_levels.emplace(level, std::move(result)).first->second;
+}
+
+void PolylineCache::Draw(Renderer& renderer, const glm::mat4& viewProjection, int viewportWidth, int viewportHeight) {
+    const std::vector<float>& vertices = Simplify(viewProjection, viewportWidth, viewportHeight);
+    for (size_t s = 0; s < m_stripStarts.size(); ++s) {
+        size_t first = m_stripStarts[s];
+        size_t last = s + 1 < m_stripStarts.size() ? m_stripStarts[s + 1] : vertices.size() / 6;
+        if (last - first >= 2) {
+            renderer.DrawLineStrip(vertices.data() + first * 6, static_cast<int>(last - first));
+        }
+    }
+}
@@ -1,11 +1,17 @@
 #include "Renderer.h"
+#include "Shader.h"
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <cmath>
-#include <vector>
-#include <cmath>
+#include <cstring>
 
-Renderer::Renderer() : m_VAO(0), m_VBO(0), m_dynamicVAO(0), m_dynamicVBO(0), m_cubeVAO(0), m_cubeVBO(0), m_cubeEBO(0) {
+Renderer::Renderer(RenderBackend backend) : m_backend(backend), m_transform(1.0f), m_viewportWidth(1), m_viewportHeight(1),
+    m_instanceVBO(0), m_instanceCapacity(0),
+    m_multiViewDivisor(1), m_dynamicVAO(0), m_dynamicVBO(0), m_instancedLines(false), m_lineWidth(1.0f), m_pointSize(1.0f) {
+    if (m_backend == RenderBackend::Software) {
+        m_software = std::make_unique<SoftwareRasterizer>();
+    }
 }
 
 Renderer::~Renderer() {
@@ -13,43 +19,454 @@ Renderer::~Renderer() {
 }
 
 bool Renderer::Initialize() {
+    if (m_backend == RenderBackend::Software) {
+        if (m_software->GetWidth() == 0) {
+            m_software->Resize(800, 600);
+        }
+        SetupTriangle();
+        SetupCube();
+        return true;
+    }
+
+    if (!m_gpuMemory.Initialize()) {
+        std::cerr << "ERROR::RENDERER::GPU_MEMORY_INITIALIZATION_FAILED" << std::endl;
+        return false;
+    }
+
     SetupTriangle();
     SetupPointsAndLines();
     SetupCube();
+    
+    // Fall back to native points and lines if the line shaders are unavailable
+    m_lineRenderer = std::make_unique<LineRenderer>();
+    m_instancedLines = m_lineRenderer->Initialize();
+    m_lineRenderer->SetViewportSize(glm::vec2(m_viewportWidth, m_viewportHeight));
+    if (!m_instancedLines) {
+        std::cerr << "Instanced line renderer unavailable, using native lines" << std::endl;
+    }
     return true;
 }
 
 void Renderer::Clear(float r, float g, float b, float a) {
+    if (m_software) {
+        m_software->Clear(glm::vec4(r, g, b, a));
+        return;
+    }
     glClearColor(r, g, b, a);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
-void Renderer::DrawTriangle() {
-    glBindVertexArray(m_VAO);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+void Renderer::EndFrame() {
+    if (m_backend == RenderBackend::OpenGL) {
+        m_gpuMemory.EndFrame();
+    }
+    // The next frame's first line draw must not inherit this frame's last transform
+    SetTransform(glm::mat4(1.0f));
+}
+
+void Renderer::Resize(int width, int height) {
+    m_viewportWidth = std::max(width, 1);
+    m_viewportHeight = std::max(height, 1);
+    if (m_software) {
+        m_software->Resize(width, height);
+    }
+    if (m_lineRenderer) {
+        m_lineRenderer->SetViewportSize(glm::vec2(m_viewportWidth, m_viewportHeight));
+    }
+}
+
+void Renderer::Finish() {
+    if (m_software) {
+        m_software->Flush();
+    }
+}
+
+bool Renderer::ReadPixels(std::vector<uint8_t>& pixels, int& width, int& height) {
+    if (m_software) {
+        m_software->Flush();
+        width = m_software->GetWidth();
+        height = m_software->GetHeight();
+        pixels.resize(static_cast<size_t>(width) * height * 4);
+        std::memcpy(pixels.data(), m_software->GetColor().data(), pixels.size());
+        return true;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    width = viewport[2];
+    height = viewport[3];
+    if (width <= 0 || height <= 0) {
+        std::cerr << "ERROR::RENDERER::READ_PIXELS_EMPTY_VIEWPORT" << std::endl;
+        return false;
+    }
+    pixels.resize(static_cast<size_t>(width) * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(viewport[0], viewport[1], width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return true;
+}
+
+Mesh Renderer::CreateMesh(const float* vertices, int vertexCount, const unsigned int* indices, int indexCount) {
+    if (m_backend == RenderBackend::Software) {
+        Mesh mesh;
+        mesh.cpuMesh = static_cast<int>(m_cpuMeshes.size());
+        mesh.indexCount = indexCount;
+        m_cpuMeshes.push_back({ std::vector<float>(vertices, vertices + vertexCount * 6),
+                                std::vector<unsigned int>(indices, indices + indexCount) });
+        return mesh;
+    }
+
+    const uint32_t stride = 6 * sizeof(float);
+    const uint32_t vertexBytes = vertexCount * stride;
+    const uint32_t indexBytes = indexCount * sizeof(unsigned int);
+
+    // Vertex data is stride-aligned so it can be addressed by base vertex
+    Mesh mesh;
+    mesh.vertices = m_gpuMemory.Allocate(GpuBufferKind::Vertex, vertexBytes, stride);
+    mesh.indices = m_gpuMemory.Allocate(GpuBufferKind::Index, indexBytes, sizeof(unsigned int));
+    if (!mesh.vertices.IsValid() || !mesh.indices.IsValid()) {
+        DestroyMesh(mesh);
+        return mesh;
+    }
+
+    m_gpuMemory.Upload(mesh.vertices, vertices, vertexBytes);
+    m_gpuMemory.Upload(mesh.indices, indices, indexBytes);
+    mesh.indexCount = indexCount;
+    mesh.baseVertex = static_cast<GLint>(mesh.vertices.offset / stride);
+    return mesh;
+}
+
+void Renderer::DrawMesh(const Mesh& mesh, GLenum mode) {
+    if (mesh.indexCount == 0) {
+        return;
+    }
+    if (m_software) {
+        const Shader* shader = Shader::GetCurrent();
+        if (mesh.cpuMesh < 0 || shader == nullptr || mode != GL_TRIANGLES) {
+            return;
+        }
+        glm::mat4 model(1.0f), view(1.0f), projection(1.0f);
+        shader->GetUniform("model", &model[0][0], 16);
+        shader->GetUniform("view", &view[0][0], 16);
+        shader->GetUniform("projection", &projection[0][0], 16);
+        const CpuMesh& cpu = m_cpuMeshes[mesh.cpuMesh];
+        m_software->DrawTriangles(cpu.vertices.data(), cpu.indices.data(), mesh.indexCount,
+                                  model, projection * view, GetSoftwareMaterial(shader));
+        return;
+    }
+    glBindVertexArray(GetMeshVAO(mesh.vertices.pool, mesh.indices.pool));
+    glDrawElementsBaseVertex(mode, mesh.indexCount, GL_UNSIGNED_INT,
+                             reinterpret_cast<const void*>(static_cast<uintptr_t>(mesh.indices.offset)), mesh.baseVertex);
     glBindVertexArray(0);
 }
 
-void Renderer::DrawCube(float size) {
-    glBindVertexArray(m_cubeVAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+void Renderer::DrawMeshInstanced(const Mesh& mesh, const glm::mat4* models, const glm::vec3* colors,
+                                 const uint32_t* indices, int count) {
+    if (mesh.indexCount == 0 || count <= 0) {
+        return;
+    }
+    if (m_software) {
+        const Shader* shader = Shader::GetCurrent();
+        if (mesh.cpuMesh < 0 || shader == nullptr) {
+            return;
+        }
+        glm::mat4 view(1.0f), projection(1.0f);
+        shader->GetUniform("view", &view[0][0], 16);
+        shader->GetUniform("projection", &projection[0][0], 16);
+        SoftwareRasterizer::Material material = GetSoftwareMaterial(shader);
+        const CpuMesh& cpu = m_cpuMeshes[mesh.cpuMesh];
+        for (int i = 0; i < count; ++i) {
+            uint32_t index = indices ? indices[i] : static_cast<uint32_t>(i);
+            material.objectColor = colors[index];
+            m_software->DrawTriangles(cpu.vertices.data(), cpu.indices.data(), mesh.indexCount,
+                                      models[index], projection * view, material);
+        }
+        return;
+    }
+
+    // The VAO owns the instance buffer, so fetch it before uploading
+    GLuint vao = GetInstancedVAO(mesh.vertices.pool, mesh.indices.pool);
+
+    // Grow geometrically; otherwise the buffer is orphaned on every map
+    const size_t stride = sizeof(glm::mat4) + sizeof(glm::vec3);
+    size_t bytes = static_cast<size_t>(count) * stride;
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    if (bytes > m_instanceCapacity) {
+        size_t capacity = std::max(bytes, m_instanceCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        m_instanceCapacity = capacity;
+    }
+    auto* mapped = static_cast<uint8_t*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes,
+                                                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (mapped == nullptr) {
+        // Respecify the storage on the next draw rather than trusting it
+        m_instanceCapacity = 0;
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        std::cerr << "ERROR::RENDERER::INSTANCE_BUFFER_MAP_FAILED" << std::endl;
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        uint32_t index = indices ? indices[i] : static_cast<uint32_t>(i);
+        std::memcpy(mapped, &models[index][0][0], sizeof(glm::mat4));
+        std::memcpy(mapped + sizeof(glm::mat4), &colors[index][0], sizeof(glm::vec3));
+        mapped += stride;
+    }
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindVertexArray(vao);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+                                      reinterpret_cast<const void*>(static_cast<uintptr_t>(mesh.indices.offset)),
+                                      count, mesh.baseVertex);
+    glBindVertexArray(0);
+}
+
+void Renderer::DrawCubeInstanced(const glm::mat4* models, const glm::vec3* colors, const uint32_t* indices, int count) {
+    DrawMeshInstanced(m_cube, models, colors, indices, count);
+}
+
+void Renderer::DrawMeshMultiView(const Mesh& mesh, const glm::mat4* models, const glm::vec3* colors, const uint32_t* viewMasks,
+                                 const uint32_t* indices, int count, int viewCount) {
+    if (mesh.indexCount == 0 || count <= 0 || viewCount <= 0) {
+        return;
+    }
+    if (m_software) {
+        std::cerr << "ERROR::RENDERER::MULTI_VIEW_UNSUPPORTED" << std::endl;
+        return;
+    }
+
+    // The VAO owns the instance buffer, so fetch it before uploading
+    GLuint vao = GetMultiViewVAO(mesh.vertices.pool, mesh.indices.pool);
+    const size_t stride = sizeof(glm::mat4) + sizeof(glm::vec3) + sizeof(uint32_t);
+    size_t bytes = static_cast<size_t>(count) * stride;
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    if (bytes > m_instanceCapacity) {
+        size_t capacity = std::max(bytes, m_instanceCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        m_instanceCapacity = capacity;
+    }
+    auto* mapped = static_cast<uint8_t*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes,
+                                                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (mapped == nullptr) {
+        m_instanceCapacity = 0;
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        std::cerr << "ERROR::RENDERER::INSTANCE_BUFFER_MAP_FAILED" << std::endl;
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        uint32_t index = indices ? indices[i] : static_cast<uint32_t>(i);
+        std::memcpy(mapped, &models[index][0][0], sizeof(glm::mat4));
+        std::memcpy(mapped + sizeof(glm::mat4), &colors[index][0], sizeof(glm::vec3));
+        std::memcpy(mapped + sizeof(glm::mat4) + sizeof(glm::vec3), &viewMasks[index], sizeof(uint32_t));
+        mapped += stride;
+    }
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Every VAO shares the divisor, so it only changes with the view count
+    glBindVertexArray(vao);
+    if (viewCount != m_multiViewDivisor) {
+        for (auto& entry : m_multiViewVAOs) {
+            glBindVertexArray(entry.second);
+            for (int location = 2; location <= 7; ++location) {
+                glVertexAttribDivisor(location, viewCount);
+            }
+        }
+        m_multiViewDivisor = viewCount;
+        glBindVertexArray(vao);
+    }
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+                                      reinterpret_cast<const void*>(static_cast<uintptr_t>(mesh.indices.offset)),
+                                      count * viewCount, mesh.baseVertex);
+    glBindVertexArray(0);
+}
+
+void Renderer::DrawCubeMultiView(const glm::mat4* models, const glm::vec3* colors, const uint32_t* viewMasks,
+                                 const uint32_t* indices, int count, int viewCount) {
+    DrawMeshMultiView(m_cube, models, colors, viewMasks, indices, count, viewCount);
+}
+
+void Renderer::DestroyMesh(Mesh& mesh) {
+    if (m_backend == RenderBackend::Software) {
+        if (mesh.cpuMesh >= 0) {
+            m_cpuMeshes[mesh.cpuMesh] = CpuMesh();
+        }
+        mesh = Mesh();
+        return;
+    }
+    // Deferred: the ranges are reused only after this frame's fence signals
+    m_gpuMemory.Free(mesh.vertices);
+    m_gpuMemory.Free(mesh.indices);
+    mesh = Mesh();
+}
+
+// Lit when the shader carries the fragment.glsl lighting uniforms; anything
+// else (the 2D shader) shows vertex colors
+SoftwareRasterizer::Material Renderer::GetSoftwareMaterial(const Shader* shader) const {
+    SoftwareRasterizer::Material material;
+    material.lit = shader->GetUniform("lightPos", &material.lightPos[0], 3);
+    shader->GetUniform("lightColor", &material.lightColor[0], 3);
+    shader->GetUniform("objectColor", &material.objectColor[0], 3);
+    return material;
+}
+
+GLuint Renderer::GetMeshVAO(int vertexPool, int indexPool) {
+    auto key = std::make_pair(vertexPool, indexPool);
+    auto found = m_meshVAOs.find(key);
+    if (found != m_meshVAOs.end()) {
+        return found->second;
+    }
+
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_gpuMemory.GetBuffer(GpuBufferKind::Vertex, vertexPool));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_gpuMemory.GetBuffer(GpuBufferKind::Index, indexPool));
+
+    // Position attribute (location = 0)
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Color / normal attribute (location = 1)
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindVertexArray(0);
+    m_meshVAOs[key] = vao;
+    return vao;
+}
+
+GLuint Renderer::GetInstancedVAO(int vertexPool, int indexPool) {
+    auto key = std::make_pair(vertexPool, indexPool);
+    auto found = m_instancedVAOs.find(key);
+    if (found != m_instancedVAOs.end()) {
+        return found->second;
+    }
+
+    if (m_instanceVBO == 0) {
+        glGenBuffers(1, &m_instanceVBO);
+    }
+
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_gpuMemory.GetBuffer(GpuBufferKind::Vertex, vertexPool));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_gpuMemory.GetBuffer(GpuBufferKind::Index, indexPool));
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // Instance color (location = 2) and model matrix columns (locations 3-6)
+    const GLsizei stride = sizeof(glm::mat4) + sizeof(glm::vec3);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)sizeof(glm::mat4));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    for (int column = 0; column < 4; ++column) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, stride, (void*)(column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
+
     glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_instancedVAOs[key] = vao;
+    return vao;
+}
+
+GLuint Renderer::GetMultiViewVAO(int vertexPool, int indexPool) {
+    auto key = std::make_pair(vertexPool, indexPool);
+    auto found = m_multiViewVAOs.find(key);
+    if (found != m_multiViewVAOs.end()) {
+        return found->second;
+    }
+
+    if (m_instanceVBO == 0) {
+        glGenBuffers(1, &m_instanceVBO);
+    }
+
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_gpuMemory.GetBuffer(GpuBufferKind::Vertex, vertexPool));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_gpuMemory.GetBuffer(GpuBufferKind::Index, indexPool));
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // As GetInstancedVAO, plus the view mask (location = 7)
+    const GLsizei stride = sizeof(glm::mat4) + sizeof(glm::vec3) + sizeof(uint32_t);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)sizeof(glm::mat4));
+    glEnableVertexAttribArray(2);
+    for (int column = 0; column < 4; ++column) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, stride, (void*)(column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + column);
+    }
+    glVertexAttribIPointer(7, 1, GL_UNSIGNED_INT, stride, (void*)(sizeof(glm::mat4) + sizeof(glm::vec3)));
+    glEnableVertexAttribArray(7);
+    for (int location = 2; location <= 7; ++location) {
+        glVertexAttribDivisor(location, m_multiViewDivisor);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_multiViewVAOs[key] = vao;
+    return vao;
+}
+
+void Renderer::DrawTriangle() {
+    DrawMesh(m_triangle);
+}
+
+void Renderer::DrawCube(float size) {
+    DrawMesh(m_cube);
 }
 
 void Renderer::DrawCubeWireframe(float size) {
+    if (m_software) {
+        // Triangle edges as lines, in the shader's object color
+        const Shader* shader = Shader::GetCurrent();
+        if (shader == nullptr || m_cube.cpuMesh < 0) {
+            return;
+        }
+        glm::mat4 model(1.0f), view(1.0f), projection(1.0f);
+        shader->GetUniform("model", &model[0][0], 16);
+        shader->GetUniform("view", &view[0][0], 16);
+        shader->GetUniform("projection", &projection[0][0], 16);
+        glm::vec3 color(1.0f);
+        shader->GetUniform("objectColor", &color[0], 3);
+
+        const CpuMesh& cube = m_cpuMeshes[m_cube.cpuMesh];
+        std::vector<float> segments;
+        for (size_t i = 0; i + 2 < cube.indices.size(); i += 3) {
+            for (int edge = 0; edge < 3; ++edge) {
+                for (unsigned int index : { cube.indices[i + edge], cube.indices[i + (edge + 1) % 3] }) {
+                    const float* position = &cube.vertices[index * 6];
+                    segments.insert(segments.end(), { position[0], position[1], position[2], color.r, color.g, color.b });
+                }
+            }
+        }
+        m_software->DrawLines(segments.data(), static_cast<int>(segments.size() / 12), m_lineWidth, projection * view * model);
+        return;
+    }
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     DrawCube(size);
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 }
 
 void Renderer::Shutdown() {
-    if (m_VBO != 0) {
-        glDeleteBuffers(1, &m_VBO);
-        m_VBO = 0;
+    if (m_backend == RenderBackend::Software) {
+        m_software.reset();
+        m_cpuMeshes.clear();
+        m_triangle = Mesh();
+        m_cube = Mesh();
+        return;
     }
-    if (m_VAO != 0) {
-        glDeleteVertexArrays(1, &m_VAO);
-        m_VAO = 0;
+    if (m_lineRenderer) {
+        m_lineRenderer->Shutdown();
+        m_lineRenderer.reset();
     }
     if (m_dynamicVBO != 0) {
         glDeleteBuffers(1, &m_dynamicVBO);
@@ -59,18 +476,27 @@ void Renderer::Shutdown() {
         glDeleteVertexArrays(1, &m_dynamicVAO);
         m_dynamicVAO = 0;
     }
-    if (m_cubeVBO != 0) {
-        glDeleteBuffers(1, &m_cubeVBO);
-        m_cubeVBO = 0;
+    for (auto& entry : m_meshVAOs) {
+        glDeleteVertexArrays(1, &entry.second);
+    }
+    m_meshVAOs.clear();
+    for (auto& entry : m_instancedVAOs) {
+        glDeleteVertexArrays(1, &entry.second);
     }
-    if (m_cubeEBO != 0) {
-        glDeleteBuffers(1, &m_cubeEBO);
-        m_cubeEBO = 0;
+    m_instancedVAOs.clear();
+    for (auto& entry : m_multiViewVAOs) {
+        glDeleteVertexArrays(1, &entry.second);
     }
-    if (m_cubeVAO != 0) {
-        glDeleteVertexArrays(1, &m_cubeVAO);
-        m_cubeVAO = 0;
+    m_multiViewVAOs.clear();
+    m_multiViewDivisor = 1;
+    if (m_instanceVBO != 0) {
+        glDeleteBuffers(1, &m_instanceVBO);
+        m_instanceVBO = 0;
+        m_instanceCapacity = 0;
     }
+    m_triangle = Mesh();
+    m_cube = Mesh();
+    m_gpuMemory.Shutdown();
 }
 
 void Renderer::SetupTriangle() {
@@ -82,25 +508,9 @@ void Renderer::SetupTriangle() {
          0.0f,  0.5f, 0.0f,   0.0f, 0.0f, 1.0f    // top
     };
 
-    // Generate and bind VAO
-    glGenVertexArrays(1, &m_VAO);
-    glBindVertexArray(m_VAO);
-
-    // Generate and bind VBO
-    glGenBuffers(1, &m_VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    // Position attribute (location = 0)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Color attribute (location = 1)
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    unsigned int indices[] = { 0, 1, 2 };
 
-    // Unbind VAO
-    glBindVertexArray(0);
+    m_triangle = CreateMesh(vertices, 3, indices, 3);
 }
 
 void Renderer::SetupPointsAndLines() {
@@ -133,6 +543,15 @@ void Renderer::DrawPoint(float x, float y, float z) {
 }
 
 void Renderer::DrawPoints(const float* vertices, int count) {
+    if (m_software) {
+        m_software->DrawPoints(vertices, count, m_pointSize, m_transform);
+        return;
+    }
+    if (m_instancedLines) {
+        m_lineRenderer->DrawPoints(vertices, count, m_pointSize);
+        return;
+    }
+    
     glBindVertexArray(m_dynamicVAO);
     glBindBuffer(GL_ARRAY_BUFFER, m_dynamicVBO);
     glBufferData(GL_ARRAY_BUFFER, count * 6 * sizeof(float), vertices, GL_DYNAMIC_DRAW);
@@ -152,6 +571,15 @@ void Renderer::DrawLine(float x1, float y1, float z1, float x2, float y2, float
 }
 
 void Renderer::DrawLines(const float* vertices, int count) {
+    if (m_software) {
+        m_software->DrawLines(vertices, count, m_lineWidth, m_transform);
+        return;
+    }
+    if (m_instancedLines) {
+        m_lineRenderer->DrawSegments(vertices, count, m_lineWidth);
+        return;
+    }
+    
     glBindVertexArray(m_dynamicVAO);
     glBindBuffer(GL_ARRAY_BUFFER, m_dynamicVBO);
     glBufferData(GL_ARRAY_BUFFER, count * 2 * 6 * sizeof(float), vertices, GL_DYNAMIC_DRAW);
@@ -162,6 +590,19 @@ void Renderer::DrawLines(const float* vertices, int count) {
 }
 
 void Renderer::DrawLineStrip(const float* vertices, int count) {
+    if (m_software) {
+        std::vector<float> segments;
+        for (int i = 0; i + 1 < count; ++i) {
+            segments.insert(segments.end(), vertices + i * 6, vertices + (i + 2) * 6);
+        }
+        m_software->DrawLines(segments.data(), count - 1, m_lineWidth, m_transform);
+        return;
+    }
+    if (m_instancedLines) {
+        m_lineRenderer->DrawStrip(vertices, count, false, m_lineWidth);
+        return;
+    }
+    
     glBindVertexArray(m_dynamicVAO);
     glBindBuffer(GL_ARRAY_BUFFER, m_dynamicVBO);
     glBufferData(GL_ARRAY_BUFFER, count * 6 * sizeof(float), vertices, GL_DYNAMIC_DRAW);
@@ -172,6 +613,21 @@ void Renderer::DrawLineStrip(const float* vertices, int count) {
 }
 
 void Renderer::DrawLineLoop(const float* vertices, int count) {
+    if (m_software) {
+        std::vector<float> segments;
+        for (int i = 0; i < count; ++i) {
+            int next = (i + 1) % count;
+            segments.insert(segments.end(), vertices + i * 6, vertices + (i + 1) * 6);
+            segments.insert(segments.end(), vertices + next * 6, vertices + (next + 1) * 6);
+        }
+        m_software->DrawLines(segments.data(), count, m_lineWidth, m_transform);
+        return;
+    }
+    if (m_instancedLines) {
+        m_lineRenderer->DrawStrip(vertices, count, true, m_lineWidth);
+        return;
+    }
+    
     glBindVertexArray(m_dynamicVAO);
     glBindBuffer(GL_ARRAY_BUFFER, m_dynamicVBO);
     glBufferData(GL_ARRAY_BUFFER, count * 6 * sizeof(float), vertices, GL_DYNAMIC_DRAW);
@@ -183,11 +639,48 @@ void Renderer::DrawLineLoop(const float* vertices, int count) {
 
 // Utility functions
 void Renderer::SetPointSize(float size) {
-    glPointSize(size);
+    m_pointSize = size;
+    if (!m_instancedLines && m_backend == RenderBackend::OpenGL) {
+        glPointSize(size);
+    }
 }
 
 void Renderer::SetLineWidth(float width) {
-    glLineWidth(width);
+    m_lineWidth = width;
+    // Core profiles clamp (or reject) native widths above 1.0
+    if (!m_instancedLines && m_backend == RenderBackend::OpenGL) {
+        glLineWidth(width);
+    }
+}
+
+void Renderer::SetLineCap(LineCap cap) {
+    if (m_lineRenderer) {
+        m_lineRenderer->SetCap(cap);
+    }
+}
+
+void Renderer::SetLineJoin(LineJoin join) {
+    if (m_lineRenderer) {
+        m_lineRenderer->SetJoin(join);
+    }
+}
+
+void Renderer::SetTransform(const glm::mat4& transform, int viewportWidth, int viewportHeight) {
+    m_transform = transform;
+    if (m_lineRenderer) {
+        m_lineRenderer->SetTransform(transform);
+        m_lineRenderer->SetViewportSize(viewportWidth > 0 && viewportHeight > 0
+            ? glm::vec2(viewportWidth, viewportHeight)
+            : glm::vec2(m_viewportWidth, m_viewportHeight));
+    }
+}
+
+void Renderer::SetInstancedLines(bool enabled) {
+    m_instancedLines = enabled && m_lineRenderer != nullptr;
+    if (!m_instancedLines && m_backend == RenderBackend::OpenGL) {
+        glPointSize(m_pointSize);
+        glLineWidth(m_lineWidth);
+    }
 }
 
 // Shape drawing utilities
@@ -304,25 +797,5 @@ void Renderer::SetupCube() {
         20, 22, 21, 22, 20, 23
     };
     
-    glGenVertexArrays(1, &m_cubeVAO);
-    glGenBuffers(1, &m_cubeVBO);
-    glGenBuffers(1, &m_cubeEBO);
-    
-    glBindVertexArray(m_cubeVAO);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, m_cubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_cubeEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cubeIndices), cubeIndices, GL_STATIC_DRAW);
-    
-    // Position attribute (location = 0)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Normal attribute (location = 1)
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    glBindVertexArray(0);
+    m_cube = CreateMesh(cubeVertices, 24, cubeIndices, 36);
 }
@@ -0,0 +1,268 @@
+#include "SceneGraph.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace {
+
+template <typename T>
+void Permute(std::vector<T>& values, const std::vector<uint32_t>& order) {
+    std::vector<T> sorted;
+    sorted.reserve(order.size());
+    for (uint32_t slot : order) {
+        sorted.push_back(values[slot]);
+    }
+    values.swap(sorted);
+}
+
+} // namespace
+
+SceneGraph::SceneGraph()
+    : m_layoutDirty(false), m_minDirtyDepth(kNone), m_updateIndex(0), m_version(0) {
+}
+
+SceneGraph::~SceneGraph() = default;
+
+void SceneGraph::Reserve(size_t count) {
+    m_nodes.reserve(count);
+    m_parents.reserve(count);
+    m_depths.reserve(count);
+    m_local.reserve(count);
+    m_world.reserve(count);
+    m_localBounds.reserve(count);
+    m_worldBounds.reserve(count);
+    m_colors.reserve(count);
+    m_textures.reserve(count);
+    m_flags.reserve(count);
+    m_localDirty.reserve(count);
+    m_changedUpdate.reserve(count);
+    m_slots.reserve(count);
+}
+
+void SceneGraph::Clear() {
+    m_nodes.clear();
+    m_parents.clear();
+    m_depths.clear();
+    m_local.clear();
+    m_world.clear();
+    m_localBounds.clear();
+    m_worldBounds.clear();
+    m_colors.clear();
+    m_textures.clear();
+    m_flags.clear();
+    m_localDirty.clear();
+    m_changedUpdate.clear();
+    m_slots.clear();
+    m_freeNodes.clear();
+    m_levelStarts.clear();
+    m_layoutDirty = false;
+    m_minDirtyDepth = kNone;
+    m_stats = Stats();
+}
+
+SceneGraph::Node SceneGraph::AddNode(Node parent, const glm::mat4& local, uint8_t flags, const AABB& localBounds) {
+    uint32_t parentSlot = parent == kNone ? kNone : m_slots[parent];
+    uint32_t depth = parentSlot == kNone ? 0 : m_depths[parentSlot] + 1;
+
+    Node node;
+    if (!m_freeNodes.empty()) {
+        node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    } else {
+        node = static_cast<Node>(m_slots.size());
+        m_slots.push_back(kNone);
+    }
+
+    // Appending keeps the depth order when the tree is built top-down
+    size_t slot = m_nodes.size();
+    if (m_layoutDirty || (slot > 0 && depth < m_depths.back())) {
+        m_layoutDirty = true;
+    } else if (slot == 0 || depth > m_depths.back()) {
+        if (m_levelStarts.empty()) {
+            m_levelStarts.push_back(0);
+        }
+        m_levelStarts.push_back(slot + 1);
+    } else {
+        ++m_levelStarts.back();
+    }
+
+    m_slots[node] = static_cast<uint32_t>(slot);
+    m_nodes.push_back(node);
+    m_parents.push_back(parentSlot);
+    m_depths.push_back(depth);
+    m_local.push_back(local);
+    m_world.push_back(local);
+    m_localBounds.push_back(localBounds);
+    m_worldBounds.push_back(localBounds);
+    m_colors.push_back(glm::vec3(1.0f));
+    m_textures.push_back(-1);
+    m_flags.push_back(flags);
+    m_localDirty.push_back(0);
+    m_changedUpdate.push_back(0);
+    MarkDirty(slot);
+    return node;
+}
+
+void SceneGraph::Remove(Node node) {
+    if (m_layoutDirty) {
+        SortByDepth();
+    }
+
+    // Parents precede children, so one forward sweep finds the whole subtree
+    size_t root = m_slots[node];
+    m_flags[root] = kRemoved;
+    for (size_t slot = root + 1; slot < m_nodes.size(); ++slot) {
+        uint32_t parent = m_parents[slot];
+        if (parent != kNone && (m_flags[parent] & kRemoved) && !(m_flags[slot] & kRemoved)) {
+            m_flags[slot] = kRemoved;
+        }
+    }
+    for (size_t slot = root; slot < m_nodes.size(); ++slot) {
+        if ((m_flags[slot] & kRemoved) && m_slots[m_nodes[slot]] == slot) {
+            m_slots[m_nodes[slot]] = kNone;
+            m_freeNodes.push_back(m_nodes[slot]);
+        }
+    }
+    m_layoutDirty = true;
+}
+
+void SceneGraph::SetLocalTransform(Node node, const glm::mat4& local) {
+    size_t slot = m_slots[node];
+    m_local[slot] = local;
+    MarkDirty(slot);
+}
+
+void SceneGraph::SetColor(Node node, const glm::vec3& color) {
+    m_colors[m_slots[node]] = color;
+}
+
+void SceneGraph::SetTexture(Node node, int texture) {
+    m_textures[m_slots[node]] = texture;
+}
+
+void SceneGraph::MarkDirty(size_t slot) {
+    m_localDirty[slot] = 1;
+    m_minDirtyDepth = std::min(m_minDirtyDepth, m_depths[slot]);
+}
+
+void SceneGraph::Update() {
+    auto start = std::chrono::high_resolution_clock::now();
+    bool sorted = m_layoutDirty;
+    if (m_layoutDirty) {
+        SortByDepth();
+    }
+
+    ++m_updateIndex;
+    m_stats.updated = 0;
+    m_stats.batches = 0;
+
+    // Levels above the shallowest change are untouched
+    size_t firstDepth = m_minDirtyDepth == kNone ? m_levelStarts.size() : m_minDirtyDepth;
+    for (size_t depth = firstDepth; depth + 1 < m_levelStarts.size(); ++depth) {
+        size_t begin = m_levelStarts[depth];
+        size_t end = m_levelStarts[depth + 1];
+        if (end - begin < kParallelLevel) {
+            m_stats.updated += UpdateRange(begin, end);
+            continue;
+        }
+
+        // Nodes of one level only read the level above, so batches are independent
+        if (!m_pool) {
+            m_pool = std::make_unique<ThreadPool>();
+        }
+        size_t batches = std::min(m_pool->GetThreadCount() + 1, (end - begin) / kMinBatch);
+        size_t batchSize = (end - begin + batches - 1) / batches;
+        std::atomic<size_t> updated(0);
+        for (size_t batchBegin = begin + batchSize; batchBegin < end; batchBegin += batchSize) {
+            size_t batchEnd = std::min(batchBegin + batchSize, end);
+            m_pool->Submit([this, &updated, batchBegin, batchEnd]() {
+                updated += UpdateRange(batchBegin, batchEnd);
+            });
+            ++m_stats.batches;
+        }
+        updated += UpdateRange(begin, begin + batchSize);
+        m_pool->Wait();
+        m_stats.updated += updated;
+    }
+    m_minDirtyDepth = kNone;
+    if (sorted || m_stats.updated > 0) {
+        ++m_version;
+    }
+
+    m_stats.nodes = m_nodes.size();
+    m_stats.levels = m_levelStarts.empty() ? 0 : m_levelStarts.size() - 1;
+    m_stats.updateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+size_t SceneGraph::UpdateRange(size_t begin, size_t end) {
+    size_t updated = 0;
+    for (size_t slot = begin; slot < end; ++slot) {
+        uint32_t parent = m_parents[slot];
+        bool parentChanged = parent != kNone && m_changedUpdate[parent] == m_updateIndex;
+        if (!m_localDirty[slot] && !parentChanged) {
+            continue;
+        }
+        m_localDirty[slot] = 0;
+        m_changedUpdate[slot] = m_updateIndex;
+        m_world[slot] = parent == kNone ? m_local[slot] : m_world[parent] * m_local[slot];
+        m_worldBounds[slot] = m_localBounds[slot].Transform(m_world[slot]);
+        ++updated;
+    }
+    return updated;
+}
+
+void SceneGraph::SortByDepth() {
+    // Stable counting sort: siblings keep their insertion order, removed slots are dropped
+    uint32_t maxDepth = 0;
+    for (size_t slot = 0; slot < m_nodes.size(); ++slot) {
+        if (!(m_flags[slot] & kRemoved)) {
+            maxDepth = std::max(maxDepth, m_depths[slot]);
+        }
+    }
+    std::vector<size_t> starts(maxDepth + 2, 0);
+    for (size_t slot = 0; slot < m_nodes.size(); ++slot) {
+        if (!(m_flags[slot] & kRemoved)) {
+            ++starts[m_depths[slot] + 1];
+        }
+    }
+    for (size_t depth = 1; depth < starts.size(); ++depth) {
+        starts[depth] += starts[depth - 1];
+    }
+
+    std::vector<uint32_t> order(starts.back());
+    std::vector<uint32_t> remap(m_nodes.size(), kNone);
+    std::vector<size_t> next(starts.begin(), starts.end() - 1);
+    for (size_t slot = 0; slot < m_nodes.size(); ++slot) {
+        if (!(m_flags[slot] & kRemoved)) {
+            size_t sorted = next[m_depths[slot]]++;
+            order[sorted] = static_cast<uint32_t>(slot);
+            remap[slot] = static_cast<uint32_t>(sorted);
+        }
+    }
+
+    Permute(m_nodes, order);
+    Permute(m_parents, order);
+    Permute(m_depths, order);
+    Permute(m_local, order);
+    Permute(m_world, order);
+    Permute(m_localBounds, order);
+    Permute(m_worldBounds, order);
+    Permute(m_colors, order);
+    Permute(m_textures, order);
+    Permute(m_flags, order);
+    Permute(m_localDirty, order);
+    Permute(m_changedUpdate, order);
+
+    for (size_t slot = 0; slot < m_nodes.size(); ++slot) {
+        if (m_parents[slot] != kNone) {
+            m_parents[slot] = remap[m_parents[slot]];
+        }
+        m_slots[m_nodes[slot]] = static_cast<uint32_t>(slot);
+    }
+    m_levelStarts.assign(starts.begin(), starts.end());
+    if (m_nodes.empty()) {
+        m_levelStarts.clear();
+    }
+    m_layoutDirty = false;
+}
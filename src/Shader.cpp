@@ -2,6 +2,10 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+
+bool Shader::s_softwareMode = false;
+const Shader* Shader::s_current = nullptr;
 
 Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) : m_program(0) {
     // Read vertex and fragment shader source code from files
@@ -12,28 +16,55 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) :
         std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
         return;
     }
+    if (s_softwareMode) {
+        return;
+    }
+    Link(vertexCode, "", fragmentCode);
+}
 
-    // Compile shaders
-    GLuint vertex = CompileShader(vertexCode, GL_VERTEX_SHADER);
-    GLuint fragment = CompileShader(fragmentCode, GL_FRAGMENT_SHADER);
+Shader::Shader(const std::string& vertexPath, const std::string& geometryPath, const std::string& fragmentPath)
+    : m_program(0) {
+    std::string vertexCode = ReadFile(vertexPath);
+    std::string geometryCode = ReadFile(geometryPath);
+    std::string fragmentCode = ReadFile(fragmentPath);
 
-    // Create shader program
+    if (vertexCode.empty() || geometryCode.empty() || fragmentCode.empty()) {
+        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+        return;
+    }
+    if (s_softwareMode) {
+        return;
+    }
+    Link(vertexCode, geometryCode, fragmentCode);
+}
+
+Shader::Shader(const std::string& computePath) : m_program(0) {
+    std::string computeCode = ReadFile(computePath);
+    if (computeCode.empty()) {
+        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+        return;
+    }
+    if (s_softwareMode) {
+        return;
+    }
+
+    GLuint compute = CompileShader(computeCode, GL_COMPUTE_SHADER);
     m_program = glCreateProgram();
-    glAttachShader(m_program, vertex);
-    glAttachShader(m_program, fragment);
+    glAttachShader(m_program, compute);
     glLinkProgram(m_program);
     CheckCompileErrors(m_program, "PROGRAM");
-
-    // Delete shaders as they're linked into our program and no longer necessary
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    glDeleteShader(compute);
 }
 
 Shader::~Shader() {
     Delete();
+    if (s_current == this) {
+        s_current = nullptr;
+    }
 }
 
 void Shader::Use() const {
+    s_current = this;
     if (m_program != 0) {
         glUseProgram(m_program);
     }
@@ -46,35 +77,124 @@ void Shader::Delete() const {
 }
 
 void Shader::SetBool(const std::string& name, bool value) const {
+    if (s_softwareMode) {
+        float recorded = value ? 1.0f : 0.0f;
+        Record(name, &recorded, 1);
+        return;
+    }
     glUniform1i(glGetUniformLocation(m_program, name.c_str()), static_cast<int>(value));
 }
 
 void Shader::SetInt(const std::string& name, int value) const {
+    if (s_softwareMode) {
+        float recorded = static_cast<float>(value);
+        Record(name, &recorded, 1);
+        return;
+    }
     glUniform1i(glGetUniformLocation(m_program, name.c_str()), value);
 }
 
 void Shader::SetFloat(const std::string& name, float value) const {
+    if (s_softwareMode) {
+        Record(name, &value, 1);
+        return;
+    }
     glUniform1f(glGetUniformLocation(m_program, name.c_str()), value);
 }
 
+void Shader::SetVec2(const std::string& name, const glm::vec2& value) const {
+    if (s_softwareMode) {
+        Record(name, glm::value_ptr(value), 2);
+        return;
+    }
+    glUniform2fv(glGetUniformLocation(m_program, name.c_str()), 1, glm::value_ptr(value));
+}
+
 void Shader::SetVec3(const std::string& name, const glm::vec3& value) const {
+    if (s_softwareMode) {
+        Record(name, glm::value_ptr(value), 3);
+        return;
+    }
     glUniform3fv(glGetUniformLocation(m_program, name.c_str()), 1, glm::value_ptr(value));
 }
 
 void Shader::SetMat4(const std::string& name, const glm::mat4& value) const {
+    if (s_softwareMode) {
+        Record(name, glm::value_ptr(value), 16);
+        return;
+    }
     glUniformMatrix4fv(glGetUniformLocation(m_program, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
 }
 
 void Shader::SetMat4(const std::string& name, const float* value) const {
+    if (s_softwareMode) {
+        Record(name, value, 16);
+        return;
+    }
     glUniformMatrix4fv(glGetUniformLocation(m_program, name.c_str()), 1, GL_FALSE, value);
 }
 
+void Shader::SetUniformBlock(const std::string& name, GLuint binding) const {
+    if (s_softwareMode) {
+        return;
+    }
+    GLuint index = glGetUniformBlockIndex(m_program, name.c_str());
+    if (index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(m_program, index, binding);
+    }
+}
+
+void Shader::Record(const std::string& name, const float* value, size_t count) const {
+    m_uniforms[name].assign(value, value + count);
+}
+
+bool Shader::GetUniform(const std::string& name, float* value, size_t count) const {
+    auto found = m_uniforms.find(name);
+    if (found == m_uniforms.end()) {
+        return false;
+    }
+    std::copy_n(found->second.begin(), std::min(count, found->second.size()), value);
+    return true;
+}
+
+void Shader::Link(const std::string& vertexCode, const std::string& geometryCode, const std::string& fragmentCode) {
+    // Compile shaders
+    GLuint vertex = CompileShader(vertexCode, GL_VERTEX_SHADER);
+    GLuint geometry = geometryCode.empty() ? 0 : CompileShader(geometryCode, GL_GEOMETRY_SHADER);
+    GLuint fragment = CompileShader(fragmentCode, GL_FRAGMENT_SHADER);
+
+    // Create shader program
+    m_program = glCreateProgram();
+    glAttachShader(m_program, vertex);
+    if (geometry != 0) {
+        glAttachShader(m_program, geometry);
+    }
+    glAttachShader(m_program, fragment);
+    glLinkProgram(m_program);
+    CheckCompileErrors(m_program, "PROGRAM");
+
+    // Delete shaders as they're linked into our program and no longer necessary
+    glDeleteShader(vertex);
+    if (geometry != 0) {
+        glDeleteShader(geometry);
+    }
+    glDeleteShader(fragment);
+}
+
 GLuint Shader::CompileShader(const std::string& source, GLenum type) const {
     GLuint shader = glCreateShader(type);
     const char* sourceCStr = source.c_str();
     glShaderSource(shader, 1, &sourceCStr, nullptr);
     glCompileShader(shader);
-    CheckCompileErrors(shader, type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT");
+    const char* name = "FRAGMENT";
+    if (type == GL_VERTEX_SHADER) {
+        name = "VERTEX";
+    } else if (type == GL_GEOMETRY_SHADER) {
+        name = "GEOMETRY";
+    } else if (type == GL_COMPUTE_SHADER) {
+        name = "COMPUTE";
+    }
+    CheckCompileErrors(shader, name);
     return shader;
 }
 
@@ -0,0 +1,392 @@
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_RASTERIZER_SSE2 1
+#endif
+
+namespace {
+
+uint32_t PackColor(const glm::vec3& color) {
+    auto channel = [](float value) {
+        return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    return channel(color.r) | (channel(color.g) << 8) | (channel(color.b) << 16) | (255u << 24);
+}
+
+bool operator==(const SoftwareRasterizer::Material& a, const SoftwareRasterizer::Material& b) {
+    return a.lit == b.lit && a.lightPos == b.lightPos && a.lightColor == b.lightColor && a.objectColor == b.objectColor;
+}
+
+} // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(size_t threadCount)
+    : m_width(0), m_height(0), m_tilesX(0), m_tilesY(0), m_clearPending(false), m_clearColor(0),
+      m_pool(threadCount) {
+}
+
+void SoftwareRasterizer::Resize(int width, int height) {
+    m_width = std::max(width, 1);
+    m_height = std::max(height, 1);
+    m_tilesX = (m_width + kTileSize - 1) / kTileSize;
+    m_tilesY = (m_height + kTileSize - 1) / kTileSize;
+    m_color.assign(static_cast<size_t>(m_width) * m_height, 0);
+    m_depth.assign(static_cast<size_t>(m_width) * m_height, 1.0f);
+    m_bins.assign(static_cast<size_t>(m_tilesX) * m_tilesY, {});
+    m_triangles.clear();
+    m_materials.clear();
+}
+
+// Deferred to Flush so every tile clears its own memory in parallel
+void SoftwareRasterizer::Clear(const glm::vec4& color) {
+    for (auto& bin : m_bins) {
+        bin.clear();
+    }
+    m_triangles.clear();
+    m_materials.clear();
+    m_clearPending = true;
+    m_clearColor = PackColor(glm::vec3(color));
+}
+
+int SoftwareRasterizer::AddMaterial(const Material& material) {
+    if (m_materials.empty() || !(m_materials.back() == material)) {
+        m_materials.push_back(material);
+    }
+    return static_cast<int>(m_materials.size()) - 1;
+}
+
+void SoftwareRasterizer::DrawTriangles(const float* vertices, const unsigned int* indices, int indexCount,
+                                       const glm::mat4& model, const glm::mat4& viewProjection, const Material& material) {
+    if (indexCount < 3) {
+        return;
+    }
+
+    // Vertex stage, once per referenced vertex
+    unsigned int vertexCount = *std::max_element(indices, indices + indexCount) + 1;
+    glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+    std::vector<Vertex> transformed(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i) {
+        const float* source = vertices + i * 6;
+        glm::vec4 world = model * glm::vec4(source[0], source[1], source[2], 1.0f);
+        glm::vec3 attribute(source[3], source[4], source[5]);
+        transformed[i].clip = viewProjection * world;
+        transformed[i].world = glm::vec3(world);
+        transformed[i].attribute = material.lit ? normalMatrix * attribute : attribute;
+    }
+
+    int materialIndex = material.lit ? AddMaterial(material) : -1;
+    for (int i = 0; i + 2 < indexCount; i += 3) {
+        ClipAndSetup(transformed[indices[i]], transformed[indices[i + 1]], transformed[indices[i + 2]], materialIndex);
+    }
+}
+
+void SoftwareRasterizer::DrawLines(const float* vertices, int segmentCount, float width, const glm::mat4& transform) {
+    const float halfWidth = std::max(width, 1.0f) * 0.5f;
+    for (int i = 0; i < segmentCount; ++i) {
+        Vertex ends[2];
+        for (int j = 0; j < 2; ++j) {
+            const float* source = vertices + (i * 2 + j) * 6;
+            glm::vec3 position(source[0], source[1], source[2]);
+            ends[j].clip = transform * glm::vec4(position, 1.0f);
+            ends[j].world = position;
+            ends[j].attribute = glm::vec3(source[3], source[4], source[5]);
+        }
+
+        // Clip against the near plane
+        float d0 = ends[0].clip.z + ends[0].clip.w;
+        float d1 = ends[1].clip.z + ends[1].clip.w;
+        if (d0 < 0.0f && d1 < 0.0f) {
+            continue;
+        }
+        if (d0 < 0.0f || d1 < 0.0f) {
+            float t = d0 / (d0 - d1);
+            Vertex clipped;
+            clipped.clip = ends[0].clip + (ends[1].clip - ends[0].clip) * t;
+            clipped.world = ends[0].world + (ends[1].world - ends[0].world) * t;
+            clipped.attribute = ends[0].attribute + (ends[1].attribute - ends[0].attribute) * t;
+            ends[d0 < 0.0f ? 0 : 1] = clipped;
+        }
+
+        // Expand to a screen-space quad
+        ScreenVertex a = ToScreen(ends[0]);
+        ScreenVertex b = ToScreen(ends[1]);
+        glm::vec2 direction(b.x - a.x, b.y - a.y);
+        float length = glm::length(direction);
+        direction = length > 1e-4f ? direction / length : glm::vec2(1.0f, 0.0f);
+        glm::vec2 offset = glm::vec2(-direction.y, direction.x) * halfWidth;
+
+        ScreenVertex corners[4] = { a, a, b, b };
+        corners[0].x += offset.x; corners[0].y += offset.y;
+        corners[1].x -= offset.x; corners[1].y -= offset.y;
+        corners[2].x += offset.x; corners[2].y += offset.y;
+        corners[3].x -= offset.x; corners[3].y -= offset.y;
+        SetupTriangle(corners[0], corners[1], corners[2], -1);
+        SetupTriangle(corners[2], corners[1], corners[3], -1);
+    }
+}
+
+void SoftwareRasterizer::DrawPoints(const float* vertices, int count, float size, const glm::mat4& transform) {
+    const float half = std::max(size, 1.0f) * 0.5f;
+    for (int i = 0; i < count; ++i) {
+        const float* source = vertices + i * 6;
+        Vertex vertex;
+        vertex.clip = transform * glm::vec4(source[0], source[1], source[2], 1.0f);
+        vertex.world = glm::vec3(source[0], source[1], source[2]);
+        vertex.attribute = glm::vec3(source[3], source[4], source[5]);
+        if (vertex.clip.z + vertex.clip.w < 0.0f) {
+            continue;
+        }
+
+        ScreenVertex center = ToScreen(vertex);
+        ScreenVertex corners[4] = { center, center, center, center };
+        corners[0].x -= half; corners[0].y -= half;
+        corners[1].x += half; corners[1].y -= half;
+        corners[2].x -= half; corners[2].y += half;
+        corners[3].x += half; corners[3].y += half;
+        SetupTriangle(corners[0], corners[1], corners[2], -1);
+        SetupTriangle(corners[2], corners[1], corners[3], -1);
+    }
+}
+
+// Near-plane clipping; the other planes are handled by the screen bounds and
+// the depth range test
+void SoftwareRasterizer::ClipAndSetup(const Vertex& a, const Vertex& b, const Vertex& c, int material) {
+    const Vertex* input[3] = { &a, &b, &c };
+    float distance[3];
+    int inside = 0;
+    for (int i = 0; i < 3; ++i) {
+        distance[i] = input[i]->clip.z + input[i]->clip.w;
+        inside += distance[i] >= 0.0f ? 1 : 0;
+    }
+
+    if (inside == 3) {
+        SetupTriangle(ToScreen(a), ToScreen(b), ToScreen(c), material);
+        return;
+    }
+    if (inside == 0) {
+        return;
+    }
+
+    Vertex polygon[4];
+    int count = 0;
+    for (int i = 0; i < 3; ++i) {
+        int next = (i + 1) % 3;
+        if (distance[i] >= 0.0f) {
+            polygon[count++] = *input[i];
+        }
+        if ((distance[i] >= 0.0f) != (distance[next] >= 0.0f)) {
+            float t = distance[i] / (distance[i] - distance[next]);
+            Vertex& clipped = polygon[count++];
+            clipped.clip = input[i]->clip + (input[next]->clip - input[i]->clip) * t;
+            clipped.world = input[i]->world + (input[next]->world - input[i]->world) * t;
+            clipped.attribute = input[i]->attribute + (input[next]->attribute - input[i]->attribute) * t;
+        }
+    }
+
+    ScreenVertex first = ToScreen(polygon[0]);
+    for (int i = 1; i + 1 < count; ++i) {
+        SetupTriangle(first, ToScreen(polygon[i]), ToScreen(polygon[i + 1]), material);
+    }
+}
+
+SoftwareRasterizer::ScreenVertex SoftwareRasterizer::ToScreen(const Vertex& vertex) const {
+    ScreenVertex screen;
+    screen.invW = 1.0f / std::max(vertex.clip.w, 1e-6f);
+    screen.x = (vertex.clip.x * screen.invW * 0.5f + 0.5f) * m_width;
+    screen.y = (vertex.clip.y * screen.invW * 0.5f + 0.5f) * m_height;
+    screen.z = vertex.clip.z * screen.invW * 0.5f + 0.5f;
+    screen.world = vertex.world;
+    screen.attribute = vertex.attribute;
+    return screen;
+}
+
+void SoftwareRasterizer::SetupTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, int material) {
+    const ScreenVertex* v[3] = { &a, &b, &c };
+    Triangle triangle;
+
+    for (int i = 0; i < 3; ++i) {
+        const ScreenVertex& from = *v[(i + 1) % 3];
+        const ScreenVertex& to = *v[(i + 2) % 3];
+        triangle.edgeA[i] = from.y - to.y;
+        triangle.edgeB[i] = to.x - from.x;
+        triangle.edgeC[i] = from.x * to.y - to.x * from.y;
+    }
+
+    // Both windings are drawn (no face culling), so orient edges positive inside
+    float area = triangle.edgeA[0] * a.x + triangle.edgeB[0] * a.y + triangle.edgeC[0];
+    if (std::fabs(area) < 1e-8f) {
+        return;
+    }
+    if (area < 0.0f) {
+        for (int i = 0; i < 3; ++i) {
+            triangle.edgeA[i] = -triangle.edgeA[i];
+            triangle.edgeB[i] = -triangle.edgeB[i];
+            triangle.edgeC[i] = -triangle.edgeC[i];
+        }
+        area = -area;
+    }
+    triangle.invArea = 1.0f / area;
+
+    float minX = std::min({ a.x, b.x, c.x });
+    float maxX = std::max({ a.x, b.x, c.x });
+    float minY = std::min({ a.y, b.y, c.y });
+    float maxY = std::max({ a.y, b.y, c.y });
+    triangle.minX = std::max(0, static_cast<int>(std::floor(minX)));
+    triangle.minY = std::max(0, static_cast<int>(std::floor(minY)));
+    triangle.maxX = std::min(m_width - 1, static_cast<int>(std::ceil(maxX)));
+    triangle.maxY = std::min(m_height - 1, static_cast<int>(std::ceil(maxY)));
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+        return;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        triangle.z[i] = v[i]->z;
+        triangle.invW[i] = v[i]->invW;
+        triangle.world[i] = v[i]->world * v[i]->invW;
+        triangle.attribute[i] = v[i]->attribute * v[i]->invW;
+    }
+    triangle.material = material;
+
+    uint32_t index = static_cast<uint32_t>(m_triangles.size());
+    m_triangles.push_back(triangle);
+    for (int tileY = triangle.minY / kTileSize; tileY <= triangle.maxY / kTileSize; ++tileY) {
+        for (int tileX = triangle.minX / kTileSize; tileX <= triangle.maxX / kTileSize; ++tileX) {
+            m_bins[tileY * m_tilesX + tileX].push_back(index);
+        }
+    }
+}
+
+void SoftwareRasterizer::Flush() {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    m_stats.triangles = m_triangles.size();
+    m_stats.binEntries = 0;
+    for (int tileY = 0; tileY < m_tilesY; ++tileY) {
+        for (int tileX = 0; tileX < m_tilesX; ++tileX) {
+            size_t entries = m_bins[tileY * m_tilesX + tileX].size();
+            m_stats.binEntries += entries;
+            if (entries > 0 || m_clearPending) {
+                m_pool.Submit([this, tileX, tileY]() { RasterizeTile(tileX, tileY); });
+            }
+        }
+    }
+    m_pool.Wait();
+
+    for (auto& bin : m_bins) {
+        bin.clear();
+    }
+    m_triangles.clear();
+    m_materials.clear();
+    m_clearPending = false;
+
+    m_stats.flushMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void SoftwareRasterizer::RasterizeTile(int tileX, int tileY) {
+    const int x0 = tileX * kTileSize;
+    const int y0 = tileY * kTileSize;
+    const int x1 = std::min(x0 + kTileSize, m_width) - 1;
+    const int y1 = std::min(y0 + kTileSize, m_height) - 1;
+    uint32_t* color = m_color.data();
+    float* depth = m_depth.data();
+
+    if (m_clearPending) {
+        for (int y = y0; y <= y1; ++y) {
+            std::fill(color + y * m_width + x0, color + y * m_width + x1 + 1, m_clearColor);
+            std::fill(depth + y * m_width + x0, depth + y * m_width + x1 + 1, 1.0f);
+        }
+    }
+
+    // Triangles are processed in submission order, so per-pixel results match
+    // a serial rasterizer
+    for (uint32_t index : m_bins[tileY * m_tilesX + tileX]) {
+        const Triangle& triangle = m_triangles[index];
+        const int minX = std::max(triangle.minX, x0);
+        const int maxX = std::min(triangle.maxX, x1);
+        const int minY = std::max(triangle.minY, y0);
+        const int maxY = std::min(triangle.maxY, y1);
+
+#ifdef SOFTWARE_RASTERIZER_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 a0 = _mm_set1_ps(triangle.edgeA[0]);
+        const __m128 a1 = _mm_set1_ps(triangle.edgeA[1]);
+        const __m128 a2 = _mm_set1_ps(triangle.edgeA[2]);
+#endif
+
+        for (int y = minY; y <= maxY; ++y) {
+            const float py = y + 0.5f;
+            const float row0 = triangle.edgeB[0] * py + triangle.edgeC[0];
+            const float row1 = triangle.edgeB[1] * py + triangle.edgeC[1];
+            const float row2 = triangle.edgeB[2] * py + triangle.edgeC[2];
+            int x = minX;
+
+#ifdef SOFTWARE_RASTERIZER_SSE2
+            const __m128 r0 = _mm_set1_ps(row0);
+            const __m128 r1 = _mm_set1_ps(row1);
+            const __m128 r2 = _mm_set1_ps(row2);
+            for (; x + 3 <= maxX; x += 4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+                __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px), r0);
+                __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px), r1);
+                __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px), r2);
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+                int mask = _mm_movemask_ps(inside);
+                if (mask == 0) {
+                    continue;
+                }
+
+                alignas(16) float w0[4], w1[4], w2[4];
+                _mm_store_ps(w0, e0);
+                _mm_store_ps(w1, e1);
+                _mm_store_ps(w2, e2);
+                for (int lane = 0; lane < 4; ++lane) {
+                    if (mask & (1 << lane)) {
+                        ShadePixel(triangle, w0[lane] * triangle.invArea, w1[lane] * triangle.invArea, w2[lane] * triangle.invArea,
+                                   x + lane, y, color, depth);
+                    }
+                }
+            }
+#endif
+
+            for (; x <= maxX; ++x) {
+                const float px = x + 0.5f;
+                float e0 = triangle.edgeA[0] * px + row0;
+                float e1 = triangle.edgeA[1] * px + row1;
+                float e2 = triangle.edgeA[2] * px + row2;
+                if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f) {
+                    ShadePixel(triangle, e0 * triangle.invArea, e1 * triangle.invArea, e2 * triangle.invArea, x, y, color, depth);
+                }
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::ShadePixel(const Triangle& triangle, float b0, float b1, float b2, int x, int y, uint32_t* color, float* depth) const {
+    float z = b0 * triangle.z[0] + b1 * triangle.z[1] + b2 * triangle.z[2];
+    size_t index = static_cast<size_t>(y) * m_width + x;
+    if (z < 0.0f || z > 1.0f || z >= depth[index]) {
+        return;
+    }
+    depth[index] = z;
+
+    // Perspective-correct attributes
+    float w = 1.0f / (b0 * triangle.invW[0] + b1 * triangle.invW[1] + b2 * triangle.invW[2]);
+    glm::vec3 attribute = (triangle.attribute[0] * b0 + triangle.attribute[1] * b1 + triangle.attribute[2] * b2) * w;
+    if (triangle.material < 0) {
+        color[index] = PackColor(attribute);
+        return;
+    }
+
+    // Same lighting as fragment.glsl
+    const Material& material = m_materials[triangle.material];
+    glm::vec3 world = (triangle.world[0] * b0 + triangle.world[1] * b1 + triangle.world[2] * b2) * w;
+    glm::vec3 normal = glm::normalize(attribute);
+    glm::vec3 lightDir = glm::normalize(material.lightPos - world);
+    glm::vec3 ambient = 0.1f * material.lightColor;
+    glm::vec3 diffuse = std::max(glm::dot(normal, lightDir), 0.0f) * material.lightColor;
+    color[index] = PackColor((ambient + diffuse) * material.objectColor);
+}
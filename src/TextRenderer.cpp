@@ -0,0 +1,639 @@
+#include "TextRenderer.h"
+#include "Shader.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+constexpr uint32_t kAtlasMagic = 0x41464453;  // "SDFA"
+constexpr uint32_t kAtlasVersion = 1;
+constexpr float kInfinity = 1e20f;
+
+struct AtlasHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t pageSize;
+    uint32_t pageCount;
+};
+
+// Exact 1D squared Euclidean distance transform of a sampled function
+// (Felzenszwalb & Huttenlocher); stride steps between samples
+void DistanceTransform1D(float* values, int count, int stride, std::vector<float>& f,
+                         std::vector<int>& v, std::vector<float>& z) {
+    for (int i = 0; i < count; ++i) {
+        f[i] = values[i * stride];
+    }
+    // Lower envelope of the parabolas rooted at every sample
+    int k = 0;
+    v[0] = 0;
+    z[0] = -kInfinity;
+    z[1] = kInfinity;
+    for (int q = 1; q < count; ++q) {
+        float s;
+        while (true) {
+            int p = v[k];
+            s = ((f[q] + q * q) - (f[p] + p * p)) / (2.0f * (q - p));
+            if (s > z[k]) {
+                break;
+            }
+            --k;
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = kInfinity;
+    }
+    k = 0;
+    for (int q = 0; q < count; ++q) {
+        while (z[k + 1] < q) {
+            ++k;
+        }
+        int p = v[k];
+        values[q * stride] = (q - p) * (q - p) + f[p];
+    }
+}
+
+// Squared distance of every texel to the nearest texel where feature is set
+void DistanceTransform2D(const std::vector<uint8_t>& feature, uint8_t set, int width, int height,
+                         std::vector<float>& distances) {
+    distances.resize(feature.size());
+    for (size_t i = 0; i < feature.size(); ++i) {
+        distances[i] = feature[i] == set ? 0.0f : kInfinity;
+    }
+    int size = std::max(width, height);
+    std::vector<float> f(size);
+    std::vector<int> v(size);
+    std::vector<float> z(size + 1);
+    for (int x = 0; x < width; ++x) {
+        DistanceTransform1D(&distances[x], height, width, f, v, z);
+    }
+    for (int y = 0; y < height; ++y) {
+        DistanceTransform1D(&distances[y * width], width, 1, f, v, z);
+    }
+}
+
+// Grows [begin, end) to cover [first, last); an empty range is replaced
+void ExtendRange(size_t& begin, size_t& end, size_t first, size_t last) {
+    if (first >= last) {
+        return;
+    }
+    if (begin >= end) {
+        begin = first;
+        end = last;
+    } else {
+        begin = std::min(begin, first);
+        end = std::max(end, last);
+    }
+}
+
+uint16_t ToUnorm16(float value) {
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+} // namespace
+
+TextRenderer::TextRenderer()
+    : m_vertexArray(0), m_instanceBuffer(0), m_instanceCapacity(0),
+      m_recordBuffer(0), m_recordTexture(0), m_recordCapacity(0),
+      m_pageStarts(kPageCount + 1, 0), m_glyphsDirty(false), m_instanceDirty(kPageCount),
+      m_recordDirtyBegin(0), m_recordDirtyEnd(0), m_version(0) {
+    static_assert(sizeof(GlyphInstance) == 28, "Instance layout is shared with vertex_text.glsl");
+    for (int glyph = 0; glyph < BitmapFont::kGlyphCount; ++glyph) {
+        int cell = glyph % kCellsPerPage;
+        float u = static_cast<float>((cell % kCellsPerRow) * kCellWidth) / kPageSize;
+        float v = static_cast<float>((cell / kCellsPerRow) * kCellHeight) / kPageSize;
+        m_texRects[glyph][0] = ToUnorm16(u);
+        m_texRects[glyph][1] = ToUnorm16(v);
+        m_texRects[glyph][2] = ToUnorm16(u + static_cast<float>(kCellWidth) / kPageSize);
+        m_texRects[glyph][3] = ToUnorm16(v + static_cast<float>(kCellHeight) / kPageSize);
+    }
+}
+
+TextRenderer::~TextRenderer() {
+    Shutdown();
+}
+
+bool TextRenderer::Initialize(const std::string& cachePath) {
+    m_shader = std::make_unique<Shader>("shaders/vertex_text.glsl", "shaders/fragment_text.glsl");
+    if (m_shader->GetID() == 0) {
+        std::cerr << "ERROR::TEXT_RENDERER::SHADER_UNAVAILABLE" << std::endl;
+        return false;
+    }
+
+    // Sampler units never change, bind them once
+    m_shader->Use();
+    m_shader->SetInt("atlas", 0);
+    m_shader->SetInt("labels", 1);
+    glUseProgram(0);
+
+    // Generating the distance fields is the slow part; reuse them across runs
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<uint8_t> pixels;
+    m_stats.atlasFromCache = LoadAtlas(cachePath, pixels);
+    if (!m_stats.atlasFromCache) {
+        GenerateAtlas(pixels);
+        SaveAtlas(cachePath, pixels);
+    }
+    m_stats.atlasMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "Text atlas: " << kPageCount << " pages of " << kPageSize << "x" << kPageSize
+              << (m_stats.atlasFromCache ? " loaded from " : " generated and cached in ") << cachePath
+              << " (" << m_stats.atlasMs << " ms)" << std::endl;
+
+    // Mipmaps keep small text from shimmering; a few levels stay inside the cell padding
+    m_pages.resize(kPageCount);
+    glGenTextures(kPageCount, m_pages.data());
+    for (int page = 0; page < kPageCount; ++page) {
+        glBindTexture(GL_TEXTURE_2D, m_pages[page]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, kPageSize, kPageSize, 0, GL_RED, GL_UNSIGNED_BYTE,
+                     pixels.data() + static_cast<size_t>(page) * kPageSize * kPageSize);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 3);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Label records, read with texelFetch
+    m_recordCapacity = 256;
+    glGenBuffers(1, &m_recordBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, m_recordBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, m_recordCapacity * 2 * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glGenTextures(1, &m_recordTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, m_recordTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_recordBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    // Quads are generated from gl_VertexID; only the instance attributes come from buffers
+    glGenVertexArrays(1, &m_vertexArray);
+    glGenBuffers(1, &m_instanceBuffer);
+    glBindVertexArray(m_vertexArray);
+    for (GLuint attribute = 0; attribute < 3; ++attribute) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    glBindVertexArray(0);
+    return true;
+}
+
+void TextRenderer::Shutdown() {
+    if (m_vertexArray != 0) {
+        glDeleteVertexArrays(1, &m_vertexArray);
+        m_vertexArray = 0;
+    }
+    if (m_instanceBuffer != 0) {
+        glDeleteBuffers(1, &m_instanceBuffer);
+        m_instanceBuffer = 0;
+        m_instanceCapacity = 0;
+    }
+    if (m_recordTexture != 0) {
+        glDeleteTextures(1, &m_recordTexture);
+        m_recordTexture = 0;
+    }
+    if (m_recordBuffer != 0) {
+        glDeleteBuffers(1, &m_recordBuffer);
+        m_recordBuffer = 0;
+        m_recordCapacity = 0;
+    }
+    if (!m_pages.empty()) {
+        glDeleteTextures(static_cast<GLsizei>(m_pages.size()), m_pages.data());
+        m_pages.clear();
+    }
+    if (m_shader) {
+        m_shader->Delete();
+        m_shader.reset();
+    }
+    Clear();
+}
+
+uint64_t TextRenderer::AtlasKey() {
+    // FNV-1a over the font and every parameter that shapes the atlas
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    const int parameters[] = { kScale, kSpread, kPageSize, BitmapFont::kGlyphWidth, BitmapFont::kGlyphHeight };
+    mix(BitmapFont::kGlyphs, sizeof(BitmapFont::kGlyphs));
+    mix(parameters, sizeof(parameters));
+    return hash;
+}
+
+bool TextRenderer::LoadAtlas(const std::string& path, std::vector<uint8_t>& pixels) const {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    AtlasHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != kAtlasMagic
+        || header.version != kAtlasVersion || header.key != AtlasKey()
+        || header.pageSize != kPageSize || header.pageCount != kPageCount) {
+        std::cout << "Text atlas cache " << path << " is stale, regenerating" << std::endl;
+        return false;
+    }
+    pixels.resize(static_cast<size_t>(kPageCount) * kPageSize * kPageSize);
+    if (!file.read(reinterpret_cast<char*>(pixels.data()), pixels.size())) {
+        std::cerr << "ERROR::TEXT_RENDERER::ATLAS_CACHE_TRUNCATED: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void TextRenderer::SaveAtlas(const std::string& path, const std::vector<uint8_t>& pixels) const {
+    AtlasHeader header = { kAtlasMagic, kAtlasVersion, AtlasKey(), kPageSize, kPageCount };
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+    if (!file) {
+        // Not fatal: the atlas is simply generated again next run
+        std::cerr << "ERROR::TEXT_RENDERER::ATLAS_CACHE_WRITE_FAILED: " << path << std::endl;
+    }
+}
+
+void TextRenderer::GenerateAtlas(std::vector<uint8_t>& pixels) {
+    pixels.assign(static_cast<size_t>(kPageCount) * kPageSize * kPageSize, 0);
+
+    std::vector<uint8_t> inside(kCellWidth * kCellHeight);
+    std::vector<float> toInside, toOutside;
+    for (int glyph = 0; glyph < BitmapFont::kGlyphCount; ++glyph) {
+        // Upscale the bitmap into the padded cell
+        for (int y = 0; y < kCellHeight; ++y) {
+            for (int x = 0; x < kCellWidth; ++x) {
+                int fontX = (x - kSpread) / kScale;
+                int fontY = (y - kSpread) / kScale;
+                bool set = x >= kSpread && y >= kSpread && fontX < BitmapFont::kGlyphWidth && fontY < BitmapFont::kGlyphHeight
+                    && (BitmapFont::kGlyphs[glyph][fontY] >> (15 - fontX) & 1);
+                inside[y * kCellWidth + x] = set ? 1 : 0;
+            }
+        }
+        DistanceTransform2D(inside, 1, kCellWidth, kCellHeight, toInside);
+        DistanceTransform2D(inside, 0, kCellWidth, kCellHeight, toOutside);
+
+        // 0.5 on the edge, 0 and 1 at kSpread texels outside and inside
+        int page = glyph / kCellsPerPage;
+        int cell = glyph % kCellsPerPage;
+        uint8_t* out = pixels.data() + static_cast<size_t>(page) * kPageSize * kPageSize
+            + static_cast<size_t>(cell / kCellsPerRow) * kCellHeight * kPageSize + (cell % kCellsPerRow) * kCellWidth;
+        for (int y = 0; y < kCellHeight; ++y) {
+            for (int x = 0; x < kCellWidth; ++x) {
+                int i = y * kCellWidth + x;
+                float distance = inside[i] ? std::sqrt(toOutside[i]) - 0.5f : 0.5f - std::sqrt(toInside[i]);
+                float value = std::clamp(0.5f + distance / (2.0f * kSpread), 0.0f, 1.0f);
+                out[y * kPageSize + x] = static_cast<uint8_t>(std::lround(value * 255.0f));
+            }
+        }
+    }
+}
+
+TextRenderer::Layout* TextRenderer::AcquireLayout(const std::string& text) {
+    auto found = m_layouts.find(text);
+    if (found != m_layouts.end()) {
+        ++m_stats.layoutHits;
+        ++found->second.references;
+        return &found->second;
+    }
+    ++m_stats.layoutMisses;
+
+    // Past the limit, forget every layout no label uses; element pointers stay valid
+    if (m_layouts.size() >= kMaxCachedLayouts) {
+        for (auto it = m_layouts.begin(); it != m_layouts.end();) {
+            it = it->second.references == 0 ? m_layouts.erase(it) : std::next(it);
+        }
+    }
+
+    // Monospaced: shaping is one advance per character, tabs align to four
+    Layout& layout = m_layouts[text];
+    layout.pageCounts.assign(kPageCount, 0);
+    const float advance = static_cast<float>(BitmapFont::kGlyphWidth) / BitmapFont::kGlyphHeight;
+    float x = 0.0f;
+    float width = 0.0f;
+    int line = 0;
+    for (unsigned char c : text) {
+        if (c == '\n') {
+            width = std::max(width, x);
+            x = 0.0f;
+            ++line;
+            continue;
+        }
+        if (c == '\t') {
+            x = (std::floor(x / (4.0f * advance)) + 1.0f) * 4.0f * advance;
+            continue;
+        }
+        if ((c & 0xC0) == 0x80) {
+            continue;  // UTF-8 continuation; the lead byte shows as '?'
+        }
+        if (c < BitmapFont::kFirstChar || c >= BitmapFont::kFirstChar + BitmapFont::kGlyphCount) {
+            c = '?';
+        }
+        if (c != ' ') {
+            uint16_t glyph = static_cast<uint16_t>(c - BitmapFont::kFirstChar);
+            layout.glyphs.push_back({ glyph, x, static_cast<float>(line) });
+            ++layout.pageCounts[glyph / kCellsPerPage];
+        }
+        x += advance;
+    }
+    layout.size = glm::vec2(std::max(width, x), static_cast<float>(line + 1));
+    layout.references = 1;
+    return &layout;
+}
+
+void TextRenderer::ReleaseLayout(Layout* layout) {
+    if (layout) {
+        --layout->references;
+    }
+}
+
+glm::vec2 TextRenderer::Measure(const std::string& text) {
+    Layout* layout = AcquireLayout(text);
+    glm::vec2 size = layout->size;
+    ReleaseLayout(layout);
+    return size;
+}
+
+int TextRenderer::AddLabel(const std::string& text, const glm::vec3& position, float size, const glm::vec4& color,
+                           TextSpace space, const glm::vec2& pivot) {
+    int index;
+    if (!m_freeLabels.empty()) {
+        index = m_freeLabels.back();
+        m_freeLabels.pop_back();
+    } else {
+        index = static_cast<int>(m_labels.size());
+        m_labels.emplace_back();
+        m_records.resize(m_records.size() + 2, glm::vec4(0.0f));
+    }
+
+    Label& label = m_labels[index];
+    label.layout = AcquireLayout(text);
+    label.pivot = pivot;
+    label.space = space;
+    label.firstInstance.clear();
+    label.alive = true;
+    WriteRecord(index, position, size, color);
+
+    // New glyphs need room in their pages; one rebuild covers every add before the next Draw
+    m_glyphsDirty = true;
+    ++m_stats.labels;
+    ++m_version;
+    return index;
+}
+
+void TextRenderer::RemoveLabel(int index) {
+    Label& label = m_labels[index];
+    if (!label.alive) {
+        return;
+    }
+
+    // Collapse the quads in place; the next rebuild compacts them away
+    if (!m_glyphsDirty && !label.firstInstance.empty()) {
+        for (int page = 0; page < kPageCount; ++page) {
+            size_t first = label.firstInstance[page];
+            size_t last = first + label.layout->pageCounts[page];
+            for (size_t i = first; i < last; ++i) {
+                m_instances[i].rect[2] = 0.0f;
+                m_instances[i].rect[3] = 0.0f;
+            }
+            ExtendRange(m_instanceDirty[page].first, m_instanceDirty[page].second, first, last);
+        }
+    }
+
+    ReleaseLayout(label.layout);
+    label = Label();
+    m_freeLabels.push_back(index);
+    --m_stats.labels;
+    ++m_version;
+}
+
+void TextRenderer::SetLabelText(int index, const std::string& text) {
+    Label& label = m_labels[index];
+    Layout* previous = label.layout;
+    Layout* layout = AcquireLayout(text);
+    if (layout == previous) {
+        ReleaseLayout(layout);
+        return;
+    }
+    label.layout = layout;
+
+    // Counters and other fixed-format text usually keep the per-page glyph
+    // counts, so the new quads fit exactly where the old ones were
+    if (!m_glyphsDirty && !label.firstInstance.empty() && layout->pageCounts == previous->pageCounts) {
+        GlyphInstance* cursors[kPageCount];
+        for (int page = 0; page < kPageCount; ++page) {
+            size_t first = label.firstInstance[page];
+            cursors[page] = m_instances.data() + first;
+            ExtendRange(m_instanceDirty[page].first, m_instanceDirty[page].second, first, first + layout->pageCounts[page]);
+        }
+        WriteGlyphs(label, index, cursors);
+        ++m_stats.patches;
+    } else {
+        m_glyphsDirty = true;
+    }
+    ReleaseLayout(previous);
+    ++m_version;
+}
+
+void TextRenderer::SetLabelPosition(int index, const glm::vec3& position) {
+    WriteRecord(index, position, m_records[index * 2].w, m_records[index * 2 + 1]);
+}
+
+void TextRenderer::SetLabelColor(int index, const glm::vec4& color) {
+    WriteRecord(index, glm::vec3(m_records[index * 2]), m_records[index * 2].w, color);
+}
+
+void TextRenderer::WriteRecord(int index, const glm::vec3& position, float size, const glm::vec4& color) {
+    glm::vec4 record[2] = { glm::vec4(position, size), color };
+    size_t first = static_cast<size_t>(index) * 2;
+    if (m_records[first] == record[0] && m_records[first + 1] == record[1]) {
+        return;
+    }
+    m_records[first] = record[0];
+    m_records[first + 1] = record[1];
+    ExtendRange(m_recordDirtyBegin, m_recordDirtyEnd, first, first + 2);
+    ++m_version;
+}
+
+void TextRenderer::Clear() {
+    m_labels.clear();
+    m_freeLabels.clear();
+    m_records.clear();
+    m_layouts.clear();
+    m_instances.clear();
+    m_pageStarts.assign(kPageCount + 1, 0);
+    m_glyphsDirty = false;
+    m_instanceDirty.assign(kPageCount, { 0, 0 });
+    m_recordDirtyBegin = m_recordDirtyEnd = 0;
+    m_stats.labels = 0;
+    m_stats.glyphs = 0;
+    ++m_version;
+}
+
+void TextRenderer::WriteGlyphs(const Label& label, int index, GlyphInstance** cursors) const {
+    // The cell's padding extends the quad past the glyph box on every side
+    const float cellWidth = static_cast<float>(kCellWidth) / (kScale * BitmapFont::kGlyphHeight);
+    const float cellHeight = static_cast<float>(kCellHeight) / (kScale * BitmapFont::kGlyphHeight);
+    const float padding = static_cast<float>(kSpread) / (kScale * BitmapFont::kGlyphHeight);
+    glm::vec2 origin = -label.pivot * label.layout->size - glm::vec2(padding);
+    uint32_t tag = static_cast<uint32_t>(index) | (static_cast<uint32_t>(label.space) << 30);
+
+    for (const LayoutGlyph& glyph : label.layout->glyphs) {
+        GlyphInstance& instance = *cursors[glyph.glyph / kCellsPerPage]++;
+        instance.label = tag;
+        instance.rect[0] = origin.x + glyph.x;
+        instance.rect[1] = origin.y + glyph.y;
+        instance.rect[2] = cellWidth;
+        instance.rect[3] = cellHeight;
+        std::copy(m_texRects[glyph.glyph], m_texRects[glyph.glyph] + 4, instance.uv);
+    }
+}
+
+void TextRenderer::RebuildGlyphs() {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Count per page first so every page's quads end up contiguous
+    std::vector<size_t> counts(kPageCount, 0);
+    for (const Label& label : m_labels) {
+        if (label.alive) {
+            for (int page = 0; page < kPageCount; ++page) {
+                counts[page] += label.layout->pageCounts[page];
+            }
+        }
+    }
+    m_pageStarts.assign(kPageCount + 1, 0);
+    for (int page = 0; page < kPageCount; ++page) {
+        m_pageStarts[page + 1] = m_pageStarts[page] + counts[page];
+    }
+    m_instances.resize(m_pageStarts.back());
+
+    GlyphInstance* cursors[kPageCount];
+    for (int page = 0; page < kPageCount; ++page) {
+        cursors[page] = m_instances.data() + m_pageStarts[page];
+        m_instanceDirty[page] = { m_pageStarts[page], m_pageStarts[page + 1] };
+    }
+    for (size_t index = 0; index < m_labels.size(); ++index) {
+        Label& label = m_labels[index];
+        if (!label.alive) {
+            continue;
+        }
+        label.firstInstance.resize(kPageCount);
+        for (int page = 0; page < kPageCount; ++page) {
+            label.firstInstance[page] = static_cast<uint32_t>(cursors[page] - m_instances.data());
+        }
+        WriteGlyphs(label, static_cast<int>(index), cursors);
+    }
+
+    m_glyphsDirty = false;
+    m_stats.glyphs = m_instances.size();
+    ++m_stats.rebuilds;
+    m_stats.rebuildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void TextRenderer::Upload() {
+    if (m_glyphsDirty) {
+        RebuildGlyphs();
+    }
+
+    // Grow with headroom (a rebuild has marked everything dirty); otherwise
+    // only the changed range of each page is sent
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+    if (m_instances.size() > m_instanceCapacity) {
+        m_instanceCapacity = m_instances.size() + m_instances.size() / 2;
+        glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity * sizeof(GlyphInstance), nullptr, GL_DYNAMIC_DRAW);
+    }
+    for (std::pair<size_t, size_t>& range : m_instanceDirty) {
+        if (range.first < range.second) {
+            glBufferSubData(GL_ARRAY_BUFFER, range.first * sizeof(GlyphInstance),
+                            (range.second - range.first) * sizeof(GlyphInstance), m_instances.data() + range.first);
+        }
+        range = { 0, 0 };
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (m_recordDirtyBegin < m_recordDirtyEnd || m_labels.size() > m_recordCapacity) {
+        glBindBuffer(GL_TEXTURE_BUFFER, m_recordBuffer);
+        if (m_labels.size() > m_recordCapacity) {
+            m_recordCapacity = m_labels.size() + m_labels.size() / 2;
+            glBufferData(GL_TEXTURE_BUFFER, m_recordCapacity * 2 * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+            m_recordDirtyBegin = 0;
+            m_recordDirtyEnd = m_records.size();
+        }
+        glBufferSubData(GL_TEXTURE_BUFFER, m_recordDirtyBegin * sizeof(glm::vec4),
+                        (m_recordDirtyEnd - m_recordDirtyBegin) * sizeof(glm::vec4), m_records.data() + m_recordDirtyBegin);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        m_recordDirtyBegin = m_recordDirtyEnd = 0;
+    }
+}
+
+void TextRenderer::Draw(const glm::mat4& view, const glm::mat4& projection, int width, int height) {
+    m_stats.draws = 0;
+    if (!m_shader || m_stats.labels == 0) {
+        return;
+    }
+    Upload();
+
+    m_shader->Use();
+    m_shader->SetMat4("viewProjection", projection * view);
+    m_shader->SetVec3("cameraRight", glm::vec3(view[0][0], view[1][0], view[2][0]));
+    m_shader->SetVec3("cameraUp", glm::vec3(view[0][1], view[1][1], view[2][1]));
+    m_shader->SetVec2("viewport", glm::vec2(static_cast<float>(width), static_cast<float>(height)));
+    m_shader->SetFloat("outline", 0.15f);
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    GLint blendFunc[4];
+    glGetIntegerv(GL_BLEND_SRC_RGB, &blendFunc[0]);
+    glGetIntegerv(GL_BLEND_DST_RGB, &blendFunc[1]);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &blendFunc[2]);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &blendFunc[3]);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, m_recordTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    // One instanced draw per page; the attributes are re-pointed at the page's range
+    const GLsizei stride = sizeof(GlyphInstance);
+    glBindVertexArray(m_vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+    for (int page = 0; page < kPageCount; ++page) {
+        size_t count = m_pageStarts[page + 1] - m_pageStarts[page];
+        if (count == 0) {
+            continue;
+        }
+        size_t base = m_pageStarts[page] * sizeof(GlyphInstance);
+        glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, stride, reinterpret_cast<const void*>(base + offsetof(GlyphInstance, label)));
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(base + offsetof(GlyphInstance, rect)));
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_SHORT, GL_TRUE, stride, reinterpret_cast<const void*>(base + offsetof(GlyphInstance, uv)));
+        glBindTexture(GL_TEXTURE_2D, m_pages[page]);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(count));
+        ++m_stats.draws;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBlendFuncSeparate(blendFunc[0], blendFunc[1], blendFunc[2], blendFunc[3]);
+    if (!blend) {
+        glDisable(GL_BLEND);
+    }
+    if (depthTest) {
+        glEnable(GL_DEPTH_TEST);
+    }
+}
+
+void TextRenderer::ResetCounters() {
+    m_stats.layoutHits = 0;
+    m_stats.layoutMisses = 0;
+    m_stats.rebuilds = 0;
+    m_stats.patches = 0;
+    m_stats.cachedLayouts = m_layouts.size();
+}
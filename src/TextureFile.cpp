@@ -0,0 +1,367 @@
+#include "TextureFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+uint32_t Read32(const uint8_t* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint64_t Read64(const uint8_t* data) {
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+constexpr uint32_t FourCC(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+GLenum FormatFromDXGI(uint32_t dxgi) {
+    switch (dxgi) {
+    case 71: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;         // BC1_UNORM
+    case 72: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;   // BC1_UNORM_SRGB
+    case 74: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;         // BC2_UNORM
+    case 75: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;   // BC2_UNORM_SRGB
+    case 77: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;         // BC3_UNORM
+    case 78: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;   // BC3_UNORM_SRGB
+    case 80: return GL_COMPRESSED_RED_RGTC1;                  // BC4_UNORM
+    case 83: return GL_COMPRESSED_RG_RGTC2;                   // BC5_UNORM
+    case 98: return GL_COMPRESSED_RGBA_BPTC_UNORM;            // BC7_UNORM
+    case 99: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;      // BC7_UNORM_SRGB
+    default: return 0;
+    }
+}
+
+GLenum FormatFromVulkan(uint32_t vkFormat) {
+    switch (vkFormat) {
+    case 131: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;         // BC1_RGB_UNORM_BLOCK
+    case 132: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;        // BC1_RGB_SRGB_BLOCK
+    case 133: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;        // BC1_RGBA_UNORM_BLOCK
+    case 134: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;  // BC1_RGBA_SRGB_BLOCK
+    case 135: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;        // BC2_UNORM_BLOCK
+    case 136: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;  // BC2_SRGB_BLOCK
+    case 137: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;        // BC3_UNORM_BLOCK
+    case 138: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;  // BC3_SRGB_BLOCK
+    case 139: return GL_COMPRESSED_RED_RGTC1;                 // BC4_UNORM_BLOCK
+    case 141: return GL_COMPRESSED_RG_RGTC2;                  // BC5_UNORM_BLOCK
+    case 145: return GL_COMPRESSED_RGBA_BPTC_UNORM;           // BC7_UNORM_BLOCK
+    case 146: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;     // BC7_SRGB_BLOCK
+    default: return 0;
+    }
+}
+
+} // namespace
+
+// MappedFile
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER size;
+        HANDLE mapping = GetFileSizeEx(file, &size) && size.QuadPart > 0
+            ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (view) {
+            m_file = file;
+            m_mapping = mapping;
+            m_data = static_cast<const uint8_t*>(view);
+            m_size = static_cast<size_t>(size.QuadPart);
+            return true;
+        }
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat info;
+        void* view = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (view != MAP_FAILED) {
+            m_data = static_cast<const uint8_t*>(view);
+            m_size = static_cast<size_t>(info.st_size);
+            return true;
+        }
+    }
+#endif
+
+    // Fallback: plain read
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream) {
+        return false;
+    }
+    m_fallback.resize(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0);
+    stream.read(reinterpret_cast<char*>(m_fallback.data()), static_cast<std::streamsize>(m_fallback.size()));
+    if (!stream) {
+        m_fallback.clear();
+        return false;
+    }
+    m_data = m_fallback.data();
+    m_size = m_fallback.size();
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_data != nullptr && m_fallback.empty()) {
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+    }
+    m_fallback.clear();
+    m_data = nullptr;
+    m_size = 0;
+}
+
+void MappedFile::Prefetch(size_t offset, size_t size) const {
+    if (m_data == nullptr || !m_fallback.empty() || offset >= m_size) {
+        return;
+    }
+    size = std::min(size, m_size - offset);
+
+#ifndef _WIN32
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = offset / page * page;
+    madvise(const_cast<uint8_t*>(m_data) + begin, offset + size - begin, MADV_WILLNEED);
+#endif
+    // Touch every page so the later copy on the render thread never faults to disk
+    volatile uint8_t sink = 0;
+    for (size_t i = offset; i < offset + size; i += 4096) {
+        sink = sink + m_data[i];
+    }
+    (void)sink;
+}
+
+// TextureFile
+bool TextureFile::Load(const std::string& path) {
+    m_path = path;
+    m_levels.clear();
+    if (!m_file.Open(path)) {
+        std::cerr << "ERROR::TEXTURE::FILE_NOT_SUCCESSFULLY_READ " << path << std::endl;
+        return false;
+    }
+
+    const uint8_t* data = m_file.GetData();
+    bool parsed = false;
+    if (m_file.GetSize() >= 4 && Read32(data) == FourCC('D', 'D', 'S', ' ')) {
+        parsed = ParseDDS();
+    } else if (m_file.GetSize() >= 12 && std::memcmp(data, "\xABKTX 20\xBB\r\n\x1A\n", 12) == 0) {
+        parsed = ParseKTX2();
+    } else {
+        std::cerr << "ERROR::TEXTURE::UNKNOWN_CONTAINER " << path << std::endl;
+    }
+
+    if (!parsed || !ValidateLevels()) {
+        m_file.Close();
+        m_levels.clear();
+        return false;
+    }
+    return true;
+}
+
+bool TextureFile::ParseDDS() {
+    const uint8_t* data = m_file.GetData();
+    const size_t headerEnd = 4 + 124;
+    if (m_file.GetSize() < headerEnd || Read32(data + 4) != 124) {
+        std::cerr << "ERROR::TEXTURE::DDS_BAD_HEADER " << m_path << std::endl;
+        return false;
+    }
+
+    uint32_t height = Read32(data + 4 + 8);
+    uint32_t width = Read32(data + 4 + 12);
+    uint32_t levelCount = std::max(1u, Read32(data + 4 + 24));
+    uint32_t fourCC = Read32(data + 4 + 80);
+    if (width > kMaxDimension || height > kMaxDimension || levelCount > kMaxLevels) {
+        std::cerr << "ERROR::TEXTURE::BAD_DIMENSIONS " << m_path << std::endl;
+        return false;
+    }
+    m_width = static_cast<int>(width);
+    m_height = static_cast<int>(height);
+
+    size_t offset = headerEnd;
+    switch (fourCC) {
+    case FourCC('D', 'X', 'T', '1'): m_format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+    case FourCC('D', 'X', 'T', '3'): m_format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;
+    case FourCC('D', 'X', 'T', '5'): m_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+    case FourCC('A', 'T', 'I', '1'):
+    case FourCC('B', 'C', '4', 'U'): m_format = GL_COMPRESSED_RED_RGTC1; break;
+    case FourCC('A', 'T', 'I', '2'):
+    case FourCC('B', 'C', '5', 'U'): m_format = GL_COMPRESSED_RG_RGTC2; break;
+    case FourCC('D', 'X', '1', '0'):
+        if (m_file.GetSize() < headerEnd + 20) {
+            return false;
+        }
+        m_format = FormatFromDXGI(Read32(data + headerEnd));
+        offset += 20;
+        break;
+    default:
+        m_format = 0;
+        break;
+    }
+    if (m_format == 0) {
+        std::cerr << "ERROR::TEXTURE::DDS_UNSUPPORTED_FORMAT " << m_path << std::endl;
+        return false;
+    }
+
+    // Mips are stored largest first, tightly packed; only the first surface is used
+    int levelWidth = m_width;
+    int levelHeight = m_height;
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        Level entry;
+        entry.offset = offset;
+        entry.size = LevelBytes(m_format, levelWidth, levelHeight);
+        entry.width = levelWidth;
+        entry.height = levelHeight;
+        m_levels.push_back(entry);
+        offset += entry.size;
+        levelWidth = std::max(1, levelWidth / 2);
+        levelHeight = std::max(1, levelHeight / 2);
+    }
+    return true;
+}
+
+bool TextureFile::ParseKTX2() {
+    const uint8_t* data = m_file.GetData();
+    const size_t levelIndex = 80;
+    if (m_file.GetSize() < levelIndex) {
+        std::cerr << "ERROR::TEXTURE::KTX2_BAD_HEADER " << m_path << std::endl;
+        return false;
+    }
+
+    m_format = FormatFromVulkan(Read32(data + 12));
+    uint32_t width = Read32(data + 20);
+    uint32_t height = Read32(data + 24);
+    uint32_t levelCount = std::max(1u, Read32(data + 40));
+    uint32_t supercompression = Read32(data + 44);
+    if (width > kMaxDimension || height > kMaxDimension || levelCount > kMaxLevels) {
+        std::cerr << "ERROR::TEXTURE::BAD_DIMENSIONS " << m_path << std::endl;
+        return false;
+    }
+    m_width = static_cast<int>(width);
+    m_height = static_cast<int>(height);
+
+    if (m_format == 0 || supercompression != 0) {
+        std::cerr << "ERROR::TEXTURE::KTX2_UNSUPPORTED_FORMAT " << m_path << std::endl;
+        return false;
+    }
+    if (m_file.GetSize() < levelIndex + static_cast<uint64_t>(levelCount) * 24) {
+        std::cerr << "ERROR::TEXTURE::KTX2_BAD_HEADER " << m_path << std::endl;
+        return false;
+    }
+
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        const uint8_t* entry = data + levelIndex + level * 24;
+        Level info;
+        uint64_t offset = Read64(entry);
+        uint64_t size = Read64(entry + 8);
+        // Checked before narrowing to size_t; ValidateLevels does the full check
+        if (offset > m_file.GetSize() || size > m_file.GetSize()) {
+            std::cerr << "ERROR::TEXTURE::TRUNCATED " << m_path << std::endl;
+            return false;
+        }
+        info.offset = static_cast<size_t>(offset);
+        info.size = static_cast<size_t>(size);
+        info.width = std::max(1, m_width >> level);
+        info.height = std::max(1, m_height >> level);
+        m_levels.push_back(info);
+    }
+    return true;
+}
+
+bool TextureFile::ValidateLevels() const {
+    if (m_width <= 0 || m_height <= 0 || m_levels.empty()) {
+        std::cerr << "ERROR::TEXTURE::BAD_DIMENSIONS " << m_path << std::endl;
+        return false;
+    }
+    for (const Level& level : m_levels) {
+        // Written so that a huge offset cannot wrap around the file size
+        if (level.size > m_file.GetSize() || level.offset > m_file.GetSize() - level.size
+            || level.size < LevelBytes(m_format, level.width, level.height)) {
+            std::cerr << "ERROR::TEXTURE::TRUNCATED " << m_path << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t TextureFile::BlockBytes(GLenum format) {
+    switch (format) {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RED_RGTC1:
+        return 8;
+    default:
+        return 16;
+    }
+}
+
+size_t TextureFile::LevelBytes(GLenum format, int width, int height) {
+    size_t blocksX = static_cast<size_t>((width + 3) / 4);
+    size_t blocksY = static_cast<size_t>((height + 3) / 4);
+    return blocksX * blocksY * BlockBytes(format);
+}
+
+bool TextureFile::IsFormatSupported(GLenum format) {
+    static std::set<std::string> extensions;
+    if (extensions.empty()) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i) {
+            extensions.insert(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)));
+        }
+    }
+
+    switch (format) {
+    case GL_COMPRESSED_RED_RGTC1:
+    case GL_COMPRESSED_RG_RGTC2:
+        return true;  // Core since 3.0
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        return GLAD_GL_VERSION_4_2 || extensions.count("GL_ARB_texture_compression_bptc") > 0;
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        return extensions.count("GL_EXT_texture_compression_s3tc") > 0
+            && (extensions.count("GL_EXT_texture_sRGB") > 0 || extensions.count("GL_EXT_texture_compression_s3tc_srgb") > 0);
+    default:
+        return extensions.count("GL_EXT_texture_compression_s3tc") > 0;
+    }
+}
@@ -0,0 +1,359 @@
+#include "TextureStreamer.h"
+#include "Camera.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+TextureStreamer::TextureStreamer()
+    : m_pboIndex(0), m_residencyBudget(0), m_uploadBudget(0), m_frame(1),
+      m_cameraPosition(0.0f), m_pixelScale(1.0f) {
+}
+
+TextureStreamer::~TextureStreamer() {
+    Shutdown();
+}
+
+bool TextureStreamer::Initialize(size_t residencyBudget, size_t uploadBudget, size_t loaderThreads) {
+    m_residencyBudget = residencyBudget;
+    m_uploadBudget = uploadBudget;
+    m_loaders = std::make_unique<ThreadPool>(loaderThreads);
+
+    for (Pbo& pbo : m_pbos) {
+        glGenBuffers(1, &pbo.buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, uploadBudget, nullptr, GL_STREAM_DRAW);
+        pbo.size = uploadBudget;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+void TextureStreamer::Shutdown() {
+    // Join the loaders first, they may still reference textures
+    m_loaders.reset();
+    m_loaded.clear();
+
+    for (Pbo& pbo : m_pbos) {
+        if (pbo.fence != nullptr) {
+            glDeleteSync(pbo.fence);
+            pbo.fence = nullptr;
+        }
+        if (pbo.buffer != 0) {
+            glDeleteBuffers(1, &pbo.buffer);
+            pbo.buffer = 0;
+        }
+    }
+    for (auto& texture : m_textures) {
+        if (texture->texture != 0) {
+            glDeleteTextures(1, &texture->texture);
+        }
+    }
+    m_textures.clear();
+    m_stats = Stats();
+}
+
+TextureStreamer::Handle TextureStreamer::Request(const std::string& path) {
+    for (size_t i = 0; i < m_textures.size(); ++i) {
+        if (m_textures[i]->path == path) {
+            return static_cast<Handle>(i);
+        }
+    }
+
+    auto texture = std::make_unique<Texture>();
+    texture->path = path;
+    Handle handle = static_cast<Handle>(m_textures.size());
+    m_textures.push_back(std::move(texture));
+    ++m_stats.textures;
+    ++m_stats.pendingLoads;
+
+    // Parse the header and page in the mip tail off the render thread
+    m_loaders->Submit([this, handle, path]() {
+        auto file = std::make_unique<TextureFile>();
+        if (file->Load(path)) {
+            for (int level = file->GetLevelCount() - 1; level >= 0; --level) {
+                const TextureFile::Level& info = file->GetLevel(level);
+                file->GetFile().Prefetch(info.offset, info.size);
+                if (std::max(info.width, info.height) > kTailSize) {
+                    break;
+                }
+            }
+        } else {
+            file.reset();
+        }
+        std::lock_guard<std::mutex> lock(m_loadedMutex);
+        m_loaded.emplace_back(handle, std::move(file));
+    });
+    return handle;
+}
+
+bool TextureStreamer::Bind(Handle handle, GLuint unit, const glm::vec3& center, float radius) {
+    if (handle < 0 || handle >= static_cast<Handle>(m_textures.size())) {
+        return false;
+    }
+    Texture& texture = *m_textures[handle];
+    if (texture.state != State::Ready) {
+        return false;
+    }
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture.texture);
+
+    // Largest on-screen size this frame drives the mip target
+    float distance = std::max(glm::length(center - m_cameraPosition), 1e-3f);
+    float pixels = 2.0f * radius * m_pixelScale / distance;
+    texture.screenPixels = texture.lastUsed == m_frame ? std::max(texture.screenPixels, pixels) : pixels;
+    texture.lastUsed = m_frame;
+    return true;
+}
+
+void TextureStreamer::Update(const Camera& camera, int viewportHeight) {
+    m_stats.uploadedBytes = 0;
+    m_stats.levelsUploaded = 0;
+
+    FinishLoads();
+    SelectLevels();
+    UploadLevels();
+
+    // Pixels covered per world unit at distance 1, for next frame's Bind() calls
+    m_cameraPosition = camera.GetPosition();
+    m_pixelScale = 0.5f * viewportHeight / std::tan(glm::radians(camera.GetFOV()) * 0.5f);
+    ++m_frame;
+}
+
+void TextureStreamer::ResetCounters() {
+    m_stats.evictions = 0;
+    m_stats.stalledFrames = 0;
+}
+
+void TextureStreamer::FinishLoads() {
+    std::vector<std::pair<Handle, std::unique_ptr<TextureFile>>> loaded;
+    {
+        std::lock_guard<std::mutex> lock(m_loadedMutex);
+        loaded.swap(m_loaded);
+    }
+
+    for (auto& entry : loaded) {
+        Texture& texture = *m_textures[entry.first];
+        --m_stats.pendingLoads;
+        if (!entry.second) {
+            texture.state = State::Failed;
+            continue;
+        }
+        if (!TextureFile::IsFormatSupported(entry.second->GetFormat())) {
+            std::cerr << "ERROR::TEXTURE::FORMAT_NOT_SUPPORTED " << texture.path << std::endl;
+            texture.state = State::Failed;
+            continue;
+        }
+
+        texture.file = std::move(entry.second);
+        texture.tailLevel = texture.file->GetLevelCount() - 1;
+        for (int level = 0; level < texture.file->GetLevelCount(); ++level) {
+            const TextureFile::Level& info = texture.file->GetLevel(level);
+            if (std::max(info.width, info.height) <= kTailSize) {
+                texture.tailLevel = level;
+                break;
+            }
+        }
+        texture.prefetchedLevel.store(texture.tailLevel);
+        texture.prefetchRequested = texture.tailLevel;
+        CreateTexture(texture);
+        texture.state = State::Ready;
+    }
+}
+
+void TextureStreamer::CreateTexture(Texture& texture) {
+    if (texture.texture != 0) {
+        glDeleteTextures(1, &texture.texture);
+    }
+    glGenTextures(1, &texture.texture);
+    glBindTexture(GL_TEXTURE_2D, texture.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.file->GetLevelCount() - 1);
+    UploadDirect(texture, texture.tailLevel);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// The mip tail is small enough to upload straight from the mapping
+void TextureStreamer::UploadDirect(Texture& texture, int finestLevel) {
+    const TextureFile& file = *texture.file;
+    m_stats.residentBytes -= texture.residentBytes;
+    texture.residentBytes = 0;
+
+    for (int level = file.GetLevelCount() - 1; level >= finestLevel; --level) {
+        const TextureFile::Level& info = file.GetLevel(level);
+        GLsizei size = static_cast<GLsizei>(TextureFile::LevelBytes(file.GetFormat(), info.width, info.height));
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, file.GetFormat(), info.width, info.height, 0, size, file.GetLevelData(level));
+        texture.residentBytes += size;
+        ++m_stats.levelsUploaded;
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, finestLevel);
+
+    texture.residentLevel = finestLevel;
+    m_stats.residentBytes += texture.residentBytes;
+}
+
+// Pick the level whose size roughly matches the texture's on-screen footprint.
+// Only textures drawn last frame are refined.
+void TextureStreamer::SelectLevels() {
+    for (auto& entry : m_textures) {
+        Texture& texture = *entry;
+        if (texture.state != State::Ready) {
+            continue;
+        }
+
+        if (texture.lastUsed != m_frame || texture.screenPixels <= 0.0f) {
+            texture.targetLevel = texture.tailLevel;
+            continue;
+        }
+
+        float size = static_cast<float>(std::max(texture.file->GetWidth(), texture.file->GetHeight()));
+        int level = static_cast<int>(std::floor(std::log2(std::max(size / texture.screenPixels, 1.0f))));
+        texture.targetLevel = std::clamp(level, 0, texture.tailLevel);
+
+        if (texture.targetLevel < texture.prefetchRequested) {
+            texture.prefetchRequested = texture.targetLevel;
+            Texture* target = &texture;
+            int finest = texture.targetLevel;
+            m_loaders->Submit([target, finest]() {
+                for (int level = target->prefetchedLevel.load() - 1; level >= finest; --level) {
+                    const TextureFile::Level& info = target->file->GetLevel(level);
+                    target->file->GetFile().Prefetch(info.offset, info.size);
+                    target->prefetchedLevel.store(level);
+                }
+            });
+        }
+    }
+}
+
+void TextureStreamer::UploadLevels() {
+    Pbo& pbo = m_pbos[m_pboIndex];
+    if (pbo.fence != nullptr) {
+        GLenum status = glClientWaitSync(pbo.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            ++m_stats.stalledFrames;
+            return;
+        }
+        glDeleteSync(pbo.fence);
+        pbo.fence = nullptr;
+    }
+
+    // Coarse-to-fine across all textures: always take the next level of the
+    // texture that is currently furthest from its full resolution
+    std::vector<Upload> uploads;
+    size_t planned = 0;
+    for (;;) {
+        Texture* best = nullptr;
+        for (auto& entry : m_textures) {
+            Texture& texture = *entry;
+            if (texture.state != State::Ready || texture.residentLevel <= texture.targetLevel
+                || texture.prefetchedLevel.load() > texture.residentLevel - 1) {
+                continue;
+            }
+            if (best == nullptr || texture.residentLevel > best->residentLevel
+                || (texture.residentLevel == best->residentLevel && texture.screenPixels > best->screenPixels)) {
+                best = &texture;
+            }
+        }
+        if (best == nullptr) {
+            break;
+        }
+
+        int level = best->residentLevel - 1;
+        const TextureFile::Level& info = best->file->GetLevel(level);
+        size_t bytes = TextureFile::LevelBytes(best->file->GetFormat(), info.width, info.height);
+        // A level larger than the whole budget still goes through, alone
+        if (planned > 0 && planned + bytes > m_uploadBudget) {
+            break;
+        }
+        if (!MakeRoom(bytes)) {
+            break;
+        }
+
+        uploads.push_back({ best, level, planned });
+        planned += bytes;
+        best->residentLevel = level;
+        best->residentBytes += bytes;
+        m_stats.residentBytes += bytes;
+    }
+
+    if (uploads.empty()) {
+        return;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.buffer);
+    if (planned > pbo.size) {
+        pbo.size = planned;
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, pbo.size, nullptr, GL_STREAM_DRAW);
+    }
+
+    // The fence above guarantees the GPU is done with this PBO
+    uint8_t* dst = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, planned,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    if (dst == nullptr) {
+        std::cerr << "ERROR::TEXTURESTREAMER::PBO_MAP_FAILED" << std::endl;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        // Roll back so the levels are retried next frame
+        for (auto it = uploads.rbegin(); it != uploads.rend(); ++it) {
+            const TextureFile::Level& info = it->texture->file->GetLevel(it->level);
+            size_t bytes = TextureFile::LevelBytes(it->texture->file->GetFormat(), info.width, info.height);
+            it->texture->residentLevel = it->level + 1;
+            it->texture->residentBytes -= bytes;
+            m_stats.residentBytes -= bytes;
+        }
+        return;
+    }
+    for (const Upload& upload : uploads) {
+        const TextureFile& file = *upload.texture->file;
+        const TextureFile::Level& info = file.GetLevel(upload.level);
+        std::memcpy(dst + upload.offset, file.GetLevelData(upload.level), TextureFile::LevelBytes(file.GetFormat(), info.width, info.height));
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    for (const Upload& upload : uploads) {
+        const TextureFile& file = *upload.texture->file;
+        const TextureFile::Level& info = file.GetLevel(upload.level);
+        GLsizei size = static_cast<GLsizei>(TextureFile::LevelBytes(file.GetFormat(), info.width, info.height));
+        glBindTexture(GL_TEXTURE_2D, upload.texture->texture);
+        glCompressedTexImage2D(GL_TEXTURE_2D, upload.level, file.GetFormat(), info.width, info.height, 0, size,
+                               reinterpret_cast<const void*>(upload.offset));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, upload.level);
+        ++m_stats.levelsUploaded;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    pbo.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_pboIndex = (m_pboIndex + 1) % kPboCount;
+    m_stats.uploadedBytes = planned;
+}
+
+// Evicts least recently used textures that were not drawn last frame until
+// `bytes` more fit in the residency budget
+bool TextureStreamer::MakeRoom(size_t bytes) {
+    while (m_stats.residentBytes + bytes > m_residencyBudget) {
+        Texture* victim = nullptr;
+        for (auto& entry : m_textures) {
+            Texture& texture = *entry;
+            if (texture.state == State::Ready && texture.lastUsed != m_frame && texture.residentLevel < texture.tailLevel
+                && (victim == nullptr || texture.lastUsed < victim->lastUsed)) {
+                victim = &texture;
+            }
+        }
+        if (victim == nullptr) {
+            return false;
+        }
+        Evict(*victim);
+    }
+    return true;
+}
+
+// GL 4.1 cannot release individual levels, so rebuild the texture with its tail
+void TextureStreamer::Evict(Texture& texture) {
+    CreateTexture(texture);
+    texture.prefetchRequested = texture.tailLevel;
+    ++m_stats.evictions;
+}
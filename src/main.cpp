@@ -1,9 +1,56 @@
 #include "Application.h"
+#include "Headless.h"
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    // CPU rendering without a window, for hosts with no usable GPU
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--software") == 0) {
+            return RunHeadless(argc, argv);
+        }
+    }
 
-int main() {
     Application app(800, 600, "OpenGL 4.5 - Points & Lines Demo");
 
+    // --capture <path> [--capture-frames N] records the first N frames for GLReplay
+    // --record <path> records video from startup (F7 toggles it at runtime)
+    // --multiview-bench times 1 to 16 views in both multi-view modes
+    // --dynamic-resolution [--resolution-scale <min> <max>] [--frame-target <ms>]
+    //   scales the 3D scene to hold a GPU frame time (R toggles it at runtime)
+    std::string capturePath;
+    std::string recordPath;
+    int captureFrames = 120;
+    bool dynamicResolution = false;
+    DynamicResolution::Settings resolutionSettings;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            capturePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--capture-frames") == 0 && i + 1 < argc) {
+            captureFrames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--multiview-bench") == 0) {
+            app.SetMultiViewBench(true);
+        } else if (std::strcmp(argv[i], "--dynamic-resolution") == 0) {
+            dynamicResolution = true;
+        } else if (std::strcmp(argv[i], "--resolution-scale") == 0 && i + 2 < argc) {
+            resolutionSettings.minScale = static_cast<float>(std::atof(argv[++i]));
+            resolutionSettings.maxScale = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--frame-target") == 0 && i + 1 < argc) {
+            resolutionSettings.targetMs = static_cast<float>(std::atof(argv[++i]));
+        }
+    }
+    if (!capturePath.empty()) {
+        app.SetCapture(capturePath, captureFrames);
+    }
+    if (!recordPath.empty()) {
+        app.SetRecordPath(recordPath);
+    }
+    app.SetDynamicResolution(dynamicResolution, resolutionSettings);
+
     if (!app.Initialize()) {
         std::cerr << "Failed to initialize application" << std::endl;
         return -1;
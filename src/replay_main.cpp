@@ -0,0 +1,82 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "GLReplay.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// Replays a capture written by OpenGLApp --capture on a hidden window:
+//   GLReplay capture.glcap [--sync] [--finish-calls] [--dump] [--csv frames.csv]
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: GLReplay <capture> [--sync] [--finish-calls] [--dump] [--csv <path>]" << std::endl;
+        return -1;
+    }
+
+    GLReplay::Options options;
+    std::string csvPath;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--sync") == 0) {
+            options.finishFrames = true;
+        } else if (std::strcmp(argv[i], "--finish-calls") == 0) {
+            options.finishCalls = true;
+        } else if (std::strcmp(argv[i], "--dump") == 0) {
+            options.dump = true;
+        } else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csvPath = argv[++i];
+        }
+    }
+
+    GLReplay replay;
+    if (!replay.Load(argv[1])) {
+        return -1;
+    }
+
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+
+    // Same context as the application; hidden, and never presented
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(std::max(replay.GetWidth(), 1), std::max(replay.GetHeight(), 1), "GLReplay", nullptr, nullptr);
+    if (!window) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+        window = glfwCreateWindow(std::max(replay.GetWidth(), 1), std::max(replay.GetHeight(), 1), "GLReplay", nullptr, nullptr);
+    }
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return -1;
+    }
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+    int result = 0;
+    if (replay.Run(options)) {
+        std::cout << replay.Report();
+        if (!csvPath.empty() && !replay.WriteFrameCsv(csvPath)) {
+            result = -1;
+        }
+    } else {
+        std::cerr << "ERROR::GL_REPLAY::NO_FRAMES_REPLAYED" << std::endl;
+        result = -1;
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return result;
+}